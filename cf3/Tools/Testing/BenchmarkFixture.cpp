@@ -0,0 +1,216 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <boost/lexical_cast.hpp>
+
+#include "common/BuildInfo.hpp"
+#include "common/Core.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "Tools/Testing/BenchmarkFixture.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace Tools {
+namespace Testing {
+
+using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+/// Quote a string for JSON
+std::string json_string(const std::string& str)
+{
+  std::string result("\"");
+  for (std::string::const_iterator c=str.begin(); c!=str.end(); ++c)
+  {
+    if (*c == '"' || *c == '\\')
+      result += '\\';
+    result += *c;
+  }
+  return result + "\"";
+}
+
+/// Value of an environment variable, or an empty string
+std::string environment_variable(const char* name)
+{
+  const char* value = std::getenv(name);
+  return value ? std::string(value) : std::string();
+}
+
+/// One measurement
+struct BenchmarkResult
+{
+  std::string name;
+  Real time;
+  Real work;
+  std::string work_unit;
+  Real memory_peak;
+};
+
+/// Results of all benchmarks in this executable, rewritten to the output file after each new result
+class BenchmarkResults
+{
+public:
+  static BenchmarkResults& instance()
+  {
+    static BenchmarkResults results;
+    return results;
+  }
+
+  void add(const BenchmarkResult& result)
+  {
+    // the communicator may already be finalized when the last test case is recorded
+    if (PE::Comm::instance().is_active())
+    {
+      m_rank = PE::Comm::instance().rank();
+      m_nb_procs = PE::Comm::instance().size();
+    }
+    m_results.push_back(result);
+    write();
+  }
+
+private:
+  BenchmarkResults() :
+    m_filename(environment_variable("CF3_BENCHMARK_OUTPUT")),
+    m_rank(0),
+    m_nb_procs(1)
+  {
+  }
+
+  void write() const
+  {
+    if (m_filename.empty() || m_rank != 0)
+      return;
+
+    std::ofstream file(m_filename.c_str());
+    if (!file)
+    {
+      std::cerr << "Could not write benchmark results to " << m_filename << std::endl;
+      return;
+    }
+
+    file.precision(12);
+    file << "{\n"
+         << "  \"suite\": " << json_string(boost::unit_test::framework::master_test_suite().p_name.get()) << ",\n"
+         << "  \"revision\": " << json_string(Core::instance().build_info().git_commit_sha()) << ",\n"
+         << "  \"build_type\": " << json_string(Core::instance().build_info().build_type()) << ",\n"
+         << "  \"nb_procs\": " << m_nb_procs << ",\n"
+         << "  \"scale\": " << BenchmarkFixture::scale() << ",\n"
+         << "  \"results\": [";
+    for (Uint i=0; i<m_results.size(); ++i)
+    {
+      const BenchmarkResult& result = m_results[i];
+      file << (i == 0 ? "\n" : ",\n")
+           << "    { \"name\": " << json_string(result.name)
+           << ", \"time\": " << result.time
+           << ", \"work\": " << result.work
+           << ", \"unit\": " << json_string(result.work_unit)
+           << ", \"throughput\": " << (result.time > 0. ? result.work/result.time : 0.)
+           << ", \"memory_peak\": " << result.memory_peak << " }";
+    }
+    file << "\n  ]\n}\n";
+  }
+
+  std::string m_filename;
+  Uint m_rank;
+  Uint m_nb_procs;
+  std::vector<BenchmarkResult> m_results;
+};
+
+/// Print a result in CDash format, and store it
+void add_result(const std::string& name, const Real time, const Real work, const std::string& work_unit)
+{
+  std::cout << "<DartMeasurement name=\"" << name << " time\" type=\"numeric/double\">" << time << "</DartMeasurement>" << std::endl;
+  if (work > 0. && time > 0.)
+    std::cout << "<DartMeasurement name=\"" << name << " " << work_unit << "/s\" type=\"numeric/double\">" << work/time << "</DartMeasurement>" << std::endl;
+
+  BenchmarkResult result;
+  result.name = name;
+  result.time = time;
+  result.work = work;
+  result.work_unit = work_unit;
+  result.memory_peak = OSystem::instance().layer()->memory_peak();
+  BenchmarkResults::instance().add(result);
+}
+
+} // detail
+
+////////////////////////////////////////////////////////////////////////////////
+
+BenchmarkFixture::BenchmarkFixture() :
+  m_work(0.)
+{
+  m_timer.restart();
+  m_case_timer.restart();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BenchmarkFixture::~BenchmarkFixture()
+{
+  detail::add_result(boost::unit_test::framework::current_test_case().p_name.get(), m_case_timer.elapsed(), m_work, m_work_unit);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Real BenchmarkFixture::scale()
+{
+  static const std::string scale_str = detail::environment_variable("CF3_BENCHMARK_SCALE");
+  static const Real factor = scale_str.empty() ? 1. : boost::lexical_cast<Real>(scale_str);
+  return factor;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint BenchmarkFixture::scaled(const Uint size)
+{
+  return std::max(1u, static_cast<Uint>(scale()*static_cast<Real>(size) + 0.5));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BenchmarkFixture::restart_timer()
+{
+  m_timer.restart();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BenchmarkFixture::record(const std::string& name, const Real work, const std::string& work_unit)
+{
+  const Real time = m_timer.elapsed();
+  detail::add_result(boost::unit_test::framework::current_test_case().p_name.get() + " " + name, time, work, work_unit);
+  m_timer.restart();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BenchmarkFixture::set_work(const Real work, const std::string& work_unit)
+{
+  m_work = work;
+  m_work_unit = work_unit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // Testing
+} // Tools
+} // cf3
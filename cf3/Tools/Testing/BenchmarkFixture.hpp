@@ -0,0 +1,78 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Tools_Testing_BenchmarkFixture_hpp
+#define cf3_Tools_Testing_BenchmarkFixture_hpp
+
+#include <string>
+
+#include "common/Timer.hpp"
+
+#include "Tools/Testing/LibTesting.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace Tools {
+namespace Testing {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Any test using this fixture (or a derivative) is timed, and its results are kept for comparison between revisions
+///
+/// Each test case is recorded when it ends, and record() adds measurements within a test case.
+/// Every result holds the wall time, the throughput if an amount of work was given, and the peak memory use of the process.
+/// The results are printed as CDash measurements, and written as JSON to the file named by the
+/// environment variable CF3_BENCHMARK_OUTPUT, if it is set. Only rank 0 writes the file.
+/// The environment variable CF3_BENCHMARK_SCALE scales the problem sizes returned by scaled().
+class Testing_API BenchmarkFixture
+{
+public:
+
+  /// Start timing the test case
+  BenchmarkFixture();
+
+  /// Record the test case
+  ~BenchmarkFixture();
+
+  /// Factor in CF3_BENCHMARK_SCALE, or 1 if it is not set
+  static Real scale();
+
+  /// Problem size multiplied by scale(), and at least 1
+  static Uint scaled(const Uint size);
+
+  /// Restart the timer used by record()
+  void restart_timer();
+
+  /// @brief Record the time since the last call to restart_timer() or record()
+  /// @param name       Name of the measurement, prefixed with the name of the test case
+  /// @param work       Amount of work done, e.g. the number of elements, used to compute the throughput. Zero if there is none.
+  /// @param work_unit  Unit of the work, e.g. "elements"
+  void record(const std::string& name, const Real work = 0., const std::string& work_unit = "");
+
+  /// Amount of work done by the whole test case, used for the throughput when the test case is recorded
+  void set_work(const Real work, const std::string& work_unit);
+
+private:
+  /// Times the measurements of record()
+  common::Timer m_timer;
+  /// Times the whole test case
+  common::Timer m_case_timer;
+  /// Work done by the test case
+  Real m_work;
+  /// Unit of m_work
+  std::string m_work_unit;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // Testing
+} // Tools
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_Tools_Testing_BenchmarkFixture_hpp
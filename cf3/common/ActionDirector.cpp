@@ -4,6 +4,11 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <map>
+
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
 #include "common/BasicExceptions.hpp"
 #include "common/Builder.hpp"
 #include "common/ComponentIterator.hpp"
@@ -16,7 +21,9 @@
 #include "common/OptionList.hpp"
 #include "common/PropertyList.hpp"
 #include "common/Signal.hpp"
+#include "common/ThreadPool.hpp"
 #include "common/URI.hpp"
+#include "common/Core.hpp"
 
 #include "common/XML/Protocol.hpp"
 #include "common/XML/SignalOptions.hpp"
@@ -36,10 +43,26 @@ ActionDirector::ActionDirector(const std::string& name): Action(name)
     .description("Names of the actions to disable")
     .pretty_name("Disabled Actions")
     .attach_trigger(boost::bind(&ActionDirector::trigger_disabled_actions, this));
+
+  m_concurrent = false;
+  options().add("concurrent", m_concurrent)
+    .description("Execute the actions as a task graph on the thread pool, concurrently unless ordered by the dependencies")
+    .pretty_name("Concurrent")
+    .link_to(&m_concurrent);
+
+  options().add("dependencies", std::vector<std::string>())
+    .description("Ordering of concurrent actions, as a list of \"action:prerequisite\" entries")
+    .pretty_name("Dependencies");
 }
 
 void ActionDirector::execute()
 {
+  if(m_concurrent)
+  {
+    execute_concurrently();
+    return;
+  }
+
   BOOST_FOREACH(Component& child, *this)
   {
     Handle<Action> action(follow_link(child));
@@ -60,6 +83,52 @@ void ActionDirector::execute()
   }
 }
 
+namespace
+{
+  /// Placeholder for disabled actions, keeping the ordering through them
+  void skip_action() {}
+
+  void execute_action(Action* action)
+  {
+    action->execute();
+  }
+}
+
+void ActionDirector::execute_concurrently()
+{
+  TaskGraph graph;
+  std::map<std::string, Uint> tasks;
+  BOOST_FOREACH(Component& child, *this)
+  {
+    Handle<Action> action(follow_link(child));
+    if(is_null(action))
+      continue;
+
+    if(is_disabled(action->name()))
+    {
+      CFdebug << name() << ": Skipping disabled action " << action->uri().path() << CFendl;
+      tasks[child.name()] = graph.add_task(&skip_action);
+    }
+    else
+    {
+      CFdebug << name() << ": Scheduling action " << action->uri().path() << CFendl;
+      tasks[child.name()] = graph.add_task(boost::bind(&execute_action, action.get()));
+    }
+  }
+
+  BOOST_FOREACH(const std::string& dependency, options().value< std::vector<std::string> >("dependencies"))
+  {
+    std::vector<std::string> names;
+    boost::algorithm::split(names, dependency, boost::algorithm::is_any_of(":"));
+    if(names.size() != 2 || !tasks.count(names[0]) || !tasks.count(names[1]))
+      throw SetupError(FromHere(), "Invalid dependency \"" + dependency + "\" in " + uri().string()
+                       + ": expected \"action:prerequisite\" with two child actions");
+    graph.add_dependency(tasks[names[0]], tasks[names[1]]);
+  }
+
+  graph.run(Core::instance().thread_pool());
+}
+
 bool ActionDirector::is_disabled(const std::string& name)
 {
   return m_disabled_actions.count(name);
@@ -22,6 +22,11 @@ namespace common {
 
 /// Executes actions or links to actions that are direct children of this component.
 /// Actions can be deactivated through a list of booleans
+///
+/// With option "concurrent" enabled, the actions are executed as a task graph on the
+/// thread pool of the Core. Actions run concurrently unless ordered by option "dependencies",
+/// a list of "action:prerequisite" entries. Only actions that do not modify shared
+/// data may run concurrently.
 class Common_API ActionDirector : public Action
 {
 public: // functions
@@ -42,7 +47,10 @@ protected:
   
 private:
   void trigger_disabled_actions();
+  /// Execute the child actions as a task graph on the thread pool
+  void execute_concurrently();
   std::set<std::string> m_disabled_actions;
+  bool m_concurrent;
 };
 
 /// Add a link to the passed action as a child
@@ -28,6 +28,7 @@
 #include "common/FindComponents.hpp"
 #include "common/Core.hpp"
 #include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
 #include "common/LibLoader.hpp"
 #include "common/PropertyList.hpp"
 #include "common/ComponentIterator.hpp"
@@ -93,6 +94,13 @@ Component::Component ( const std::string& name ) :
       .pretty_name("Print tree")
       .signature( boost::bind(&Component::signature_print_tree, this, _1) );
 
+  regist_signal( "print_memory_footprint" )
+      .connect( boost::bind( &Component::signal_print_memory_footprint, this, _1 ) )
+      .hidden(false)
+      .read_only(true)
+      .description("Print the memory footprint of the component tree inside this component")
+      .pretty_name("Print memory footprint")
+      .signature( boost::bind(&Component::signature_print_memory_footprint, this, _1) );
 
   regist_signal( "list_properties" )
       .connect( boost::bind( &Component::signal_list_properties, this, _1 ) )
@@ -799,6 +807,60 @@ size_t Component::count_children() const
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+size_t Component::recursive_memory_footprint() const
+{
+  size_t footprint = memory_footprint();
+  boost_foreach( const Component& c, *this )
+  {
+    footprint += c.recursive_memory_footprint();
+  }
+  return footprint;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string Component::memory_tree(Uint depth, Uint threshold, Uint recursion_level) const
+{
+  std::string tree;
+  const size_t footprint = recursive_memory_footprint();
+  if ( (recursion_level<=depth || depth==0) && footprint >= threshold )
+  {
+    for (Uint i=0; i<recursion_level; i++)
+      tree += "  ";
+    tree += name() + "  [" + OSystemLayer::memory_str(static_cast<Real>(footprint)) + "]\n";
+
+    boost_foreach( const Component& c, *this )
+    {
+      tree += c.memory_tree(depth,threshold,recursion_level+1);
+    }
+  }
+  return tree;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void Component::signal_print_memory_footprint( SignalArgs& args ) const
+{
+  SignalOptions options( args );
+  CFinfo << memory_tree(options.value<Uint>("depth"),options.value<Uint>("threshold")) << CFendl;
+  CFinfo << "process memory usage [" << OSystem::instance().layer()->memory_usage_str() << "]  "
+         << "high-water mark [" << OSystem::instance().layer()->memory_peak_str() << "]" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void Component::signature_print_memory_footprint( SignalArgs& args ) const
+{
+  SignalOptions options( args );
+
+  options.add("depth", 0u )
+      .description("Define howmany levels will be printed");
+  options.add("threshold", 0u )
+      .description("Components holding less bytes than this are not printed");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 PropertyList& Component::properties()
 {
   return *m_properties;
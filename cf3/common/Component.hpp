@@ -269,6 +269,22 @@ public: // functions
   /// @return Returns the number of children this component has.
   size_t count_children() const;
 
+  /// @return the number of bytes of data held by this component itself, excluding
+  /// its sub-components. Components storing large data structures (tables, lists,
+  /// matrices, ...) override this, the default returns 0.
+  virtual size_t memory_footprint() const { return 0; }
+
+  /// @return the number of bytes of data held by this component and all its sub-components
+  size_t recursive_memory_footprint() const;
+
+  /// @returns a string representation of the tree below this component,
+  /// annotated with the recursive memory footprint of each component
+  /// @param [in] depth       defines howmany recursions should maximally be performed
+  ///                         (default value depth=0 means full tree)
+  /// @param [in] threshold   components holding less bytes than this are not printed
+  /// @param [in] level       recursion parameter, should not be touched
+  std::string memory_tree(Uint depth=0, Uint threshold=0, Uint recursion_level=0) const;
+
   /// @return Returns the type name of the subclass, according to
   /// @c cf3::common::TypeInfo
   virtual std::string derived_type_name() const = 0;
@@ -340,6 +356,12 @@ public: // functions
   ///  signature to signal_print_tree
   void signature_print_tree ( SignalArgs& args ) const;
 
+  ///  signal to print the memory footprint of the tree
+  void signal_print_memory_footprint ( SignalArgs& args ) const;
+
+  ///  signature to signal_print_memory_footprint
+  void signature_print_memory_footprint ( SignalArgs& args ) const;
+
   /// renames this component
   void signal_rename_component ( SignalArgs& args ) ;
 
@@ -25,6 +25,7 @@
 #include "common/BuildInfo.hpp"
 #include "common/CodeProfiler.hpp"
 #include "common/LibLoader.hpp"
+#include "common/ThreadPool.hpp"
 #include "common/Core.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -60,6 +61,7 @@ Core::Core()
   // create singleton objects inside core
   m_build_info.reset    ( new BuildInfo()    );
   m_network_info.reset  ( new NetworkInfo()  );
+  m_thread_pool.reset   ( new ThreadPool()   );
 
 
   // this types must be registered immediately on creation,
@@ -134,6 +136,10 @@ void Core::terminate()
   if(is_not_null(m_libraries))
     libraries().terminate_all_libraries();
 
+  // join the worker threads before the components they may use disappear
+  if(is_not_null(m_thread_pool))
+    m_thread_pool->resize(0);
+
   m_root.reset();
   m_environment.reset();
   m_libraries.reset();
@@ -221,6 +227,14 @@ NetworkInfo& Core::network_info () const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+ThreadPool& Core::thread_pool () const
+{
+  cf3_assert( is_not_null(m_thread_pool) );
+  return *m_thread_pool;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 
 } // common
 } // cf3
@@ -28,6 +28,7 @@ namespace common {
   class Libraries;
   class Factories;
   class NetworkInfo;
+  class ThreadPool;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -93,6 +94,12 @@ public: // methods
   /// Gets the network information.
   /// @return Returns the network information.
   NetworkInfo& network_info() const;
+
+  /// Gets the thread pool shared by the whole process
+  /// @pre Core does not need to be initialized before
+  /// @note The pool has no worker threads, executing every task in the calling thread,
+  ///       until the Environment option "nb_threads" is changed
+  ThreadPool& thread_pool() const;
   
   /// command-line arguments count
   /// @return count of arguments
@@ -123,6 +130,8 @@ private: // data
   boost::shared_ptr< common::Group >        m_root;
   /// The network information
   boost::shared_ptr< common::NetworkInfo >  m_network_info;
+  /// The thread pool
+  boost::shared_ptr< common::ThreadPool >   m_thread_pool;
 
   /// command-line arguments count
   int m_argc;
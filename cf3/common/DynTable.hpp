@@ -106,6 +106,15 @@ public:
   /// @return A const reference to the array data
   const ArrayT& array() const { return m_array; }
 
+  /// @return the number of bytes held by the table data, including the row bookkeeping
+  virtual size_t memory_footprint() const
+  {
+    size_t footprint = m_array.capacity()*sizeof(std::vector<T>);
+    boost_foreach(const std::vector<T>& row, m_array)
+      footprint += row.capacity()*sizeof(T);
+    return footprint;
+  }
+
 private: // data
 
   ArrayT m_array;
@@ -12,6 +12,8 @@
 #include "common/Log.hpp"
 #include "common/Environment.hpp"
 #include "common/PropertyList.hpp"
+#include "common/Core.hpp"
+#include "common/ThreadPool.hpp"
 
 namespace cf3 {
 namespace common {
@@ -104,6 +106,35 @@ Environment::Environment ( const std::string& name) : Component ( name )
 
   trigger_log_level();
 
+  options().add("log_async", false)
+      .pretty_name("Asynchronous Log")
+      .description("If true, screen and file output of the log is written by a background thread")
+      .attach_trigger(boost::bind(&Environment::trigger_log_async,this));
+
+  options().add("log_aggregate", false)
+      .pretty_name("Aggregate Log")
+      .description("If true, the screen output of all ranks is collected and printed by rank 0 at the end of every iteration, "
+                   "identical messages being printed once with the number of ranks that sent them")
+      .attach_trigger(boost::bind(&Environment::trigger_log_aggregate,this));
+
+  options().add("log_rate_limit", 0u)
+      .pretty_name("Log Rate Limit")
+      .description("Maximum number of messages per second coming from the same line of code, zero for no limit")
+      .attach_trigger(boost::bind(&Environment::trigger_log_rate_limit,this));
+
+  options().add("nb_threads", 1u)
+      .pretty_name("Number of Threads")
+      .description("Number of threads executing tasks of the thread pool, including the calling thread. "
+                   "Zero divides the cores of the node over the MPI ranks running on it.")
+      .mark_basic()
+      .attach_trigger(boost::bind(&Environment::trigger_threads,this));
+
+  options().add("pin_threads", false)
+      .pretty_name("Pin Threads")
+      .description("If true, bind every thread of the thread pool to its own core, "
+                   "leaving the cores of the other MPI ranks on the node free.")
+      .attach_trigger(boost::bind(&Environment::trigger_threads,this));
+
   // signals
   signal("create_component")->hidden(true);
   signal("rename_component")->hidden(true);
@@ -180,5 +211,38 @@ void Environment::trigger_log_level()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Environment::trigger_log_async()
+{
+  Logger::instance().set_async(options().value<bool>("log_async"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Environment::trigger_log_aggregate()
+{
+  Logger::instance().set_aggregate(options().value<bool>("log_aggregate"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Environment::trigger_log_rate_limit()
+{
+  Logger::instance().set_rate_limit(options().value<Uint>("log_rate_limit"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Environment::trigger_threads()
+{
+  Uint nb_threads = options().value<Uint>("nb_threads");
+  if (nb_threads == 0)
+    nb_threads = ThreadPool::default_nb_threads();
+
+  // the thread waiting for tasks executes them as well
+  Core::instance().thread_pool().resize(nb_threads-1, options().value<bool>("pin_threads"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // common
 } // cf3
@@ -51,6 +51,14 @@ private: // functions
 
   void trigger_log_level();
 
+  void trigger_log_async();
+
+  void trigger_log_aggregate();
+
+  void trigger_log_rate_limit();
+
+  void trigger_threads();
+
 }; // Environment
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -12,6 +12,7 @@
 #include <execinfo.h>    // for backtrace() from glibc
 #include <sys/types.h>   // for getting the PID of the process
 #include <malloc.h>      //  for mallinfo
+#include <sys/resource.h> // for getrusage
 
 
 #include "common/BasicExceptions.hpp"
@@ -188,6 +189,18 @@ double OSystemLayer::memory_usage() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+double OSystemLayer::memory_peak() const
+{
+  struct rusage usage;
+  if ( getrusage(RUSAGE_SELF, &usage) != 0 )
+    return -1;
+
+  // on Linux ru_maxrss is reported in kilobytes
+  return static_cast<double>(usage.ru_maxrss) * 1024.;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void OSystemLayer::regist_os_signal_handlers()
 {
   // register handler functions for the signals
@@ -52,6 +52,10 @@ public:
   /// @return a double with the memory usage
   virtual double memory_usage() const;
 
+  /// Gets the peak memory usage
+  /// @return a double with the high-water mark of the memory usage
+  virtual double memory_peak() const;
+
   /// Regists the signal handlers that will be handled by this class
   virtual void regist_os_signal_handlers();
 
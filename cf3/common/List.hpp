@@ -110,6 +110,9 @@ public: // functions
   /// @return The number of local rows in the array
   Uint size() const { return m_array.size(); }
 
+  /// @return the number of bytes held by the list data
+  virtual size_t memory_footprint() const { return m_array.num_elements()*sizeof(ValueT); }
+
 private: // data
 
   /// storage of the array
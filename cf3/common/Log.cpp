@@ -22,6 +22,7 @@
 #include "common/Core.hpp"
 #include "common/Environment.hpp"
 #include "common/Log.hpp"
+#include "common/LogAsyncWriter.hpp"
 #include "common/PE/Comm.hpp"
 #include "common/OptionList.hpp"
 
@@ -37,12 +38,13 @@ namespace common {
 ////////////////////////////////////////////////////////////////////////////////
 
 Logger::Logger()
+: m_writer(new LogAsyncWriter())
 {
   // streams initialization
-  m_streams[ERROR]   = new LogStream("Error",   ERROR);
-  m_streams[WARNING] = new LogStream("Warning", WARNING);
-  m_streams[INFO]    = new LogStream("Info",    INFO);
-  m_streams[DEBUG]   = new LogStream("Debug",   DEBUG);
+  m_streams[ERROR]   = new LogStream("Error",   ERROR,   m_writer.get());
+  m_streams[WARNING] = new LogStream("Warning", WARNING, m_writer.get());
+  m_streams[INFO]    = new LogStream("Info",    INFO,    m_writer.get());
+  m_streams[DEBUG]   = new LogStream("Debug",   DEBUG,   m_writer.get());
 
   m_streams[ERROR]->setFilterRankZero( true );
 
@@ -151,5 +153,46 @@ void Logger::set_log_level(const Uint log_level)
 
 //////////////////////////////////////////////////////////////////////////////
 
+void Logger::set_async(const bool async)
+{
+  m_writer->set_running(async);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Logger::set_aggregate(const bool aggregate)
+{
+  std::map<LogLevel, LogStream *>::iterator it;
+
+  // errors and warnings are output immediately, they may precede an abort
+  for(it = m_streams.begin() ; it != m_streams.end() ; it++)
+  {
+    if(it->first != ERROR && it->first != WARNING)
+      it->second->setAggregate(aggregate);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Logger::aggregate()
+{
+  std::map<LogLevel, LogStream *>::iterator it;
+
+  for(it = m_streams.begin() ; it != m_streams.end() ; it++)
+    it->second->aggregate();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Logger::set_rate_limit(const Uint max_messages)
+{
+  std::map<LogLevel, LogStream *>::iterator it;
+
+  for(it = m_streams.begin() ; it != m_streams.end() ; it++)
+    it->second->setRateLimit(max_messages);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 } // common
 } // cf3
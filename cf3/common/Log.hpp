@@ -7,6 +7,8 @@
 #ifndef cf3_common_Log_hpp
 #define cf3_common_Log_hpp
 
+#include <boost/scoped_ptr.hpp>
+
 #include "common/CommonAPI.hpp"
 #include "common/LogLevel.hpp"
 #include "common/LogStream.hpp"
@@ -18,6 +20,7 @@ namespace cf3 {
 namespace common {
 
 class LogStream;
+class LogAsyncWriter;
 
 /// @brief Main class of the logging system.
 
@@ -80,8 +83,31 @@ class Common_API Logger : public boost::noncopyable {
 
   void set_log_level(const Uint log_level);
 
+  /// @brief Writes screen and file output from a background thread, or directly
+  void set_async(const bool async);
+
+  /// @brief Enables or disables the aggregation of the messages of all ranks
+
+  /// Only applies to the info and debug streams, errors and warnings are
+  /// always output immediately.
+  /// @see LogStream::setAggregate
+  void set_aggregate(const bool aggregate);
+
+  /// @brief Outputs the aggregated messages of all streams on rank 0
+
+  /// Collective operation, does nothing unless aggregation is enabled.
+  /// @see LogStream::aggregate
+  void aggregate();
+
+  /// @brief Limits the number of messages per second from a single code location
+  /// @see LogStream::setRateLimit
+  void set_rate_limit(const Uint max_messages);
+
   private :
 
+  /// @brief Writer shared by all streams, created before them
+  boost::scoped_ptr<LogAsyncWriter> m_writer;
+
   /// @brief Managed streams.
 
   /// The key is the stream type. The value is a pointer to the stream.
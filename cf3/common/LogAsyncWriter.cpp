@@ -0,0 +1,166 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <iostream>
+
+#include <boost/bind.hpp>
+
+#include "common/LogAsyncWriter.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+
+LogAsyncWriter::LogAsyncWriter()
+: m_nb_queued(0),
+m_nb_written(0),
+m_stop(false)
+{
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+LogAsyncWriter::~LogAsyncWriter()
+{
+  set_running(false);
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void LogAsyncWriter::set_running(const bool running)
+{
+  if(running == is_running())
+    return;
+
+  if(running)
+  {
+    m_stop = false;
+    m_thread.reset(new boost::thread(boost::bind(&LogAsyncWriter::run, this)));
+  }
+  else
+  {
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_work_available.notify_one();
+    m_thread->join();
+    m_thread.reset();
+  }
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void LogAsyncWriter::write(std::ostream & target, const char * text, const std::streamsize size)
+{
+  if(!is_running())
+  {
+    target.write(text, size);
+    return;
+  }
+
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if(m_pending.empty() || m_pending.back().target != &target)
+    {
+      m_pending.push_back(Entry());
+      m_pending.back().target = &target;
+      ++m_nb_queued;
+    }
+    m_pending.back().text.append(text, size);
+  }
+  m_work_available.notify_one();
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void LogAsyncWriter::flush()
+{
+  if(!is_running())
+    return;
+
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  const Uint nb_queued = m_nb_queued;
+  while(m_nb_written < nb_queued)
+    m_work_done.wait(lock);
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void LogAsyncWriter::run()
+{
+  std::vector<Entry> entries;
+  while(true)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(m_pending.empty() && !m_stop)
+        m_work_available.wait(lock);
+
+      if(m_pending.empty()) // stopped, and everything is written
+        return;
+
+      entries.swap(m_pending);
+    }
+
+    write_entries(entries);
+
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      m_nb_written += entries.size();
+    }
+    m_work_done.notify_all();
+    entries.clear();
+  }
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void LogAsyncWriter::write_entries(std::vector<Entry> & entries)
+{
+  // targets may share a file descriptor, so each entry is flushed before the
+  // next one is written to keep the order of the messages
+  std::vector<Entry>::iterator it;
+
+  for(it = entries.begin() ; it != entries.end() ; it++)
+  {
+    it->target->write(it->text.data(), it->text.size());
+    it->target->flush();
+  }
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+LogAsyncSink::LogAsyncSink(LogAsyncWriter & writer, std::ostream & target)
+: m_writer(&writer),
+m_target(&target)
+{
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+std::streamsize LogAsyncSink::write(const char * text, std::streamsize size)
+{
+  m_writer->write(*m_target, text, size);
+  return size;
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+bool LogAsyncSink::flush()
+{
+  if(!m_writer->is_running())
+    m_target->flush();
+  return true;
+}
@@ -0,0 +1,133 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_LogAsyncWriter_hpp
+#define cf3_common_LogAsyncWriter_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "common/BoostIostreams.hpp"
+
+#include "common/CF.hpp"
+#include "common/CommonAPI.hpp"
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Writes log output from a background thread
+
+/// While running, text passed to @c #write is appended to a pending buffer and
+/// the calling thread returns immediately. The background thread swaps the
+/// pending buffer with an empty one and writes it out, so the lock is only held
+/// to append or to swap. When not running, @c #write writes directly.
+class Common_API LogAsyncWriter : public boost::noncopyable
+{
+public:
+
+  LogAsyncWriter();
+
+  /// Stops the background thread, after writing everything that is pending
+  ~LogAsyncWriter();
+
+  /// @brief Starts or stops the background thread
+
+  /// Stopping writes all pending output first.
+  void set_running(const bool running);
+
+  /// @brief Checks whether output is written from the background thread
+  bool is_running() const { return m_thread.get() != 0; }
+
+  /// @brief Writes text to a target stream, or queues it if running
+  void write(std::ostream & target, const char * text, const std::streamsize size);
+
+  /// @brief Blocks until all text queued so far has been written and the targets flushed
+  void flush();
+
+private:
+
+  /// Text for one target, consecutive writes to the same target are merged
+  struct Entry
+  {
+    std::ostream * target;
+    std::string text;
+  };
+
+  /// Body of the background thread
+  void run();
+
+  /// Writes the entries and flushes their targets
+  static void write_entries(std::vector<Entry> & entries);
+
+  /// Output waiting to be written, protected by m_mutex
+  std::vector<Entry> m_pending;
+
+  /// Number of entries pushed and written, to implement flush()
+  Uint m_nb_queued;
+  Uint m_nb_written;
+
+  /// Set to stop the background thread
+  bool m_stop;
+
+  boost::mutex m_mutex;
+
+  /// Signals new pending output to the background thread
+  boost::condition_variable m_work_available;
+
+  /// Signals written output to threads waiting in flush()
+  boost::condition_variable m_work_done;
+
+  boost::scoped_ptr<boost::thread> m_thread;
+
+}; // class LogAsyncWriter
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Boost.Iostreams sink that passes its output to a LogAsyncWriter
+class Common_API LogAsyncSink
+{
+public:
+
+  typedef char char_type;
+  struct category : boost::iostreams::sink_tag, boost::iostreams::flushable_tag {};
+
+  /// @param writer The writer that decides when the text is written.
+  /// @param target The stream that receives the text.
+  LogAsyncSink(LogAsyncWriter & writer, std::ostream & target);
+
+  std::streamsize write(const char * text, std::streamsize size);
+
+  /// Flushes the target when writing synchronously. In asynchronous mode the
+  /// background thread flushes after each batch.
+  bool flush();
+
+private:
+
+  LogAsyncWriter * m_writer;
+
+  std::ostream * m_target;
+
+}; // class LogAsyncSink
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_LogAsyncWriter_hpp
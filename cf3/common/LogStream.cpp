@@ -4,7 +4,9 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
 
 #include "common/PE/Comm.hpp"
 #include "common/Log.hpp"
@@ -12,6 +14,7 @@
 #include "common/LogLevelFilter.hpp"
 #include "common/LogStampFilter.hpp"
 #include "common/LogStringForwarder.hpp"
+#include "common/LogAsyncWriter.hpp"
 #include "common/CodeLocation.hpp"
 
 
@@ -19,8 +22,12 @@ using namespace cf3;
 using namespace cf3::common;
 using namespace boost;
 
-LogStream::LogStream(const std::string & streamName, LogLevel level)
+LogStream::LogStream(const std::string & streamName, LogLevel level, LogAsyncWriter * writer)
 : m_buffer(),
+m_writer(writer),
+m_file(NULL),
+m_rate_limit(0),
+m_suppressed(false),
 m_streamName(streamName),
 m_filter_level(level),
 m_flushed(true)
@@ -32,7 +39,10 @@ m_flushed(true)
   stream = new iostreams::filtering_ostream();
   stream->push(levelFilter);
   stream->push(LogStampFilter(streamName));
-  stream->push(std::cout);
+  if(m_writer != NULL)
+    stream->push(LogAsyncSink(*m_writer, std::cout));
+  else
+    stream->push(std::cout);
   m_destinations[SCREEN] = stream;
 
   // FILE
@@ -52,12 +62,20 @@ m_flushed(true)
   stream->push(std::cout);
   m_destinations[SYNC_SCREEN] = stream;
 
+  // AGGREGATE
+  stream = new iostreams::filtering_ostream();
+  stream->push(levelFilter);
+  stream->push(LogStampFilter(streamName));
+  stream->push(back_inserter(m_aggregate_buffer));
+  m_destinations[AGGREGATE] = stream;
+
 
-  // by default, we use all destinations except SYNC_SCREEN
+  // by default, we use all destinations except SYNC_SCREEN and AGGREGATE
   m_usedDests[SCREEN] = true;
   m_usedDests[FILE] = true;
   m_usedDests[STRING] = true;
   m_usedDests[SYNC_SCREEN] = false;
+  m_usedDests[AGGREGATE] = false;
 
   // by default, only the first processor outputs
   m_filterRankZero[SCREEN] = true;
@@ -65,6 +83,8 @@ m_flushed(true)
   m_filterRankZero[STRING] = true;
   m_filterRankZero[SYNC_SCREEN] = true;
 
+  // all processes contribute to the aggregated output
+  m_filterRankZero[AGGREGATE] = false;
 }
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -77,8 +97,18 @@ LogStream::~LogStream()
   if(!m_flushed)
     this->flush();
 
+  // messages logged after the last aggregation would be lost otherwise
+  this->outputAggregated();
+
   for(it = m_destinations.begin() ; it != m_destinations.end() ; it++)
     delete it->second;
+
+  // the writer may still hold output for the file or the screen
+  if(m_writer != NULL)
+    m_writer->flush();
+
+  if(m_file != NULL)
+    delete m_file;
 }
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -93,6 +123,7 @@ LogStream & LogStream::operator << (LogLevel tmp_log_level)
 
   this->getLevelFilter(STRING).set_tmp_log_level(tmp_log_level);
   this->getLevelFilter(SYNC_SCREEN).set_tmp_log_level(tmp_log_level);
+  this->getLevelFilter(AGGREGATE).set_tmp_log_level(tmp_log_level);
 
   return *this;
 }
@@ -113,6 +144,44 @@ LogStream & LogStream::operator << (LogTag tag)
 
 LogStream & LogStream::operator << (const CodeLocation & place)
 {
+  Uint nb_dropped = 0;
+
+  // only the first location of a message counts for the rate limit
+  if(m_rate_limit != 0 && m_flushed && !m_suppressed)
+  {
+    const posix_time::ptime now = posix_time::microsec_clock::universal_time();
+    std::map<std::string, RateCount>::iterator count_it = m_rate_counts.find(place.str());
+
+    if(count_it == m_rate_counts.end())
+    {
+      RateCount count;
+      count.period_start = now;
+      count.nb_messages = 0;
+      count.nb_dropped = 0;
+      count_it = m_rate_counts.insert(std::make_pair(place.str(), count)).first;
+    }
+
+    RateCount & count = count_it->second;
+
+    if(now - count.period_start >= posix_time::seconds(1))
+    {
+      count.period_start = now;
+      count.nb_messages = 0;
+    }
+
+    if(count.nb_messages < m_rate_limit)
+    {
+      ++count.nb_messages;
+      nb_dropped = count.nb_dropped;
+      count.nb_dropped = 0;
+    }
+    else
+    {
+      ++count.nb_dropped;
+      m_suppressed = true;
+    }
+  }
+
   this->getStampFilter(SCREEN).setPlace(place);
 
   if(this->isFileOpen())
@@ -120,6 +189,10 @@ LogStream & LogStream::operator << (const CodeLocation & place)
 
   this->getStampFilter(STRING).setPlace(place);
   this->getStampFilter(SYNC_SCREEN).setPlace(place);
+  this->getStampFilter(AGGREGATE).setPlace(place);
+
+  if(nb_dropped != 0)
+    *this << "(" << nb_dropped << " messages from this location were dropped by the rate limit)\n";
 
   return *this;
 }
@@ -147,6 +220,7 @@ void LogStream::flush()
 
   this->getLevelFilter(STRING).resetToDefaultLevel();
   this->getLevelFilter(SYNC_SCREEN).resetToDefaultLevel();
+  this->getLevelFilter(AGGREGATE).resetToDefaultLevel();
 
   this->getStampFilter(SCREEN).endMessage();
 
@@ -155,6 +229,13 @@ void LogStream::flush()
 
   this->getStampFilter(STRING).endMessage();
   this->getStampFilter(SYNC_SCREEN).endMessage();
+  this->getStampFilter(AGGREGATE).endMessage();
+
+  if(!m_aggregate_buffer.empty())
+  {
+    m_aggregate_messages.push_back(m_aggregate_buffer);
+    m_aggregate_buffer.clear();
+  }
 
   if(!m_buffer.empty())
   {
@@ -169,6 +250,7 @@ void LogStream::flush()
   }
 
   m_flushed = true;
+  m_suppressed = false;
 }
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -183,6 +265,7 @@ void LogStream::set_log_level(const Uint level)
 
   this->getLevelFilter(STRING).set_log_level(level);
   this->getLevelFilter(SYNC_SCREEN).set_log_level(level);
+  this->getLevelFilter(AGGREGATE).set_log_level(level);
 }
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -206,6 +289,7 @@ void LogStream::set_filter(LogLevel level)
 
   this->getLevelFilter(STRING).set_filter(level);
   this->getLevelFilter(SYNC_SCREEN).set_filter(level);
+  this->getLevelFilter(AGGREGATE).set_filter(level);
 }
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -275,6 +359,7 @@ void LogStream::setStamp(const std::string & stampFormat)
 
   this->getStampFilter(STRING).setStamp(stampFormat);
   this->getStampFilter(SYNC_SCREEN).setStamp(stampFormat);
+  this->getStampFilter(AGGREGATE).setStamp(stampFormat);
 }
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -315,7 +400,14 @@ void LogStream::setFile(const iostreams::file_descriptor_sink & fileDescr)
 
     stream->push(LogLevelFilter(m_filter_level));
     stream->push(LogStampFilter(m_streamName));
-    stream->push(fileDescr);
+
+    if(m_writer != NULL)
+    {
+      m_file = new iostreams::stream<iostreams::file_descriptor_sink>(fileDescr);
+      stream->push(LogAsyncSink(*m_writer, *m_file));
+    }
+    else
+      stream->push(fileDescr);
 
     m_destinations[FILE] = stream;
   }
@@ -373,3 +465,158 @@ unsigned int LogStream::getStringForwarderCount() const
   return (unsigned int) m_stringForwarders.size();
 }
 
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void LogStream::setAggregate(bool aggregate)
+{
+  if(aggregate == this->isAggregating())
+    return;
+
+  if(!aggregate)
+    this->outputAggregated();
+
+  m_usedDests[AGGREGATE] = aggregate;
+  m_usedDests[SCREEN] = !aggregate;
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void LogStream::outputAggregated()
+{
+  // output what was collected so far, without waiting for the other ranks
+  std::vector<std::string>::const_iterator it;
+  for(it = m_aggregate_messages.begin() ; it != m_aggregate_messages.end() ; it++)
+  {
+    if(m_writer != NULL)
+      m_writer->write(std::cout, it->data(), it->size());
+    else
+      std::cout << *it;
+  }
+  m_aggregate_messages.clear();
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+bool LogStream::isAggregating() const
+{
+  return m_usedDests.find(AGGREGATE)->second;
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void LogStream::aggregate()
+{
+  if(!this->isAggregating())
+    return;
+
+  // messages are separated by a null character, the last one always ends the
+  // data so that no rank sends an empty array
+  std::vector<char> local_data;
+  std::vector<std::string>::const_iterator msg_it;
+  for(msg_it = m_aggregate_messages.begin() ; msg_it != m_aggregate_messages.end() ; msg_it++)
+  {
+    local_data.insert(local_data.end(), msg_it->begin(), msg_it->end());
+    local_data.push_back('\0');
+  }
+  local_data.push_back('\0');
+  m_aggregate_messages.clear();
+
+  std::vector<char> all_data;
+  std::vector<int> all_sizes(1, local_data.size());
+
+  if(PE::Comm::instance().is_active() && PE::Comm::instance().size() > 1)
+  {
+    all_sizes.assign(PE::Comm::instance().size(), -1);
+    PE::Comm::instance().gather(local_data, local_data.size(), all_data, all_sizes, 0);
+    if(PE::Comm::instance().rank() != 0)
+      return;
+  }
+  else
+  {
+    all_data.swap(local_data);
+  }
+
+  const std::string text = mergeMessages(all_data, all_sizes);
+  if(m_writer != NULL)
+    m_writer->write(std::cout, text.data(), text.size());
+  else
+    std::cout << text << std::flush;
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+std::string LogStream::mergeMessages(const std::vector<char> & data, const std::vector<int> & sizes)
+{
+  const Uint nb_ranks = sizes.size();
+
+  // A line is identified by its text and by how often its rank sent that text before,
+  // so that the n-th occurrence of a line is merged over the ranks, and repeats from
+  // one rank are all kept. Lines are output in the order they first arrive.
+  typedef std::pair<std::string, Uint> LineKey;
+  std::vector<LineKey> lines;
+  std::map<LineKey, Uint> nb_senders;
+  std::vector<char>::const_iterator rank_begin = data.begin();
+  for(Uint rank = 0 ; rank != sizes.size() ; ++rank)
+  {
+    const std::vector<char>::const_iterator rank_end = rank_begin + sizes[rank];
+    std::map<std::string, Uint> nb_occurrences;
+    std::vector<char>::const_iterator begin = rank_begin;
+    while(begin != rank_end)
+    {
+      std::vector<char>::const_iterator end = std::find(begin, rank_end, '\0');
+      if(end == rank_end)
+        break;
+      if(end != begin)
+      {
+        const std::string message(begin, end);
+        const LineKey key(message, nb_occurrences[message]++);
+        std::map<LineKey, Uint>::iterator count_it = nb_senders.find(key);
+        if(count_it == nb_senders.end())
+        {
+          nb_senders[key] = 1;
+          lines.push_back(key);
+        }
+        else
+        {
+          ++count_it->second;
+        }
+      }
+      begin = end + 1;
+    }
+    rank_begin = rank_end;
+  }
+
+  std::ostringstream output;
+  std::vector<LineKey>::const_iterator line_it;
+  for(line_it = lines.begin() ; line_it != lines.end() ; line_it++)
+  {
+    const std::string& message = line_it->first;
+    const Uint count = nb_senders[*line_it];
+    if(nb_ranks == 1 || count == 1)
+    {
+      output << message;
+      continue;
+    }
+
+    // put the rank count before the line end
+    const std::string::size_type text_end = message.find_last_not_of('\n') + 1;
+    output << message.substr(0, text_end) << " [" << count << "/" << nb_ranks << " ranks]" << message.substr(text_end);
+  }
+
+  return output.str();
+}
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void LogStream::setRateLimit(Uint max_messages)
+{
+  m_rate_limit = max_messages;
+  m_rate_counts.clear();
+}
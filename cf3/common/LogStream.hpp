@@ -11,12 +11,16 @@
 
 #include "common/BoostIostreams.hpp"
 
+#include <boost/iostreams/stream.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
 #include "common/PE/Comm.hpp"
 
 namespace cf3 {
 namespace common {
 
 class CodeLocation;
+class LogAsyncWriter;
 class LogToStream;
 class LogLevelFilter;
 class LogStampFilter;
@@ -58,19 +62,27 @@ class Common_API LogStream
 		/// @brief Standard output (with MPI synchronization)
 		/// @note If one processor will output more than another, that processor will
 		/// wait FOREVER for synchronization. Use with care!
-		SYNC_SCREEN = 8
+		SYNC_SCREEN = 8,
+
+    /// @brief Standard output of rank 0, combining identical messages of all ranks
+    /// @note Messages are only output by @c #aggregate(), which must be
+    /// called by all processes.
+    AGGREGATE = 16
 	};
 
 
   /// @brief Constructor
 
   /// @param fileStream The file stream.
-  LogStream(const std::string & streamName, LogLevel level = INFO);
+  /// @param writer If not @c NULL, @c #SCREEN and @c #FILE output is passed to
+  /// this writer, which can write it from a background thread.
+  LogStream(const std::string & streamName, LogLevel level = INFO, LogAsyncWriter * writer = NULL);
 
   /// @brief Destructor.
 
   /// Frees all allocated memory. The file stream is not destroyed. All
-  /// unflushed streams are flushed
+  /// unflushed streams are flushed, and the messages that were not
+  /// aggregated yet are output, as if aggregation was disabled.
   ~LogStream();
 
   /// @brief Flushes the stream contents.
@@ -103,6 +115,9 @@ class Common_API LogStream
   /// @return Returns a reference to this object.
   template <typename T> LogStream & operator << (const T & t)
   {
+    if (m_suppressed)
+      return *this;
+
     std::map<LogDestination, boost::iostreams::filtering_ostream *>::iterator it;
 
     for(it = m_destinations.begin() ; it != m_destinations.end() ; it++)
@@ -279,8 +294,60 @@ class Common_API LogStream
   /// @return Returns the number of string forwarders.
   unsigned int getStringForwarderCount() const;
 
+  /// @brief Enables or disables the aggregation of the messages of all ranks
+
+  /// While enabled, the @c #AGGREGATE destination replaces @c #SCREEN.
+  /// Disabling outputs the messages that were not aggregated yet on each rank.
+  /// @param aggregate If @c true, aggregation is enabled.
+  void setAggregate(bool aggregate);
+
+  /// @brief Checks whether aggregation is enabled
+  bool isAggregating() const;
+
+  /// @brief Outputs the collected messages of all ranks on rank 0
+
+  /// Identical messages are printed once, followed by the number of ranks that
+  /// sent them, in the order in which rank 0, then rank 1, ... sent them.
+  /// Does nothing if aggregation is disabled. Otherwise this is a collective
+  /// operation, that must be called by all processes.
+  void aggregate();
+
+  /// @brief Merges the messages gathered from all ranks
+
+  /// The n-th occurrence of a message on a rank is merged with the n-th
+  /// occurrence on the other ranks, so that a message repeated by one rank is
+  /// output as many times as it was sent, and only counts distinct ranks.
+  /// @param data The messages of all ranks, each ended by a null character.
+  /// @param sizes The number of characters sent by each rank.
+  /// @return The text to output.
+  static std::string mergeMessages(const std::vector<char> & data, const std::vector<int> & sizes);
+
+  /// @brief Limits the number of messages per code location
+
+  /// At most @c max_messages messages coming from the same
+  /// @link CodeLocation code location @endlink are output per second, the
+  /// others are dropped. The number of dropped messages is reported with the
+  /// next message that is output from that location.
+  /// @param max_messages The maximum number of messages per second. Zero
+  /// disables the limit.
+  void setRateLimit(Uint max_messages);
+
   private:
 
+  /// @brief Outputs the messages of this rank that were not aggregated yet
+  void outputAggregated();
+
+  /// @brief Message count of a code location within the current period
+  struct RateCount
+  {
+    /// Start of the period
+    boost::posix_time::ptime period_start;
+    /// Messages in the period
+    Uint nb_messages;
+    /// Messages dropped since the last output message
+    Uint nb_dropped;
+  };
+
   /// @brief Destinations.
 
   /// The key is the destination. The value is the corresponding stream.
@@ -302,6 +369,27 @@ class Common_API LogStream
   /// @brief Buffer for @c #STRING destination
   std::string m_buffer;
 
+  /// @brief Buffer for the message being written to @c #AGGREGATE
+  std::string m_aggregate_buffer;
+
+  /// @brief Complete messages, waiting for @c #aggregate()
+  std::vector<std::string> m_aggregate_messages;
+
+  /// @brief Writer for @c #SCREEN and @c #FILE output, may be @c NULL
+  LogAsyncWriter * m_writer;
+
+  /// @brief The stream to the file, if a writer is used
+  boost::iostreams::stream<boost::iostreams::file_descriptor_sink> * m_file;
+
+  /// @brief Maximum number of messages per second and per code location, zero if unlimited
+  Uint m_rate_limit;
+
+  /// @brief Message counts, by code location
+  std::map<std::string, RateCount> m_rate_counts;
+
+  /// @brief If @c true, the current message is dropped by the rate limit
+  bool m_suppressed;
+
   /// @brief Stream name
 
   /// This attribute is used on @c #FILE stream creation.
@@ -12,6 +12,7 @@
 #include <sstream>       // streamstring
 #include <execinfo.h>    // for backtrace() from glibc
 #include <sys/types.h>   // for getting the PID of the process
+#include <sys/resource.h> // for getrusage
 
 
 #include <mach/mach_types.h>
@@ -176,6 +177,18 @@ double OSystemLayer::memory_usage() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+double OSystemLayer::memory_peak() const
+{
+  struct rusage usage;
+  if ( getrusage(RUSAGE_SELF, &usage) != 0 )
+    return -1;
+
+  // on Mac OS X ru_maxrss is reported in bytes
+  return static_cast<double>(usage.ru_maxrss);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 /// Following functions are required since they are not available for Mac OSX
 /// This only works for intel architecture
 /// http://www-personal.umich.edu/~williams/archive/computation/fe-handling-example.c
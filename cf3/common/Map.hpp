@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
 #include "common/Component.hpp"
 
 namespace cf3 {
@@ -150,6 +152,23 @@ public: // functions
     return true;
   }
   
+  /// @brief Erase all entries for which the predicate is true, in a single pass
+  /// @note Erasing keeps the map sorted, so this does not call the costly sort_keys()
+  /// @param[in] pred  unary predicate on a std::pair<KEY,DATA>
+  template <typename Predicate>
+  void erase_if (const Predicate& pred)
+  {
+    m_vectorMap.erase(std::remove_if(m_vectorMap.begin(), m_vectorMap.end(), pred), m_vectorMap.end());
+  }
+
+  /// @brief Insert pairs into the sorted map, keeping it sorted
+  ///
+  /// Only the new pairs are sorted, and then merged with the existing ones in a single pass,
+  /// which is cheaper than sort_keys() when few pairs are inserted in a large map.
+  /// @param[in] pairs  new pairs, with keys that are not in the map. They are sorted on return.
+  /// @pre the map must be sorted
+  void merge (std::vector<value_type>& pairs);
+
   /// @brief Check if the given KEY is existing in the Map
   /// @param[in] key  key to be looked-up
   /// @pre Before using exists() the CFMap has to be sorted with sort_keys().
@@ -172,6 +191,9 @@ public: // functions
   /// @brief Get the capacity of the map (memory allocated)
   size_t capacity() const;
 
+  /// @brief Get the number of bytes allocated by the map
+  virtual size_t memory_footprint() const;
+
   /// @brief Overloading of the operator"[]" for assignment AND insertion
   /// @note WARNING: This procedure will call the costly sort_keys() if the map is not sorted
   /// @param[in] key The key to look for. If the key is not found,
@@ -403,6 +425,14 @@ size_t Map<KEY,DATA>::capacity() const
 
 //////////////////////////////////////////////////////////////////////////////
 
+template <typename KEY, typename DATA>
+inline size_t Map<KEY,DATA>::memory_footprint() const
+{
+  return m_vectorMap.capacity()*sizeof(value_type);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 template <typename KEY, typename DATA>
 size_t Map<KEY,DATA>::size() const
 {
@@ -435,6 +465,21 @@ inline const typename Map<KEY,DATA>::data_type& Map<KEY,DATA>::operator[] (const
 
 //////////////////////////////////////////////////////////////////////////////
 
+template <typename KEY, typename DATA>
+void Map<KEY,DATA>::merge(std::vector<value_type>& pairs)
+{
+  cf3_assert_desc ( "Map internal structure must be sorted" , m_sorted);
+  std::sort(pairs.begin(), pairs.end(), LessThan());
+  const size_t old_size = size();
+  m_vectorMap.insert(m_vectorMap.end(), pairs.begin(), pairs.end());
+  std::inplace_merge(begin(), begin()+old_size, end(), LessThan());
+
+  cf3_assert_desc ("Duplicated keys detected in map "+uri().string(),
+    std::unique (begin(), end(), unique_key ) - begin() == (int) size() );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 template <typename KEY, typename DATA>
 void Map<KEY,DATA>::sort_keys()
 {
@@ -48,8 +48,20 @@ void OSystemLayer::execute_command(const std::string& call)
 
 std::string OSystemLayer::memory_usage_str () const
 {
-  const cf3::Real bytes = memory_usage();
+  return memory_str( memory_usage() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
+std::string OSystemLayer::memory_peak_str () const
+{
+  return memory_str( memory_peak() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string OSystemLayer::memory_str (const cf3::Real bytes)
+{
   std::ostringstream out;
   if (  bytes/1024 <= 1 ) {
   out << bytes << " B";
@@ -66,6 +66,21 @@ public: // functions
   /// @param out the output stream
   std::string memory_usage_str () const;
 
+  /// Gets the high-water mark of the memory usage of this process
+  /// @return a double with the peak memory usage in bytes
+  virtual cf3::Real memory_peak () const = 0;
+
+  /// @returns a string with the peak memory usage
+  /// @post adds the unit of memory (B, KB, MB or GB)
+  /// @post  no end of line added
+  std::string memory_peak_str () const;
+
+  /// @returns a string with the given amount of memory
+  /// @post adds the unit of memory (B, KB, MB or GB)
+  /// @post  no end of line added
+  /// @param bytes the amount of memory in bytes
+  static std::string memory_str (const cf3::Real bytes);
+
   /// Executes the command passed in the string
   /// @todo should return the output of the command but not yet implemented.
   void execute_command (const std::string& call);
@@ -656,6 +656,14 @@ void CommPattern::remove_local(Uint lid, bool on_all_ranks)
 // Component related
 ////////////////////////////////////////////////////////////////////////////////
 
+size_t CommPattern::memory_footprint() const
+{
+  return ( m_add_buffer.capacity() + m_mov_buffer.capacity() + m_rem_buffer.capacity() ) * sizeof(temp_buffer_item)
+       + m_free_lids.capacity() * sizeof(Uint)
+       + m_isUpdatable.capacity() / 8
+       + ( m_sendCount.capacity() + m_sendMap.capacity() + m_recvCount.capacity() + m_recvMap.capacity() ) * sizeof(CPint);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 } // PE
@@ -281,6 +281,10 @@ public:
   /// @return vector of bools
   std::vector<bool>& isUpdatable() { return m_isUpdatable; }
 
+  /// number of bytes held by the communication pattern and its temporary buffers
+  /// @return the memory footprint in bytes
+  virtual size_t memory_footprint() const;
+
   //@} END ACCESSORS
 
 protected: // helper function
@@ -0,0 +1,261 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <limits>
+
+#include "common/Foreach.hpp"
+#include "common/PE/Comm.hpp"
+#include "common/PE/DistributedDirectory.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+namespace PE {
+
+////////////////////////////////////////////////////////////////////////////////
+
+DistributedDirectory::DistributedDirectory() :
+  m_nb_procs(Comm::instance().is_active() ? Comm::instance().size() : 1u)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint DistributedDirectory::home_rank(const KeyT key) const
+{
+  if (!m_splitters.empty())
+    return std::upper_bound(m_splitters.begin(), m_splitters.end(), key) - m_splitters.begin();
+
+  // Mix the bits, so consecutive ids are spread over all ranks
+  KeyT h = key;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return static_cast<Uint>(h % m_nb_procs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DistributedDirectory::partition_keys(const std::vector<KeyT>& keys)
+{
+  cf3_assert(m_entries.empty());
+  m_splitters.clear();
+  if (m_nb_procs == 1)
+    return;
+
+  // Regular samples of the sorted ids. Ranks with less ids than samples fill up with the largest possible id.
+  const Uint nb_samples = m_nb_procs-1;
+  std::vector<KeyT> sorted_keys(keys);
+  std::sort(sorted_keys.begin(), sorted_keys.end());
+  std::vector<KeyT> samples(nb_samples, std::numeric_limits<KeyT>::max());
+  if (!sorted_keys.empty())
+  {
+    for (Uint s=0; s<nb_samples; ++s)
+      samples[s] = sorted_keys[(s*sorted_keys.size())/nb_samples];
+  }
+
+  // The first rank chooses the splitters from all samples, and broadcasts them
+  std::vector<KeyT> all_samples;
+  Comm::instance().gather(samples, all_samples, 0);
+  std::vector<KeyT> splitters;
+  if (Comm::instance().rank() == 0)
+  {
+    std::sort(all_samples.begin(), all_samples.end());
+    for (Uint p=0; p<m_nb_procs-1; ++p)
+      splitters.push_back(all_samples[(p+1)*nb_samples]);
+  }
+  Comm::instance().broadcast(splitters, m_splitters, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DistributedDirectory::insert(const std::vector<KeyT>& keys)
+{
+  insert(keys, std::vector<Uint>(), std::vector<Uint>(keys.size()+1, 0u));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DistributedDirectory::insert(const std::vector<KeyT>& keys, const std::vector<Uint>& payload, const std::vector<Uint>& payload_start)
+{
+  cf3_assert(payload_start.size() == keys.size()+1);
+
+  // Message per entry: key, payload size, payload
+  std::vector< std::vector<KeyT> > send(m_nb_procs);
+  for (Uint i=0; i<keys.size(); ++i)
+  {
+    std::vector<KeyT>& message = send[home_rank(keys[i])];
+    message.push_back(keys[i]);
+    message.push_back(payload_start[i+1]-payload_start[i]);
+    for (Uint j=payload_start[i]; j<payload_start[i+1]; ++j)
+      message.push_back(payload[j]);
+  }
+
+  std::vector< std::vector<KeyT> > recv;
+  exchange(send, recv);
+
+  // Messages are processed in order of increasing rank, which keeps the entries of each id sorted by rank
+  for (Uint p=0; p<m_nb_procs; ++p)
+  {
+    const std::vector<KeyT>& message = recv[p];
+    Uint i=0;
+    while (i<message.size())
+    {
+      const KeyT key = message[i];
+      const Uint nb_payload = message[i+1];
+      i += 2;
+      Entry entry;
+      entry.rank = p;
+      entry.payload_begin = m_payload.size();
+      for (Uint j=0; j<nb_payload; ++j)
+        m_payload.push_back(message[i++]);
+      entry.payload_end = m_payload.size();
+      m_entries[key].push_back(entry);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DistributedDirectory::find_owners(const std::vector<KeyT>& keys, std::vector<Uint>& owners) const
+{
+  std::vector< std::vector<KeyT> > send(m_nb_procs);
+  std::vector< std::vector<Uint> > send_idx(m_nb_procs);
+  for (Uint i=0; i<keys.size(); ++i)
+  {
+    const Uint home = home_rank(keys[i]);
+    send[home].push_back(keys[i]);
+    send_idx[home].push_back(i);
+  }
+
+  std::vector< std::vector<KeyT> > queries;
+  exchange(send, queries);
+
+  std::vector< std::vector<KeyT> > answers(m_nb_procs);
+  for (Uint p=0; p<m_nb_procs; ++p)
+  {
+    answers[p].reserve(queries[p].size());
+    boost_foreach(const KeyT key, queries[p])
+    {
+      const std::map< KeyT, std::vector<Entry> >::const_iterator found = m_entries.find(key);
+      answers[p].push_back(found == m_entries.end() ? std::numeric_limits<Uint>::max() : found->second.front().rank);
+    }
+  }
+
+  std::vector< std::vector<KeyT> > recv;
+  exchange(answers, recv);
+
+  // Answers arrive in the order the queries were sent
+  owners.assign(keys.size(), std::numeric_limits<Uint>::max());
+  for (Uint p=0; p<m_nb_procs; ++p)
+  {
+    cf3_assert(recv[p].size() == send_idx[p].size());
+    for (Uint q=0; q<send_idx[p].size(); ++q)
+      owners[send_idx[p][q]] = recv[p][q];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DistributedDirectory::find_payloads(const std::vector<KeyT>& keys, std::vector<Uint>& payload, std::vector<Uint>& payload_start, const bool include_own) const
+{
+  std::vector< std::vector<KeyT> > send(m_nb_procs);
+  std::vector< std::vector<Uint> > send_idx(m_nb_procs);
+  for (Uint i=0; i<keys.size(); ++i)
+  {
+    const Uint home = home_rank(keys[i]);
+    send[home].push_back(keys[i]);
+    send_idx[home].push_back(i);
+  }
+
+  std::vector< std::vector<KeyT> > queries;
+  exchange(send, queries);
+
+  // Answer per query: payload size, payload
+  std::vector< std::vector<KeyT> > answers(m_nb_procs);
+  for (Uint p=0; p<m_nb_procs; ++p)
+  {
+    boost_foreach(const KeyT key, queries[p])
+    {
+      const Uint size_idx = answers[p].size();
+      answers[p].push_back(0u);
+      const std::map< KeyT, std::vector<Entry> >::const_iterator found = m_entries.find(key);
+      if (found == m_entries.end())
+        continue;
+      boost_foreach(const Entry& entry, found->second)
+      {
+        if (entry.rank == p && !include_own)
+          continue;
+        answers[p].insert(answers[p].end(), m_payload.begin()+entry.payload_begin, m_payload.begin()+entry.payload_end);
+      }
+      answers[p][size_idx] = answers[p].size() - size_idx - 1;
+    }
+  }
+
+  std::vector< std::vector<KeyT> > recv;
+  exchange(answers, recv);
+
+  // Count the payload for each key, then copy it in key order
+  std::vector<Uint> nb_payload(keys.size(), 0u);
+  std::vector< std::vector<Uint> > recv_begin(m_nb_procs);
+  for (Uint p=0; p<m_nb_procs; ++p)
+  {
+    recv_begin[p].resize(send_idx[p].size());
+    Uint i=0;
+    for (Uint q=0; q<send_idx[p].size(); ++q)
+    {
+      nb_payload[send_idx[p][q]] = recv[p][i];
+      recv_begin[p][q] = i+1;
+      i += recv[p][i] + 1;
+    }
+    cf3_assert(i == recv[p].size());
+  }
+
+  payload_start.resize(keys.size()+1);
+  payload_start[0] = 0;
+  for (Uint i=0; i<keys.size(); ++i)
+    payload_start[i+1] = payload_start[i] + nb_payload[i];
+
+  payload.resize(payload_start.back());
+  for (Uint p=0; p<m_nb_procs; ++p)
+  {
+    for (Uint q=0; q<send_idx[p].size(); ++q)
+    {
+      const Uint key_idx = send_idx[p][q];
+      std::copy(recv[p].begin()+recv_begin[p][q], recv[p].begin()+recv_begin[p][q]+nb_payload[key_idx], payload.begin()+payload_start[key_idx]);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DistributedDirectory::clear()
+{
+  m_entries.clear();
+  m_payload.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DistributedDirectory::exchange(const std::vector< std::vector<KeyT> >& send, std::vector< std::vector<KeyT> >& recv) const
+{
+  if (m_nb_procs == 1)
+  {
+    recv = send;
+    return;
+  }
+  Comm::instance().all_to_all(send, recv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace PE
+} // namespace common
+} // namespace cf3
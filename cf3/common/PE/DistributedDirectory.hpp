@@ -0,0 +1,115 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+/// @file DistributedDirectory.hpp
+/// @brief Directory of global ids, distributed over the ranks
+
+#ifndef CF3_COMMON_PE_DistributedDirectory_hpp
+#define CF3_COMMON_PE_DistributedDirectory_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <map>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include "common/CommonAPI.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+namespace PE {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Directory mapping global ids to the ranks that have them, and an optional payload per rank
+///
+/// Every global id has a home rank, found by hashing the id, or by the range of ids of each rank after
+/// partition_keys(). Ranks register their ids with insert(),
+/// which sends each entry to its home rank. Queries are also sent to the home rank, which answers directly.
+/// Each operation thus takes a fixed number of all_to_all exchanges, and the data per rank only depends on
+/// the number of ids that rank inserts or queries, not on the number of ranks.
+/// All operations, except home_rank(), are collective.
+/// Without an active communicator, the directory works on the local data only.
+class Common_API DistributedDirectory
+{
+public:
+
+  typedef boost::uint64_t KeyT;
+
+  /// @brief Constructor, creating an empty directory
+  DistributedDirectory();
+
+  /// @brief Rank that manages the given global id
+  Uint home_rank(const KeyT key) const;
+
+  /// @brief Give each rank a contiguous range of ids to manage, by a sample sort of the given ids
+  ///
+  /// Each rank sends regular samples of its sorted ids to the first rank, which chooses the range boundaries
+  /// and broadcasts them. This balances the ids over the ranks when they are not spread evenly,
+  /// e.g. space filling curve keys. Must be called before any insert().
+  /// @param [in] keys  The ids this rank will insert
+  void partition_keys(const std::vector<KeyT>& keys);
+
+  /// @brief Register global ids for this rank, without payload
+  void insert(const std::vector<KeyT>& keys);
+
+  /// @brief Register global ids for this rank, with a payload of variable length for each id
+  /// @param [in] keys           The global ids
+  /// @param [in] payload        The payloads, stored contiguously
+  /// @param [in] payload_start  Payload of keys[i] is in payload[payload_start[i]] up to payload[payload_start[i+1]]
+  void insert(const std::vector<KeyT>& keys, const std::vector<Uint>& payload, const std::vector<Uint>& payload_start);
+
+  /// @brief Lowest rank that inserted each global id, or std::numeric_limits<Uint>::max() if no rank did
+  void find_owners(const std::vector<KeyT>& keys, std::vector<Uint>& owners) const;
+
+  /// @brief Payloads that other ranks inserted for each global id, concatenated in order of increasing rank
+  /// @param [in]  keys           The global ids to look up
+  /// @param [out] payload        The found payloads, stored contiguously
+  /// @param [out] payload_start  Payloads for keys[i] are in payload[payload_start[i]] up to payload[payload_start[i+1]]
+  /// @param [in]  include_own    Also return the payloads inserted by this rank
+  void find_payloads(const std::vector<KeyT>& keys, std::vector<Uint>& payload, std::vector<Uint>& payload_start, const bool include_own=false) const;
+
+  /// @brief Remove all entries, keeping the ranges of partition_keys()
+  void clear();
+
+private:
+
+  /// Entry inserted by one rank
+  struct Entry
+  {
+    Uint rank;
+    Uint payload_begin;
+    Uint payload_end;
+  };
+
+  /// Send message i to rank i, receive message i from rank i
+  void exchange(const std::vector< std::vector<KeyT> >& send, std::vector< std::vector<KeyT> >& recv) const;
+
+  /// Number of ranks
+  Uint m_nb_procs;
+
+  /// Rank p manages the ids in [ m_splitters[p-1] , m_splitters[p] ), if not empty
+  std::vector<KeyT> m_splitters;
+
+  /// Entries for the ids managed by this rank, ordered by rank for each id
+  std::map< KeyT, std::vector<Entry> > m_entries;
+
+  /// Payload storage for m_entries
+  std::vector<Uint> m_payload;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // namespace PE
+} // namespace common
+} // namespace cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // CF3_COMMON_PE_DistributedDirectory_hpp
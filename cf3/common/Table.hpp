@@ -132,6 +132,9 @@ public: // functions
   /// could be passed to be consistent with DynTable with variable row_sizes
   Uint row_size(Uint i=0) const { return m_array.shape()[1]; }
 
+  /// @return the number of bytes held by the table data
+  virtual size_t memory_footprint() const { return m_array.num_elements()*sizeof(ValueT); }
+
   /// copy a given row into the array, The row type must have the size() function declared
   /// @param[in] array_idx the index of the row that will be set
   /// @param[in] row       the row that will be copied into the array
@@ -0,0 +1,455 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#ifdef CF3_OS_LINUX
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#include "common/BasicExceptions.hpp"
+#include "common/Foreach.hpp"
+#include "common/StringConversion.hpp"
+#include "common/ThreadPool.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// @return the value of the first defined environment variable in the list, or the default
+Uint environment_value(const char* names[], const Uint nb_names, const Uint default_value)
+{
+  for (Uint i=0; i<nb_names; ++i)
+  {
+    const char* value = std::getenv(names[i]);
+    if (value != NULL)
+      return from_str<Uint>(value);
+  }
+  return default_value;
+}
+
+/// Rank and number of ranks on this node, as exported by the common MPI launchers
+Uint local_rank()
+{
+  const char* names[] = { "OMPI_COMM_WORLD_LOCAL_RANK", "MV2_COMM_WORLD_LOCAL_RANK", "MPI_LOCALRANKID" };
+  return environment_value(names,3,0u);
+}
+
+Uint local_size()
+{
+  const char* names[] = { "OMPI_COMM_WORLD_LOCAL_SIZE", "MV2_COMM_WORLD_LOCAL_SIZE", "MPI_LOCALNRANKS" };
+  return std::max(1u,environment_value(names,3,1u));
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::ThreadPool(const Uint nb_threads, const bool pin_threads) :
+  m_nb_pending(0),
+  m_next_queue(0),
+  m_stop(false),
+  m_pin_threads(pin_threads)
+{
+  resize(nb_threads,pin_threads);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::~ThreadPool()
+{
+  stop();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::resize(const Uint nb_threads, const bool pin_threads)
+{
+  stop();
+
+  m_stop = false;
+  m_next_queue = 0;
+  m_pin_threads = pin_threads;
+  m_queues.resize(nb_threads);
+  for (Uint worker=0; worker<nb_threads; ++worker)
+    m_queues[worker].reset(new Queue);
+
+  m_threads.resize(nb_threads);
+  for (Uint worker=0; worker<nb_threads; ++worker)
+    m_threads[worker].reset(new boost::thread(boost::bind(&ThreadPool::work,this,worker)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::stop()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  for (Uint worker=0; worker<m_threads.size(); ++worker)
+    m_threads[worker]->join();
+  m_threads.clear();
+  m_queues.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::submit(const Task& task)
+{
+  if (m_queues.empty())
+  {
+    task();
+    return;
+  }
+
+  Uint worker = current_worker();
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if (worker == nb_threads())
+    {
+      worker = m_next_queue;
+      m_next_queue = (m_next_queue+1) % nb_threads();
+    }
+    ++m_nb_pending;
+  }
+  {
+    boost::lock_guard<boost::mutex> lock(m_queues[worker]->mutex);
+    m_queues[worker]->tasks.push_back(task);
+  }
+  m_wake.notify_one();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ThreadPool::pop_task(const Uint worker, Task& task)
+{
+  const Uint nb_queues = nb_threads();
+
+  // own queue first, most recent task: its data is most likely still in cache
+  if (worker < nb_queues)
+  {
+    Queue& own = *m_queues[worker];
+    boost::lock_guard<boost::mutex> lock(own.mutex);
+    if (!own.tasks.empty())
+    {
+      task = own.tasks.back();
+      own.tasks.pop_back();
+      boost::lock_guard<boost::mutex> count_lock(m_mutex);
+      --m_nb_pending;
+      return true;
+    }
+  }
+
+  // steal the oldest task of another queue
+  for (Uint i=1; i<=nb_queues; ++i)
+  {
+    Queue& victim = *m_queues[(worker+i) % nb_queues];
+    boost::lock_guard<boost::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty())
+    {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      boost::lock_guard<boost::mutex> count_lock(m_mutex);
+      --m_nb_pending;
+      return true;
+    }
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ThreadPool::run_pending_task()
+{
+  if (m_queues.empty())
+    return false;
+
+  Task task;
+  if (!pop_task(current_worker(),task))
+    return false;
+  task();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::work(const Uint worker)
+{
+  if (m_pin_threads)
+    pin(worker);
+
+  Task task;
+  while (true)
+  {
+    if (pop_task(worker,task))
+    {
+      task();
+      task.clear();
+      continue;
+    }
+
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    while (m_nb_pending == 0 && !m_stop)
+      m_wake.wait(lock);
+    if (m_stop && m_nb_pending == 0)
+      return;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint ThreadPool::current_worker() const
+{
+  const boost::thread::id id = boost::this_thread::get_id();
+  for (Uint worker=0; worker<m_threads.size(); ++worker)
+  {
+    if (m_threads[worker]->get_id() == id)
+      return worker;
+  }
+  return nb_threads();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ThreadPool::pin(const Uint worker)
+{
+#ifdef CF3_OS_LINUX
+  // ranks on the same node get consecutive, disjoint sets of cores
+  const Uint nb_cores = std::max(1u,boost::thread::hardware_concurrency());
+  const Uint core = (local_rank()*nb_threads() + worker) % nb_cores;
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(core,&cpuset);
+  pthread_setaffinity_np(pthread_self(),sizeof(cpu_set_t),&cpuset);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint ThreadPool::default_nb_threads()
+{
+  const Uint nb_cores = std::max(1u,boost::thread::hardware_concurrency());
+  return std::max(1u,nb_cores/local_size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Execute one range of a parallel_for
+void execute_range(const ThreadPool::RangeTask& body, const Uint begin, const Uint end)
+{
+  body(begin,end);
+}
+
+}
+
+void ThreadPool::parallel_for(const Uint begin, const Uint end, const RangeTask& body, const Uint grain_size)
+{
+  if (end <= begin)
+    return;
+
+  const Uint size = end-begin;
+  // a few ranges per thread, so that stealing can balance uneven ranges
+  const Uint grain = grain_size ? grain_size : std::max(1u, size / (4u*(nb_threads()+1u)));
+  if (m_queues.empty() || size <= grain)
+  {
+    body(begin,end);
+    return;
+  }
+
+  TaskGroup group(*this);
+  for (Uint range_begin=begin; range_begin<end; range_begin+=grain)
+    group.run(boost::bind(&execute_range,boost::cref(body),range_begin,std::min(end,range_begin+grain)));
+  group.wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+TaskGroup::TaskGroup(ThreadPool& pool) :
+  m_pool(pool),
+  m_nb_running(0),
+  m_failed(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TaskGroup::~TaskGroup()
+{
+  try
+  {
+    wait();
+  }
+  catch (...)
+  {
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TaskGroup::run(const ThreadPool::Task& task)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    ++m_nb_running;
+  }
+  m_pool.submit(boost::bind(&TaskGroup::execute,this,task));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TaskGroup::execute(const ThreadPool::Task& task)
+{
+  bool failed = false;
+  std::string error;
+  try
+  {
+    task();
+  }
+  catch (std::exception& e)
+  {
+    failed = true;
+    error = e.what();
+  }
+  catch (...)
+  {
+    failed = true;
+    error = "unknown exception";
+  }
+
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  if (failed && !m_failed)
+  {
+    m_failed = true;
+    m_error = error;
+  }
+  if (--m_nb_running == 0)
+    m_done.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TaskGroup::wait()
+{
+  while (true)
+  {
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      if (m_nb_running == 0)
+        break;
+    }
+    if (!m_pool.run_pending_task())
+    {
+      // Tasks of this group are running in other threads. Wake up regularly,
+      // to help with nested tasks they may queue.
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      if (m_nb_running != 0)
+        m_done.timed_wait(lock,boost::posix_time::milliseconds(1));
+    }
+  }
+
+  std::string error;
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if (!m_failed)
+      return;
+    error = m_error;
+    m_failed = false;
+  }
+  throw ParallelError(FromHere(), "A task failed: " + error);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+Uint TaskGraph::add_task(const ThreadPool::Task& task)
+{
+  m_tasks.push_back(task);
+  m_dependents.push_back(std::vector<Uint>());
+  m_nb_prerequisites.push_back(0);
+  return m_tasks.size()-1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TaskGraph::add_dependency(const Uint task, const Uint prerequisite)
+{
+  cf3_assert(task < m_tasks.size());
+  cf3_assert(prerequisite < m_tasks.size());
+  m_dependents[prerequisite].push_back(task);
+  ++m_nb_prerequisites[task];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TaskGraph::run(ThreadPool& pool)
+{
+  // Detect cycles before executing anything
+  {
+    std::vector<Uint> nb_waiting = m_nb_prerequisites;
+    std::vector<Uint> ready;
+    for (Uint task=0; task<m_tasks.size(); ++task)
+      if (nb_waiting[task] == 0)
+        ready.push_back(task);
+    Uint nb_visited = 0;
+    while (!ready.empty())
+    {
+      const Uint task = ready.back();
+      ready.pop_back();
+      ++nb_visited;
+      boost_foreach(const Uint dependent, m_dependents[task])
+        if (--nb_waiting[dependent] == 0)
+          ready.push_back(dependent);
+    }
+    if (nb_visited != m_tasks.size())
+      throw SetupError(FromHere(), "Task dependencies contain a cycle");
+  }
+
+  m_nb_waiting = m_nb_prerequisites;
+  TaskGroup group(pool);
+  for (Uint task=0; task<m_tasks.size(); ++task)
+  {
+    if (m_nb_prerequisites[task] == 0)
+      group.run(boost::bind(&TaskGraph::execute,this,task,boost::ref(group)));
+  }
+  group.wait();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TaskGraph::execute(const Uint task, TaskGroup& group)
+{
+  m_tasks[task]();
+
+  std::vector<Uint> ready;
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    boost_foreach(const Uint dependent, m_dependents[task])
+      if (--m_nb_waiting[dependent] == 0)
+        ready.push_back(dependent);
+  }
+  boost_foreach(const Uint dependent, ready)
+    group.run(boost::bind(&TaskGraph::execute,this,dependent,boost::ref(group)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
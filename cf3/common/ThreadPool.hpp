@@ -0,0 +1,231 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_ThreadPool_hpp
+#define cf3_common_ThreadPool_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "common/CF.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Process-wide pool of worker threads with work stealing
+///
+/// Every worker owns a queue of tasks. A worker takes the most recently queued
+/// task of its own queue, and when that is empty, steals the oldest task of another
+/// worker. Tasks queued from outside the pool are distributed round-robin.
+/// Threads waiting for tasks (see TaskGroup::wait()) help executing queued tasks,
+/// so that tasks may themselves start and wait for nested tasks.
+///
+/// The pool of the process is accessed through Core::instance().thread_pool(),
+/// and configured by the Environment options "nb_threads" and "pin_threads".
+/// A pool with zero workers executes every task immediately in the calling thread.
+class Common_API ThreadPool : public boost::noncopyable
+{
+public: // typedefs
+
+  typedef boost::function<void ()> Task;
+
+  /// Body of a parallel_for, executed for the index range [begin,end)
+  typedef boost::function<void (const Uint, const Uint)> RangeTask;
+
+public: // functions
+
+  /// Constructor
+  /// @param [in] nb_threads  number of worker threads
+  /// @param [in] pin_threads bind every worker to its own core
+  ThreadPool(const Uint nb_threads=0, const bool pin_threads=false);
+
+  /// Destructor, waits for the queued tasks to finish
+  ~ThreadPool();
+
+  /// Stop the current workers, and start a given number of new ones
+  /// @pre no tasks may be running
+  void resize(const Uint nb_threads, const bool pin_threads=false);
+
+  /// @return the number of worker threads
+  Uint nb_threads() const { return m_queues.size(); }
+
+  /// Queue a task. Use a TaskGroup to wait for its completion.
+  void submit(const Task& task);
+
+  /// Execute one queued task in the calling thread, if any is available
+  /// @return true if a task was executed
+  bool run_pending_task();
+
+  /// Execute body over [begin,end), split in ranges that are executed concurrently.
+  /// Returns when all ranges are done. An exception thrown by the body is reported as ParallelError.
+  /// @param [in] grain_size  minimal number of indices per range, zero for an automatic choice
+  void parallel_for(const Uint begin, const Uint end, const RangeTask& body, const Uint grain_size=0);
+
+  /// Default number of threads for this process: the hardware concurrency
+  /// divided over the MPI ranks running on the same node
+  static Uint default_nb_threads();
+
+  /// Index of the worker running the calling thread, or nb_threads() if outside the pool.
+  /// Tasks can use it to select per-thread scratch data out of nb_threads()+1 slots.
+  Uint current_worker() const;
+
+private: // functions
+
+  /// Main loop of worker thread with given index
+  void work(const Uint worker);
+
+  /// Take a task from the queue of the given worker, or steal one from another queue
+  bool pop_task(const Uint worker, Task& task);
+
+  /// Bind the worker with given index to a core, taking into account the other MPI ranks on this node
+  void pin(const Uint worker);
+
+  /// Stop and join all workers
+  void stop();
+
+private: // data
+
+  struct Queue
+  {
+    boost::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /// one queue per worker
+  std::vector< boost::shared_ptr<Queue> > m_queues;
+
+  /// the worker threads, in the same order as the queues
+  std::vector< boost::shared_ptr<boost::thread> > m_threads;
+
+  /// protects m_nb_pending, m_next_queue and m_stop
+  boost::mutex m_mutex;
+
+  /// signals idle workers that tasks were queued
+  boost::condition_variable m_wake;
+
+  /// total number of queued tasks
+  Uint m_nb_pending;
+
+  /// queue receiving the next task submitted from outside the pool
+  Uint m_next_queue;
+
+  /// set when the workers must exit
+  bool m_stop;
+
+  /// bind workers to cores
+  bool m_pin_threads;
+
+}; // ThreadPool
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Set of tasks that can be waited for
+///
+/// @code
+/// TaskGroup group(Core::instance().thread_pool());
+/// group.run(boost::bind(&compute,0));
+/// group.run(boost::bind(&compute,1));
+/// group.wait();
+/// @endcode
+///
+/// An exception thrown by a task is caught in the thread executing it, and reported
+/// by wait() as a ParallelError carrying the description of the first failure.
+class Common_API TaskGroup : public boost::noncopyable
+{
+public:
+
+  /// Constructor
+  TaskGroup(ThreadPool& pool);
+
+  /// Destructor, waits for all tasks (ignoring exceptions)
+  ~TaskGroup();
+
+  /// Queue a task in the pool
+  void run(const ThreadPool::Task& task);
+
+  /// Wait until all tasks of this group are done, executing queued tasks meanwhile
+  void wait();
+
+private:
+
+  /// Wrapper around every task, counting and catching exceptions
+  void execute(const ThreadPool::Task& task);
+
+  ThreadPool& m_pool;
+  boost::mutex m_mutex;
+  boost::condition_variable m_done;
+  Uint m_nb_running;
+  bool m_failed;
+  std::string m_error;
+
+}; // TaskGroup
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Tasks with dependencies, executed concurrently as soon as their prerequisites are done
+///
+/// @code
+/// TaskGraph graph;
+/// const Uint a = graph.add_task(task_a);
+/// const Uint b = graph.add_task(task_b);
+/// const Uint c = graph.add_task(task_c);
+/// graph.add_dependency(c,a);   // c runs after a, b runs concurrently with both
+/// graph.run(Core::instance().thread_pool());
+/// @endcode
+class Common_API TaskGraph : public boost::noncopyable
+{
+public:
+
+  /// Add a task
+  /// @return the index of the task, used to add dependencies
+  Uint add_task(const ThreadPool::Task& task);
+
+  /// Make a task wait for the completion of a prerequisite task
+  void add_dependency(const Uint task, const Uint prerequisite);
+
+  /// Execute all tasks, returning when all are done.
+  /// After an exception the tasks that depend on the failed one are not executed,
+  /// and a ParallelError is thrown.
+  /// @throw SetupError if the dependencies contain a cycle
+  void run(ThreadPool& pool);
+
+private:
+
+  /// Execute a task, and queue its dependents that became ready
+  void execute(const Uint task, TaskGroup& group);
+
+  std::vector<ThreadPool::Task> m_tasks;
+  std::vector< std::vector<Uint> > m_dependents;
+  std::vector<Uint> m_nb_prerequisites;
+
+  /// remaining prerequisites of every task during run()
+  std::vector<Uint> m_nb_waiting;
+  boost::mutex m_mutex;
+
+}; // TaskGraph
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_ThreadPool_hpp
@@ -360,6 +360,27 @@ double OSystemLayer::memory_usage () const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+double OSystemLayer::memory_peak () const
+{
+  double return_value = 0.;
+
+  HANDLE hProcess = GetCurrentProcess();
+
+  PROCESS_MEMORY_COUNTERS pmc;
+
+  if ( hProcess != NULL )
+  {
+    if ( GetProcessMemoryInfo( hProcess, &pmc, sizeof(pmc)) )
+      return_value = (double) pmc.PeakWorkingSetSize;
+
+    CloseHandle( hProcess );
+  }
+
+  return return_value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void OSystemLayer::regist_os_signal_handlers()
 {
 }
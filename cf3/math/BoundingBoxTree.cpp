@@ -0,0 +1,215 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <limits>
+
+#include "common/Assertions.hpp"
+
+#include "math/BoundingBoxTree.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+/// Orders box indices by the centre of the boxes in one direction
+struct BoxCentreLess
+{
+  BoxCentreLess(const std::vector<Real>& boxes, const Uint dim, const Uint direction) :
+    m_boxes(boxes), m_dim(dim), m_direction(direction) {}
+
+  bool operator()(const Uint a, const Uint b) const
+  {
+    return centre(a) < centre(b);
+  }
+
+  Real centre(const Uint box) const
+  {
+    return m_boxes[2*m_dim*box+m_direction] + m_boxes[2*m_dim*box+m_dim+m_direction];
+  }
+
+  const std::vector<Real>& m_boxes;
+  const Uint m_dim;
+  const Uint m_direction;
+};
+
+} // detail
+
+//////////////////////////////////////////////////////////////////////////////
+
+BoundingBoxTree::BoundingBoxTree() :
+  m_dim(0u)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void BoundingBoxTree::clear()
+{
+  m_boxes.clear();
+  m_order.clear();
+  m_node_bounds.clear();
+  m_node_begin.clear();
+  m_node_end.clear();
+  m_node_children.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void BoundingBoxTree::build(const Uint dim, const std::vector<Real>& boxes, const Uint max_leaf_size)
+{
+  cf3_assert(dim > 0);
+  cf3_assert(boxes.size() % (2*dim) == 0);
+  cf3_assert(max_leaf_size > 0);
+
+  clear();
+  m_dim = dim;
+  m_boxes = boxes;
+
+  const Uint nb_boxes = boxes.size() / (2*dim);
+  if (nb_boxes == 0)
+    return;
+
+  m_order.resize(nb_boxes);
+  for (Uint i=0; i<nb_boxes; ++i)
+    m_order[i] = i;
+
+  // A binary tree with at most nb_boxes leaves has less than 2*nb_boxes nodes
+  m_node_begin.reserve(2*nb_boxes);
+  m_node_end.reserve(2*nb_boxes);
+  m_node_children.reserve(2*nb_boxes);
+  m_node_bounds.reserve(2*nb_boxes*2*dim);
+
+  build_node(add_node(0u, nb_boxes), max_leaf_size);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void BoundingBoxTree::build_node(const Uint node, const Uint max_leaf_size)
+{
+  const Uint begin = m_node_begin[node];
+  const Uint end = m_node_end[node];
+
+  // Bounding box of the node
+  const Uint bounds_idx = 2*m_dim*node;
+  for (Uint d=0; d<m_dim; ++d)
+  {
+    m_node_bounds[bounds_idx+d]       =  std::numeric_limits<Real>::max();
+    m_node_bounds[bounds_idx+m_dim+d] = -std::numeric_limits<Real>::max();
+  }
+  for (Uint i=begin; i<end; ++i)
+  {
+    const Uint box_idx = 2*m_dim*m_order[i];
+    for (Uint d=0; d<m_dim; ++d)
+    {
+      m_node_bounds[bounds_idx+d]       = std::min(m_node_bounds[bounds_idx+d],       m_boxes[box_idx+d]);
+      m_node_bounds[bounds_idx+m_dim+d] = std::max(m_node_bounds[bounds_idx+m_dim+d], m_boxes[box_idx+m_dim+d]);
+    }
+  }
+
+  if (end-begin <= max_leaf_size)
+    return;
+
+  // Split at the median along the longest side
+  Uint direction = 0;
+  for (Uint d=1; d<m_dim; ++d)
+  {
+    if (m_node_bounds[bounds_idx+m_dim+d]-m_node_bounds[bounds_idx+d] >
+        m_node_bounds[bounds_idx+m_dim+direction]-m_node_bounds[bounds_idx+direction])
+      direction = d;
+  }
+  const Uint mid = begin + (end-begin)/2;
+  std::nth_element(m_order.begin()+begin, m_order.begin()+mid, m_order.begin()+end,
+                   detail::BoxCentreLess(m_boxes, m_dim, direction));
+
+  // Both children are stored next to each other
+  const Uint first_child = add_node(begin, mid);
+  add_node(mid, end);
+  m_node_children[node] = first_child;
+
+  build_node(first_child, max_leaf_size);
+  build_node(first_child+1, max_leaf_size);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Uint BoundingBoxTree::add_node(const Uint begin, const Uint end)
+{
+  const Uint node = m_node_begin.size();
+  m_node_begin.push_back(begin);
+  m_node_end.push_back(end);
+  m_node_children.push_back(0u);
+  m_node_bounds.resize(m_node_bounds.size() + 2*m_dim);
+  return node;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void BoundingBoxTree::find_boxes(const RealVector& point, std::vector<Uint>& found, const Real tolerance) const
+{
+  if (empty())
+    return;
+
+  cf3_assert(point.size() == m_dim);
+
+  std::vector<Uint> stack;
+  stack.reserve(64);
+  stack.push_back(0u);
+  while (!stack.empty())
+  {
+    const Uint node = stack.back();
+    stack.pop_back();
+
+    bool inside = true;
+    const Uint bounds_idx = 2*m_dim*node;
+    for (Uint d=0; d<m_dim && inside; ++d)
+    {
+      inside = point[d] >= m_node_bounds[bounds_idx+d]-tolerance &&
+               point[d] <= m_node_bounds[bounds_idx+m_dim+d]+tolerance;
+    }
+    if (!inside)
+      continue;
+
+    if (m_node_children[node] != 0u)
+    {
+      stack.push_back(m_node_children[node]+1);
+      stack.push_back(m_node_children[node]);
+      continue;
+    }
+
+    for (Uint i=m_node_begin[node]; i<m_node_end[node]; ++i)
+    {
+      const Uint box = m_order[i];
+      const Uint box_idx = 2*m_dim*box;
+      bool in_box = true;
+      for (Uint d=0; d<m_dim && in_box; ++d)
+      {
+        in_box = point[d] >= m_boxes[box_idx+d]-tolerance &&
+                 point[d] <= m_boxes[box_idx+m_dim+d]+tolerance;
+      }
+      if (in_box)
+        found.push_back(box);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t BoundingBoxTree::memory_footprint() const
+{
+  return sizeof(Real) * (m_boxes.capacity() + m_node_bounds.capacity()) +
+         sizeof(Uint) * (m_order.capacity() + m_node_begin.capacity() + m_node_end.capacity() + m_node_children.capacity());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
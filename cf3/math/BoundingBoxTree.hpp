@@ -0,0 +1,108 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_math_BoundingBoxTree_hpp
+#define cf3_math_BoundingBoxTree_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+
+#include "math/MatrixTypes.hpp"
+#include "math/LibMath.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Bounding volume hierarchy over a set of axis-aligned boxes
+///
+/// The tree is built by recursively splitting the boxes in two halves at the median
+/// of their centres, along the longest side of the enclosing box.
+/// All data is stored in flat arrays: each node has a bounding box and a contiguous range
+/// in the permutation of the boxes, and the children of a node are stored next to each other.
+class Math_API BoundingBoxTree
+{
+public: // functions
+
+  /// Gets the Class name
+  static std::string type_name() { return "BoundingBoxTree"; }
+
+  /// Create an empty tree
+  BoundingBoxTree();
+
+  /// @brief Build the tree
+  /// @param [in] dim            Dimension of the boxes
+  /// @param [in] boxes          For every box, the dim minimum coordinates followed by the dim maximum coordinates
+  /// @param [in] max_leaf_size  Maximum number of boxes in a leaf
+  void build(const Uint dim, const std::vector<Real>& boxes, const Uint max_leaf_size=4);
+
+  /// @brief Find all boxes that contain a point
+  /// @param [in]  point      The point to look for
+  /// @param [out] found      Indices of the boxes containing the point are appended to this vector
+  /// @param [in]  tolerance  Boxes are enlarged with this tolerance in every direction
+  void find_boxes(const RealVector& point, std::vector<Uint>& found, const Real tolerance=0.) const;
+
+  /// Number of boxes in the tree
+  Uint nb_boxes() const { return m_order.size(); }
+
+  /// Number of nodes in the tree
+  Uint nb_nodes() const { return m_node_begin.size(); }
+
+  /// Dimension of the boxes
+  Uint dim() const { return m_dim; }
+
+  /// True if the tree holds no boxes
+  bool empty() const { return m_order.empty(); }
+
+  /// Remove all boxes
+  void clear();
+
+  /// Number of bytes used by the arrays of the tree
+  std::size_t memory_footprint() const;
+
+private: // functions
+
+  /// Append an empty node for the boxes in m_order[begin, end), returning its index
+  Uint add_node(const Uint begin, const Uint end);
+
+  /// Compute the bounds of a node, and split it recursively until the leaves are small enough
+  void build_node(const Uint node, const Uint max_leaf_size);
+
+private: // data
+
+  /// Dimension of the boxes
+  Uint m_dim;
+
+  /// Copy of the boxes, 2*m_dim values per box
+  std::vector<Real> m_boxes;
+
+  /// Permutation of the box indices, so the boxes of every node are contiguous
+  std::vector<Uint> m_order;
+
+  /// Bounding box of each node, 2*m_dim values per node
+  std::vector<Real> m_node_bounds;
+
+  /// Range of each node in m_order
+  std::vector<Uint> m_node_begin;
+  std::vector<Uint> m_node_end;
+
+  /// Index of the first child of each node. The second child follows it. Zero for leaves.
+  std::vector<Uint> m_node_children;
+
+}; // end BoundingBoxTree
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_math_BoundingBoxTree_hpp
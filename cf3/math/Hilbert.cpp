@@ -4,6 +4,14 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include <boost/bind.hpp>
+
+#include "common/Core.hpp"
+#include "common/ThreadPool.hpp"
 
 #include "math/Hilbert.hpp"
 #include "math/Defs.hpp"
@@ -20,311 +28,334 @@ namespace math {
 
 //////////////////////////////////////////////////////////////////////////////
 
+namespace {
+  /// Minimal number of points per range of a batch computed on the thread pool
+  const Uint batch_grain_size = 4096;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+/// @brief All vertex labelings of the boxes of the Hilbert curve in a given dimension
+///
+/// A labeling maps every vertex label (A, B, C, ...) to a corner of the box. Corner c has
+/// the maximum coordinate in direction d if bit d of c is set, and the minimum otherwise.
+/// The sub-box around the vertex with label q gets label L at the midpoint of the vertices
+/// q and child_vertex[q][L] of its parent, which is the corner child_vertex[q][L] of the sub-box.
+struct HilbertTable
+{
+  HilbertTable(const Uint dim, const Uint* initial_corners, const Uint* child_vertex) :
+    nb_vertices(1u << dim)
+  {
+    std::vector< std::vector<Uint> > labelings(1, std::vector<Uint>(initial_corners, initial_corners+nb_vertices));
+    std::map< std::vector<Uint>, Uint > labeling_idx;
+    labeling_idx[labelings[0]] = 0;
+
+    for (Uint state=0; state<labelings.size(); ++state)
+    {
+      const std::vector<Uint> labeling = labelings[state];
+      corner.insert(corner.end(), labeling.begin(), labeling.end());
+      label.resize(corner.size());
+      for (Uint l=0; l<nb_vertices; ++l)
+        label[state*nb_vertices+labeling[l]] = l;
+      for (Uint q=0; q<nb_vertices; ++q)
+      {
+        std::vector<Uint> child(nb_vertices);
+        for (Uint l=0; l<nb_vertices; ++l)
+          child[l] = labeling[child_vertex[q*nb_vertices+l]];
+
+        std::map< std::vector<Uint>, Uint >::iterator it = labeling_idx.find(child);
+        if (it == labeling_idx.end())
+        {
+          it = labeling_idx.insert(std::make_pair(child, static_cast<Uint>(labelings.size()))).first;
+          labelings.push_back(child);
+        }
+        next_state.push_back(it->second);
+      }
+    }
+  }
+
+  /// Number of vertices of a box
+  const Uint nb_vertices;
+
+  /// corner[state*nb_vertices+label] is the corner with the given label
+  std::vector<Uint> corner;
+
+  /// label[state*nb_vertices+c] is the label of corner c, the inverse of corner
+  std::vector<Uint> label;
+
+  /// next_state[state*nb_vertices+q] is the labeling of the sub-box around the vertex with label q
+  std::vector<Uint> next_state;
+};
+
+enum VertexLabel {A=0, B=1, C=2, D=3, E=4, F=5, G=6, H=7};
+
+template <Uint DIM>
+const HilbertTable& hilbert_table();
+
+template <>
+const HilbertTable& hilbert_table<1>()
+{
+  static const Uint initial_corners[] = { 0, 1 };
+  static const Uint child_vertex[] = { A, B,
+                                       A, B };
+  static const HilbertTable table(1, initial_corners, child_vertex);
+  return table;
+}
+
+template <>
+const HilbertTable& hilbert_table<2>()
+{
+  static const Uint initial_corners[] = { 0, 2, 3, 1 };
+  static const Uint child_vertex[] = { A, D, C, B,
+                                       A, B, C, D,
+                                       A, B, C, D,
+                                       C, B, A, D };
+  static const HilbertTable table(2, initial_corners, child_vertex);
+  return table;
+}
+
+template <>
+const HilbertTable& hilbert_table<3>()
+{
+  static const Uint initial_corners[] = { 0, 4, 5, 1, 3, 7, 6, 2 };
+  static const Uint child_vertex[] = { A, H, E, D, C, F, G, B,
+                                       A, B, G, H, E, F, C, D,
+                                       A, B, C, D, E, F, G, H,
+                                       G, B, A, H, E, D, C, F,
+                                       C, F, E, D, A, H, G, B,
+                                       A, B, C, D, E, F, G, H,
+                                       E, F, C, D, A, B, G, H,
+                                       G, B, C, F, E, D, A, H };
+  static const HilbertTable table(3, initial_corners, child_vertex);
+  return table;
+}
+
+/// Distance measure between a coordinate and a vertex, in one direction
+template <Uint DIM>
+inline Real distance(const Real dx) { return dx*dx; }
+
+template <>
+inline Real distance<1>(const Real dx) { return std::abs(dx); }
+
+} // detail
+
+//////////////////////////////////////////////////////////////////////////////
+
 Hilbert::Hilbert(const math::BoundingBox& bounding_box, Uint levels) :
   m_bounding_box(bounding_box),
   m_max_level(levels)
 {
   m_dim = m_bounding_box.dim();
+  cf3_assert(m_dim*m_max_level <= 64);
+  m_nb_keys = (boost::uint64_t) std::ldexp(1,m_dim*m_max_level);  // equivalent to:  1*2^(m_dim*m_max_level)
 
+  // Build the table of labelings now, as keys may later be computed concurrently
   switch (m_dim)
   {
-  case DIM_2D:
-    m_box2.resize(4);
-    m_tmp_box2.resize(4);
-    break;
-  case DIM_3D:
-    m_box3.resize(8);
-    m_tmp_box3.resize(8);
-    break;
-  case DIM_1D:
-    m_box1.resize(2);
-    break;
+  case DIM_2D: detail::hilbert_table<2>(); break;
+  case DIM_3D: detail::hilbert_table<3>(); break;
+  case DIM_1D: detail::hilbert_table<1>(); break;
   }
-  m_nb_keys = (boost::uint64_t) std::ldexp(1,m_dim*m_max_level);  // equivalent to:  1*2^(m_dim*m_max_level)
 }
 
-boost::uint64_t Hilbert::operator() (const RealVector& point)
+boost::uint64_t Hilbert::operator() (const RealVector& point) const
 {
+  cf3_assert(point.size() == m_dim);
   switch (m_dim)
   {
   case DIM_2D:
-    return operator()( static_cast<RealVector2>(point) );
+    return compute_key<2>(point.data(),NULL);
   case DIM_3D:
-    return operator()( static_cast<RealVector3>(point) );
+    return compute_key<3>(point.data(),NULL);
   case DIM_1D:
-    return operator()( static_cast<RealVector1>(point) );
+    return compute_key<1>(point.data(),NULL);
   }
   return 0u;
 }
 
-boost::uint64_t Hilbert::operator() (const RealVector& point, Real& relative_tolerance)
+boost::uint64_t Hilbert::operator() (const RealVector& point, Real& relative_tolerance) const
 {
+  cf3_assert(point.size() == m_dim);
+  Real extent[3];
+  boost::uint64_t key = 0u;
   switch (m_dim)
   {
   case DIM_2D:
-    return operator()( static_cast<RealVector2>(point),relative_tolerance);
+    key = compute_key<2>(point.data(),extent);
+    break;
   case DIM_3D:
-    return operator()( static_cast<RealVector3>(point),relative_tolerance);
+    key = compute_key<3>(point.data(),extent);
+    break;
   case DIM_1D:
-    return operator()( static_cast<RealVector1>(point),relative_tolerance);
+    key = compute_key<1>(point.data(),extent);
+    break;
   }
-  return 0u;
+  relative_tolerance = this->relative_tolerance(extent);
+  return key;
 }
 
-boost::uint64_t Hilbert::operator() (const RealVector1& point)
+boost::uint64_t Hilbert::operator() (const RealVector1& point) const
 {
   cf3_assert(m_dim==1);
-  m_key = 0;
-  m_level = 0;
-  m_box1[A] = m_bounding_box.min()[XX];
-  m_box1[B] = m_bounding_box.max()[XX];
-  recursive_algorithm_1d(point[XX]);
-  return m_key;
+  return compute_key<1>(point.data(),NULL);
 }
 
-boost::uint64_t Hilbert::operator() (const RealVector1& point, Real& relative_tolerance)
+boost::uint64_t Hilbert::operator() (const RealVector1& point, Real& relative_tolerance) const
 {
-  operator()(point);
-  relative_tolerance = std::abs(m_box1[A]-m_box1[B]) / std::abs(m_bounding_box.max()[XX]-m_bounding_box.min()[XX]);
-  return m_key;
+  cf3_assert(m_dim==1);
+  Real extent[1];
+  const boost::uint64_t key = compute_key<1>(point.data(),extent);
+  relative_tolerance = this->relative_tolerance(extent);
+  return key;
 }
 
-
-boost::uint64_t Hilbert::operator() (const RealVector2& point)
+boost::uint64_t Hilbert::operator() (const RealVector2& point) const
 {
   cf3_assert(m_dim==2);
-  m_key = 0;
-  m_level = 0;
-  m_box2[A] = m_bounding_box.min();
-  m_box2[C] = m_bounding_box.max();
-  m_box2[D][XX] = m_box2[C][XX];
-  m_box2[D][YY] = m_box2[A][YY];
-  m_box2[B][XX] = m_box2[A][XX];
-  m_box2[B][YY] = m_box2[C][YY];
-  cf3_assert_desc("point lies outside bounding box", (point-m_box2[A]).squaredNorm() <= (m_box2[A]-m_box2[C]).squaredNorm() );
-  cf3_assert_desc("point lies outside bounding box", (point-m_box2[B]).squaredNorm() <= (m_box2[A]-m_box2[C]).squaredNorm() );
-  recursive_algorithm_2d(point);
-  return m_key;
+  return compute_key<2>(point.data(),NULL);
 }
 
-boost::uint64_t Hilbert::operator() (const RealVector2& point, Real& relative_tolerance)
+boost::uint64_t Hilbert::operator() (const RealVector2& point, Real& relative_tolerance) const
 {
-  operator()(point);
-  relative_tolerance = (m_box2[A]-m_box2[C]).norm() / (m_bounding_box.max()-m_bounding_box.min()).norm();
-  return m_key;
+  cf3_assert(m_dim==2);
+  Real extent[2];
+  const boost::uint64_t key = compute_key<2>(point.data(),extent);
+  relative_tolerance = this->relative_tolerance(extent);
+  return key;
 }
 
-boost::uint64_t Hilbert::operator() (const RealVector3& point)
+boost::uint64_t Hilbert::operator() (const RealVector3& point) const
 {
   cf3_assert(m_dim==3);
-  m_key = 0;
-  m_level = 0;
-  m_box3[A] = m_bounding_box.min();
-  m_box3[F] = m_bounding_box.max();
-  m_box3[B] <<  m_box3[A][XX]  ,  m_box3[A][YY]  ,  m_box3[F][ZZ];
-  m_box3[C] <<  m_box3[F][XX]  ,  m_box3[A][YY]  ,  m_box3[F][ZZ];
-  m_box3[D] <<  m_box3[F][XX]  ,  m_box3[A][YY]  ,  m_box3[A][ZZ];
-  m_box3[E] <<  m_box3[F][XX]  ,  m_box3[F][YY]  ,  m_box3[A][ZZ];
-  m_box3[G] <<  m_box3[A][XX]  ,  m_box3[F][YY]  ,  m_box3[F][ZZ];
-  m_box3[H] <<  m_box3[A][XX]  ,  m_box3[F][YY]  ,  m_box3[A][ZZ];
-  recursive_algorithm_3d(point);
-  return m_key;
+  return compute_key<3>(point.data(),NULL);
 }
 
-boost::uint64_t Hilbert::operator() (const RealVector3& point, Real& relative_tolerance)
+boost::uint64_t Hilbert::operator() (const RealVector3& point, Real& relative_tolerance) const
 {
-  operator()(point);
-  relative_tolerance = (m_box3[A]-m_box3[F]).norm() / (m_bounding_box.max()-m_bounding_box.min()).norm();
-  return m_key;
+  cf3_assert(m_dim==3);
+  Real extent[3];
+  const boost::uint64_t key = compute_key<3>(point.data(),extent);
+  relative_tolerance = this->relative_tolerance(extent);
+  return key;
 }
 
-boost::uint64_t Hilbert::max_key() const { return m_nb_keys-1; }
-
-void Hilbert::recursive_algorithm_1d(const Real& p)
+void Hilbert::operator() (const boost::multi_array<Real,2>& coordinates, std::vector<boost::uint64_t>& keys) const
 {
-  m_min_distance=Consts::real_max();
-  for (m_idx=0; m_idx<2; ++m_idx)
-  {
-    m_distance = std::abs(p-m_box1[m_idx]);
-    if (m_distance < m_min_distance)
-    {
-      m_quadrant=m_idx;
-      m_min_distance = m_distance;
-    }
-  }
-  if(m_quadrant == A)
-  {
-    m_box1[B]=0.5*(m_box1[A]+m_box1[B]);
-  }
-  else
+  const Uint nb_points = coordinates.size();
+  keys.resize(nb_points);
+  if (nb_points == 0)
+    return;
+  cf3_assert(coordinates.shape()[1] == m_dim);
+
+  // Ranges of points are computed concurrently on the thread pool
+  ThreadPool& pool = Core::instance().thread_pool();
+  switch (m_dim)
   {
-    m_box1[A]=0.5*(m_box1[A]+m_box1[B]);
+  case DIM_2D:
+    pool.parallel_for(0, nb_points, boost::bind(&Hilbert::compute_keys<2>, this, boost::cref(coordinates), boost::ref(keys), _1, _2), batch_grain_size);
+    break;
+  case DIM_3D:
+    pool.parallel_for(0, nb_points, boost::bind(&Hilbert::compute_keys<3>, this, boost::cref(coordinates), boost::ref(keys), _1, _2), batch_grain_size);
+    break;
+  case DIM_1D:
+    pool.parallel_for(0, nb_points, boost::bind(&Hilbert::compute_keys<1>, this, boost::cref(coordinates), boost::ref(keys), _1, _2), batch_grain_size);
+    break;
   }
+}
 
-  m_key += (boost::uint64_t) std::ldexp((long double) 0.5*m_quadrant,(m_max_level-m_level));
-
-  ++m_level;
-  if (m_level < m_max_level)
-    recursive_algorithm_1d(p);
-
+template <Uint DIM>
+void Hilbert::compute_keys(const boost::multi_array<Real,2>& coordinates, std::vector<boost::uint64_t>& keys, const Uint begin, const Uint end) const
+{
+  // Rows of a multi_array are contiguous
+  for (Uint i=begin; i<end; ++i)
+    keys[i] = compute_key<DIM>(&coordinates[i][0],NULL);
 }
 
+boost::uint64_t Hilbert::max_key() const { return m_nb_keys-1; }
 
-void Hilbert::recursive_algorithm_2d(const RealVector2& p)
+template <Uint DIM>
+boost::uint64_t Hilbert::compute_key(const Real* point, Real* extent) const
 {
-  m_min_distance=Consts::real_max();
-  for (m_idx=0; m_idx<4; ++m_idx)
-  {
-    m_distance = (p-m_box2[m_idx]).squaredNorm();
-    if (m_distance < m_min_distance)
-    {
-      m_quadrant=m_idx;
-      m_min_distance = m_distance;
-    }
-  }
+  const detail::HilbertTable& table = detail::hilbert_table<DIM>();
+  const Uint nb_vertices = 1u << DIM;
 
-  switch (m_quadrant)
+  // box at the current level: minimum and maximum coordinate in every direction
+  Real box[DIM][2];
+  for (Uint d=0; d<DIM; ++d)
   {
-  case A:
-    m_tmp_box2[A] = m_box2[A];
-    m_tmp_box2[B] = 0.5*(m_box2[A]+m_box2[D]);
-    m_tmp_box2[C] = 0.5*(m_box2[A]+m_box2[C]);
-    m_tmp_box2[D] = 0.5*(m_box2[A]+m_box2[B]);
-    break;
-  case B:
-    m_tmp_box2[A] = 0.5*(m_box2[A]+m_box2[B]);
-    m_tmp_box2[B] = m_box2[B];
-    m_tmp_box2[C] = 0.5*(m_box2[B]+m_box2[C]);
-    m_tmp_box2[D] = 0.5*(m_box2[B]+m_box2[D]);
-    break;
-  case C:
-    m_tmp_box2[A] = 0.5*(m_box2[A]+m_box2[C]);
-    m_tmp_box2[B] = 0.5*(m_box2[B]+m_box2[C]);
-    m_tmp_box2[C] = m_box2[C];
-    m_tmp_box2[D] = 0.5*(m_box2[C]+m_box2[D]);
-    break;
-  case D:
-    m_tmp_box2[A] = 0.5*(m_box2[C]+m_box2[D]);
-    m_tmp_box2[B] = 0.5*(m_box2[B]+m_box2[D]);
-    m_tmp_box2[C] = 0.5*(m_box2[A]+m_box2[D]);
-    m_tmp_box2[D] = m_box2[D];
-    break;
+    box[d][0] = m_bounding_box.min()[d];
+    box[d][1] = m_bounding_box.max()[d];
   }
 
-  m_box2 = m_tmp_box2;
-
-  m_key += (boost::uint64_t) std::ldexp((long double) 0.25*m_quadrant,2*(m_max_level-m_level));
-
-  ++m_level;
-  if (m_level < m_max_level)
-    recursive_algorithm_2d(p);
-}
+  boost::uint64_t key = 0u;
+  Uint state = 0;
+  Real distance_lo[DIM], distance_hi[DIM];
+  for (Uint level=0; level<m_max_level; ++level)
+  {
+    for (Uint d=0; d<DIM; ++d)
+    {
+      distance_lo[d] = detail::distance<DIM>(point[d]-box[d][0]);
+      distance_hi[d] = detail::distance<DIM>(point[d]-box[d][1]);
+    }
 
+    // The closest vertex is the one on the closest side in every direction, unless the point
+    // is (nearly) equally close to both sides in some direction
+    const Uint* corner = &table.corner[state*nb_vertices];
+    Uint closest_corner = 0;
+    Real total_distance = 0.;
+    Real min_difference = real_max();
+    for (Uint d=0; d<DIM; ++d)
+    {
+      closest_corner |= static_cast<Uint>(distance_hi[d] < distance_lo[d]) << d;
+      total_distance += distance_lo[d] + distance_hi[d];
+      min_difference = std::min(min_difference, std::abs(distance_lo[d] - distance_hi[d]));
+    }
 
-void Hilbert::recursive_algorithm_3d(const RealVector3& p)
-{
-  m_min_distance=Consts::real_max();
-  for (m_idx=0; m_idx<8; ++m_idx)
-  {
-    m_distance = (p-m_box3[m_idx]).squaredNorm();
-    if (m_distance < m_min_distance)
+    Uint closest = table.label[state*nb_vertices+closest_corner];
+    if (min_difference <= 1e-10*total_distance)
     {
-      m_octant=m_idx;
-      m_min_distance = m_distance;
+      // Compare all vertices, picking the first one in label order if several are equally close
+      Real min_distance = real_max();
+      for (Uint label=0; label<nb_vertices; ++label)
+      {
+        Real vertex_distance = (corner[label] & 1u) ? distance_hi[0] : distance_lo[0];
+        for (Uint d=1; d<DIM; ++d)
+          vertex_distance += ((corner[label] >> d) & 1u) ? distance_hi[d] : distance_lo[d];
+        if (vertex_distance < min_distance)
+        {
+          closest = label;
+          min_distance = vertex_distance;
+        }
+      }
     }
+
+    // Continue in the sub-box around the closest vertex, without branching on the side
+    for (Uint d=0; d<DIM; ++d)
+      box[d][1u - ((corner[closest] >> d) & 1u)] = 0.5*(box[d][0]+box[d][1]);
+
+    key = (key << DIM) | closest;
+    state = table.next_state[state*nb_vertices+closest];
   }
 
-  switch (m_octant)
+  if (extent)
   {
-  case A:
-    m_tmp_box3[A] = m_box3[A];
-    m_tmp_box3[B] = 0.5*(m_box3[A]+m_box3[H]);
-    m_tmp_box3[C] = 0.5*(m_box3[A]+m_box3[E]);
-    m_tmp_box3[D] = 0.5*(m_box3[A]+m_box3[D]);
-    m_tmp_box3[E] = 0.5*(m_box3[A]+m_box3[C]);
-    m_tmp_box3[F] = 0.5*(m_box3[A]+m_box3[F]);
-    m_tmp_box3[G] = 0.5*(m_box3[A]+m_box3[G]);
-    m_tmp_box3[H] = 0.5*(m_box3[A]+m_box3[B]);
-    break;
-  case B:
-    m_tmp_box3[A] = 0.5*(m_box3[B]+m_box3[A]);
-    m_tmp_box3[B] = m_box3[B];
-    m_tmp_box3[C] = 0.5*(m_box3[B]+m_box3[G]);
-    m_tmp_box3[D] = 0.5*(m_box3[B]+m_box3[H]);
-    m_tmp_box3[E] = 0.5*(m_box3[B]+m_box3[E]);
-    m_tmp_box3[F] = 0.5*(m_box3[B]+m_box3[F]);
-    m_tmp_box3[G] = 0.5*(m_box3[B]+m_box3[C]);
-    m_tmp_box3[H] = 0.5*(m_box3[B]+m_box3[D]);
-    break;
-  case C:
-    m_tmp_box3[A] = 0.5*(m_box3[C]+m_box3[A]);
-    m_tmp_box3[B] = 0.5*(m_box3[C]+m_box3[B]);
-    m_tmp_box3[C] = m_box3[C];
-    m_tmp_box3[D] = 0.5*(m_box3[C]+m_box3[D]);
-    m_tmp_box3[E] = 0.5*(m_box3[C]+m_box3[E]);
-    m_tmp_box3[F] = 0.5*(m_box3[C]+m_box3[F]);
-    m_tmp_box3[G] = 0.5*(m_box3[C]+m_box3[G]);
-    m_tmp_box3[H] = 0.5*(m_box3[C]+m_box3[H]);
-    break;
-  case D:
-    m_tmp_box3[A] = 0.5*(m_box3[D]+m_box3[G]);
-    m_tmp_box3[B] = 0.5*(m_box3[D]+m_box3[B]);
-    m_tmp_box3[C] = 0.5*(m_box3[D]+m_box3[A]);
-    m_tmp_box3[D] = 0.5*(m_box3[D]+m_box3[H]);
-    m_tmp_box3[E] = 0.5*(m_box3[D]+m_box3[E]);
-    m_tmp_box3[F] = m_box3[D];
-    m_tmp_box3[G] = 0.5*(m_box3[D]+m_box3[C]);
-    m_tmp_box3[H] = 0.5*(m_box3[D]+m_box3[F]);
-    break;
-  case E:
-    m_tmp_box3[A] = 0.5*(m_box3[E]+m_box3[C]);
-    m_tmp_box3[B] = 0.5*(m_box3[E]+m_box3[F]);
-    m_tmp_box3[C] = m_box3[E];
-    m_tmp_box3[D] = 0.5*(m_box3[E]+m_box3[D]);
-    m_tmp_box3[E] = 0.5*(m_box3[E]+m_box3[A]);
-    m_tmp_box3[F] = 0.5*(m_box3[E]+m_box3[H]);
-    m_tmp_box3[G] = 0.5*(m_box3[E]+m_box3[G]);
-    m_tmp_box3[H] = 0.5*(m_box3[E]+m_box3[B]);
-    break;
-  case F:
-    m_tmp_box3[A] = 0.5*(m_box3[F]+m_box3[A]);
-    m_tmp_box3[B] = 0.5*(m_box3[F]+m_box3[B]);
-    m_tmp_box3[C] = 0.5*(m_box3[F]+m_box3[C]);
-    m_tmp_box3[D] = 0.5*(m_box3[F]+m_box3[D]);
-    m_tmp_box3[E] = 0.5*(m_box3[F]+m_box3[E]);
-    m_tmp_box3[F] = m_box3[F];
-    m_tmp_box3[G] = 0.5*(m_box3[F]+m_box3[G]);
-    m_tmp_box3[H] = 0.5*(m_box3[F]+m_box3[H]);
-    break;
-  case G:
-    m_tmp_box3[A] = 0.5*(m_box3[G]+m_box3[E]);
-    m_tmp_box3[B] = 0.5*(m_box3[G]+m_box3[F]);
-    m_tmp_box3[C] = 0.5*(m_box3[G]+m_box3[C]);
-    m_tmp_box3[D] = 0.5*(m_box3[G]+m_box3[D]);
-    m_tmp_box3[E] = 0.5*(m_box3[G]+m_box3[A]);
-    m_tmp_box3[F] = 0.5*(m_box3[G]+m_box3[B]);
-    m_tmp_box3[G] = m_box3[G];
-    m_tmp_box3[H] = 0.5*(m_box3[G]+m_box3[H]);
-    break;
-  case H:
-    m_tmp_box3[A] = 0.5*(m_box3[H]+m_box3[G]);
-    m_tmp_box3[B] = 0.5*(m_box3[H]+m_box3[B]);
-    m_tmp_box3[C] = 0.5*(m_box3[H]+m_box3[C]);
-    m_tmp_box3[D] = 0.5*(m_box3[H]+m_box3[F]);
-    m_tmp_box3[E] = 0.5*(m_box3[H]+m_box3[E]);
-    m_tmp_box3[F] = 0.5*(m_box3[H]+m_box3[D]);
-    m_tmp_box3[G] = 0.5*(m_box3[H]+m_box3[A]);
-    m_tmp_box3[H] = m_box3[H];
-    break;
+    for (Uint d=0; d<DIM; ++d)
+      extent[d] = box[d][1]-box[d][0];
   }
+  return key;
+}
 
-  m_box3 = m_tmp_box3;
-
-  m_key += (uint64_t) std::ldexp((long double) 0.125*m_octant,3*(m_max_level-m_level));
+Real Hilbert::relative_tolerance(const Real* extent) const
+{
+  if (m_dim == DIM_1D)
+    return std::abs(extent[XX]) / std::abs(m_bounding_box.max()[XX]-m_bounding_box.min()[XX]);
 
-  ++m_level;
-  if (m_level < m_max_level)
-    recursive_algorithm_3d(p);
+  Real extent_norm = 0.;
+  for (Uint d=0; d<m_dim; ++d)
+    extent_norm += extent[d]*extent[d];
+  return std::sqrt(extent_norm) / (m_bounding_box.max()-m_bounding_box.min()).norm();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -10,6 +10,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <boost/cstdint.hpp>      // for boost::uint_64_t
+
+#include "common/BoostArray.hpp"
+
 #include "math/BoundingBox.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -33,11 +36,11 @@ namespace math {
 /// In 1D, the levels cannot be higher than 32, if you want the indices to fit in "unsigned int" type of 32bit.
 /// In 2D, the levels cannot be higher than 15, if you want the indices to fit in "unsigned int" type of 32bit.
 /// In 3D, the levels cannot be higher than 10, if you want the indices to fit in "unsigned int" type of 32bit.
+/// The keys fit in 64 bit as long as dim*levels <= 64.
 ///
-///
-/// No attempt is made to provide the most efficient algorithm. There exist other open-source
-/// libraries with more efficient algorithms, such as libhilbert, but its GPL license
-/// is not compatible with the LGPL license.
+/// The vertex labelings of the sub-boxes only depend on the labeling of the parent box and the
+/// chosen vertex, so they are enumerated once in a table of states. A key is then computed
+/// iteratively, with one table lookup per level, appending dim bits per level.
 ///
 /// @author Willem Deconinck
 class Hilbert
@@ -49,32 +52,37 @@ public:
   Hilbert(const math::BoundingBox& bounding_box, Uint levels);
 
   /// Compute the hilbert code for a given point, checks for dimension
-  boost::uint64_t operator() (const RealVector& point);
+  boost::uint64_t operator() (const RealVector& point) const;
 
   /// Compute the hilbert code for a given point, checks for dimension
   /// @param [out] relative_tolerance  cell-size of smallest level divided by bounding-box size
-  boost::uint64_t operator() (const RealVector& point, Real& relative_tolerance);
+  boost::uint64_t operator() (const RealVector& point, Real& relative_tolerance) const;
 
   /// Compute the hilbert code for a given point in 1D
-  boost::uint64_t operator() (const RealVector1& point);
+  boost::uint64_t operator() (const RealVector1& point) const;
 
   /// Compute the hilbert code for a given point in 1D
   /// @param [out] relative_tolerance  cell-size of smallest level divided by bounding-box size
-  boost::uint64_t operator() (const RealVector1& point, Real& relative_tolerance);
+  boost::uint64_t operator() (const RealVector1& point, Real& relative_tolerance) const;
 
   /// Compute the hilbert code for a given point in 2D
-  boost::uint64_t operator() (const RealVector2& point);
+  boost::uint64_t operator() (const RealVector2& point) const;
 
   /// Compute the hilbert code for a given point in 2D
   /// @param [out] relative_tolerance  cell-size of smallest level divided by bounding-box size
-  boost::uint64_t operator() (const RealVector2& point, Real& relative_tolerance);
+  boost::uint64_t operator() (const RealVector2& point, Real& relative_tolerance) const;
 
   /// Compute the hilbert code for a given point in 3D
-  boost::uint64_t operator() (const RealVector3& point);
+  boost::uint64_t operator() (const RealVector3& point) const;
 
   /// Compute the hilbert code for a given point in 3D
   /// @param [out] relative_tolerance  cell-size of smallest level divided by bounding-box size
-  boost::uint64_t operator() (const RealVector3& point, Real& relative_tolerance);
+  boost::uint64_t operator() (const RealVector3& point, Real& relative_tolerance) const;
+
+  /// Compute the hilbert codes for all points in a table
+  /// @param [in]  coordinates  one point per row, with as many columns as the dimension of the bounding box
+  /// @param [out] keys         resized to the number of points
+  void operator() (const boost::multi_array<Real,2>& coordinates, std::vector<boost::uint64_t>& keys) const;
 
   /// Return the maximum hilbert code possible with the initialized levels
   ///
@@ -84,19 +92,23 @@ public:
 
 private: // functions
 
-  /// @brief Recursive 1D algorithm
-  void recursive_algorithm_1d(const Real& p);
+  /// @brief Iterative algorithm, following the vertex labels down to the smallest level
+  /// @param [in]  point   coordinates of the point, DIM values
+  /// @param [out] extent  size of the box at the smallest level in each direction, if not null
+  template <Uint DIM>
+  boost::uint64_t compute_key(const Real* point, Real* extent) const;
 
-  /// @brief Recursive 2D algorithm
-  void recursive_algorithm_2d(const RealVector2& p);
+  /// Compute the keys of the points [begin,end) of a table
+  template <Uint DIM>
+  void compute_keys(const boost::multi_array<Real,2>& coordinates, std::vector<boost::uint64_t>& keys, const Uint begin, const Uint end) const;
 
-  /// @brief Recursive 3D algorithm
-  void recursive_algorithm_3d(const RealVector3& p);
+  /// Relative tolerance, given the size of the box at the smallest level
+  Real relative_tolerance(const Real* extent) const;
 
 private: // data
 
-  /// Vertex label type (8 vertices in 3D)
-  enum VertexLabel {A=0, B=1, C=2, D=3, E=4, F=5, G=6, H=7};
+  /// Bounding box, defining the space to be filled
+  const math::BoundingBox& m_bounding_box;
 
   /// maximum recursion level of the Hilbert space filling curve
   Uint m_max_level;
@@ -104,52 +116,8 @@ private: // data
   /// maximum number of unique codes, computed by max_level
   boost::uint64_t m_nb_keys;
 
-  /// Bounding box, defining the space to be filled
-  const math::BoundingBox& m_bounding_box;
-
   /// Dimension
   Uint m_dim;
-
-  /// Current recursion level
-  Uint m_level;
-
-  /// Current key at recursion level
-  boost::uint64_t m_key;
-
-  /// @name Recursion allocation
-  //@{
-
-  /// Quadrant the coordinate lies in. (2D)
-  Uint m_quadrant;
-
-  /// Octant the coordinate lies in. (3D)
-  Uint m_octant;
-
-  /// Distance between coordinate and a vertex
-  Real m_distance;
-
-  /// Minimum distance between coordinate and a vertex
-  Real m_min_distance;
-
-  /// index
-  Uint m_idx;
-
-  /// box at recursion level. (1D)
-  std::vector<Real> m_box1;
-
-  /// box at recursion level. (2D)
-  std::vector<RealVector2,Eigen::aligned_allocator<RealVector2> > m_box2;
-
-  /// temporary box at recursion level. (2D)
-  std::vector<RealVector2,Eigen::aligned_allocator<RealVector2> > m_tmp_box2;
-
-  /// box at recursion level. (2D)
-  std::vector<RealVector3,Eigen::aligned_allocator<RealVector3> > m_box3;
-
-  /// temporary box at recursion level. (3D)
-  std::vector<RealVector3,Eigen::aligned_allocator<RealVector3> > m_tmp_box3;
-
-  //@}
 };
 
 ////////////////////////////////////////////////////////////////////////////////
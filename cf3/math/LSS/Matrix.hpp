@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <set>
+
 #include <boost/utility.hpp>
 
 #include "math/LSS/LibLSS.hpp"
@@ -107,6 +109,35 @@ public:
   /// @warning Structural symmetry is not checked, incorrect results will appear if you use this on a non structurally symmetric matrix
   virtual void symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, LSS::Vector& rhs) = 0;
 
+  /// Apply many dirichlet boundary conditions at once: entry i fixes equation eqs[i] of block row blockrows[i] to values[i].
+  /// The matrix rows are set to identity, and the right hand side is set to the values. With preserve_symmetry, the
+  /// constrained columns are moved to the right hand side as in symmetric_dirichlet.
+  /// If the same equation is constrained more than once, only the last entry is applied. This differs from calling
+  /// symmetric_dirichlet for each entry, where the columns are moved to the right hand side with the first value.
+  /// The default implementation applies the entries one by one, implementations may precompute the affected entries
+  /// once for a given list of rows and reuse that for subsequent calls.
+  virtual void dirichlet_batch(const std::vector<Uint>& blockrows, const std::vector<Uint>& eqs, const std::vector<Real>& values, LSS::Vector& rhs, const bool preserve_symmetry)
+  {
+    cf3_assert(blockrows.size() == eqs.size() && blockrows.size() == values.size());
+    // Walk the entries backwards, so the last condition for an equation is the one that is applied
+    std::set< std::pair<Uint, Uint> > applied;
+    for(Uint i = blockrows.size(); i != 0; --i)
+    {
+      const Uint e = i-1;
+      if(!applied.insert(std::make_pair(blockrows[e], eqs[e])).second)
+        continue;
+      if(preserve_symmetry)
+      {
+        symmetric_dirichlet(blockrows[e], eqs[e], values[e], rhs);
+      }
+      else
+      {
+        set_row(blockrows[e], eqs[e], 1., 0.);
+        rhs.set_value(blockrows[e], eqs[e], values[e]);
+      }
+    }
+  }
+
   /// Add one line to another and tie to it via dirichlet-style (applying periodicity)
   virtual void tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from) = 0;
 
@@ -151,6 +182,10 @@ public:
   /// Accessor to the number of block columns
   virtual const Uint blockcol_size() = 0;
 
+  /// True while a matrix-free implementation computes a product by executing the assembly again.
+  /// Assembly code must then leave the right hand side untouched.
+  virtual bool is_applying() const { return false; }
+
   //@} END MISCELLANEOUS
 
   /// @name TEST ONLY
@@ -48,7 +48,9 @@ using namespace cf3::math;
 common::ComponentBuilder < LSS::System, LSS::System, LSS::LibLSS > System_Builder;
 
 LSS::System::System(const std::string& name) :
-  Component(name)
+  Component(name),
+  m_batch_dirichlet(false),
+  m_dirichlet_preserve_symmetry(false)
 {
   options().add( "matrix_builder" , "cf3.math.LSS.TrilinosFEVbrMatrix")
     .pretty_name("Matrix Builder")
@@ -236,6 +238,21 @@ void LSS::System::dirichlet(const Uint iblockrow, const Uint ieq, const Real val
 {
   cf3_assert(is_created());
 
+  if (m_batch_dirichlet)
+  {
+    // a batch is applied with a single symmetry setting
+    if (!m_dirichlet_blockrows.empty() && preserve_symmetry != m_dirichlet_preserve_symmetry)
+    {
+      end_dirichlet_batch();
+      begin_dirichlet_batch();
+    }
+    m_dirichlet_preserve_symmetry = preserve_symmetry;
+    m_dirichlet_blockrows.push_back(iblockrow);
+    m_dirichlet_eqs.push_back(ieq);
+    m_dirichlet_values.push_back(value);
+    return;
+  }
+
   if (preserve_symmetry)
   {
     m_mat->symmetric_dirichlet(iblockrow, ieq, value, *m_rhs);
@@ -251,6 +268,42 @@ void LSS::System::dirichlet(const Uint iblockrow, const Uint ieq, const Real val
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+void LSS::System::dirichlet(const std::vector<Uint>& blockrows, const std::vector<Uint>& eqs, const std::vector<Real>& values, const bool preserve_symmetry)
+{
+  cf3_assert(is_created());
+  cf3_assert(blockrows.size() == eqs.size() && blockrows.size() == values.size());
+
+  m_mat->dirichlet_batch(blockrows, eqs, values, *m_rhs, preserve_symmetry);
+
+  const Uint nb_entries = blockrows.size();
+  for (Uint i=0; i<nb_entries; ++i)
+    m_sol->set_value(blockrows[i],eqs[i],values[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void LSS::System::begin_dirichlet_batch()
+{
+  m_batch_dirichlet = true;
+  m_dirichlet_blockrows.clear();
+  m_dirichlet_eqs.clear();
+  m_dirichlet_values.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void LSS::System::end_dirichlet_batch()
+{
+  m_batch_dirichlet = false;
+  if (!m_dirichlet_blockrows.empty())
+    dirichlet(m_dirichlet_blockrows, m_dirichlet_eqs, m_dirichlet_values, m_dirichlet_preserve_symmetry);
+  m_dirichlet_blockrows.clear();
+  m_dirichlet_eqs.clear();
+  m_dirichlet_values.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void LSS::System::periodicity (const Uint iblockrow_to, const Uint iblockrow_from)
 {
   cf3_assert(is_created());
@@ -110,6 +110,25 @@ public:
   /// When preserve_symmetry is true than blockrow*numequations+eq column is is zeroed by moving it to the right hand side (however this usually results in performance penalties).
   void dirichlet(const Uint iblockrow, const Uint ieq, const Real value, const bool preserve_symmetry=false);
 
+  /// Apply a list of dirichlet-type boundary conditions at once, see Matrix::dirichlet_batch
+  void dirichlet(const std::vector<Uint>& blockrows, const std::vector<Uint>& eqs, const std::vector<Real>& values, const bool preserve_symmetry=false);
+
+  /// Collect the conditions passed to dirichlet() from now on, and apply them together in end_dirichlet_batch().
+  /// This lets the matrix reuse the positions of the constrained entries between time steps.
+  /// This changes the order in which the conditions are applied:
+  ///   - Changes made to the system between begin_dirichlet_batch() and end_dirichlet_batch() come before all
+  ///     the collected conditions, even if they were made after the call to dirichlet(). A value written to a
+  ///     constrained row of the matrix or right hand side in that time is overwritten.
+  ///   - If an equation is constrained more than once, only the last value is used, also for the columns moved
+  ///     to the right hand side when preserving symmetry.
+  ///   - A change of preserve_symmetry applies the conditions collected so far, so conditions with a different
+  ///     symmetry setting are applied in the order of the calls.
+  /// @note The solution, matrix and right hand side only reflect the conditions after end_dirichlet_batch()
+  void begin_dirichlet_batch();
+
+  /// Apply the conditions collected since begin_dirichlet_batch()
+  void end_dirichlet_batch();
+
   /// Applying periodicity by adding one line to another and dirichlet-style fixing it to
   /// Note that prerequisite for this is to work that the matrix sparsity should be compatible (same nonzero pattern for the two block rows).
   /// Note that only structural symmetry can be preserved (again, if sparsity input was symmetric).
@@ -185,6 +204,15 @@ private:
   /// Strategy for the solution
   Handle<LSS::SolutionStrategy> m_solution_strategy;
 
+  /// True between begin_dirichlet_batch() and end_dirichlet_batch()
+  bool m_batch_dirichlet;
+
+  /// Dirichlet conditions collected in batch mode
+  std::vector<Uint> m_dirichlet_blockrows;
+  std::vector<Uint> m_dirichlet_eqs;
+  std::vector<Real> m_dirichlet_values;
+  bool m_dirichlet_preserve_symmetry;
+
 }; // end of class System
 
 ////////////////////////////////////////////////////////////////////////////////////////////
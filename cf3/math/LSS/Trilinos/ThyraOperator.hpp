@@ -25,6 +25,9 @@ public:
   
   /// Writable access to the matrix
   virtual Teuchos::RCP<Thyra::LinearOpBase<Real> > thyra_operator() = 0;
+
+  /// Approximation of the operator used to build the preconditioner, or null to use the operator itself
+  virtual Teuchos::RCP<const Thyra::LinearOpBase<Real> > thyra_preconditioner_operator() const { return Teuchos::null; }
 };
 
 } // namespace LSS
@@ -7,6 +7,7 @@
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <map>
 
 #include <boost/pointer_cast.hpp>
 
@@ -31,6 +32,9 @@
 
 #include "common/Assertions.hpp"
 #include "common/Builder.hpp"
+#include "common/Core.hpp"
+#include "common/Foreach.hpp"
+#include "common/ThreadPool.hpp"
 #include "common/PE/Comm.hpp"
 #include "common/Log.hpp"
 #include "common/OptionList.hpp"
@@ -204,6 +208,7 @@ void TrilinosCrsMatrix::destroy()
   m_neq=0;
   m_num_my_elements=0;
   m_is_created=false;
+  m_dirichlet_pattern = DirichletPattern();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -426,6 +431,185 @@ void TrilinosCrsMatrix::symmetric_dirichlet(const Uint blockrow, const Uint ieq,
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+  /// Finds the value offset of a column in a row of a CRS matrix, or -1 if absent
+  inline int find_offset(const int* row_offsets, const int* indices, const int row, const int column)
+  {
+    for(int i = row_offsets[row]; i != row_offsets[row+1]; ++i)
+    {
+      if(indices[i] == column)
+        return i;
+    }
+    return -1;
+  }
+
+  /// Moves the constrained columns of a range of coupled rows to the rhs contributions
+  struct MoveColumnsToRhs
+  {
+    MoveColumnsToRhs(const std::vector<Uint>& begin, const std::vector<int>& offsets, const std::vector<Uint>& entries,
+                     const std::vector<Real>& bc_values, Real* matrix_values, std::vector<Real>& rhs_deltas) :
+      m_begin(begin), m_offsets(offsets), m_entries(entries), m_bc_values(bc_values), m_matrix_values(matrix_values), m_rhs_deltas(rhs_deltas)
+    {
+    }
+
+    void operator()(const Uint range_begin, const Uint range_end) const
+    {
+      for(Uint row = range_begin; row != range_end; ++row)
+      {
+        Real delta = 0.;
+        for(Uint k = m_begin[row]; k != m_begin[row+1]; ++k)
+        {
+          Real& value = m_matrix_values[m_offsets[k]];
+          delta -= value * m_bc_values[m_entries[k]];
+          value = 0.;
+        }
+        m_rhs_deltas[row] = delta;
+      }
+    }
+
+    const std::vector<Uint>& m_begin;
+    const std::vector<int>& m_offsets;
+    const std::vector<Uint>& m_entries;
+    const std::vector<Real>& m_bc_values;
+    Real* m_matrix_values;
+    std::vector<Real>& m_rhs_deltas;
+  };
+
+  /// Replaces a range of constrained rows by identity rows
+  struct SetIdentityRows
+  {
+    SetIdentityRows(const std::vector<int>& rows, const std::vector<int>& diagonals, const int* row_offsets, Real* matrix_values) :
+      m_rows(rows), m_diagonals(diagonals), m_row_offsets(row_offsets), m_matrix_values(matrix_values)
+    {
+    }
+
+    void operator()(const Uint range_begin, const Uint range_end) const
+    {
+      for(Uint i = range_begin; i != range_end; ++i)
+      {
+        const int row = m_rows[i];
+        std::fill(m_matrix_values + m_row_offsets[row], m_matrix_values + m_row_offsets[row+1], 0.);
+        m_matrix_values[m_diagonals[i]] = 1.;
+      }
+    }
+
+    const std::vector<int>& m_rows;
+    const std::vector<int>& m_diagonals;
+    const int* m_row_offsets;
+    Real* m_matrix_values;
+  };
+}
+
+void TrilinosCrsMatrix::build_dirichlet_pattern(const std::vector<Uint>& blockrows, const std::vector<Uint>& eqs, const bool preserve_symmetry)
+{
+  DirichletPattern& pattern = m_dirichlet_pattern;
+  pattern = DirichletPattern();
+  pattern.blockrows = blockrows;
+  pattern.eqs = eqs;
+  pattern.preserve_symmetry = preserve_symmetry;
+
+  int* row_offsets;
+  int* indices;
+  Real* values;
+  TRILINOS_THROW(m_mat->ExtractCrsDataPointers(row_offsets, indices, values));
+
+  // Keep only the last condition for every constrained column
+  const Uint nb_entries = blockrows.size();
+  std::vector<int> condition_of_column(m_p2m.size(), -1);
+  for(Uint e = 0; e != nb_entries; ++e)
+    condition_of_column[m_p2m[blockrows[e]*m_neq+eqs[e]]] = static_cast<int>(e);
+  for(Uint e = 0; e != nb_entries; ++e)
+  {
+    const int bc_col = m_p2m[blockrows[e]*m_neq+eqs[e]];
+    if(condition_of_column[bc_col] != static_cast<int>(e))
+      continue;
+    pattern.entries.push_back(e);
+    if(bc_col < m_num_my_elements)
+    {
+      pattern.constrained_rows.push_back(bc_col);
+      pattern.constrained_diagonals.push_back(detail::find_offset(row_offsets, indices, bc_col, bc_col));
+      cf3_assert(pattern.constrained_diagonals.back() >= 0);
+    }
+  }
+
+  if(!preserve_symmetry)
+    return;
+
+  // Gather, per owned unconstrained row, the entries in constrained columns.
+  // The matrix is structurally symmetric, so these rows are the neighbours of the constrained rows.
+  std::map< int, std::vector< std::pair<int, Uint> > > couplings;
+  std::map< int, std::pair<Uint, Uint> > rhs_index;
+  boost_foreach(const Uint e, pattern.entries)
+  {
+    const Uint blockrow = blockrows[e];
+    const int bc_col = m_p2m[blockrow*m_neq+eqs[e]];
+    for(int col_idx = m_starting_indices[blockrow]; col_idx != m_starting_indices[blockrow+1]; ++col_idx)
+    {
+      const int col = m_node_connectivity[col_idx];
+      for(int j = 0; j != m_neq; ++j)
+      {
+        const int other_row = m_p2m[col*m_neq+j];
+        if(other_row >= m_num_my_elements || condition_of_column[other_row] != -1)
+          continue;
+        const int offset = detail::find_offset(row_offsets, indices, other_row, bc_col);
+        cf3_assert(offset >= 0);
+        couplings[other_row].push_back(std::make_pair(offset, e));
+        rhs_index[other_row] = std::make_pair(static_cast<Uint>(col), static_cast<Uint>(j));
+      }
+    }
+  }
+
+  pattern.coupling_begin.reserve(couplings.size()+1);
+  pattern.coupling_begin.push_back(0);
+  for(std::map< int, std::vector< std::pair<int, Uint> > >::const_iterator it = couplings.begin(); it != couplings.end(); ++it)
+  {
+    pattern.coupled_blockrows.push_back(rhs_index[it->first].first);
+    pattern.coupled_eqs.push_back(rhs_index[it->first].second);
+    for(Uint k = 0; k != it->second.size(); ++k)
+    {
+      pattern.coupling_offsets.push_back(it->second[k].first);
+      pattern.coupling_entries.push_back(it->second[k].second);
+    }
+    pattern.coupling_begin.push_back(pattern.coupling_offsets.size());
+  }
+}
+
+void TrilinosCrsMatrix::dirichlet_batch(const std::vector<Uint>& blockrows, const std::vector<Uint>& eqs, const std::vector<Real>& values, Vector& rhs, const bool preserve_symmetry)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(blockrows.size() == eqs.size() && blockrows.size() == values.size());
+
+  const DirichletPattern& pattern = m_dirichlet_pattern;
+  if(pattern.preserve_symmetry != preserve_symmetry || pattern.blockrows != blockrows || pattern.eqs != eqs)
+    build_dirichlet_pattern(blockrows, eqs, preserve_symmetry);
+
+  int* row_offsets;
+  int* indices;
+  Real* matrix_values;
+  TRILINOS_THROW(m_mat->ExtractCrsDataPointers(row_offsets, indices, matrix_values));
+
+  common::ThreadPool& pool = common::Core::instance().thread_pool();
+
+  // Move the constrained columns to the rhs. Every coupled row is handled by one task,
+  // the rhs itself is updated afterwards because it is not thread-safe.
+  const Uint nb_coupled = pattern.coupled_blockrows.size();
+  if(nb_coupled != 0)
+  {
+    std::vector<Real> rhs_deltas(nb_coupled);
+    pool.parallel_for(0, nb_coupled, detail::MoveColumnsToRhs(pattern.coupling_begin, pattern.coupling_offsets, pattern.coupling_entries, values, matrix_values, rhs_deltas));
+    for(Uint i = 0; i != nb_coupled; ++i)
+      rhs.add_value(pattern.coupled_blockrows[i], pattern.coupled_eqs[i], rhs_deltas[i]);
+  }
+
+  pool.parallel_for(0, pattern.constrained_rows.size(), detail::SetIdentityRows(pattern.constrained_rows, pattern.constrained_diagonals, row_offsets, matrix_values));
+
+  boost_foreach(const Uint e, pattern.entries)
+    rhs.set_value(blockrows[e], eqs[e], values[e]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void TrilinosCrsMatrix::tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from)
 {
   cf3_assert(m_is_created);
@@ -626,6 +810,24 @@ void TrilinosCrsMatrix::print_native(ostream& stream)
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+size_t TrilinosCrsMatrix::memory_footprint() const
+{
+  size_t footprint = ( m_p2m.capacity() + m_converted_indices.capacity() + m_node_connectivity.capacity() + m_starting_indices.capacity() ) * sizeof(int);
+  if (m_is_created)
+  {
+    // values and column indices per nonzero, plus the row offsets
+    footprint += static_cast<size_t>(m_mat->NumMyNonzeros()) * (sizeof(Real) + sizeof(int));
+    footprint += static_cast<size_t>(m_mat->NumMyRows() + 1) * sizeof(int);
+  }
+  const DirichletPattern& pattern = m_dirichlet_pattern;
+  footprint += ( pattern.blockrows.capacity() + pattern.eqs.capacity() + pattern.entries.capacity() + pattern.coupled_blockrows.capacity()
+               + pattern.coupled_eqs.capacity() + pattern.coupling_begin.capacity() + pattern.coupling_entries.capacity() ) * sizeof(Uint);
+  footprint += ( pattern.constrained_rows.capacity() + pattern.constrained_diagonals.capacity() + pattern.coupling_offsets.capacity() ) * sizeof(int);
+  return footprint;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void TrilinosCrsMatrix::debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values)
 {
   row_indices.clear(); col_indices.clear(); values.clear();
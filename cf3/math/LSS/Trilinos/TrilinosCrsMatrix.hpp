@@ -101,6 +101,10 @@ public:
 
   virtual void symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, Vector& rhs);
 
+  /// Apply a list of dirichlet conditions in one pass. The value offsets of all affected matrix entries are
+  /// computed on the first call, and reused as long as the same rows are passed, i.e. on later time steps.
+  virtual void dirichlet_batch(const std::vector<Uint>& blockrows, const std::vector<Uint>& eqs, const std::vector<Real>& values, Vector& rhs, const bool preserve_symmetry);
+
   /// Add one line to another and tie to it via dirichlet-style (applying periodicity)
   void tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from);
 
@@ -132,6 +136,9 @@ public:
 
   void print_native(ostream& stream);
 
+  /// Number of bytes held by the underlying Epetra data and the index mapping arrays
+  size_t memory_footprint() const;
+
   /// Accessor to the state of create
   const bool is_created() { return m_is_created; }
 
@@ -201,6 +208,38 @@ private:
 
   /// Copy of the connectivity data
   std::vector<int> m_node_connectivity, m_starting_indices;
+
+  /// Positions in the matrix value array affected by a list of dirichlet conditions
+  struct DirichletPattern
+  {
+    DirichletPattern() : preserve_symmetry(false) {}
+
+    /// rows and equations the pattern was built for
+    std::vector<Uint> blockrows, eqs;
+    bool preserve_symmetry;
+
+    /// index in the batch of every distinct condition (the last one, if a row is given more than once)
+    std::vector<Uint> entries;
+
+    /// owned matrix rows that become identity rows, and the value offset of their diagonal
+    std::vector<int> constrained_rows, constrained_diagonals;
+
+    /// owned unconstrained rows with entries in constrained columns, with their rhs block row and equation
+    std::vector<Uint> coupled_blockrows, coupled_eqs;
+
+    /// per coupled row, the range in coupling_offsets and coupling_entries
+    std::vector<Uint> coupling_begin;
+
+    /// value offset of an entry in a constrained column, and the index in the batch of its condition
+    std::vector<int> coupling_offsets;
+    std::vector<Uint> coupling_entries;
+  };
+
+  /// Compute m_dirichlet_pattern for the given conditions
+  void build_dirichlet_pattern(const std::vector<Uint>& blockrows, const std::vector<Uint>& eqs, const bool preserve_symmetry);
+
+  /// Pattern of the last call to dirichlet_batch
+  DirichletPattern m_dirichlet_pattern;
 }; // end of class Matrix
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -800,6 +800,22 @@ void TrilinosFEVbrMatrix::print_native(ostream& stream)
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+size_t TrilinosFEVbrMatrix::memory_footprint() const
+{
+  size_t footprint = ( m_p2m.capacity() + m_converted_indices.capacity() + m_node_connectivity.capacity() + m_starting_indices.capacity() ) * sizeof(int)
+                   + m_keep_node.capacity() / 8;
+  if (m_is_created)
+  {
+    // point values, block column indices and the block row offsets
+    footprint += static_cast<size_t>(m_mat->NumMyNonzeros()) * sizeof(Real);
+    footprint += static_cast<size_t>(m_mat->NumMyBlockEntries()) * sizeof(int);
+    footprint += static_cast<size_t>(m_mat->NumMyBlockRows() + 1) * sizeof(int);
+  }
+  return footprint;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void TrilinosFEVbrMatrix::debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values)
 {
   cf3_assert(m_is_created);
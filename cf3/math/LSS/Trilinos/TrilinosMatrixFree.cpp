@@ -0,0 +1,723 @@
+// Copyright (C) 2010 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <sstream>
+
+#include "Teuchos_RCP.hpp"
+
+#include "Epetra_CrsGraph.h"
+#include "Epetra_Map.h"
+
+#include "Thyra_EpetraLinearOp.hpp"
+
+#include "common/Assertions.hpp"
+#include "common/BasicExceptions.hpp"
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/OptionComponent.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+
+#include "math/LSS/Trilinos/TrilinosMatrixFree.hpp"
+#include "math/LSS/Trilinos/TrilinosDetail.hpp"
+#include "math/LSS/Trilinos/TrilinosVector.hpp"
+#include "math/VariablesDescriptor.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file TrilinosMatrixFree.cpp implementation of LSS::TrilinosMatrixFree
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  /// Epetra view on a TrilinosMatrixFree, so it can be wrapped by Thyra
+  class MatrixFreeEpetraOperator : public Epetra_Operator
+  {
+  public:
+    MatrixFreeEpetraOperator(TrilinosMatrixFree& matrix, const Epetra_Map& map) :
+      m_matrix(matrix),
+      m_map(map)
+    {
+    }
+
+    int SetUseTranspose(bool use_transpose)
+    {
+      return use_transpose ? -1 : 0;
+    }
+
+    int Apply(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const
+    {
+      m_matrix.apply(X, Y);
+      return 0;
+    }
+
+    int ApplyInverse(const Epetra_MultiVector& X, Epetra_MultiVector& Y) const
+    {
+      return -1;
+    }
+
+    double NormInf() const
+    {
+      return 0.;
+    }
+
+    const char* Label() const
+    {
+      return "cf3 matrix-free operator";
+    }
+
+    bool UseTranspose() const
+    {
+      return false;
+    }
+
+    bool HasNormInf() const
+    {
+      return false;
+    }
+
+    const Epetra_Comm& Comm() const
+    {
+      return m_map.Comm();
+    }
+
+    const Epetra_Map& OperatorDomainMap() const
+    {
+      return m_map;
+    }
+
+    const Epetra_Map& OperatorRangeMap() const
+    {
+      return m_map;
+    }
+
+  private:
+    TrilinosMatrixFree& m_matrix;
+    const Epetra_Map m_map;
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < LSS::TrilinosMatrixFree, LSS::Matrix, LSS::LibLSS > TrilinosMatrixFree_Builder;
+
+TrilinosMatrixFree::TrilinosMatrixFree(const std::string& name) :
+  LSS::Matrix(name),
+  m_comm(common::PE::Comm::instance().communicator()),
+  m_is_created(false),
+  m_applying(false),
+  m_operand_values(0),
+  m_product_values(0),
+  m_neq(0),
+  m_num_my_elements(0)
+{
+  properties().add("vector_type", std::string("cf3.math.LSS.TrilinosVector"));
+
+  options().add("assembly", m_assembly)
+    .pretty_name("Assembly")
+    .description("Action that assembles the system matrix. It is executed again for every product with the matrix.")
+    .link_to(&m_assembly)
+    .mark_basic();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs)
+{
+  boost::shared_ptr<VariablesDescriptor> single_var_descriptor = common::allocate_component<VariablesDescriptor>("SingleVariableDescriptor");
+  single_var_descriptor->options().set(common::Tags::dimension(), neq);
+  single_var_descriptor->push_back("LSSvars", VariablesDescriptor::Dimensionalities::VECTOR);
+  create_blocked(cp, *single_var_descriptor, node_connectivity, starting_indices, solution, rhs);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector< Uint >& node_connectivity, const std::vector< Uint >& starting_indices, Vector& solution, Vector& rhs)
+{
+  // if already created
+  if (m_is_created) destroy();
+
+  const Uint total_nb_eq = vars.size();
+
+  std::vector<int> my_global_elements;
+  create_map_data(cp, vars, m_p2m, my_global_elements, m_num_my_elements);
+
+  // rowmap, ghosts not present
+  Epetra_Map rowmap(-1,m_num_my_elements,&my_global_elements[0],0,m_comm);
+
+  // colmap, has ghosts at the end
+  const Uint nb_nodes_for_rank = cp.isUpdatable().size();
+  Epetra_Map colmap(-1,nb_nodes_for_rank*total_nb_eq,&my_global_elements[0],0,m_comm);
+
+  // Only the equations of the same node are coupled in the diagonal blocks, so all columns are owned
+  Epetra_CrsGraph graph(Copy, rowmap, rowmap, static_cast<int>(total_nb_eq), true);
+  m_converted_indices.resize(total_nb_eq);
+  for(Uint i = 0; i != nb_nodes_for_rank; ++i)
+  {
+    if(!cp.isUpdatable()[i])
+      continue;
+    for(Uint k = 0; k != total_nb_eq; ++k)
+      m_converted_indices[k] = m_p2m[i*total_nb_eq+k];
+    for(Uint k = 0; k != total_nb_eq; ++k)
+      TRILINOS_THROW(graph.InsertMyIndices(m_converted_indices[k], static_cast<int>(total_nb_eq), &m_converted_indices[0]));
+  }
+  TRILINOS_THROW(graph.FillComplete());
+  TRILINOS_THROW(graph.OptimizeStorage());
+
+  m_diagonal_blocks = Teuchos::rcp(new Epetra_CrsMatrix(Copy, graph));
+  TRILINOS_THROW(m_diagonal_blocks->FillComplete());
+  TRILINOS_THROW(m_diagonal_blocks->OptimizeStorage());
+
+  m_operand = Teuchos::rcp(new Epetra_Vector(colmap));
+  m_importer = Teuchos::rcp(new Epetra_Import(colmap, rowmap));
+  m_operator = Teuchos::rcp(new detail::MatrixFreeEpetraOperator(*this, rowmap));
+
+  m_m2p.resize(m_p2m.size());
+  for(Uint i = 0; i != m_p2m.size(); ++i)
+    m_m2p[m_p2m[i]] = i;
+
+  m_constrained_diagonal.assign(m_num_my_elements, 0.);
+  m_is_constrained.assign(m_num_my_elements, false);
+  m_constrained_rows.clear();
+  m_is_eliminated.assign(m_p2m.size(), false);
+  m_eliminated_columns.clear();
+  m_diagonal_shift.assign(m_num_my_elements, 0.);
+
+  m_is_created=true;
+  m_neq=total_nb_eq;
+  CFdebug << "Rank " << common::PE::Comm::instance().rank() << ": Created a matrix-free operator with " << m_num_my_elements << " local rows" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::destroy()
+{
+  m_operator.reset();
+  m_diagonal_blocks.reset();
+  m_operand.reset();
+  m_importer.reset();
+  m_p2m.clear();
+  m_m2p.clear();
+  m_converted_indices.clear();
+  m_constrained_diagonal.clear();
+  m_is_constrained.clear();
+  m_constrained_rows.clear();
+  m_is_eliminated.clear();
+  m_eliminated_columns.clear();
+  m_diagonal_shift.clear();
+  m_neq=0;
+  m_num_my_elements=0;
+  m_is_created=false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::set_value(const Uint icol, const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  TRILINOS_THROW(m_diagonal_blocks->ReplaceMyValues(m_p2m[irow], 1, &value, &m_p2m[icol]));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::add_value(const Uint icol, const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  TRILINOS_THROW(m_diagonal_blocks->SumIntoMyValues(m_p2m[irow], 1, &value, &m_p2m[icol]));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::get_value(const Uint icol, const Uint irow, Real& value)
+{
+  cf3_assert(m_is_created);
+  int num_entries;
+  Real* extracted_values;
+  int* extracted_indices;
+  TRILINOS_THROW(m_diagonal_blocks->ExtractMyRowView(m_p2m[irow], num_entries, extracted_values, extracted_indices));
+  for(int i = 0; i != num_entries; ++i)
+  {
+    if(extracted_indices[i] == m_p2m[icol])
+    {
+      value = extracted_values[i];
+      return;
+    }
+  }
+  throw common::BadValue(FromHere(),"Trying to access an entry outside the diagonal blocks of a matrix-free matrix.");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::set_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  if(m_applying)
+    throw common::NotSupported(FromHere(), "Assigning blocks is not supported in the assembly of matrix-free matrix " + uri().path() + ", use +=");
+
+  const Uint nb_nodes = values.indices.size();
+  const int num_entries = nb_nodes*m_neq;
+  cf3_assert(values.mat.rows() == num_entries);
+  if(m_converted_indices.size() < num_entries)
+    m_converted_indices.resize(num_entries);
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    const Uint local_start_idx = values.indices[i]*m_neq;
+    for(int j = 0; j != m_neq; ++j)
+      m_converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
+  }
+  // only the diagonal blocks are stored
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    for(int j = 0; j != m_neq; ++j)
+    {
+      const int row_idx = i*m_neq+j;
+      if(m_converted_indices[row_idx] < m_num_my_elements)
+        TRILINOS_THROW(m_diagonal_blocks->ReplaceMyValues(m_converted_indices[row_idx], m_neq, values.mat.data()+(num_entries*row_idx + i*m_neq), &m_converted_indices[i*m_neq]));
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::add_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_nodes = values.indices.size();
+  const int num_entries = nb_nodes*m_neq;
+  cf3_assert(values.mat.rows() == num_entries);
+  if(m_converted_indices.size() < num_entries)
+    m_converted_indices.resize(num_entries);
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    const Uint local_start_idx = values.indices[i]*m_neq;
+    for(int j = 0; j != m_neq; ++j)
+      m_converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
+  }
+
+  if(m_applying)
+  {
+    // multiply the block with the operand, for the owned rows
+    for(int row_idx = 0; row_idx != num_entries; ++row_idx)
+    {
+      const int row = m_converted_indices[row_idx];
+      if(row >= m_num_my_elements)
+        continue;
+      const Real* mat_row = values.mat.data() + num_entries*row_idx;
+      Real sum = 0.;
+      for(int col_idx = 0; col_idx != num_entries; ++col_idx)
+        sum += mat_row[col_idx] * m_operand_values[m_converted_indices[col_idx]];
+      m_product_values[row] += sum;
+    }
+    return;
+  }
+
+  // only the diagonal blocks are stored
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    for(int j = 0; j != m_neq; ++j)
+    {
+      const int row_idx = i*m_neq+j;
+      if(m_converted_indices[row_idx] < m_num_my_elements)
+        TRILINOS_THROW(m_diagonal_blocks->SumIntoMyValues(m_converted_indices[row_idx], m_neq, values.mat.data()+(num_entries*row_idx + i*m_neq), &m_converted_indices[i*m_neq]));
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::get_values(BlockAccumulator& values)
+{
+  throw common::NotSupported(FromHere(), "get_values is not supported for matrix-free matrix " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval)
+{
+  cf3_assert(m_is_created);
+  if(offdiagval != 0.)
+    throw common::NotSupported(FromHere(), "Matrix-free matrix " + uri().path() + " only supports zero off-diagonal values in set_row");
+
+  const int row = m_p2m[iblockrow*m_neq+ieq];
+  if(row >= m_num_my_elements)
+    return;
+
+  constrain_row(row, diagval);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values)
+{
+  throw common::NotImplemented(FromHere(), "get_column_and_replace_to_zero is not implemented for TrilinosMatrixFree");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, Vector& rhs)
+{
+  dirichlet_batch(std::vector<Uint>(1, blockrow), std::vector<Uint>(1, ieq), std::vector<Real>(1, value), rhs, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::dirichlet_batch(const std::vector<Uint>& blockrows, const std::vector<Uint>& eqs, const std::vector<Real>& values, Vector& rhs, const bool preserve_symmetry)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(blockrows.size() == eqs.size() && blockrows.size() == values.size());
+  const Uint nb_entries = blockrows.size();
+
+  // Contribution of the columns that become eliminated: A*g, with g holding the prescribed values
+  Epetra_Vector lifting(m_diagonal_blocks->RowMap());
+  if(preserve_symmetry)
+  {
+    TRILINOS_THROW(m_operand->PutScalar(0.));
+    for(Uint e = 0; e != nb_entries; ++e)
+    {
+      const int col = m_p2m[blockrows[e]*m_neq+eqs[e]];
+      if(!m_is_eliminated[col])
+        (*m_operand)[col] = values[e];
+    }
+    boost_foreach(const int col, m_eliminated_columns)
+      (*m_operand)[col] = 0.;
+    evaluate_product(*m_operand, lifting);
+  }
+
+  for(Uint e = 0; e != nb_entries; ++e)
+  {
+    const int row = m_p2m[blockrows[e]*m_neq+eqs[e]];
+    if(row < m_num_my_elements)
+      constrain_row(row, 1.);
+  }
+
+  if(preserve_symmetry)
+  {
+    for(Uint e = 0; e != nb_entries; ++e)
+    {
+      const Uint blockrow = blockrows[e];
+      const int col = m_p2m[blockrow*m_neq+eqs[e]];
+      if(m_is_eliminated[col])
+        continue;
+      m_is_eliminated[col] = true;
+      m_eliminated_columns.push_back(col);
+
+      // the column also appears in the diagonal block of its own node
+      if(col >= m_num_my_elements)
+        continue;
+      for(Uint j = 0; j != m_neq; ++j)
+      {
+        const int other_row = m_p2m[blockrow*m_neq+j];
+        if(m_is_constrained[other_row])
+          continue;
+        int num_entries;
+        Real* extracted_values;
+        int* extracted_indices;
+        TRILINOS_THROW(m_diagonal_blocks->ExtractMyRowView(other_row, num_entries, extracted_values, extracted_indices));
+        for(int i = 0; i != num_entries; ++i)
+        {
+          if(extracted_indices[i] == col)
+            extracted_values[i] = 0.;
+        }
+      }
+    }
+
+    for(int row = 0; row != m_num_my_elements; ++row)
+    {
+      if(!m_is_constrained[row] && lifting[row] != 0.)
+        rhs.add_value(m_m2p[row] / m_neq, m_m2p[row] % m_neq, -lifting[row]);
+    }
+  }
+
+  for(Uint e = 0; e != nb_entries; ++e)
+    rhs.set_value(blockrows[e], eqs[e], values[e]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from)
+{
+  throw common::NotImplemented(FromHere(), "tie_blockrow_pairs is not implemented for TrilinosMatrixFree");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::set_diagonal(const std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(diag.size() == m_p2m.size());
+  for(Uint i = 0; i != m_p2m.size(); ++i)
+  {
+    const int row = m_p2m[i];
+    if(row >= m_num_my_elements)
+      continue;
+    Real& entry = diagonal_entry(row);
+    m_diagonal_shift[row] += diag[i] - entry;
+    entry = diag[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::add_diagonal(const std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(diag.size() == m_p2m.size());
+  for(Uint i = 0; i != m_p2m.size(); ++i)
+  {
+    const int row = m_p2m[i];
+    if(row >= m_num_my_elements)
+      continue;
+    m_diagonal_shift[row] += diag[i];
+    diagonal_entry(row) += diag[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::get_diagonal(std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  diag.resize(m_p2m.size());
+  for(Uint i = 0; i != m_p2m.size(); ++i)
+    diag[i] = m_p2m[i] < m_num_my_elements ? diagonal_entry(m_p2m[i]) : 0.;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::reset(Real reset_to)
+{
+  cf3_assert(m_is_created);
+  if(reset_to != 0.)
+    throw common::NotSupported(FromHere(), "Matrix-free matrix " + uri().path() + " can only be reset to zero");
+
+  TRILINOS_THROW(m_diagonal_blocks->PutScalar(0.));
+  boost_foreach(const int row, m_constrained_rows)
+  {
+    m_is_constrained[row] = false;
+    m_constrained_diagonal[row] = 0.;
+  }
+  m_constrained_rows.clear();
+  boost_foreach(const int col, m_eliminated_columns)
+    m_is_eliminated[col] = false;
+  m_eliminated_columns.clear();
+  std::fill(m_diagonal_shift.begin(), m_diagonal_shift.end(), 0.);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::apply(const Epetra_MultiVector& X, Epetra_MultiVector& Y)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_constrained = m_constrained_rows.size();
+  std::vector<Real> constrained_values(nb_constrained);
+  for(int v = 0; v != X.NumVectors(); ++v)
+  {
+    TRILINOS_THROW(m_operand->Import(*X(v), *m_importer, Insert));
+
+    // the owned entries come first in the column map, so the operand also holds the owned values of X
+    for(Uint i = 0; i != nb_constrained; ++i)
+    {
+      const int row = m_constrained_rows[i];
+      constrained_values[i] = m_constrained_diagonal[row] * (*m_operand)[row];
+    }
+    boost_foreach(const int col, m_eliminated_columns)
+      (*m_operand)[col] = 0.;
+
+    Epetra_Vector& y = *Y(v);
+    evaluate_product(*m_operand, y);
+
+    for(int row = 0; row != m_num_my_elements; ++row)
+      y[row] += m_diagonal_shift[row] * (*m_operand)[row];
+    for(Uint i = 0; i != nb_constrained; ++i)
+      y[m_constrained_rows[i]] = constrained_values[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::evaluate_product(Epetra_Vector& operand, Epetra_Vector& product)
+{
+  if(is_null(m_assembly))
+    throw common::SetupError(FromHere(), "No assembly action configured for matrix-free matrix " + uri().path());
+
+  TRILINOS_THROW(product.PutScalar(0.));
+  TRILINOS_THROW(operand.ExtractView(&m_operand_values));
+  TRILINOS_THROW(product.ExtractView(&m_product_values));
+
+  m_applying = true;
+  try
+  {
+    m_assembly->execute();
+  }
+  catch(...)
+  {
+    m_applying = false;
+    m_operand_values = 0;
+    m_product_values = 0;
+    throw;
+  }
+  m_applying = false;
+  m_operand_values = 0;
+  m_product_values = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::constrain_row(const int row, const Real diagval)
+{
+  if(!m_is_constrained[row])
+  {
+    m_is_constrained[row] = true;
+    m_constrained_rows.push_back(row);
+  }
+  m_constrained_diagonal[row] = diagval;
+
+  int num_entries;
+  Real* extracted_values;
+  int* extracted_indices;
+  TRILINOS_THROW(m_diagonal_blocks->ExtractMyRowView(row, num_entries, extracted_values, extracted_indices));
+  for(int i = 0; i != num_entries; ++i)
+    extracted_values[i] = extracted_indices[i] == row ? diagval : 0.;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Real& TrilinosMatrixFree::diagonal_entry(const int row)
+{
+  int num_entries;
+  Real* extracted_values;
+  int* extracted_indices;
+  TRILINOS_THROW(m_diagonal_blocks->ExtractMyRowView(row, num_entries, extracted_values, extracted_indices));
+  for(int i = 0; i != num_entries; ++i)
+  {
+    if(extracted_indices[i] == row)
+      return extracted_values[i];
+  }
+  throw common::BadValue(FromHere(), "Missing diagonal entry in matrix-free matrix " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::print(common::LogStream& stream)
+{
+  std::stringstream out;
+  print(out);
+  stream << out.str() << CFflush;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::print(std::ostream& stream)
+{
+  if (m_is_created)
+  {
+    int sumentries=0;
+    int num_entries;
+    Real* extracted_values;
+    int* extracted_indices;
+
+    for(int row = 0; row != m_num_my_elements; ++row)
+    {
+      TRILINOS_THROW(m_diagonal_blocks->ExtractMyRowView(row, num_entries, extracted_values, extracted_indices));
+      for(int i = 0; i != num_entries; ++i)
+      {
+        stream << m_m2p[extracted_indices[i]] << " " << -m_m2p[row] << " " << extracted_values[i] << std::endl;
+      }
+      sumentries += num_entries;
+    }
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << m_comm.MyPID() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_num_my_elements << "\n";
+    stream << "# number of block rows: " << m_num_my_elements/m_neq << "\n";
+    stream << "# number of entries in the diagonal blocks: " << sumentries << "\n";
+    stream << "# number of constrained rows: " << m_constrained_rows.size() << "\n";
+  } else {
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# Matrix is not created!" << "\n";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::print(const std::string& filename, std::ios_base::openmode mode )
+{
+  std::ofstream stream(filename.c_str(),mode);
+  stream << "VARIABLES=COL,ROW,VAL\n" << std::flush;
+  stream << "ZONE T=\"" << type_name() << "::" << name() <<  "\"\n" << std::flush;
+  print(stream);
+  stream.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::print_native(ostream& stream)
+{
+  m_diagonal_blocks->Print(stream);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t TrilinosMatrixFree::memory_footprint() const
+{
+  size_t footprint = ( m_p2m.capacity() + m_m2p.capacity() + m_converted_indices.capacity() + m_constrained_rows.capacity() + m_eliminated_columns.capacity() ) * sizeof(int);
+  footprint += ( m_constrained_diagonal.capacity() + m_diagonal_shift.capacity() ) * sizeof(Real);
+  footprint += ( m_is_constrained.capacity() + m_is_eliminated.capacity() ) / 8;
+  if (m_is_created)
+  {
+    footprint += static_cast<size_t>(m_diagonal_blocks->NumMyNonzeros()) * (sizeof(Real) + sizeof(int));
+    footprint += static_cast<size_t>(m_diagonal_blocks->NumMyRows() + 1) * sizeof(int);
+    footprint += static_cast<size_t>(m_operand->MyLength()) * sizeof(Real);
+  }
+  return footprint;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosMatrixFree::debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values)
+{
+  throw common::NotSupported(FromHere(), "debug_data is not supported for matrix-free matrix " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Teuchos::RCP< const Thyra::LinearOpBase< Real > > TrilinosMatrixFree::thyra_operator() const
+{
+  return Thyra::epetraLinearOp(m_operator);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Teuchos::RCP< Thyra::LinearOpBase< Real > > TrilinosMatrixFree::thyra_operator()
+{
+  return Thyra::nonconstEpetraLinearOp(m_operator);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Teuchos::RCP< const Thyra::LinearOpBase< Real > > TrilinosMatrixFree::thyra_preconditioner_operator() const
+{
+  return Thyra::epetraLinearOp(m_diagonal_blocks);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
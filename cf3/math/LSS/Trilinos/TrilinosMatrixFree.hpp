@@ -0,0 +1,258 @@
+// Copyright (C) 2010 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_TrilinosMatrixFree_hpp
+#define cf3_Math_LSS_TrilinosMatrixFree_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Epetra_MpiComm.h>
+#include <Epetra_CrsMatrix.h>
+#include <Epetra_Import.h>
+#include <Epetra_Operator.h>
+#include <Epetra_Vector.h>
+#include <Teuchos_RCP.hpp>
+
+#include "common/Action.hpp"
+
+#include "math/LSS/LibLSS.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/Vector.hpp"
+#include "math/LSS/Matrix.hpp"
+
+#include "ThyraOperator.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file TrilinosMatrixFree.hpp definition of LSS::TrilinosMatrixFree
+
+  Matrix that is never assembled: products are computed by executing the assembly again.
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Matrix-free linear operator, for use with the iterative Trilinos solvers.
+/// The action configured in the "assembly" option is the code that normally assembles the matrix.
+/// To compute a product, that action is executed again, and every block passed to add_values is
+/// multiplied with the matching entries of the operand instead of being stored. Right hand side contributions
+/// are skipped during such a product, see is_applying().
+/// Only the diagonal blocks (the equations of a single node) are assembled, and these are used to build
+/// the preconditioner. Dirichlet conditions are stored as a list of constrained rows and eliminated columns.
+/// The assembly must depend only on the state before the solve, i.e. it must represent a linear operator.
+class LSS_API TrilinosMatrixFree : public LSS::Matrix, public ThyraOperator {
+public:
+
+  /// @name CREATION, DESTRUCTION AND COMPONENT SYSTEM
+  //@{
+
+  /// name of the type
+  static std::string type_name () { return "TrilinosMatrixFree"; }
+
+  /// Accessor to solver type
+  const std::string solvertype() { return "Trilinos"; }
+
+  /// Accessor to the flag if matrix, solution and rhs are tied together or not
+  const bool is_swappable(const LSS::Vector& solution, const LSS::Vector& rhs) { return true; }
+
+  /// Default constructor
+  TrilinosMatrixFree(const std::string& name);
+
+  /// Setup the maps. The connectivity is not stored.
+  void create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs);
+  virtual void create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector< Uint >& node_connectivity, const std::vector< Uint >& starting_indices, Vector& solution, Vector& rhs);
+
+  /// Deallocate underlying data
+  void destroy();
+
+  //@} END CREATION, DESTRUCTION AND COMPONENT SYSTEM
+
+  /// @name INDIVIDUAL ACCESS
+  //@{
+
+  /// Set value at given location in the matrix. Only entries in the diagonal blocks can be accessed.
+  void set_value(const Uint icol, const Uint irow, const Real value);
+
+  /// Add value at given location in the matrix. Only entries in the diagonal blocks can be accessed.
+  void add_value(const Uint icol, const Uint irow, const Real value);
+
+  /// Get value at given location in the matrix. Only entries in the diagonal blocks can be accessed.
+  void get_value(const Uint icol, const Uint irow, Real& value);
+
+  //@} END INDIVIDUAL ACCESS
+
+  /// @name EFFICCIENT ACCESS
+  //@{
+
+  /// Set a list of values. Not supported during a product.
+  void set_values(const BlockAccumulator& values);
+
+  /// Add a list of values: stores the diagonal blocks, or multiplies during a product
+  void add_values(const BlockAccumulator& values);
+
+  /// Not supported, the off-diagonal blocks are not stored
+  void get_values(BlockAccumulator& values);
+
+  /// Set a row, diagonal and off-diagonals values separately (dirichlet-type boundaries). Only a zero offdiagval is supported.
+  void set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval);
+
+  /// Not supported
+  void get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values);
+
+  /// Costs a product with the matrix, use dirichlet_batch for many conditions
+  virtual void symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, Vector& rhs);
+
+  /// Apply a list of dirichlet conditions. With preserve_symmetry, the constrained columns are moved to the
+  /// right hand side using a single product with the matrix.
+  virtual void dirichlet_batch(const std::vector<Uint>& blockrows, const std::vector<Uint>& eqs, const std::vector<Real>& values, Vector& rhs, const bool preserve_symmetry);
+
+  /// Not supported
+  void tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from);
+
+  /// Set the diagonal
+  void set_diagonal(const std::vector<Real>& diag);
+
+  /// Add to the diagonal
+  void add_diagonal(const std::vector<Real>& diag);
+
+  /// Get the diagonal
+  void get_diagonal(std::vector<Real>& diag);
+
+  /// Reset Matrix. Only resetting to zero is supported.
+  void reset(Real reset_to=0.);
+
+  //@} END EFFICCIENT ACCESS
+
+  /// @name MISCELLANEOUS
+  //@{
+
+  /// Print the diagonal blocks to wherever
+  void print(common::LogStream& stream);
+
+  /// Print the diagonal blocks to wherever
+  void print(std::ostream& stream);
+
+  /// Print to file given by filename
+  void print(const std::string& filename, std::ios_base::openmode mode = std::ios_base::out );
+
+  void print_native(ostream& stream);
+
+  /// Number of bytes held by the diagonal blocks, the work vectors and the index mapping arrays
+  size_t memory_footprint() const;
+
+  /// Accessor to the state of create
+  const bool is_created() { return m_is_created; }
+
+  /// Accessor to the number of equations
+  const Uint neq() { cf3_assert(m_is_created); return m_neq; }
+
+  /// Accessor to the number of block rows
+  const Uint blockrow_size() {  cf3_assert(m_is_created); return m_num_my_elements/neq(); }
+
+  /// Accessor to the number of block columns
+  const Uint blockcol_size() {  cf3_assert(m_is_created); return m_p2m.size()/neq(); }
+
+  /// True while the assembly is executed to compute a product
+  virtual bool is_applying() const { return m_applying; }
+
+  /// Compute Y = A*X, for every vector of the multivectors
+  void apply(const Epetra_MultiVector& X, Epetra_MultiVector& Y);
+
+  //@} END MISCELLANEOUS
+
+  /// @name TEST ONLY
+  //@{
+
+  /// Not supported, the matrix is never assembled
+  void debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values);
+
+  //@} END TEST ONLY
+
+  virtual Teuchos::RCP< const Thyra::LinearOpBase< Real > > thyra_operator() const;
+  virtual Teuchos::RCP< Thyra::LinearOpBase< Real > > thyra_operator();
+
+  /// The assembled diagonal blocks
+  virtual Teuchos::RCP< const Thyra::LinearOpBase< Real > > thyra_preconditioner_operator() const;
+
+private:
+
+  /// Execute the assembly, computing product = A*operand. The operand is indexed using the column map,
+  /// the product using the row map.
+  void evaluate_product(Epetra_Vector& operand, Epetra_Vector& product);
+
+  /// Mark a row as constrained, with the given diagonal value
+  void constrain_row(const int row, const Real diagval);
+
+  /// Diagonal entry of an owned row in the assembled diagonal blocks
+  Real& diagonal_entry(const int row);
+
+  /// The action that assembles the matrix
+  Handle<common::Action> m_assembly;
+
+  /// Epetra view on this matrix
+  Teuchos::RCP<Epetra_Operator> m_operator;
+
+  /// The assembled diagonal blocks, used for preconditioning
+  Teuchos::RCP<Epetra_CrsMatrix> m_diagonal_blocks;
+
+  /// Operand with ghosts, and the importer to fill in the ghosts
+  Teuchos::RCP<Epetra_Vector> m_operand;
+  Teuchos::RCP<Epetra_Import> m_importer;
+
+  /// epetra mpi environment
+  Epetra_MpiComm m_comm;
+
+  /// state of creation
+  bool m_is_created;
+
+  /// True during evaluate_product
+  bool m_applying;
+
+  /// Operand and product values during evaluate_product
+  Real* m_operand_values;
+  Real* m_product_values;
+
+  /// number of equations
+  Uint m_neq;
+
+  /// number of local elements (rows)
+  int m_num_my_elements;
+
+  /// mapper array, maps from process local numbering to matrix local numbering (because ghost nodes need to be ordered to the back)
+  std::vector<int> m_p2m;
+
+  /// inverse of m_p2m
+  std::vector<int> m_m2p;
+
+  /// a helper array used in set/add/get_values to avoid frequent new+free combo
+  std::vector<int> m_converted_indices;
+
+  /// Diagonal value for each owned row replaced by set_row or a dirichlet condition, or 0 if the row is not constrained
+  std::vector<Real> m_constrained_diagonal;
+  std::vector<bool> m_is_constrained;
+  std::vector<int> m_constrained_rows;
+
+  /// Columns moved to the right hand side by a symmetric dirichlet condition, in the column map
+  std::vector<bool> m_is_eliminated;
+  std::vector<int> m_eliminated_columns;
+
+  /// Values added to the diagonal on top of the assembled values, per owned row
+  std::vector<Real> m_diagonal_shift;
+}; // end of class TrilinosMatrixFree
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_TrilinosMatrixFree_hpp
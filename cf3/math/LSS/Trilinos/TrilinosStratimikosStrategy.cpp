@@ -19,6 +19,7 @@
 #include "Thyra_EpetraLinearOp.hpp"
 #include "Thyra_EpetraThyraWrappers.hpp"
 #include "Thyra_LinearOpWithSolveBase.hpp"
+#include "Thyra_LinearOpWithSolveFactoryHelpers.hpp"
 #include "Thyra_VectorBase.hpp"
 #include "Thyra_MultiVectorStdOps.hpp"
 
@@ -27,6 +28,8 @@
 #include "common/Builder.hpp"
 #include "common/EventHandler.hpp"
 #include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Timer.hpp"
 
 #include "ParameterList.hpp"
 #include "ThyraMultiVector.hpp"
@@ -53,7 +56,10 @@ struct TrilinosStratimikosStrategy::Implementation
 {
   Implementation(common::Component& self) :
     m_self(self),
-    m_parameter_list(Teuchos::createParameterList())
+    m_parameter_list(Teuchos::createParameterList()),
+    m_solves_since_setup(0),
+    m_baseline_iterations(-1),
+    m_rebuild_requested(false)
   {
     Teko::addTekoToStratimikosBuilder(m_linear_solver_builder);
     m_linear_solver_builder.setParameterList(m_parameter_list);
@@ -80,6 +86,36 @@ struct TrilinosStratimikosStrategy::Implementation
       .description("If set, the settings will initially be read from this file")
       .attach_trigger(boost::bind(&Implementation::trigger_settings_file, this))
       .mark_basic();
+
+    common::Option& reuse_option = m_self.options().add("preconditioner_reuse", std::string("symbolic"))
+      .pretty_name("Preconditioner Reuse")
+      .description("Policy for reusing the preconditioner between solves. "
+                   "full: rebuild it from scratch every solve. "
+                   "symbolic: recompute it for the new matrix values, letting the preconditioner keep its symbolic setup (graph, aggregates). "
+                   "count: reuse it unchanged for reuse_count solves. "
+                   "iterations: reuse it unchanged until the iteration count grows by more than reuse_degradation percent")
+      .mark_basic();
+    reuse_option.restricted_list().push_back(std::string("full"));
+    reuse_option.restricted_list().push_back(std::string("symbolic"));
+    reuse_option.restricted_list().push_back(std::string("count"));
+    reuse_option.restricted_list().push_back(std::string("iterations"));
+
+    m_self.options().add("reuse_count", 10u)
+      .pretty_name("Reuse Count")
+      .description("Number of solves a preconditioner is used for, with preconditioner_reuse set to count");
+
+    m_self.options().add("reuse_degradation", 50.)
+      .pretty_name("Reuse Degradation")
+      .description("Allowed growth of the iteration count in percent, compared to the first solve after setup, "
+                   "with preconditioner_reuse set to iterations");
+
+    m_self.properties()["setup_time"] = 0.;
+    m_self.properties()["solve_time"] = 0.;
+    m_self.properties()["total_setup_time"] = 0.;
+    m_self.properties()["total_solve_time"] = 0.;
+    m_self.properties()["iterations"] = -1;
+    m_self.properties()["preconditioner_rebuilt"] = false;
+    m_self.properties()["nb_preconditioner_setups"] = 0u;
   }
 
   void trigger_verbosity()
@@ -117,6 +153,9 @@ struct TrilinosStratimikosStrategy::Implementation
     m_lows_factory->setVerbLevel(static_cast<Teuchos::EVerbosityLevel>(verb));
     m_lows.reset();
     m_residual_vec.reset();
+    m_solves_since_setup = 0;
+    m_baseline_iterations = -1;
+    m_rebuild_requested = false;
 
     // Update the component tree that represents the parameters. This automatically exposes available options
     update_parameters();
@@ -133,6 +172,10 @@ struct TrilinosStratimikosStrategy::Implementation
     if(is_null(m_solution))
       throw common::SetupError(FromHere(), "Null solution vector for " + m_self.uri().path());
 
+    const std::string reuse_policy = m_self.options().value<std::string>("preconditioner_reuse");
+
+    common::Timer timer;
+    bool rebuild = true;
     if(m_lows.is_null())
     {
       if(m_self.options().option("print_settings").value<bool>())
@@ -140,11 +183,73 @@ struct TrilinosStratimikosStrategy::Implementation
 
       m_lows = m_lows_factory->createOp();
     }
+    else if(reuse_policy == "full")
+    {
+      // A new operator makes the preconditioner factory start over
+      m_lows = m_lows_factory->createOp();
+    }
+    else if(reuse_policy == "count")
+    {
+      rebuild = m_solves_since_setup >= std::max(1u, m_self.options().value<Uint>("reuse_count"));
+    }
+    else if(reuse_policy == "iterations")
+    {
+      rebuild = m_rebuild_requested;
+    }
 
-    Thyra::initializeOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
+    // A matrix-free operator supplies a separate approximation to build the preconditioner from
+    const Teuchos::RCP<const Thyra::LinearOpBase<Real> > approximate_operator = m_matrix->thyra_preconditioner_operator();
+    if(rebuild)
+    {
+      if(approximate_operator.is_null())
+        Thyra::initializeOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
+      else
+        Thyra::initializeApproxPreconditionedOp(*m_lows_factory, m_matrix->thyra_operator(), approximate_operator, m_lows.ptr());
+      m_solves_since_setup = 0;
+      m_rebuild_requested = false;
+    }
+    else if(approximate_operator.is_null())
+    {
+      Thyra::initializeAndReuseOp(*m_lows_factory, m_matrix->thyra_operator(), m_lows.ptr());
+    }
+    else if(reuse_policy == "symbolic")
+    {
+      // The preconditioner is built from the cheap approximation, so recompute it
+      Thyra::initializeApproxPreconditionedOp(*m_lows_factory, m_matrix->thyra_operator(), approximate_operator, m_lows.ptr());
+    }
+    // else: keep the existing preconditioner. The matrix-free operator itself always reflects the latest assembly.
+    const Real setup_time = timer.elapsed();
 
+    timer.restart();
     Thyra::SolveStatus<double> status = Thyra::solve<double>(*m_lows, Thyra::NOTRANS, *m_rhs->thyra_vector(m_matrix->thyra_operator()->range()), m_solution->thyra_vector(m_matrix->thyra_operator()->domain()).ptr());
+    const Real solve_time = timer.elapsed();
+    ++m_solves_since_setup;
+
+    const int iterations = iteration_count(status);
+    if(reuse_policy == "iterations")
+    {
+      if(iterations < 0)
+        m_rebuild_requested = true; // no iteration count reported, so never reuse
+      else if(rebuild)
+        m_baseline_iterations = iterations;
+      else if(iterations > m_baseline_iterations * (1. + m_self.options().value<Real>("reuse_degradation") / 100.))
+        m_rebuild_requested = true;
+    }
+
+    m_self.properties()["setup_time"] = setup_time;
+    m_self.properties()["solve_time"] = solve_time;
+    m_self.properties()["total_setup_time"] = m_self.properties().value<Real>("total_setup_time") + setup_time;
+    m_self.properties()["total_solve_time"] = m_self.properties().value<Real>("total_solve_time") + solve_time;
+    m_self.properties()["iterations"] = iterations;
+    m_self.properties()["preconditioner_rebuilt"] = rebuild;
+    if(rebuild)
+      m_self.properties()["nb_preconditioner_setups"] = m_self.properties().value<Uint>("nb_preconditioner_setups") + 1u;
+
     CFinfo << "Thyra::solve finished with status " << status.message << CFendl;
+    CFinfo << "  preconditioner " << (rebuild ? "setup" : "reused") << " in " << setup_time << " s, solve in " << solve_time << " s";
+    if(iterations >= 0)
+      CFinfo << " (" << iterations << " iterations)";
+    CFinfo << CFendl;
     if(m_self.options().option("compute_residual").value<bool>())
       CFinfo << "Solver residual: " << compute_residual() << CFendl;
   }
@@ -175,6 +280,18 @@ struct TrilinosStratimikosStrategy::Implementation
     return *std::max_element(residuals.begin(), residuals.end());
   }
 
+  /// Iteration count reported by the Belos or AztecOO solvers, or -1 if unknown
+  static int iteration_count(const Thyra::SolveStatus<double>& status)
+  {
+    if(status.extraParameters.is_null())
+      return -1;
+    if(status.extraParameters->isType<int>("Belos/Iteration Count"))
+      return status.extraParameters->get<int>("Belos/Iteration Count");
+    if(status.extraParameters->isType<int>("AztecOO/Iteration Count"))
+      return status.extraParameters->get<int>("AztecOO/Iteration Count");
+    return -1;
+  }
+
   void update_parameters()
   {
     if(is_not_null(m_parameters))
@@ -197,6 +314,13 @@ struct TrilinosStratimikosStrategy::Implementation
   Handle<ThyraMultiVector> m_solution;
   Teuchos::RCP< Thyra::MultiVectorBase<Real> > m_residual_vec;
   Handle<ParameterList> m_parameters;
+
+  /// Number of solves done with the current preconditioner
+  Uint m_solves_since_setup;
+  /// Iteration count of the first solve after the last preconditioner setup
+  int m_baseline_iterations;
+  /// Set when the iteration count degraded too much
+  bool m_rebuild_requested;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////
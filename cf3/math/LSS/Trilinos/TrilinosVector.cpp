@@ -346,6 +346,16 @@ void TrilinosVector::print_native(ostream& stream)
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+size_t TrilinosVector::memory_footprint() const
+{
+  size_t footprint = ( m_p2m.capacity() + m_converted_indices.capacity() ) * sizeof(int);
+  if (m_is_created)
+    footprint += static_cast<size_t>(m_vec->MyLength()) * sizeof(Real);
+  return footprint;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
 void TrilinosVector::debug_data(std::vector<Real>& values)
 {
   cf3_assert(m_is_created);
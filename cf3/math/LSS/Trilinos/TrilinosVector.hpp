@@ -141,6 +141,9 @@ public:
   
   void print_native(ostream& stream);
 
+  /// Number of bytes held by the underlying Epetra data and the index mapping arrays
+  size_t memory_footprint() const;
+
   /// Accessor to the state of create
   const bool is_created() { return m_is_created; };
 
@@ -0,0 +1,165 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <cmath>
+
+#include <boost/bind.hpp>
+
+#include "common/Core.hpp"
+#include "common/ThreadPool.hpp"
+
+#include "math/Morton.hpp"
+#include "math/Defs.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+  using namespace common;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+  /// Minimal number of points per range of a batch computed on the thread pool
+  const Uint batch_grain_size = 4096;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+/// Interleave the bits of x with DIM-1 zero bits: bit i moves to bit DIM*i
+template <Uint DIM>
+inline boost::uint64_t spread_bits(boost::uint64_t x);
+
+template <>
+inline boost::uint64_t spread_bits<1>(boost::uint64_t x)
+{
+  return x;
+}
+
+template <>
+inline boost::uint64_t spread_bits<2>(boost::uint64_t x)
+{
+  x &= 0x00000000ffffffffULL;
+  x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+  x = (x | (x <<  8)) & 0x00ff00ff00ff00ffULL;
+  x = (x | (x <<  4)) & 0x0f0f0f0f0f0f0f0fULL;
+  x = (x | (x <<  2)) & 0x3333333333333333ULL;
+  x = (x | (x <<  1)) & 0x5555555555555555ULL;
+  return x;
+}
+
+template <>
+inline boost::uint64_t spread_bits<3>(boost::uint64_t x)
+{
+  x &= 0x00000000001fffffULL;
+  x = (x | (x << 32)) & 0x001f00000000ffffULL;
+  x = (x | (x << 16)) & 0x001f0000ff0000ffULL;
+  x = (x | (x <<  8)) & 0x100f00f00f00f00fULL;
+  x = (x | (x <<  4)) & 0x10c30c30c30c30c3ULL;
+  x = (x | (x <<  2)) & 0x1249249249249249ULL;
+  return x;
+}
+
+} // detail
+
+//////////////////////////////////////////////////////////////////////////////
+
+Morton::Morton(const math::BoundingBox& bounding_box, const Uint levels) :
+  m_dim(bounding_box.dim()),
+  m_max_level(levels)
+{
+  cf3_assert(m_dim <= 3);
+  cf3_assert(m_dim*m_max_level <= 64);
+  cf3_assert(m_max_level < 64);
+  const Real nb_cells = std::ldexp(1.,m_max_level);
+  m_max_cell = (static_cast<boost::uint64_t>(1u) << m_max_level) - 1u;
+  for (Uint d=0; d<m_dim; ++d)
+  {
+    m_min[d] = bounding_box.min()[d];
+    m_cells_per_length[d] = nb_cells / (bounding_box.max()[d]-bounding_box.min()[d]);
+  }
+}
+
+boost::uint64_t Morton::operator() (const RealVector& point) const
+{
+  cf3_assert(point.size() == m_dim);
+  switch (m_dim)
+  {
+  case DIM_2D:
+    return compute_key<2>(point.data());
+  case DIM_3D:
+    return compute_key<3>(point.data());
+  case DIM_1D:
+    return compute_key<1>(point.data());
+  }
+  return 0u;
+}
+
+void Morton::operator() (const boost::multi_array<Real,2>& coordinates, std::vector<boost::uint64_t>& keys) const
+{
+  const Uint nb_points = coordinates.size();
+  keys.resize(nb_points);
+  if (nb_points == 0)
+    return;
+  cf3_assert(coordinates.shape()[1] == m_dim);
+
+  // Ranges of points are computed concurrently on the thread pool
+  ThreadPool& pool = Core::instance().thread_pool();
+  switch (m_dim)
+  {
+  case DIM_2D:
+    pool.parallel_for(0, nb_points, boost::bind(&Morton::compute_keys<2>, this, boost::cref(coordinates), boost::ref(keys), _1, _2), batch_grain_size);
+    break;
+  case DIM_3D:
+    pool.parallel_for(0, nb_points, boost::bind(&Morton::compute_keys<3>, this, boost::cref(coordinates), boost::ref(keys), _1, _2), batch_grain_size);
+    break;
+  case DIM_1D:
+    pool.parallel_for(0, nb_points, boost::bind(&Morton::compute_keys<1>, this, boost::cref(coordinates), boost::ref(keys), _1, _2), batch_grain_size);
+    break;
+  }
+}
+
+template <Uint DIM>
+void Morton::compute_keys(const boost::multi_array<Real,2>& coordinates, std::vector<boost::uint64_t>& keys, const Uint begin, const Uint end) const
+{
+  // Rows of a multi_array are contiguous
+  for (Uint i=begin; i<end; ++i)
+    keys[i] = compute_key<DIM>(&coordinates[i][0]);
+}
+
+boost::uint64_t Morton::max_key() const
+{
+  if (m_dim*m_max_level == 64)
+    return ~static_cast<boost::uint64_t>(0u);
+  return (static_cast<boost::uint64_t>(1u) << (m_dim*m_max_level)) - 1u;
+}
+
+boost::uint64_t Morton::cell(const Real x, const Uint d) const
+{
+  const Real scaled = (x - m_min[d]) * m_cells_per_length[d];
+  if (!(scaled > 0.))
+    return 0u;
+  if (scaled >= static_cast<Real>(m_max_cell))
+    return m_max_cell;
+  return static_cast<boost::uint64_t>(scaled);
+}
+
+template <Uint DIM>
+boost::uint64_t Morton::compute_key(const Real* point) const
+{
+  boost::uint64_t key = 0u;
+  for (Uint d=0; d<DIM; ++d)
+    key |= detail::spread_bits<DIM>(cell(point[d],d)) << d;
+  return key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
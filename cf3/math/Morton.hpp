@@ -0,0 +1,92 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_math_Morton_hpp
+#define cf3_math_Morton_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/cstdint.hpp>      // for boost::uint_64_t
+
+#include "common/BoostArray.hpp"
+
+#include "math/BoundingBox.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Class to compute a global index given a coordinate, based on the
+/// Morton (Z-order) Spacefilling Curve.
+///
+/// As for Hilbert, the bounding box is divided in 2^(dim*levels) equally spaced cells, and a
+/// coordinate gets the index of the cell it falls in. The Morton index of a cell interleaves the
+/// bits of its integer coordinates, which is much cheaper to compute than the Hilbert index, at
+/// the price of less locality: consecutive keys are not always neighbouring cells.
+/// Coordinates on a cell boundary belong to the cell with the higher coordinate, and
+/// coordinates outside the bounding box to the closest cell.
+/// The keys fit in 64 bit as long as dim*levels <= 64, i.e. up to 21 levels in 3D.
+class Math_API Morton
+{
+public:
+
+  /// Constructor
+  /// Initializes the Morton space filling curve with a given "space" and "levels"
+  Morton(const math::BoundingBox& bounding_box, const Uint levels);
+
+  /// Compute the Morton code for a given point
+  boost::uint64_t operator() (const RealVector& point) const;
+
+  /// Compute the Morton codes for all points in a table
+  /// @param [in]  coordinates  one point per row, with as many columns as the dimension of the bounding box
+  /// @param [out] keys         resized to the number of points
+  void operator() (const boost::multi_array<Real,2>& coordinates, std::vector<boost::uint64_t>& keys) const;
+
+  /// Return the maximum Morton code possible with the initialized levels
+  boost::uint64_t max_key() const;
+
+private: // functions
+
+  /// Morton code of a point with DIM coordinates
+  template <Uint DIM>
+  boost::uint64_t compute_key(const Real* point) const;
+
+  /// Compute the keys of the points [begin,end) of a table
+  template <Uint DIM>
+  void compute_keys(const boost::multi_array<Real,2>& coordinates, std::vector<boost::uint64_t>& keys, const Uint begin, const Uint end) const;
+
+  /// Index of the cell containing x in direction d
+  boost::uint64_t cell(const Real x, const Uint d) const;
+
+private: // data
+
+  /// Dimension
+  Uint m_dim;
+
+  /// Number of levels, the number of bits of the cell index in each direction
+  Uint m_max_level;
+
+  /// Minimum coordinates of the bounding box
+  Real m_min[3];
+
+  /// Number of cells per unit length in each direction
+  Real m_cells_per_length[3];
+
+  /// Largest cell index in each direction
+  boost::uint64_t m_max_cell;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_math_Morton_hpp
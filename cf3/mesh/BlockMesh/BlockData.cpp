@@ -50,6 +50,22 @@ using namespace cf3::common;
 using namespace cf3::mesh;
 using namespace cf3::mesh::LagrangeP1;
 
+void create_graded_mapped_coords(const Uint segments, const Real grading, std::vector<Real>& mapped_coords)
+{
+  if(fabs(grading-1.) > 1.e-6)
+  {
+    const Real r = pow(grading, 1. / static_cast<Real>(segments - 1)); // expansion ratio
+    for(Uint i = 0; i <= segments; ++i)
+      mapped_coords.push_back(2. * (1. - pow(r, (int)i)) / (1. - grading*r) - 1.);
+  }
+  else
+  {
+    const Real step = 2. / static_cast<Real>(segments);
+    for(Uint i = 0; i <= segments; ++i)
+      mapped_coords.push_back(i*step - 1.);
+  }
+}
+
 namespace detail
 {
   /// Shortcut to create a signal reply
@@ -65,27 +81,15 @@ namespace detail
   {
     const Real eps = 1500*std::numeric_limits<Real>::epsilon();
     mapped_coords.resize(boost::extents[segments+1][nb_edges]);
+    std::vector<Real> edge_coords;
     for(Uint edge = 0; edge != nb_edges; ++edge)
     {
-      Real grading = gradings[edge];
-      if(fabs(grading-1.) > 1.e-6)
+      edge_coords.clear();
+      create_graded_mapped_coords(segments, gradings[edge], edge_coords);
+      for(Uint i = 0; i <= segments; ++i)
       {
-        const Real r = pow(grading, 1. / static_cast<Real>(segments - 1)); // expansion ratio
-        for(Uint i = 0; i <= segments; ++i)
-        {
-          const Real result = 2. * (1. - pow(r, (int)i)) / (1. - grading*r) - 1.;
-          mapped_coords[i][edge] = result;
-          cf3_assert(fabs(result) < (1. + eps));
-        }
-      }
-      else
-      {
-        const Real step = 2. / static_cast<Real>(segments);
-        for(Uint i = 0; i <= segments; ++i)
-        {
-          mapped_coords[i][edge] = i*step - 1.;
-          cf3_assert(fabs(mapped_coords[i][edge]) < 1. + eps);
-        }
+        mapped_coords[i][edge] = edge_coords[i];
+        cf3_assert(fabs(edge_coords[i]) < (1. + eps));
       }
       const Real start = mapped_coords[0][edge];
       cf3_assert(fabs(start+1.) < eps);
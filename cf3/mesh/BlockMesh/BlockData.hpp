@@ -110,6 +110,10 @@ private:
   boost::scoped_ptr<Implementation> m_implementation;
 };
 
+/// Append the mapped coordinates, from -1 to 1, of the nodes along a block edge with the given number of segments
+/// and grading, i.e. the ratio of the last to the first segment length
+BlockMesh_API void create_graded_mapped_coords(const Uint segments, const Real grading, std::vector<Real>& mapped_coords);
+
 ////////////////////////////////////////////////////////////////////////////////
 
 } // BlockMesh
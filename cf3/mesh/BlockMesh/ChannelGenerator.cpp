@@ -5,11 +5,15 @@
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
 #include <boost/assign.hpp>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include "common/Builder.hpp"
 #include "common/Core.hpp"
 #include "common/Exception.hpp"
 #include "common/EventHandler.hpp"
+#include "common/FindComponents.hpp"
+#include "common/List.hpp"
 #include "common/Log.hpp"
 #include "common/OptionComponent.hpp"
 #include "common/OptionList.hpp"
@@ -21,7 +25,15 @@
 
 #include "common/PE/Comm.hpp"
 
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
 #include "mesh/Mesh.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/LagrangeP1/Hexa3D.hpp"
 #include "mesh/BlockMesh/ChannelGenerator.hpp"
 
 namespace cf3 {
@@ -35,6 +47,53 @@ using namespace boost::assign;
 
 ComponentBuilder < ChannelGenerator, Component, LibBlockMesh > ChannelGenerator_Builder;
 
+namespace detail
+{
+  /// Append the node positions along an edge from begin to end, graded in the same way as a block edge
+  void append_graded_positions(const Uint segments, const Real grading, const Real begin, const Real end, std::vector<Real>& positions)
+  {
+    std::vector<Real> mapped_coords;
+    create_graded_mapped_coords(segments, grading, mapped_coords);
+    BOOST_FOREACH(const Real mapped_coord, mapped_coords)
+    {
+      positions.push_back(begin + 0.5*(1. + mapped_coord)*(end - begin));
+    }
+  }
+
+  /// Local node indices of a slab of the channel, with the Y index running fastest and the X index slowest
+  struct SlabNodes
+  {
+    SlabNodes(const Uint nb_y_nodes, const Uint nb_z_nodes) : nb_y(nb_y_nodes), nb_z(nb_z_nodes) {}
+
+    Uint operator()(const Uint i, const Uint j, const Uint k) const
+    {
+      return (i*nb_z + k)*nb_y + j;
+    }
+
+    const Uint nb_y;
+    const Uint nb_z;
+  };
+
+  /// Create a patch from one face of each of the given volume cells
+  void add_patch(Mesh& mesh, const std::string& name, const Connectivity& volume_connectivity, const std::vector<Uint>& cells, const Uint face)
+  {
+    Elements& patch_elems = mesh.topology().create_region(name).create_elements("cf3.mesh.LagrangeP1.Quad3D", mesh.geometry_fields());
+    patch_elems.resize(cells.size());
+    Connectivity& patch_connectivity = patch_elems.geometry_space().connectivity();
+    const ElementType::FaceConnectivity& faces = LagrangeP1::Hexa3D::faces();
+    for(Uint i = 0; i != cells.size(); ++i)
+    {
+      Connectivity::ConstRow cell_row = volume_connectivity[cells[i]];
+      Connectivity::Row face_row = patch_connectivity[i];
+      Uint face_node_idx = 0;
+      BOOST_FOREACH(const Uint cell_node_idx, faces.nodes_range(face))
+      {
+        face_row[face_node_idx++] = cell_row[cell_node_idx];
+      }
+    }
+  }
+}
+
 ChannelGenerator::ChannelGenerator(const std::string& name): MeshGenerator(name)
 {
   options().add("nb_parts", PE::Comm::instance().size())
@@ -72,6 +131,10 @@ ChannelGenerator::ChannelGenerator(const std::string& name): MeshGenerator(name)
   options().add("grading", 0.2)
     .description("Grading ratio. Values smaller than one refine towards the wall")
     .pretty_name("Grading Ratio");
+
+  options().add("distributed", false)
+    .description("Generate each partition directly on its own process, without building the complete block structure on every process. Requires one partition per process.")
+    .pretty_name("Distributed");
 }
 
 void ChannelGenerator::execute()
@@ -82,6 +145,12 @@ void ChannelGenerator::execute()
   if(is_not_null(get_child("ParallelBlocks")))
     remove_component("ParallelBlocks");
 
+  if(options().value<bool>("distributed"))
+  {
+    create_distributed_mesh(*m_mesh);
+    return;
+  }
+
   const Uint x_segs = options().value<Uint>("x_segments");
   const Uint y_segs_half = options().value<Uint>("y_segments_half");
   const Uint z_segs = options().value<Uint>("z_segments");
@@ -140,6 +209,183 @@ void ChannelGenerator::execute()
   blocks.create_mesh(mesh); //--> raises mesh_loaded event inside
 }
 
+void ChannelGenerator::create_distributed_mesh(Mesh& mesh)
+{
+  const Uint x_segs = options().value<Uint>("x_segments");
+  const Uint y_segs_half = options().value<Uint>("y_segments_half");
+  const Uint z_segs = options().value<Uint>("z_segments");
+
+  const Real length = options().value<Real>("length");
+  const Real half_height = options().value<Real>("half_height");
+  const Real width = options().value<Real>("width");
+  const Real ratio = options().value<Real>("grading");
+
+  const bool is_parallel = PE::Comm::instance().is_active();
+  const Uint nb_procs = is_parallel ? PE::Comm::instance().size() : 1;
+  const Uint rank = is_parallel ? PE::Comm::instance().rank() : 0;
+
+  const Uint nb_parts = options().value<Uint>("nb_parts");
+  if(nb_parts != nb_procs)
+    throw SetupError(FromHere(), "Distributed channel generation creates one partition per process, but nb_parts is " + boost::lexical_cast<std::string>(nb_parts) + " for " + boost::lexical_cast<std::string>(nb_procs) + " processes");
+  if(x_segs < nb_procs)
+    throw SetupError(FromHere(), "Distributed channel generation needs at least one X segment per process, but x_segments is " + boost::lexical_cast<std::string>(x_segs) + " for " + boost::lexical_cast<std::string>(nb_procs) + " processes");
+
+  const Uint y_segs = 2*y_segs_half;
+  const Uint nb_y_nodes = y_segs + 1;
+  const Uint nb_z_nodes = z_segs + 1;
+  const Uint layer_size = nb_y_nodes*nb_z_nodes; // Number of nodes in a plane with constant X
+
+  // Each rank gets a slab of cell layers in the X direction. It owns the node layers at the start of each of its cell
+  // layers, and the last rank also owns the end of the channel. The node layer at the end of the slab is the ghost layer.
+  std::vector<Uint> x_distribution(nb_procs+1);
+  for(Uint proc = 0; proc <= nb_procs; ++proc)
+    x_distribution[proc] = proc*(x_segs/nb_procs) + std::min(proc, x_segs%nb_procs);
+
+  const Uint x_begin = x_distribution[rank];
+  const Uint nb_x_cells = x_distribution[rank+1] - x_begin;
+  const bool is_first = rank == 0;
+  const bool is_last = rank == (nb_procs-1);
+  const Uint nb_nodes = (nb_x_cells+1)*layer_size;
+  const Uint nb_owned_nodes = is_last ? nb_nodes : nb_x_cells*layer_size;
+
+  std::vector<Real> x_positions, y_positions, z_positions, y_top_positions;
+  detail::append_graded_positions(x_segs, 1., 0., length, x_positions);
+  detail::append_graded_positions(y_segs_half, 1./ratio, -half_height, 0., y_positions);
+  detail::append_graded_positions(y_segs_half, ratio, 0., half_height, y_top_positions);
+  y_positions.insert(y_positions.end(), y_top_positions.begin()+1, y_top_positions.end());
+  detail::append_graded_positions(z_segs, 1., 0., width, z_positions);
+
+  // Nodes, numbered so that the global index is the local index offset by the first node of the slab
+  mesh.initialize_nodes(nb_nodes, 3);
+  Field& coordinates = mesh.geometry_fields().coordinates();
+  Uint node_idx = 0;
+  for(Uint i = 0; i <= nb_x_cells; ++i)
+  {
+    for(Uint k = 0; k != nb_z_nodes; ++k)
+    {
+      for(Uint j = 0; j != nb_y_nodes; ++j)
+      {
+        coordinates[node_idx][XX] = x_positions[x_begin+i];
+        coordinates[node_idx][YY] = y_positions[j];
+        coordinates[node_idx][ZZ] = z_positions[k];
+        ++node_idx;
+      }
+    }
+  }
+
+  if(is_parallel)
+  {
+    List<Uint>& gids = mesh.geometry_fields().glb_idx(); gids.resize(nb_nodes);
+    List<Uint>& ranks = mesh.geometry_fields().rank(); ranks.resize(nb_nodes);
+    const Uint first_gid = x_begin*layer_size;
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      gids[i] = first_gid + i;
+      ranks[i] = i < nb_owned_nodes ? rank : rank+1;
+    }
+  }
+
+  // Volume cells
+  const detail::SlabNodes node(nb_y_nodes, nb_z_nodes);
+  Elements& volume_elements = mesh.topology().create_region("interior").create_elements("cf3.mesh.LagrangeP1.Hexa3D", mesh.geometry_fields());
+  volume_elements.resize(nb_x_cells*y_segs*z_segs);
+  Connectivity& volume_connectivity = volume_elements.geometry_space().connectivity();
+  Uint elem_idx = 0;
+  for(Uint i = 0; i != nb_x_cells; ++i)
+  {
+    for(Uint k = 0; k != z_segs; ++k)
+    {
+      for(Uint j = 0; j != y_segs; ++j)
+      {
+        Connectivity::Row element_connectivity = volume_connectivity[elem_idx++];
+        element_connectivity[0] = node(i  , j  , k  );
+        element_connectivity[1] = node(i+1, j  , k  );
+        element_connectivity[2] = node(i+1, j+1, k  );
+        element_connectivity[3] = node(i  , j+1, k  );
+        element_connectivity[4] = node(i  , j  , k+1);
+        element_connectivity[5] = node(i+1, j  , k+1);
+        element_connectivity[6] = node(i+1, j+1, k+1);
+        element_connectivity[7] = node(i  , j+1, k+1);
+      }
+    }
+  }
+
+  // Boundary patches, from the faces of the adjacent local cells. Patches are created on every rank, even when empty.
+  std::vector<Uint> back_cells, bottom_cells, front_cells, left_cells, right_cells, top_cells;
+  for(Uint i = 0; i != nb_x_cells; ++i)
+  {
+    for(Uint k = 0; k != z_segs; ++k)
+    {
+      bottom_cells.push_back((i*z_segs + k)*y_segs);
+      top_cells.push_back((i*z_segs + k)*y_segs + y_segs - 1);
+    }
+    for(Uint j = 0; j != y_segs; ++j)
+    {
+      front_cells.push_back(i*z_segs*y_segs + j);
+      back_cells.push_back((i*z_segs + z_segs - 1)*y_segs + j);
+    }
+  }
+  for(Uint k = 0; k != z_segs; ++k)
+  {
+    for(Uint j = 0; j != y_segs; ++j)
+    {
+      if(is_first)
+        left_cells.push_back(k*y_segs + j);
+      if(is_last)
+        right_cells.push_back(((nb_x_cells-1)*z_segs + k)*y_segs + j);
+    }
+  }
+  detail::add_patch(mesh, "back", volume_connectivity, back_cells, LagrangeP1::Hexa::ZTA_POS);
+  detail::add_patch(mesh, "bottom", volume_connectivity, bottom_cells, LagrangeP1::Hexa::ETA_NEG);
+  detail::add_patch(mesh, "front", volume_connectivity, front_cells, LagrangeP1::Hexa::ZTA_NEG);
+  detail::add_patch(mesh, "left", volume_connectivity, left_cells, LagrangeP1::Hexa::KSI_NEG);
+  detail::add_patch(mesh, "right", volume_connectivity, right_cells, LagrangeP1::Hexa::KSI_POS);
+  detail::add_patch(mesh, "top", volume_connectivity, top_cells, LagrangeP1::Hexa::ETA_POS);
+
+  // Elements are numbered per rank, as in BlockArrays::create_mesh, but the number of elements on the previous ranks
+  // follows from the X distribution. The right patch is on the last rank, which never precedes this one.
+  Uint element_offset = 0;
+  for(Uint proc = 0; proc != rank; ++proc)
+  {
+    const Uint proc_nb_x_cells = x_distribution[proc+1] - x_distribution[proc];
+    element_offset += proc_nb_x_cells*(y_segs*z_segs + 2*z_segs + 2*y_segs) + (proc == 0 ? y_segs*z_segs : 0);
+  }
+
+  BOOST_FOREACH(Elements& elements, find_components_recursively<Elements>(mesh))
+  {
+    const Uint nb_elems = elements.size();
+    elements.rank().resize(nb_elems);
+    elements.glb_idx().resize(nb_elems);
+
+    for (Uint elem=0; elem != nb_elems; ++elem)
+    {
+      elements.rank()[elem] = rank;
+      elements.glb_idx()[elem] = elem + element_offset;
+    }
+    element_offset += nb_elems;
+  }
+
+  // Ghost coordinates were computed locally, so they need no synchronization
+  if(is_parallel)
+    mesh.geometry_fields().coordinates().parallelize_with(mesh.geometry_fields().comm_pattern());
+
+  mesh.update_structures();
+
+  const Uint cell_overlap = options().value<Uint>("cell_overlap");
+  if(is_parallel && nb_procs > 1 && cell_overlap != 0)
+  {
+    mesh.block_mesh_changed(true); // avoid triggering mesh_changed before the load event is raised
+    MeshTransformer& grow_overlap = *Handle<MeshTransformer>(create_component("GrowOverlap", "cf3.mesh.actions.GrowOverlap"));
+    for(Uint i = 0; i != cell_overlap; ++i)
+      grow_overlap.transform(mesh);
+
+    mesh.geometry_fields().remove_component("CommPattern");
+    remove_component(grow_overlap);
+    mesh.block_mesh_changed(false);
+  }
+  mesh.raise_mesh_loaded();
+}
+
 } // BlockMesh
 } // mesh
 } // cf3
@@ -37,6 +37,12 @@ public:
   static std::string type_name () { return "ChannelGenerator"; }
   
   virtual void execute();
+
+private:
+  /// Generate the mesh directly in parallel: each rank creates its own slab of cells in the X direction, together
+  /// with the ghost nodes and boundary patches it touches, with global indices computed from the structured numbering.
+  /// No rank ever stores the complete block structure.
+  void create_distributed_mesh(Mesh& mesh);
 };
 
 } // BlockMesh
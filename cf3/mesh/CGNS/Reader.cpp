@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/foreach.hpp>
 #include <boost/progress.hpp>
@@ -17,6 +19,7 @@
 #include "common/FindComponents.hpp"
 #include "common/BasicExceptions.hpp"
 #include "common/StringConversion.hpp"
+#include "common/PE/Comm.hpp"
 
 #include "math/VariablesDescriptor.hpp"
 
@@ -28,6 +31,7 @@
 #include "mesh/MeshElements.hpp"
 #include "mesh/Space.hpp"
 #include "mesh/MeshTransformer.hpp"
+#include "mesh/ParallelDistribution.hpp"
 
 #include "mesh/CGNS/Reader.hpp"
 
@@ -46,11 +50,24 @@ common::ComponentBuilder< Reader, MeshReader, LibCGNS > aCGNSReader_Builder;
 //////////////////////////////////////////////////////////////////////////////
 
 Reader::Reader(const std::string& name)
-: MeshReader(name), Shared()
+: MeshReader(name), Shared(), m_elem_begin(0), m_elem_end(0)
 {
   options().add( "SectionsAreBCs", false )
       .description("Treat Sections of lower dimensionality as BC. "
                         "This means no BCs from cgns will be read");
+
+  options().add("distributed", false)
+      .description("Read only a contiguous range of the elements of each unstructured zone, and the nodes they need. "
+                   "The range is determined by the options part and nb_parts. The mesh must be partitioned afterwards.")
+      .pretty_name("Distributed");
+
+  options().add("part", PE::Comm::instance().rank())
+      .description("Number of the part of the mesh to read in distributed mode. (e.g. rank of processor)")
+      .pretty_name("Part");
+
+  options().add("nb_parts", PE::Comm::instance().size())
+      .description("Total nb_partitions in distributed mode. (e.g. number of processors)")
+      .pretty_name("Number of Parts");
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -85,6 +102,21 @@ void Reader::do_read_mesh_into(const URI& file, Mesh& mesh)
   // close the CGNS file
   CALL_CGNS(cg_close(m_file.idx));
 
+  if (options().value<bool>("distributed"))
+  {
+    const Uint part = options().value<Uint>("part");
+    BOOST_FOREACH(Elements& elements, find_components_recursively<Elements>(m_mesh->topology()))
+    {
+      elements.rank().resize(elements.size());
+      for (Uint e=0; e<elements.size(); ++e)
+        elements.rank()[e] = part;
+    }
+
+    m_local_nodes.clear();
+    m_node_runs.clear();
+    m_section_ranges.clear();
+  }
+
   // Fix global numbering
   /// @todo remove this and read glb_index ourself
   build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalNumbering","glb_numbering")->transform(m_mesh);
@@ -172,14 +204,28 @@ void Reader::read_zone(Mesh& mesh)
     this_region.add_tag("grid_zone");
     m_zone_map[m_zone.idx] = &this_region;
 
-    // read coordinates in this zone
-    for (int i=1; i<=m_zone.nbGrids; ++i)
-      read_coordinates_unstructured(this_region);
+    if (options().value<bool>("distributed"))
+    {
+      // read the elements of this part first, to know which nodes are needed
+      setup_distribution();
+      read_sections_distributed(this_region);
+      read_coordinates_distributed();
+      renumber_nodes(this_region);
+    }
+    else
+    {
+      m_elem_begin = 0;
+      m_elem_end = m_zone.total_nbElements;
 
-    // read sections (or subregions) in this zone
-    m_global_to_region.reserve(m_zone.total_nbElements);
-    for (m_section.idx=1; m_section.idx<=m_zone.nbSections; ++m_section.idx)
-      read_section(this_region);
+      // read coordinates in this zone
+      for (int i=1; i<=m_zone.nbGrids; ++i)
+        read_coordinates_unstructured(this_region);
+
+      // read sections (or subregions) in this zone
+      m_global_to_region.reserve(m_zone.total_nbElements);
+      for (m_section.idx=1; m_section.idx<=m_zone.nbSections; ++m_section.idx)
+        read_section(this_region);
+    }
 
 //    // Only read boco's if sections are not defined as BC's
 //    if (!option("SectionsAreBCs")->value<bool>())
@@ -207,6 +253,9 @@ void Reader::read_zone(Mesh& mesh)
   }
   else if(m_zone.type == CGNS_ENUMV( Structured ))
   {
+    if (options().value<bool>("distributed"))
+      throw NotSupported(FromHere(),"CGNS: distributed reading is only supported for CGNS_ENUMV( Unstructured ) zones");
+
     cgsize_t isize[3][3];
     char zone_name_char[CGNS_CHAR_MAX];
     CALL_CGNS(cg_zone_read(m_file.idx,m_base.idx,m_zone.idx,zone_name_char,isize[0]));
@@ -649,19 +698,32 @@ void Reader::read_boco_unstructured(Region& parent_region)
         throw NotSupported(FromHere(),"CGNS: Boundary with pointset_type \"CGNS_ENUMV( ElementRange )\" is only supported for CGNS_ENUMV( Unstructured ) grids");
 
       // First do some simple checks to see if an entire region can be taken as a BC.
-      Handle< Elements > first_elements = m_global_to_region[boco_elems[0]-1].first;
-      Handle< Elements > last_elements = m_global_to_region[boco_elems[1]-1].first;
-      if (first_elements->parent() == last_elements->parent())
+      if (options().value<bool>("distributed"))
       {
-        Handle< Region > group_region = Handle<Region>(first_elements->parent());
-        Uint prev_elm_count = group_region->properties().check("previous_elem_count") ? group_region->properties().value<Uint>("previous_elem_count") : 0;
-        if (group_region->recursive_elements_count(true) == prev_elm_count + Uint(boco_elems[1]-boco_elems[0]+1))
+        // The first and last elements may be read by other parts, so compare with the section ranges
+        if (Handle< Region > group_region = section_with_range(boco_elems[0],boco_elems[1]))
         {
           group_region->properties()["cgns_section_name"] = group_region->name();
           group_region->rename(m_boco.name);
           break;
         }
       }
+      else
+      {
+        Handle< Elements > first_elements = m_global_to_region[boco_elems[0]-1].first;
+        Handle< Elements > last_elements = m_global_to_region[boco_elems[1]-1].first;
+        if (first_elements->parent() == last_elements->parent())
+        {
+          Handle< Region > group_region = Handle<Region>(first_elements->parent());
+          Uint prev_elm_count = group_region->properties().check("previous_elem_count") ? group_region->properties().value<Uint>("previous_elem_count") : 0;
+          if (group_region->recursive_elements_count(true) == prev_elm_count + Uint(boco_elems[1]-boco_elems[0]+1))
+          {
+            group_region->properties()["cgns_section_name"] = group_region->name();
+            group_region->rename(m_boco.name);
+            break;
+          }
+        }
+      }
 
 
       // Create a region inside mesh/regions/bc-regions with the name of the cgns boco.
@@ -680,11 +742,15 @@ void Reader::read_boco_unstructured(Region& parent_region)
 
       for (int global_element=boco_elems[0]-1;global_element<boco_elems[1];++global_element)
       {
+        // Skip elements read by another part
+        if (Uint(global_element) < m_elem_begin || Uint(global_element) >= m_elem_end)
+          continue;
+
         // Check which region this global_element belongs to
-        Handle< Elements > element_region = m_global_to_region[global_element].first;
+        Handle< Elements > element_region = m_global_to_region[global_element-m_elem_begin].first;
 
         // Check the local element number in this region
-        Uint local_element = m_global_to_region[global_element].second;
+        Uint local_element = m_global_to_region[global_element-m_elem_begin].second;
 
         // Add the local element to the correct Elements component through its buffer
         std::cout << "element_region->element_type().derived_type_name() = " << element_region->element_type().derived_type_name() << std::endl;
@@ -707,21 +773,34 @@ void Reader::read_boco_unstructured(Region& parent_region)
         throw NotSupported(FromHere(),"CGNS: Boundary with pointset_type \"ElementList\" is only supported for CGNS_ENUMV( Unstructured ) grids");
 
       // First do some simple checks to see if an entire region can be taken as a BC.
-      std::cout << "boco_elems[0]-1 = " << boco_elems[0]-1 << std::endl;
-      std::cout << m_global_to_region[boco_elems[0]-1].second << std::endl;
-      cf3_assert(m_global_to_region[boco_elems[0]-1].first);
-      Handle< Elements > first_elements = m_global_to_region[boco_elems[0]-1].first;
-      cf3_assert(m_global_to_region[boco_elems[m_boco.nBC_elem-1]-1].first);
-      Handle< Elements > last_elements = m_global_to_region[boco_elems[m_boco.nBC_elem-1]-1].first;
-      if (first_elements->parent() == last_elements->parent())
+      if (options().value<bool>("distributed"))
       {
-        Handle< Region > group_region = Handle<Region>(first_elements->parent());
-        if (group_region->name() != m_boco.name)
+        // The first and last elements may be read by other parts, so compare with the section ranges
+        Handle< Region > group_region = section_with_range(boco_elems[0],boco_elems[m_boco.nBC_elem-1]);
+        if (is_not_null(group_region) && group_region->name() != m_boco.name && m_boco.nBC_elem == boco_elems[m_boco.nBC_elem-1]-boco_elems[0]+1)
         {
-          if (group_region->recursive_elements_count(true) == Uint(boco_elems[m_boco.nBC_elem-1]-boco_elems[0]+1))
+          group_region->rename(m_boco.name);
+          break;  // EXIT switch
+        }
+      }
+      else
+      {
+        std::cout << "boco_elems[0]-1 = " << boco_elems[0]-1 << std::endl;
+        std::cout << m_global_to_region[boco_elems[0]-1].second << std::endl;
+        cf3_assert(m_global_to_region[boco_elems[0]-1].first);
+        Handle< Elements > first_elements = m_global_to_region[boco_elems[0]-1].first;
+        cf3_assert(m_global_to_region[boco_elems[m_boco.nBC_elem-1]-1].first);
+        Handle< Elements > last_elements = m_global_to_region[boco_elems[m_boco.nBC_elem-1]-1].first;
+        if (first_elements->parent() == last_elements->parent())
+        {
+          Handle< Region > group_region = Handle<Region>(first_elements->parent());
+          if (group_region->name() != m_boco.name)
           {
-            group_region->rename(m_boco.name);
-            break;  // EXIT switch
+            if (group_region->recursive_elements_count(true) == Uint(boco_elems[m_boco.nBC_elem-1]-boco_elems[0]+1))
+            {
+              group_region->rename(m_boco.name);
+              break;  // EXIT switch
+            }
           }
         }
       }
@@ -745,11 +824,15 @@ void Reader::read_boco_unstructured(Region& parent_region)
       {
         Uint global_element = boco_elems[i]-1;
 
+        // Skip elements read by another part
+        if (global_element < m_elem_begin || global_element >= m_elem_end)
+          continue;
+
         // Check which region this global_element belongs to
-        Handle< Elements > element_region = m_global_to_region[global_element].first;
+        Handle< Elements > element_region = m_global_to_region[global_element-m_elem_begin].first;
 
         // Check the local element number in this region
-        Uint local_element = m_global_to_region[global_element].second;
+        Uint local_element = m_global_to_region[global_element-m_elem_begin].second;
 
         // Add the local element to the correct Elements component through its buffer
         std::cout << "element_region->element_type().derived_type_name() = " << element_region->element_type().derived_type_name() << std::endl;
@@ -965,7 +1048,7 @@ void Reader::read_flowsolution()
     switch (m_flowsol.grid_loc)
     {
       case CGNS_ENUMV( Vertex ):
-        datasize = m_zone.total_nbVertices;
+        datasize = options().value<bool>("distributed") ? m_local_nodes.size() : m_zone.total_nbVertices;
         dict = m_mesh->geometry_fields().handle<Dictionary>();
         break;
       case CGNS_ENUMV( CellCenter ):
@@ -980,7 +1063,6 @@ void Reader::read_flowsolution()
         throw NotSupported(FromHere(), "Flow solution Grid location ["+to_str((int)m_flowsol.grid_loc)+"] is not supported");
     }
 
-    cf3_assert(datasize == m_zone.total_nbVertices);
     cf3_assert(datasize == m_mesh->geometry_fields().size());
 
     boost::shared_ptr<math::VariablesDescriptor> variables = allocate_component<math::VariablesDescriptor>("variables");
@@ -1009,10 +1091,29 @@ void Reader::read_flowsolution()
       m_field.name=field_name_char;
 
       std::vector<double> field_data(datasize);
-      cgsize_t imin = 1;
-      cgsize_t imax = datasize;
-      CALL_CGNS(cg_field_read( m_file.idx,m_base.idx,m_zone.idx,m_flowsol.idx,
-                               field_name_char,CGNS_ENUMV( RealDouble ),&imin,&imax,(void*)(&field_data[0]) ));
+      if (options().value<bool>("distributed"))
+      {
+        // read the same runs as the coordinates, keeping only the local nodes
+        std::vector<double> run_data;
+        Uint local_idx = 0;
+        for (Uint r=0; r<m_node_runs.size(); ++r)
+        {
+          cgsize_t imin = m_node_runs[r].first;
+          cgsize_t imax = m_node_runs[r].second;
+          run_data.resize(imax-imin+1);
+          CALL_CGNS(cg_field_read( m_file.idx,m_base.idx,m_zone.idx,m_flowsol.idx,
+                                   field_name_char,CGNS_ENUMV( RealDouble ),&imin,&imax,(void*)(&run_data[0]) ));
+          for ( ; local_idx<m_local_nodes.size() && m_local_nodes[local_idx]<=imax; ++local_idx)
+            field_data[local_idx] = run_data[m_local_nodes[local_idx]-imin];
+        }
+      }
+      else
+      {
+        cgsize_t imin = 1;
+        cgsize_t imax = datasize;
+        CALL_CGNS(cg_field_read( m_file.idx,m_base.idx,m_zone.idx,m_flowsol.idx,
+                                 field_name_char,CGNS_ENUMV( RealDouble ),&imin,&imax,(void*)(&field_data[0]) ));
+      }
 
       cf3_assert(field_data.size() == flowsol_field.size());
       cf3_assert(flowsol_field.nb_vars() == m_flowsol.nbFields);
@@ -1055,6 +1156,226 @@ Uint Reader::get_total_nbElements()
 
 //////////////////////////////////////////////////////////////////////////////
 
+void Reader::setup_distribution()
+{
+  const Uint part = options().value<Uint>("part");
+  const Uint nb_parts = options().value<Uint>("nb_parts");
+
+  m_elem_distribution = allocate_component<ParallelDistribution>("elem_distribution");
+  m_elem_distribution->options().set("nb_obj",static_cast<Uint>(m_zone.total_nbElements));
+  m_elem_distribution->options().set("nb_parts",nb_parts);
+  m_elem_begin = m_elem_distribution->start_idx_in_part(part);
+  m_elem_end = m_elem_distribution->end_idx_in_part(part);
+
+  m_node_distribution = allocate_component<ParallelDistribution>("node_distribution");
+  m_node_distribution->options().set("nb_obj",static_cast<Uint>(m_zone.total_nbVertices));
+  m_node_distribution->options().set("nb_parts",nb_parts);
+
+  CFinfo << "reading elements [" << m_elem_begin << "," << m_elem_end << ") of " << m_zone.total_nbElements
+         << " in zone " << m_zone.name << CFendl;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_sections_distributed(Region& parent_region)
+{
+  Dictionary& all_nodes = m_mesh->geometry_fields();
+  m_zone.nodes = &all_nodes;
+  m_zone.nodes_start_idx = 0;
+
+  m_global_to_region.assign(m_elem_end-m_elem_begin,Region_TableIndex_pair());
+  m_section_ranges.clear();
+  m_local_nodes.clear();
+
+  for (m_section.idx=1; m_section.idx<=m_zone.nbSections; ++m_section.idx)
+  {
+    char section_name_char[CGNS_CHAR_MAX];
+    CALL_CGNS(cg_section_read(m_file.idx, m_base.idx, m_zone.idx, m_section.idx, section_name_char, &m_section.type,
+                              &m_section.eBegin, &m_section.eEnd, &m_section.nbBdry, &m_section.parentFlag));
+    m_section.name=section_name_char;
+
+    // replace whitespace by underscore
+    boost::algorithm::replace_all(m_section.name," ","_");
+    boost::algorithm::replace_all(m_section.name,".","_");
+    boost::algorithm::replace_all(m_section.name,":","_");
+    boost::algorithm::replace_all(m_section.name,"/","_");
+
+    // Every part creates the region, also when none of its elements are in this section
+    Region& this_region = parent_region.create_region(m_section.name);
+    SectionRange section_range;
+    section_range.first = m_section.eBegin;
+    section_range.last = m_section.eEnd;
+    section_range.region = this_region.handle<Region>();
+    m_section_ranges.push_back(section_range);
+
+    // Elements of this section in the range of this part, with 1-based indices
+    const cgsize_t first = std::max(m_section.eBegin, static_cast<cgsize_t>(m_elem_begin+1));
+    const cgsize_t last = std::min(m_section.eEnd, static_cast<cgsize_t>(m_elem_end));
+
+    if (m_section.type == CGNS_ENUMV( MIXED )) // Different element types, Can also be faces
+    {
+      std::map<std::string,Handle< Elements > > cells = create_cells_in_region(this_region,all_nodes,get_supported_element_types());
+      std::map<std::string,Handle< Elements > > faces = create_faces_in_region(this_region,all_nodes,get_supported_element_types());
+      std::map<std::string,Handle< Elements > > elements;
+      elements.insert(cells.begin(),cells.end());
+      elements.insert(faces.begin(),faces.end());
+      BufferMap buffer = create_connectivity_buffermap(elements);
+
+      if (first <= last)
+      {
+        // Read the whole range at once, each element is stored as its type followed by its nodes
+        cgsize_t data_size;
+        CALL_CGNS(cg_ElementPartialSize(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,first,last,&data_size));
+        std::vector<cgsize_t> data(data_size);
+        CALL_CGNS(cg_elements_partial_read(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,first,last,&data[0],NULL));
+
+        std::vector<Uint> row;
+        Uint pos = 0;
+        for (cgsize_t elem=first; elem<=last; ++elem)
+        {
+          CGNS_ENUMT( ElementType_t ) etype_cgns = static_cast<CGNS_ENUMT( ElementType_t )>(data[pos]);
+          int nb_elem_nodes;
+          CALL_CGNS(cg_npe(etype_cgns,&nb_elem_nodes));
+
+          // zone node indices, converted to local node indices in renumber_nodes()
+          row.resize(nb_elem_nodes);
+          for (int n=0; n<nb_elem_nodes; ++n)
+          {
+            row[n] = data[pos+1+n]-1;
+            m_local_nodes.push_back(data[pos+1+n]);
+          }
+          pos += 1+nb_elem_nodes;
+
+          const std::string& etype_CF = m_elemtype_CGNS_to_CF[etype_cgns]+to_str(m_zone.coord_dim)+"D";
+          cf3_assert(buffer[etype_CF]);
+          Uint table_idx = buffer[etype_CF]->add_row(row);
+          m_global_to_region[elem-1-m_elem_begin] = Region_TableIndex_pair(find_component_ptr_with_name<Elements>(this_region, etype_CF),table_idx);
+        }
+      }
+
+      for (BufferMap::iterator it=buffer.begin(); it!=buffer.end(); ++it)
+        it->second->flush();
+    }
+    else // Single element type in this section
+    {
+      CALL_CGNS(cg_npe(m_section.type,&m_section.elemNodeCount));
+      const std::string& etype_CF = m_elemtype_CGNS_to_CF[m_section.type]+to_str<int>(m_base.phys_dim)+"D";
+      Elements& element_region = this_region.create_elements(etype_CF,all_nodes);
+      Connectivity& node_connectivity = element_region.geometry_space().connectivity();
+
+      if (first <= last)
+      {
+        const Uint nb_elems = last-first+1;
+        std::vector<cgsize_t> elem_nodes(nb_elems*m_section.elemNodeCount);
+        CALL_CGNS(cg_elements_partial_read(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,first,last,&elem_nodes[0],NULL));
+
+        node_connectivity.resize(nb_elems);
+        for (Uint elem=0; elem<nb_elems; ++elem)
+        {
+          // zone node indices, converted to local node indices in renumber_nodes()
+          for (int node=0; node<m_section.elemNodeCount; ++node)
+          {
+            const cgsize_t zone_node = elem_nodes[node+elem*m_section.elemNodeCount];
+            node_connectivity[elem][node] = zone_node-1;
+            m_local_nodes.push_back(zone_node);
+          }
+          m_global_to_region[first-1-m_elem_begin+elem] = Region_TableIndex_pair(element_region.handle<Elements>(),elem);
+        }
+      }
+    }
+
+    remove_empty_element_regions(this_region);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_coordinates_distributed()
+{
+  // Nodes separated by at most this many unused nodes are read with a single call
+  const cgsize_t max_gap = 1024;
+
+  // Every owned node is read, also when no local element uses it
+  const Uint part = options().value<Uint>("part");
+  for (Uint n=m_node_distribution->start_idx_in_part(part); n<m_node_distribution->end_idx_in_part(part); ++n)
+    m_local_nodes.push_back(n+1);
+  std::sort(m_local_nodes.begin(),m_local_nodes.end());
+  m_local_nodes.erase(std::unique(m_local_nodes.begin(),m_local_nodes.end()),m_local_nodes.end());
+
+  m_node_runs.clear();
+  BOOST_FOREACH(const cgsize_t node, m_local_nodes)
+  {
+    if (m_node_runs.empty() || node - m_node_runs.back().second > max_gap)
+      m_node_runs.push_back(std::make_pair(node,node));
+    else
+      m_node_runs.back().second = node;
+  }
+
+  CFinfo << "reading " << m_local_nodes.size() << " of " << m_zone.total_nbVertices << " nodes in "
+         << m_node_runs.size() << " ranges" << CFendl;
+
+  m_mesh->initialize_nodes(m_local_nodes.size(), (Uint)m_zone.coord_dim);
+  Dictionary& nodes = m_mesh->geometry_fields();
+  common::Table<Real>& coords = nodes.coordinates();
+  common::List<Uint>& rank = nodes.rank();
+  common::List<Uint>& glb_idx = nodes.glb_idx();
+  for (Uint i=0; i<m_local_nodes.size(); ++i)
+  {
+    rank[i] = m_node_distribution->part_of_obj(m_local_nodes[i]-1);
+    glb_idx[i] = m_local_nodes[i]-1;
+  }
+
+  const char* coord_names[3] = { "CoordinateX", "CoordinateY", "CoordinateZ" };
+  std::vector<Real> run_coords;
+  for (int d=0; d<m_zone.coord_dim; ++d)
+  {
+    Uint local_idx = 0;
+    for (Uint r=0; r<m_node_runs.size(); ++r)
+    {
+      cgsize_t rmin = m_node_runs[r].first;
+      cgsize_t rmax = m_node_runs[r].second;
+      run_coords.resize(rmax-rmin+1);
+      CALL_CGNS(cg_coord_read(m_file.idx,m_base.idx,m_zone.idx, coord_names[d], CGNS_ENUMV( RealDouble ), &rmin, &rmax, &run_coords[0]));
+      for ( ; local_idx<m_local_nodes.size() && m_local_nodes[local_idx]<=rmax; ++local_idx)
+        coords[local_idx][d] = run_coords[m_local_nodes[local_idx]-rmin];
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::renumber_nodes(Region& parent_region)
+{
+  BOOST_FOREACH(Elements& elements, find_components_recursively<Elements>(parent_region))
+  {
+    Connectivity& node_connectivity = elements.geometry_space().connectivity();
+    for (Uint e=0; e<node_connectivity.size(); ++e)
+    {
+      Connectivity::Row row = node_connectivity[e];
+      for (Uint n=0; n<row.size(); ++n)
+      {
+        const cgsize_t zone_node = row[n]+1;
+        row[n] = std::lower_bound(m_local_nodes.begin(),m_local_nodes.end(),zone_node) - m_local_nodes.begin();
+        cf3_assert(m_local_nodes[row[n]] == zone_node);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Handle<Region> Reader::section_with_range(const cgsize_t first, const cgsize_t last)
+{
+  BOOST_FOREACH(const SectionRange& section_range, m_section_ranges)
+  {
+    if (section_range.first == first && section_range.last == last)
+      return section_range.region;
+  }
+  return Handle<Region>();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 } // CGNS
 } // mesh
 } // cf3
@@ -19,6 +19,7 @@
 namespace cf3 {
 namespace mesh {
   class Region;
+  class ParallelDistribution;
 namespace CGNS {
 
 //////////////////////////////////////////////////////////////////////////////
@@ -59,6 +60,27 @@ private: // functions
   void read_flowsolution();
   Uint get_total_nbElements();
 
+  /// @name Distributed reading of unstructured zones
+  //@{
+
+  /// Assign a contiguous range of the zone elements and nodes to this part
+  void setup_distribution();
+
+  /// Read the part of every section that falls within the element range of this part.
+  /// The connectivity refers to zone node indices until renumber_nodes() is called.
+  void read_sections_distributed(Region& parent_region);
+
+  /// Read the coordinates of the owned nodes and of the nodes used by the local elements
+  void read_coordinates_distributed();
+
+  /// Replace zone node indices in the connectivity of the local elements by local node indices
+  void renumber_nodes(Region& parent_region);
+
+  /// Region of the section spanning exactly the given range of (1-based) element indices
+  Handle<Region> section_with_range(const cgsize_t first, const cgsize_t last);
+
+  //@}
+
   Uint structured_node_idx(Uint i, Uint j, Uint k)
   {
     return i + j*m_zone.nbVertices[XX] + k*m_zone.nbVertices[XX]*m_zone.nbVertices[YY];
@@ -74,6 +96,31 @@ private: // data
   Handle<Mesh> m_mesh;
   Uint m_coord_start_idx;
 
+  /// Range [begin,end) of 0-based zone element indices read by this part,
+  /// m_global_to_region is indexed relative to m_elem_begin
+  Uint m_elem_begin;
+  Uint m_elem_end;
+
+  /// Distribution of the zone nodes and elements over the parts, in distributed mode
+  boost::shared_ptr<ParallelDistribution> m_node_distribution;
+  boost::shared_ptr<ParallelDistribution> m_elem_distribution;
+
+  /// Sorted 1-based zone indices of the nodes read by this part, in distributed mode.
+  /// The position in this vector is the local node index.
+  std::vector<cgsize_t> m_local_nodes;
+
+  /// Ranges [first,last] of 1-based zone node indices, read with a single call each
+  std::vector< std::pair<cgsize_t,cgsize_t> > m_node_runs;
+
+  /// Element ranges of the sections in the current zone, with their region
+  struct SectionRange
+  {
+    cgsize_t first;
+    cgsize_t last;
+    Handle<Region> region;
+  };
+  std::vector<SectionRange> m_section_ranges;
+
 }; // end Reader
 
 
@@ -4,6 +4,7 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <set>
 
 #include <boost/assign/list_of.hpp>
@@ -25,6 +26,7 @@
 #include "mesh/ContinuousDictionary.hpp"
 #include "mesh/Region.hpp"
 #include "mesh/Mesh.hpp"
+#include "mesh/MeshChangeLog.hpp"
 
 #include "mesh/Cells.hpp"
 #include "mesh/Faces.hpp"
@@ -81,9 +83,10 @@ void ContinuousDictionary::rebuild_spaces_from_geometry()
     Entities& entities = *entities_handle;
     const ShapeFunction& shape_function = space(entities).shape_function();
     RealVector node_coord(entities.element_type().dimension());
+    entities.geometry_space().allocate_coordinates(elem_coordinates);
     for (Uint elem=0; elem<entities.size(); ++elem)
     {
-      elem_coordinates = entities.geometry_space().get_coordinates(elem);
+      entities.geometry_space().put_coordinates(elem_coordinates,elem);
       for (Uint node=0; node<elem_coordinates.rows(); ++node)
       {
         node_coord = elem_coordinates.row(node);
@@ -99,12 +102,14 @@ void ContinuousDictionary::rebuild_spaces_from_geometry()
   {
     Entities& entities = *entities_handle;
     const ShapeFunction& shape_function = space(entities).shape_function();
+    space(entities).allocate_coordinates(elem_coordinates);
+    RealVector space_coordinates(elem_coordinates.cols());
     for (Uint elem=0; elem<entities.size(); ++elem)
     {
-      elem_coordinates = entities.geometry_space().get_coordinates(elem);
+      space(entities).put_computed_coordinates(elem_coordinates,elem);
       for (Uint node=0; node<shape_function.nb_nodes(); ++node)
       {
-        RealVector space_coordinates = entities.element_type().shape_function().value(shape_function.local_coordinates().row(node)) * elem_coordinates ;
+        space_coordinates = elem_coordinates.row(node);
         boost::uint64_t hash = compute_glb_idx(space_coordinates);
         points.insert( hash );
       }
@@ -132,12 +137,14 @@ void ContinuousDictionary::rebuild_spaces_from_geometry()
     const ShapeFunction& shape_function = space(entities).shape_function();
     Connectivity& connectivity = const_cast<Space&>(space(entities)).connectivity();
     connectivity.resize(entities.size());
+    space(entities).allocate_coordinates(elem_coordinates);
+    RealVector space_coordinates(elem_coordinates.cols());
     for (Uint elem=0; elem<entities.size(); ++elem)
     {
-      elem_coordinates = entities.geometry_space().get_coordinates(elem);
+      space(entities).put_computed_coordinates(elem_coordinates,elem);
       for (Uint node=0; node<shape_function.nb_nodes(); ++node)
       {
-        RealVector space_coordinates = entities.element_type().shape_function().value(shape_function.local_coordinates().row(node)) * elem_coordinates ;
+        space_coordinates = elem_coordinates.row(node);
         boost::uint64_t hash = compute_glb_idx(space_coordinates);
         Uint idx = std::distance(points.begin(), points.find(hash));
         connectivity[elem][node] = idx;
@@ -343,6 +350,162 @@ void ContinuousDictionary::rebuild_node_to_element_connectivity()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+  /// Orders the elements around a node as rebuild_node_to_element_connectivity() does:
+  /// by position of the space in Dictionary::spaces(), then by element index
+  struct SpaceElemOrder
+  {
+    SpaceElemOrder(const std::map<const Space*,Uint>& space_order) : m_space_order(space_order) {}
+
+    bool operator()(const SpaceElem& lhs, const SpaceElem& rhs) const
+    {
+      const Uint lhs_space = m_space_order.find(lhs.comp)->second;
+      const Uint rhs_space = m_space_order.find(rhs.comp)->second;
+      return lhs_space < rhs_space || (lhs_space == rhs_space && lhs.idx < rhs.idx);
+    }
+
+    const std::map<const Space*,Uint>& m_space_order;
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ContinuousDictionary::update_node_to_element_connectivity(const MeshChangeLog& changes, const Uint dict_idx)
+{
+  const RowChanges& node_changes = changes.nodes(dict_idx);
+  std::vector< std::vector<SpaceElem> >& node_elements = m_connectivity->array();
+
+  // Without a connectivity that matched the baseline, or without the nodes of a removed element,
+  // there is nothing to update from
+  bool can_update = (node_elements.size() == node_changes.baseline_size());
+  std::map<const Space*,Uint> space_order;
+  for (Uint space_idx=0; space_idx<spaces().size() && can_update; ++space_idx)
+  {
+    const Space& space = *spaces()[space_idx];
+    space_order[&space] = space_idx;
+    const Uint entities_idx = space.support().entities_idx();
+    const std::map< Uint, std::vector<Uint> >& removed_element_nodes = changes.removed_element_nodes(entities_idx,dict_idx);
+    boost_foreach (const Uint elem_idx, changes.elements(entities_idx).removed())
+    {
+      if (removed_element_nodes.find(elem_idx) == removed_element_nodes.end())
+      {
+        can_update = false;
+        break;
+      }
+    }
+  }
+  if (!can_update)
+  {
+    rebuild_node_to_element_connectivity();
+    return;
+  }
+
+  if (changes.empty())
+    return;
+
+  // 1) Elements that are not changed but were connected to a removed node, are now connected
+  //    to another node with the same global index. Remember them to connect them again later.
+  std::vector<SpaceElem> relinked_elements;
+  boost_foreach (const Uint node_idx, node_changes.removed())
+  {
+    boost_foreach (const SpaceElem& space_elem, node_elements[node_idx])
+    {
+      const RowChanges& elem_changes = changes.elements(space_elem.comp->support().entities_idx());
+      if (elem_changes.removed().count(space_elem.idx) == 0 && elem_changes.moved().count(space_elem.idx) == 0)
+        relinked_elements.push_back(space_elem);
+    }
+  }
+
+  // 2) Rows of moved nodes move along, rows of added nodes start empty
+  std::vector< std::vector<SpaceElem> > moved_rows(node_changes.moved().size());
+  Uint moved_idx=0;
+  foreach_container( (const Uint baseline_node_idx) (const Uint node_idx), node_changes.moved() )
+    moved_rows[moved_idx++].swap(node_elements[baseline_node_idx]);
+  node_elements.resize(size());
+  moved_idx=0;
+  foreach_container( (const Uint baseline_node_idx) (const Uint node_idx), node_changes.moved() )
+    node_elements[node_idx].swap(moved_rows[moved_idx++]);
+  boost_foreach (const Uint node_idx, node_changes.added())
+    node_elements[node_idx].clear();
+
+  // 3) Remove removed and moved elements. Rows still refer to elements with their baseline index,
+  //    which are unique, so this must be done before any element is added with its current index.
+  std::set<Uint> changed_nodes;
+  boost_foreach (const Handle<Space>& space, spaces())
+  {
+    const Uint entities_idx = space->support().entities_idx();
+    const RowChanges& elem_changes = changes.elements(entities_idx);
+    const std::map< Uint, std::vector<Uint> >& removed_element_nodes = changes.removed_element_nodes(entities_idx,dict_idx);
+    boost_foreach (const Uint baseline_elem_idx, elem_changes.removed())
+    {
+      const SpaceElem removed_elem(*space,baseline_elem_idx);
+      boost_foreach (const Uint baseline_node_idx, removed_element_nodes.find(baseline_elem_idx)->second)
+      {
+        Uint node_idx;
+        if (node_changes.current_index(baseline_node_idx,node_idx))
+        {
+          std::vector<SpaceElem>& row = node_elements[node_idx];
+          row.erase(std::remove(row.begin(),row.end(),removed_elem),row.end());
+          changed_nodes.insert(node_idx);
+        }
+      }
+    }
+    foreach_container( (const Uint baseline_elem_idx) (const Uint elem_idx), elem_changes.moved() )
+    {
+      const SpaceElem moved_elem(*space,baseline_elem_idx);
+      boost_foreach (const Uint node_idx, space->connectivity()[elem_idx])
+      {
+        std::vector<SpaceElem>& row = node_elements[node_idx];
+        row.erase(std::remove(row.begin(),row.end(),moved_elem),row.end());
+      }
+    }
+  }
+
+  // 4) Add moved and added elements with their current index
+  boost_foreach (const Handle<Space>& space, spaces())
+  {
+    const RowChanges& elem_changes = changes.elements(space->support().entities_idx());
+    foreach_container( (const Uint baseline_elem_idx) (const Uint elem_idx), elem_changes.moved() )
+    {
+      boost_foreach (const Uint node_idx, space->connectivity()[elem_idx])
+      {
+        node_elements[node_idx].push_back(SpaceElem(*space,elem_idx));
+        changed_nodes.insert(node_idx);
+      }
+    }
+    boost_foreach (const Uint elem_idx, elem_changes.added())
+    {
+      boost_foreach (const Uint node_idx, space->connectivity()[elem_idx])
+      {
+        node_elements[node_idx].push_back(SpaceElem(*space,elem_idx));
+        changed_nodes.insert(node_idx);
+      }
+    }
+  }
+
+  // 5) Connect the elements of removed nodes to their new nodes
+  boost_foreach (const SpaceElem& space_elem, relinked_elements)
+  {
+    boost_foreach (const Uint node_idx, space_elem.comp->connectivity()[space_elem.idx])
+    {
+      std::vector<SpaceElem>& row = node_elements[node_idx];
+      if (std::find(row.begin(),row.end(),space_elem) == row.end())
+      {
+        row.push_back(space_elem);
+        changed_nodes.insert(node_idx);
+      }
+    }
+  }
+
+  // Sort changed rows the same way a rebuild would
+  const detail::SpaceElemOrder order(space_order);
+  boost_foreach (const Uint node_idx, changed_nodes)
+    std::sort(node_elements[node_idx].begin(),node_elements[node_idx].end(),order);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
 
@@ -35,6 +35,9 @@ public: // functions
 
   virtual void rebuild_node_to_element_connectivity();
 
+  /// Update the node to element connectivity for the rows of nodes and elements that changed only
+  virtual void update_node_to_element_connectivity(const MeshChangeLog& changes, const Uint dict_idx);
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -36,6 +36,7 @@
 #include "mesh/Space.hpp"
 #include "mesh/Entities.hpp"
 #include "mesh/Connectivity.hpp"
+#include "mesh/MeshChangeLog.hpp"
 
 #include "math/Consts.hpp"
 #include "math/VariablesDescriptor.hpp"
@@ -47,6 +48,22 @@ using namespace common;
 using namespace common::PE;
 using namespace common::XML;
 
+namespace detail
+{
+  /// True for the entries of the glb_to_loc map that point to one of the given rows
+  struct IsRowIn
+  {
+    IsRowIn(const std::set<Uint>& rows) : m_rows(rows) {}
+
+    bool operator()(const std::pair<boost::uint64_t,Uint>& entry) const
+    {
+      return m_rows.count(entry.second) != 0;
+    }
+
+    const std::set<Uint>& m_rows;
+  };
+}
+
 RegistTypeInfo<Dictionary, LibMesh> regist_Dictionary_type;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -422,6 +439,43 @@ void Dictionary::rebuild_map_glb_to_loc()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Dictionary::update_map_glb_to_loc(const RowChanges& changes)
+{
+  cf3_assert(m_glb_to_loc->size() == changes.baseline_size());
+  cf3_assert(size() == changes.size());
+
+  // Erase the removed rows first, as moved rows take the place of removed ones
+  if (!changes.removed().empty())
+    m_glb_to_loc->erase_if(detail::IsRowIn(changes.removed()));
+
+  // A moved row keeps its global index
+  const common::List<Uint>& gids = glb_idx();
+  for (std::map<Uint,Uint>::const_iterator moved = changes.moved().begin(); moved != changes.moved().end(); ++moved)
+  {
+    common::Map<boost::uint64_t,Uint>::iterator entry = m_glb_to_loc->find(gids[moved->second]);
+    cf3_assert(entry != m_glb_to_loc->end() && entry->second == moved->first);
+    entry->second = moved->second;
+  }
+
+  if (!changes.added().empty())
+  {
+    std::vector< std::pair<boost::uint64_t,Uint> > added;
+    added.reserve(changes.added().size());
+    boost_foreach(const Uint row, changes.added())
+      added.push_back(std::make_pair(static_cast<boost::uint64_t>(gids[row]),row));
+    m_glb_to_loc->merge(added);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Dictionary::update_node_to_element_connectivity(const MeshChangeLog& changes, const Uint dict_idx)
+{
+  rebuild_node_to_element_connectivity();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 bool Dictionary::defined_for_entities(const Handle<Entities const>& entities) const
 {
   return ( m_spaces_map.find(entities) != m_spaces_map.end() );
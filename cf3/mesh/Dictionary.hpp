@@ -30,6 +30,8 @@ namespace mesh {
   class Entities;
   class Space;
   class SpaceElem;
+  class MeshChangeLog;
+  class RowChanges;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -138,6 +140,13 @@ public: // functions
 
   void rebuild_map_glb_to_loc();
 
+  /// @brief Update the glb_to_loc() map after rows of this dictionary were removed, moved or added
+  ///
+  /// Removed rows are erased in one pass over the map, moved rows are looked up, and only the added
+  /// rows are sorted, so that the map is never sorted again as a whole.
+  /// @param [in] changes  Changes of the rows, with as baseline the rows the map was built for
+  void update_map_glb_to_loc(const RowChanges& changes);
+
   void build();
 
   /// @note This is a function only for non-geometry spaces.
@@ -145,6 +154,13 @@ public: // functions
 
   virtual void rebuild_node_to_element_connectivity() = 0;
 
+  /// @brief Update the node to element connectivity after the mesh changed
+  ///
+  /// By default the connectivity is rebuilt from scratch.
+  /// @param [in] changes   Changes of the mesh since the connectivity was last built
+  /// @param [in] dict_idx  Index of this dictionary in Mesh::dictionaries()
+  virtual void update_node_to_element_connectivity(const MeshChangeLog& changes, const Uint dict_idx);
+
 private: // functions
 
   void config_space();
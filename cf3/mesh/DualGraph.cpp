@@ -0,0 +1,297 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include "common/Builder.hpp"
+#include "common/Core.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
+#include "common/PropertyList.hpp"
+#include "common/ThreadPool.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/DualGraph.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Space.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+  using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+cf3::common::ComponentBuilder < DualGraph, Component, LibMesh > DualGraph_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  /// Finds the neighbours of a range of elements through the node-to-element connectivity.
+  /// Found neighbours are marked in the stamp buffer of the thread, shared by all its ranges.
+  /// Without a neighbour table, only the number of neighbours is computed. With one, the sorted neighbours are written.
+  struct NeighborSearch
+  {
+    NeighborSearch(const DualGraph::AdjacencyType adjacency, const std::vector<Uint>& entities_offsets,
+                   const std::vector<const Connectivity*>& connectivities, const std::vector<const ElementType*>& element_types,
+                   const std::vector<Uint>& node_offsets, const std::vector<Uint>& node_elements,
+                   std::vector<StampBuffer>& buffers, std::vector<Uint>& offsets, std::vector<Uint>* neighbors) :
+      m_adjacency(adjacency), m_entities_offsets(entities_offsets), m_connectivities(connectivities), m_element_types(element_types),
+      m_node_offsets(node_offsets), m_node_elements(node_elements), m_buffers(buffers), m_offsets(offsets), m_neighbors(neighbors)
+    {
+    }
+
+    /// Index of the entities containing an element
+    Uint entities_of(const Uint elem) const
+    {
+      return std::upper_bound(m_entities_offsets.begin(), m_entities_offsets.end(), elem) - m_entities_offsets.begin() - 1;
+    }
+
+    Connectivity::ConstRow nodes_of(const Uint elem, const Uint entities_idx) const
+    {
+      return (*m_connectivities[entities_idx])[elem - m_entities_offsets[entities_idx]];
+    }
+
+    void operator()(const Uint range_begin, const Uint range_end) const
+    {
+      StampBuffer& buffer = m_buffers[Core::instance().thread_pool().current_worker()];
+      if(buffer.stamps.empty())
+        buffer.stamps.assign(m_entities_offsets.back(), 0);
+      std::vector<Uint>& stamps = buffer.stamps;
+
+      std::vector<Uint> found;
+      for(Uint elem = range_begin; elem != range_end; ++elem)
+      {
+        const Uint stamp = buffer.next_stamp();
+        stamps[elem] = stamp;
+        found.clear();
+
+        const Uint entities_idx = entities_of(elem);
+        const Connectivity::ConstRow nodes = nodes_of(elem, entities_idx);
+        if(m_adjacency == DualGraph::NODE_NEIGHBORS)
+        {
+          boost_foreach(const Uint node, nodes)
+          {
+            for(Uint k = m_node_offsets[node]; k != m_node_offsets[node+1]; ++k)
+            {
+              const Uint neighbor = m_node_elements[k];
+              if(stamps[neighbor] != stamp)
+              {
+                stamps[neighbor] = stamp;
+                found.push_back(neighbor);
+              }
+            }
+          }
+        }
+        else
+        {
+          // Candidates are the elements of the same dimensionality around the first node of each face
+          const ElementType& etype = *m_element_types[entities_idx];
+          const ElementType::FaceConnectivity& faces = etype.faces();
+          for(Uint face = 0; face != faces.displs.size(); ++face)
+          {
+            const ElementType::FaceConnectivity::RangeT face_nodes = faces.nodes_range(face);
+            const Uint first_node = nodes[face_nodes.front()];
+            for(Uint k = m_node_offsets[first_node]; k != m_node_offsets[first_node+1]; ++k)
+            {
+              const Uint candidate = m_node_elements[k];
+              if(stamps[candidate] == stamp)
+                continue;
+              const Uint candidate_entities_idx = entities_of(candidate);
+              if(m_element_types[candidate_entities_idx]->dimensionality() != etype.dimensionality())
+                continue;
+              const Connectivity::ConstRow candidate_nodes = nodes_of(candidate, candidate_entities_idx);
+              bool shares_face = true;
+              boost_foreach(const Uint face_node, face_nodes)
+              {
+                if(std::find(candidate_nodes.begin(), candidate_nodes.end(), nodes[face_node]) == candidate_nodes.end())
+                {
+                  shares_face = false;
+                  break;
+                }
+              }
+              if(shares_face)
+              {
+                stamps[candidate] = stamp;
+                found.push_back(candidate);
+              }
+            }
+          }
+        }
+
+        if(is_null(m_neighbors))
+        {
+          m_offsets[elem+1] = found.size();
+        }
+        else
+        {
+          std::sort(found.begin(), found.end());
+          std::copy(found.begin(), found.end(), m_neighbors->begin() + m_offsets[elem]);
+        }
+      }
+    }
+
+    const DualGraph::AdjacencyType m_adjacency;
+    const std::vector<Uint>& m_entities_offsets;
+    const std::vector<const Connectivity*>& m_connectivities;
+    const std::vector<const ElementType*>& m_element_types;
+    const std::vector<Uint>& m_node_offsets;
+    const std::vector<Uint>& m_node_elements;
+    std::vector<StampBuffer>& m_buffers;
+    std::vector<Uint>& m_offsets;
+    std::vector<Uint>* m_neighbors;
+  };
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+DualGraph::DualGraph( const std::string& name ) :
+  Component(name),
+  m_adjacency(NODE_NEIGHBORS),
+  m_nb_owned(0)
+{
+  properties()["brief"] = std::string("Element-to-element adjacency of a mesh");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DualGraph::build(const Mesh& mesh, const AdjacencyType adjacency, const bool threaded)
+{
+  clear();
+  m_adjacency = adjacency;
+  m_entities = mesh.elements();
+
+  // Number the elements consecutively
+  std::vector<const Connectivity*> connectivities;
+  std::vector<const ElementType*> element_types;
+  m_entities_offsets.push_back(0);
+  boost_foreach(const Handle<Entities>& entities, m_entities)
+  {
+    connectivities.push_back(&entities->geometry_space().connectivity());
+    element_types.push_back(&entities->element_type());
+    m_entities_offsets.push_back(m_entities_offsets.back() + entities->size());
+
+    // Elements without global index or rank yet are numbered consecutively and owned
+    const common::List<Uint>& glb_idx = entities->glb_idx();
+    const bool has_ranks = entities->rank().size() == entities->size();
+    for(Uint e = 0; e != entities->size(); ++e)
+    {
+      m_glb_idx.push_back(e < glb_idx.size() ? glb_idx[e] : m_glb_idx.size());
+      m_is_ghost.push_back(has_ranks && entities->is_ghost(e));
+      if(!m_is_ghost.back())
+        ++m_nb_owned;
+    }
+  }
+  const Uint nb_elems = m_entities_offsets.back();
+
+  // Node-to-element connectivity, by counting the elements of each node first
+  const Uint nb_nodes = mesh.geometry_fields().size();
+  std::vector<Uint> node_offsets(nb_nodes+1, 0);
+  boost_foreach(const Connectivity* connectivity, connectivities)
+  {
+    for(Uint e = 0; e != connectivity->size(); ++e)
+    {
+      boost_foreach(const Uint node, (*connectivity)[e])
+        ++node_offsets[node+1];
+    }
+  }
+  for(Uint node = 0; node != nb_nodes; ++node)
+    node_offsets[node+1] += node_offsets[node];
+
+  std::vector<Uint> node_elements(node_offsets.back());
+  std::vector<Uint> node_fill(node_offsets.begin(), node_offsets.end()-1);
+  for(Uint entities_idx = 0; entities_idx != connectivities.size(); ++entities_idx)
+  {
+    const Connectivity& connectivity = *connectivities[entities_idx];
+    for(Uint e = 0; e != connectivity.size(); ++e)
+    {
+      boost_foreach(const Uint node, connectivity[e])
+        node_elements[node_fill[node]++] = m_entities_offsets[entities_idx] + e;
+    }
+  }
+
+  // First count, then fill the neighbours, so they can be written in place
+  m_offsets.assign(nb_elems+1, 0);
+  ThreadPool& pool = Core::instance().thread_pool();
+  std::vector<detail::StampBuffer> buffers(pool.nb_threads()+1);
+  const detail::NeighborSearch count(adjacency, m_entities_offsets, connectivities, element_types, node_offsets, node_elements, buffers, m_offsets, 0);
+  if(threaded)
+    pool.parallel_for(0, nb_elems, count);
+  else
+    count(0, nb_elems);
+
+  for(Uint elem = 0; elem != nb_elems; ++elem)
+    m_offsets[elem+1] += m_offsets[elem];
+  m_neighbors.resize(m_offsets.back());
+
+  const detail::NeighborSearch fill(adjacency, m_entities_offsets, connectivities, element_types, node_offsets, node_elements, buffers, m_offsets, &m_neighbors);
+  if(threaded)
+    pool.parallel_for(0, nb_elems, fill);
+  else
+    fill(0, nb_elems);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DualGraph::clear()
+{
+  m_entities.clear();
+  m_entities_offsets.clear();
+  m_offsets.clear();
+  m_neighbors.clear();
+  m_glb_idx.clear();
+  m_is_ghost.clear();
+  m_nb_owned = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DualGraph::is_up_to_date(const Mesh& mesh) const
+{
+  if(m_offsets.empty() || m_entities != mesh.elements())
+    return false;
+  for(Uint entities_idx = 0; entities_idx != m_entities.size(); ++entities_idx)
+  {
+    if(m_entities_offsets[entities_idx+1] - m_entities_offsets[entities_idx] != m_entities[entities_idx]->size())
+      return false;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint DualGraph::element_index(const Entities& entities, const Uint elem) const
+{
+  cf3_assert(entities.entities_idx() < m_entities.size());
+  cf3_assert(m_entities[entities.entities_idx()].get() == &entities);
+  return element_index(entities.entities_idx(), elem);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::pair<Uint,Uint> DualGraph::location(const Uint element_index) const
+{
+  const Uint entities_idx = std::upper_bound(m_entities_offsets.begin(), m_entities_offsets.end(), element_index) - m_entities_offsets.begin() - 1;
+  return std::make_pair(entities_idx, element_index - m_entities_offsets[entities_idx]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t DualGraph::memory_footprint() const
+{
+  return (m_entities_offsets.capacity() + m_offsets.capacity() + m_neighbors.capacity() + m_glb_idx.capacity())*sizeof(Uint)
+       + m_is_ghost.capacity()/8;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
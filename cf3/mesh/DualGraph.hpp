@@ -0,0 +1,156 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_DualGraph_hpp
+#define cf3_mesh_DualGraph_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <vector>
+
+#include "common/Component.hpp"
+
+#include "mesh/LibMesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+  class Mesh;
+  class Entities;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Element-to-element adjacency (dual graph) of a mesh, stored in CSR format
+///
+/// The elements of all entities in Mesh::elements() are numbered consecutively, in that order.
+/// Two elements are node neighbours if they share a node, and face neighbours if they have the
+/// same dimensionality and share all nodes of a face, as defined by ElementType::faces().
+/// Boundary elements, whose only face is the element itself, have no face neighbours.
+/// An element is never its own neighbour, and neighbours are sorted by index.
+///
+/// The graph only knows the elements present on this rank. Owned elements next to a partition
+/// boundary therefore only see their off-rank neighbours when these are in the overlap, and
+/// the neighbours of ghost elements at the edge of the overlap are incomplete.
+/// Use is_ghost() to tell them apart.
+///
+/// Mesh::dual_graph() gives access to a graph built on first use, and cached until the mesh changes.
+class Mesh_API DualGraph : public common::Component {
+
+public: // types
+
+  /// Criterion for two elements to be adjacent
+  enum AdjacencyType { NODE_NEIGHBORS = 0, FACE_NEIGHBORS = 1 };
+
+public: // functions
+
+  /// constructor
+  DualGraph( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "DualGraph"; }
+
+  /// Build the graph of all elements of a mesh. The neighbour searches run on the thread pool if threaded is true.
+  void build(const Mesh& mesh, const AdjacencyType adjacency, const bool threaded = true);
+
+  /// Discard the graph
+  void clear();
+
+  /// True if the graph was built for the current elements of the mesh
+  bool is_up_to_date(const Mesh& mesh) const;
+
+  /// Adjacency criterion the graph was built with
+  AdjacencyType adjacency() const { return m_adjacency; }
+
+  /// Number of elements in the graph
+  Uint size() const { return m_is_ghost.size(); }
+
+  /// Index of an element of the mesh in the consecutive numbering
+  Uint element_index(const Uint entities_idx, const Uint elem) const { return m_entities_offsets[entities_idx] + elem; }
+
+  /// Index of an element of the mesh in the consecutive numbering
+  Uint element_index(const Entities& entities, const Uint elem) const;
+
+  /// Index of the entities in Mesh::elements(), and the element index within them, of an element in the consecutive numbering
+  std::pair<Uint,Uint> location(const Uint element_index) const;
+
+  /// Neighbours of element i are neighbors()[offsets()[i]] up to neighbors()[offsets()[i+1]]
+  const std::vector<Uint>& offsets() const { return m_offsets; }
+
+  /// Concatenated neighbour lists, in the consecutive element numbering
+  const std::vector<Uint>& neighbors() const { return m_neighbors; }
+
+  /// Number of neighbours of an element
+  Uint nb_neighbors(const Uint element_index) const { return m_offsets[element_index+1] - m_offsets[element_index]; }
+
+  /// Global index of an element
+  Uint glb_idx(const Uint element_index) const { return m_glb_idx[element_index]; }
+
+  /// True if an element is owned by another rank
+  bool is_ghost(const Uint element_index) const { return m_is_ghost[element_index]; }
+
+  /// Number of elements owned by this rank
+  Uint nb_owned() const { return m_nb_owned; }
+
+  virtual size_t memory_footprint() const;
+
+private: // data
+
+  AdjacencyType m_adjacency;
+
+  /// Entities the graph was built for
+  std::vector< Handle<Entities> > m_entities;
+
+  /// Index of the first element of each entities in the consecutive numbering, with the total as last entry
+  std::vector<Uint> m_entities_offsets;
+
+  /// CSR adjacency
+  std::vector<Uint> m_offsets;
+  std::vector<Uint> m_neighbors;
+
+  /// Global index and ghost status of each element
+  std::vector<Uint> m_glb_idx;
+  std::vector<bool> m_is_ghost;
+  Uint m_nb_owned;
+
+}; // end DualGraph
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  /// Marks of the elements visited by one thread of a graph search. The stamp changes
+  /// for every searched element, so the marks are allocated once per thread and never need clearing.
+  struct StampBuffer
+  {
+    StampBuffer() : stamp(0) {}
+
+    /// Next stamp, clearing the marks only when the stamps wrap around
+    Uint next_stamp()
+    {
+      if(++stamp == 0)
+      {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+      }
+      return stamp;
+    }
+
+    std::vector<Uint> stamps;
+    Uint stamp;
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_DualGraph_hpp
@@ -88,40 +88,22 @@ bool ElementFinderOcttree::find_element(const RealVector& target_coord, SpaceEle
   for (Uint d=0; d<target_coord.size(); ++d)
     t_coord[d] = target_coord[d];
 
-  m_elements_pool.clear();
+  // exact match, testing only the elements whose bounding box contains the coordinate
+  if (m_octtree->find_element(t_coord,m_tmp))
+  {
+    element = SpaceElem(*const_cast<Space*>(&m_dict->space(*m_tmp.comp)),m_tmp.idx);
+    return true;
+  }
 
-  if (m_octtree->find_octtree_cell(t_coord,m_octtree_idx))
+  // gather the elements in the rings of octtree cells around the coordinate, for the closest match
+  m_elements_pool.clear();
+  if (m_closest && m_octtree->find_octtree_cell(t_coord,m_octtree_idx))
   {
-    Uint pool_size = 0;
     Uint rings=0;
-    for ( ; pool_size==0 ; ++rings)
-    {
-      pool_size=m_elements_pool.size();
+    for ( ; m_elements_pool.empty() ; ++rings)
       m_octtree->gather_elements_around_idx(m_octtree_idx,rings,m_elements_pool);
-      boost_foreach(const Entity& pool_elem, boost::make_iterator_range(m_elements_pool.begin()+pool_size,m_elements_pool.end()))
-      {
-        cf3_assert(is_not_null(pool_elem.comp));
-        const RealMatrix elem_coordinates = pool_elem.get_coordinates();
-        if (pool_elem.element_type().is_coord_in_element(t_coord,elem_coordinates))
-        {
-          element = SpaceElem(*const_cast<Space*>(&m_dict->space(*pool_elem.comp)),pool_elem.idx);
-          return true;
-        }
-      }
-    }
-    // if arrived here, keep searching
-    // it means no element has been found. The search is enlarged with one more ring, for possible misses.
+    // The search is enlarged with one more ring, for possible misses.
     m_octtree->gather_elements_around_idx(m_octtree_idx,rings,m_elements_pool);
-    boost_foreach(const Entity& pool_elem, boost::make_iterator_range(m_elements_pool.begin()+pool_size,m_elements_pool.end()))
-    {
-      cf3_assert(is_not_null(pool_elem.comp));
-      const RealMatrix elem_coordinates = pool_elem.get_coordinates();
-      if (pool_elem.element_type().is_coord_in_element(t_coord,elem_coordinates))
-      {
-        element = SpaceElem(*const_cast<Space*>(&m_dict->space(*pool_elem.comp)),pool_elem.idx);
-        return true;
-      }
-    }
   }
   if (m_closest)
   {
@@ -134,7 +116,7 @@ bool ElementFinderOcttree::find_element(const RealVector& target_coord, SpaceEle
       int elem_dim=m_elements_pool[i].element_type().dimension();
       m_elements_pool[i].allocate_coordinates(m_coordinates);
       m_elements_pool[i].put_coordinates(m_coordinates);
-      m_elements_pool[i].element_type().compute_centroid( m_elements_pool[i].get_coordinates() , s_elem_centroid);
+      m_elements_pool[i].element_type().compute_centroid( m_coordinates , s_elem_centroid);
 
       Real newdistance = math::Functions::get_distance(s_elem_centroid,t_coord);
       if (newdistance < distance)
@@ -165,16 +147,9 @@ bool ElementFinderOcttree::find_element(const RealVector& target_coord, SpaceEle
     }
   }
 //  std::cout << "---> not found" << std::endl;
-  // if arrived here, it means no element has been found in the octtree cell. Give up.
-  CFdebug << "coord " << t_coord.transpose() << " has not been found in the octtree cell" << CFendl;
+  // if arrived here, it means no element has been found in the octtree. Give up.
+  CFdebug << "coord " << t_coord.transpose() << " has not been found in the octtree" << CFendl;
   return false;
-
-//  bool found = m_octtree->find_element(target_coord,m_tmp);
-//  if (!found)
-//    return false;
-
-//  element = SpaceElem(*const_cast<Space*>(&m_dict->space(*m_tmp.comp)),m_tmp.idx);
-//  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4,6 +4,9 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+#include <map>
+
 #include "common/Log.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
@@ -20,6 +23,7 @@
 #include "mesh/NodeElementConnectivity.hpp"
 #include "mesh/Dictionary.hpp"
 #include "mesh/Mesh.hpp"
+#include "mesh/MeshChangeLog.hpp"
 #include "mesh/MeshElements.hpp"
 #include "mesh/Region.hpp"
 #include "mesh/Space.hpp"
@@ -358,6 +362,205 @@ void FaceCellConnectivity::build_connectivity()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void FaceCellConnectivity::update_connectivity(const MeshChangeLog& changes)
+{
+  if (used().size() == 0 )
+  {
+    CFwarn << "No elements are given to build faces of" << CFendl;
+    return;
+  }
+
+  Mesh& mesh = find_parent_component<Mesh>(*used()[0]);
+  if (m_face_building_algorithm || !changes.applies_to(mesh))
+  {
+    build_connectivity();
+    return;
+  }
+
+  // 1) Renumber the cells of the existing faces, dropping the removed ones
+
+  Uint nb_kept_faces = 0;
+  for (Uint face=0; face<m_connectivity->size(); ++face)
+  {
+    ElementConnectivity::Row cells = (*m_connectivity)[face];
+    common::Table<Uint>::Row face_number = (*m_face_nb_in_elem)[face];
+    for (Uint c=0; c<2; ++c)
+    {
+      if ( is_null(cells[c].comp) )
+        continue;
+      Uint current_idx;
+      if ( changes.elements(cells[c].comp->entities_idx()).current_index(cells[c].idx,current_idx) )
+        cells[c].idx = current_idx;
+      else
+        cells[c] = Entity();
+    }
+
+    if ( is_null(cells[0].comp) )
+    {
+      // The remaining cell, if any, becomes the first one
+      cells[0] = cells[1];
+      face_number[0] = face_number[1];
+      cells[1] = Entity();
+      if ( is_null(cells[0].comp) )
+        continue;
+    }
+
+    if ( is_null(cells[1].comp) )
+    {
+      face_number[1] = 0;
+      (*m_cell_rotation)[face][0] = 0;
+      (*m_cell_rotation)[face][1] = 0;
+      (*m_is_bdry_face)[face] = true;
+    }
+
+    if (nb_kept_faces != face)
+    {
+      (*m_connectivity)[nb_kept_faces] = (*m_connectivity)[face];
+      (*m_face_nb_in_elem)[nb_kept_faces] = (*m_face_nb_in_elem)[face];
+      (*m_is_bdry_face)[nb_kept_faces] = (*m_is_bdry_face)[face];
+      (*m_cell_rotation)[nb_kept_faces] = (*m_cell_rotation)[face];
+      (*m_cell_orientation)[nb_kept_faces] = (*m_cell_orientation)[face];
+    }
+    ++nb_kept_faces;
+  }
+  m_connectivity->resize(nb_kept_faces);
+  m_face_nb_in_elem->resize(nb_kept_faces);
+  m_is_bdry_face->resize(nb_kept_faces);
+  m_cell_rotation->resize(nb_kept_faces);
+  m_cell_orientation->resize(nb_kept_faces);
+  m_nb_faces = nb_kept_faces;
+
+  // 2) Match the faces of the added cells, which can only share boundary faces
+  //    at the nodes of the added cells
+
+  std::map< Uint, std::vector<Uint> > mapNodeFace;
+  boost_foreach ( Handle< Component > elements_comp, used() )
+  {
+    const Elements& elements = dynamic_cast<const Elements&>(*elements_comp);
+    const Connectivity& connectivity = elements.geometry_space().connectivity();
+    boost_foreach( const Uint elem, changes.elements(elements.entities_idx()).added() )
+    {
+      boost_foreach( const Uint node, connectivity[elem] )
+        mapNodeFace[node];
+    }
+  }
+  if (mapNodeFace.empty())
+    return;
+
+  for (Uint face=0; face<m_nb_faces; ++face)
+  {
+    if ( (*m_is_bdry_face)[face] == false )
+      continue;
+    boost_foreach( const Uint node, face_nodes(face) )
+    {
+      std::map< Uint, std::vector<Uint> >::iterator node_faces = mapNodeFace.find(node);
+      if (node_faces != mapNodeFace.end())
+        node_faces->second.push_back(face);
+    }
+  }
+
+  common::Table<Entity>::Buffer f2c = m_connectivity->create_buffer();
+  common::Table<Uint>::Buffer face_number = m_face_nb_in_elem->create_buffer();
+  common::List<bool>::Buffer is_bdry_face = m_is_bdry_face->create_buffer();
+  common::Table<Uint>::Buffer cell_rotation = m_cell_rotation->create_buffer();
+  common::Table<bool>::Buffer cell_orientation = m_cell_orientation->create_buffer();
+
+  std::vector<Uint> face_nodes;  face_nodes.reserve(100);
+  std::vector<Entity> dummy_element_row(2);
+  std::vector<Uint> tmp_row(2);
+
+  boost_foreach ( Handle< Component > elements_comp, used() )
+  {
+    Elements& elements = dynamic_cast<Elements&>(*elements_comp);
+    const Connectivity& connectivity = elements.geometry_space().connectivity();
+    const Uint nb_faces_in_elem = elements.element_type().nb_faces();
+
+    boost_foreach( const Uint elem, changes.elements(elements.entities_idx()).added() )
+    {
+      Entity element(elements,elem);
+      for (Uint face_idx = 0; face_idx != nb_faces_in_elem; ++face_idx)
+      {
+        const Uint nb_nodes = elements.element_type().face_type(face_idx).nb_nodes();
+        face_nodes.resize(nb_nodes);
+        Uint i(0);
+        boost_foreach(const Uint face_node_idx, elements.element_type().faces().nodes_range(face_idx))
+          face_nodes[i++] = connectivity[elem][face_node_idx];
+
+        // A face matches if it is registered at all its nodes
+        std::vector<Uint>& first_node_faces = mapNodeFace[face_nodes[0]];
+        bool found_face = false;
+        boost_foreach( const Uint face, first_node_faces )
+        {
+          Uint nb_matched_nodes = 1;
+          for (Uint face_node_idx=1; face_node_idx!=nb_nodes; ++face_node_idx)
+          {
+            const std::vector<Uint>& node_faces = mapNodeFace[face_nodes[face_node_idx]];
+            if ( std::find(node_faces.begin(),node_faces.end(),face) != node_faces.end() )
+              ++nb_matched_nodes;
+          }
+          if (nb_matched_nodes != nb_nodes)
+            continue;
+
+          found_face = true;
+          f2c.get_row(face)[1]=element;
+          face_number.get_row(face)[1]=face_idx;
+          is_bdry_face.get_row(face)=false;
+
+          if (nb_nodes > 1)
+          {
+            // Find the rotation of the face with respect to the first cell
+            const Uint first_node_loc_idx = f2c.get_row(face)[0].get_nodes()[
+                                              f2c.get_row(face)[0].element_type().faces().nodes_range(
+                                                face_number.get_row(face)[0])[0]
+                                            ];
+            Uint rotation;
+            for (rotation=0; rotation!=nb_nodes; ++rotation)
+            {
+              if (face_nodes[rotation] == first_node_loc_idx)
+              {
+                cell_rotation.get_row(face)[1]=rotation;
+                break;
+              }
+            }
+            cf3_always_assert(rotation != nb_nodes);
+          }
+          break;
+        }
+
+        if (found_face == false)
+        {
+          boost_foreach (const Uint face_node, face_nodes)
+            mapNodeFace[face_node].push_back(m_nb_faces);
+
+          dummy_element_row[0]=element;
+          f2c.add_row(dummy_element_row);
+          tmp_row[0]=face_idx;
+          tmp_row[1]=0;
+          face_number.add_row(tmp_row);
+          tmp_row[0] = MATCHED;
+          tmp_row[1] = INVERTED;
+          cell_orientation.add_row(tmp_row);
+          tmp_row[0] = 0;
+          tmp_row[1] = 0;
+          cell_rotation.add_row(tmp_row);
+          is_bdry_face.add_row(true);
+          ++m_nb_faces;
+        }
+      }
+    }
+  }
+
+  f2c.flush();
+  face_number.flush();
+  is_bdry_face.flush();
+  cell_rotation.flush();
+  cell_orientation.flush();
+
+  cf3_assert(m_nb_faces == m_connectivity->size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 std::vector<Uint> FaceCellConnectivity::face_nodes(const Uint face) const
 {
   cf3_assert(face < m_connectivity->size());
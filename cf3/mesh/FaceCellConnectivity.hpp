@@ -23,6 +23,7 @@ namespace mesh {
   class Dictionary;
   class Region;
   class Cells;
+  class MeshChangeLog;
   typedef common::Table<Entity> ElementConnectivity;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -65,6 +66,17 @@ public:
 
   void build_connectivity();
 
+  /// @brief Update the connectivity table after the mesh changed
+  ///
+  /// Faces of removed cells are dropped, or become boundary faces, and the faces of
+  /// added cells are matched with the boundary faces around them. The faces are thus
+  /// not numbered as by build_connectivity().
+  /// The connectivity is rebuilt if the log does not apply to the mesh, or
+  /// with the face building algorithm, whose element lists are not tracked.
+  /// @pre The connectivity was built for the baseline mesh of the log
+  /// @param [in] changes   Changes of the mesh since the connectivity was built
+  void update_connectivity(const MeshChangeLog& changes);
+
   /// const access to the node to element connectivity table in unified indices
   ElementConnectivity& connectivity() { return *m_connectivity; }
 
@@ -44,6 +44,7 @@ Field::Field ( const std::string& name  ) :
   properties()["date"] = boost::gregorian::to_iso_extended_string(boost::gregorian::day_clock::local_day());
   properties()["time"] = 0.;
   properties()["step"] = 0u;
+  properties()["single_precision"] = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -318,5 +319,19 @@ VarType Field::var_type() const
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Field::set_single_precision(const bool single_precision)
+{
+  properties()["single_precision"] = single_precision;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool Field::single_precision() const
+{
+  return properties().value<bool>("single_precision");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
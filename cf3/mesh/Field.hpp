@@ -146,6 +146,13 @@ public: // functions
 
   VarType var_type() const ;
 
+  /// Request this field to be written in single precision by the mesh writers,
+  /// halving the size of output and checkpoint files. The values in memory are not affected.
+  void set_single_precision(const bool single_precision);
+
+  /// @return true if this field is written in single precision
+  bool single_precision() const;
+
   ////////////////////////////////////////////////////////////////////////////////
 
     // Index operator.
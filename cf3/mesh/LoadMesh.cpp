@@ -13,6 +13,7 @@
 #include "common/Builder.hpp"
 #include "common/Core.hpp"
 #include "common/Foreach.hpp"
+#include "common/Log.hpp"
 #include "common/OptionArray.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
@@ -22,6 +23,7 @@
 #include "common/XML/SignalOptions.hpp"
 
 #include "mesh/MeshAdaptor.hpp"
+#include "mesh/MeshCache.hpp"
 #include "mesh/MeshReader.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Domain.hpp"
@@ -54,6 +56,11 @@ LoadMesh::LoadMesh ( const std::string& name  ) :
       .description("The coordinate dimension (0 --> maximum dimensionality)")
       .pretty_name("Dimension");
 
+  options().add("use_cache", false)
+      .description("Keep a native binary copy of every mesh read from another format next to its file, "
+                   "and load that copy instead as long as the file is unchanged")
+      .pretty_name("Use Cache");
+
   // signals
 
   regist_signal ( "load_mesh" )
@@ -82,7 +89,8 @@ void LoadMesh::update_list_of_available_readers()
     ("cf3.mesh.CGNS.Reader")
   #endif
     ("cf3.mesh.gmsh.Reader")
-    ("cf3.mesh.neu.Reader");
+    ("cf3.mesh.neu.Reader")
+    ("cf3.mesh.native.Reader");
 
   boost_foreach(const std::string& reader_name, known_readers)
   {
@@ -103,6 +111,24 @@ void LoadMesh::update_list_of_available_readers()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+Handle< MeshCache > LoadMesh::mesh_cache()
+{
+  if (is_null(m_mesh_cache))
+  {
+    boost::shared_ptr<MeshCache> cache = boost::dynamic_pointer_cast<MeshCache>(build_component_nothrow("cf3.mesh.native.MeshCache", "mesh_cache"));
+    if(is_null(cache))
+    {
+      CFwarn << "No mesh cache available, reading meshes without cache" << CFendl;
+      return m_mesh_cache;
+    }
+    add_component(cache);
+    m_mesh_cache = cache->handle<MeshCache>();
+  }
+  return m_mesh_cache;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 
 void LoadMesh::load_multiple_files(const std::vector<URI>& files, Mesh& mesh)
 {
@@ -157,10 +183,22 @@ void LoadMesh::load_mesh_into(const URI& file, Mesh& mesh)
     else
     {
       Handle< MeshReader > meshreader = m_extensions_to_readers[extension][0];
+      const Uint dimension = options().value<Uint>("dimension");
+
+      // Files in the format of the cache itself are read directly
+      Handle< MeshCache > cache;
+      if (options().value<bool>("use_cache") && meshreader->get_format() != "native")
+        cache = mesh_cache();
+      if (is_not_null(cache) && cache->read(file,dimension,mesh))
+        return;
+
       meshreader->options().set("mesh",mesh.handle<Mesh>());
       meshreader->options().set("file",file);
-      meshreader->options().set("dimension",options().value<Uint>("dimension"));
+      meshreader->options().set("dimension",dimension);
       meshreader->execute();
+
+      if (is_not_null(cache))
+        cache->write(file,dimension,mesh);
     }
   }
 }
@@ -18,6 +18,7 @@
 namespace cf3 {
 namespace mesh {
   class Mesh;
+  class MeshCache;
 ////////////////////////////////////////////////////////////////////////////////
 
 /// Helper class to load mesh based on a file extension
@@ -59,10 +60,16 @@ protected: // helper functions
   /// updates the list of avialable readers and regists each one to the extension it supports
   void update_list_of_available_readers();
 
+  /// @return the cache for meshes read from other formats, created on first use,
+  ///         or a null handle if no cache implementation is available
+  Handle< MeshCache > mesh_cache();
+
 private: // data
 
   std::map<std::string,std::vector<Handle< mesh::MeshReader > > > m_extensions_to_readers;
 
+  Handle< MeshCache > m_mesh_cache;
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
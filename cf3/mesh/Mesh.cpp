@@ -43,6 +43,7 @@
 #include "mesh/DiscontinuousDictionary.hpp"
 #include "mesh/Field.hpp"
 #include "mesh/MeshElements.hpp"
+#include "mesh/MeshChangeLog.hpp"
 #include "mesh/ElementType.hpp"
 #include "mesh/WriteMesh.hpp"
 #include "mesh/MeshMetadata.hpp"
@@ -66,7 +67,9 @@ Mesh::Mesh ( const std::string& name  ) :
   Component ( name ),
   m_dimension(0u),
   m_dimensionality(0u),
-  m_block_mesh_changed(false)
+  m_block_mesh_changed(false),
+  m_revision(0u),
+  m_changes(new MeshChangeLog())
 {
   mark_basic(); // by default meshes are visible
 
@@ -85,6 +88,9 @@ Mesh::Mesh ( const std::string& name  ) :
   m_local_bounding_box  = create_static_component<BoundingBox>("bounding_box_local");
   m_global_bounding_box = create_static_component<BoundingBox>("bounding_box_global");
 
+  m_dual_graphs[DualGraph::NODE_NEIGHBORS] = create_static_component<DualGraph>("node_dual_graph");
+  m_dual_graphs[DualGraph::FACE_NEIGHBORS] = create_static_component<DualGraph>("face_dual_graph");
+
   regist_signal ( "write_mesh" )
       .description( "Write mesh, guessing automatically the format" )
       .pretty_name("Write Mesh" )
@@ -146,6 +152,13 @@ void Mesh::initialize_nodes(const Uint nb_nodes, const Uint dimension)
 
 void Mesh::update_structures()
 {
+  // Elements may have changed, so the dual graphs are rebuilt on their next use
+  m_dual_graphs[DualGraph::NODE_NEIGHBORS]->clear();
+  m_dual_graphs[DualGraph::FACE_NEIGHBORS]->clear();
+
+  ++m_revision;
+  m_changes->invalidate();
+
   Uint entities_idx=0;
   Uint dict_idx=0;
   m_elements.clear();
@@ -332,6 +345,16 @@ Dictionary& Mesh::create_discontinuous_space( const std::string& space_name, con
 
 ////////////////////////////////////////////////////////////////////////////////
 
+const DualGraph& Mesh::dual_graph(const DualGraph::AdjacencyType adjacency)
+{
+  DualGraph& graph = *m_dual_graphs[adjacency];
+  if (!graph.is_up_to_date(*this))
+    graph.build(*this,adjacency);
+  return graph;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 Dictionary& Mesh::geometry_fields() const
 {
   return *m_geometry_fields;
@@ -501,16 +524,33 @@ void Mesh::raise_mesh_loaded()
 ////////////////////////////////////////////////////////////////////////////////
 
 void Mesh::raise_mesh_changed()
+{
+  raise_mesh_changed(MeshChangeLog());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Mesh::raise_mesh_changed(const MeshChangeLog& changes)
 {
   update_structures();
   update_statistics();
 
+  const bool incremental = changes.applies_to(*this);
   for (Uint dict_idx=0; dict_idx<m_dictionaries.size(); ++dict_idx)
   {
-    m_dictionaries[dict_idx]->rebuild_map_glb_to_loc();
-    m_dictionaries[dict_idx]->rebuild_node_to_element_connectivity();
+    // The glb_to_loc maps are kept up to date by whoever logged the changes
+    if (!incremental || m_dictionaries[dict_idx]->glb_to_loc().size() != m_dictionaries[dict_idx]->size())
+      m_dictionaries[dict_idx]->rebuild_map_glb_to_loc();
+    if (incremental)
+      m_dictionaries[dict_idx]->update_node_to_element_connectivity(changes,dict_idx);
+    else
+      m_dictionaries[dict_idx]->rebuild_node_to_element_connectivity();
   }
 
+  // Keep the log for the structures that are updated on the event
+  if (incremental)
+    *m_changes = changes;
+
   check_sanity();
 
   // Raise an event to indicate that this mesh was changed
@@ -529,6 +569,15 @@ void Mesh::raise_mesh_changed()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+const MeshChangeLog* Mesh::changes_since(const Uint revision) const
+{
+  if (m_changes->applies_to(*this) && m_changes->baseline_revision() == revision)
+    return m_changes.get();
+  return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void Mesh::block_mesh_changed ( const bool block )
 {
   m_block_mesh_changed = block;
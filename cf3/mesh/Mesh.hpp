@@ -12,6 +12,7 @@
 #include "common/Component.hpp"
 #include "mesh/LibMesh.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/DualGraph.hpp"
 
 namespace cf3 {
   namespace common {
@@ -25,6 +26,7 @@ namespace mesh {
   class MeshElements;
   class MeshMetadata;
   class BoundingBox;
+  class MeshChangeLog;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -96,10 +98,36 @@ public: // functions
   void raise_mesh_loaded();
 
   void raise_mesh_changed();
+
+  /// @brief Notify that the mesh changed, as described by a change log
+  ///
+  /// Same as raise_mesh_changed(), but the node to element connectivity of the dictionaries
+  /// is only updated for the changed nodes and elements, if the log applies to this mesh.
+  /// The glb_to_loc maps of the dictionaries are then not rebuilt, as the producer of the log
+  /// keeps them up to date (see Dictionary::update_map_glb_to_loc()).
+  void raise_mesh_changed(const MeshChangeLog& changes);
+
+  /// @brief Number of times the structures of the mesh were updated
+  ///
+  /// Incremented by update_structures(), and thus by raise_mesh_loaded() and raise_mesh_changed().
+  /// Structures derived from the mesh can keep the revision they were built for.
+  Uint revision() const { return m_revision; }
+
+  /// @brief Changes of the mesh since a revision
+  /// @return The log given to the last raise_mesh_changed(), if it started at the given revision
+  ///         and the structures were not updated since. NULL otherwise, in which case
+  ///         structures derived from the mesh at that revision must be rebuilt.
+  const MeshChangeLog* changes_since(const Uint revision) const;
   
   /// If true, block subsequent raise_mesh_changed event.
   void block_mesh_changed(const bool block);
 
+  /// @brief Element adjacency of the mesh
+  ///
+  /// The graph is built on first use, and cached until the structures of the mesh are updated
+  /// (see update_structures(), raise_mesh_loaded() and raise_mesh_changed()), or the elements change size.
+  const DualGraph& dual_graph(const DualGraph::AdjacencyType adjacency = DualGraph::NODE_NEIGHBORS);
+
   const Handle<BoundingBox>& local_bounding_box()  const { return m_local_bounding_box; }
   const Handle<BoundingBox>& global_bounding_box() const { return m_global_bounding_box; }
 
@@ -121,9 +149,17 @@ private: // data
 
   Handle<BoundingBox> m_local_bounding_box;
   Handle<BoundingBox> m_global_bounding_box;
+
+  /// Cached dual graphs, indexed by DualGraph::AdjacencyType
+  Handle<DualGraph> m_dual_graphs[2];
   
   bool m_block_mesh_changed;
 
+  Uint m_revision;
+
+  /// Log of the last raise_mesh_changed(), invalidated by update_structures()
+  boost::shared_ptr<MeshChangeLog> m_changes;
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
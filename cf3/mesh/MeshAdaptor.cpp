@@ -15,6 +15,7 @@
 #include "common/PropertyList.hpp"
 
 #include "common/PE/debug.hpp"
+#include "common/PE/DistributedDirectory.hpp"
 
 #include "math/Consts.hpp"
 #include "math/VariablesDescriptor.hpp"
@@ -168,6 +169,65 @@ void PackedNode::pack(PE::Buffer& buf)
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+  /// @brief Find the rows that a flush may move into removed rows, by global index
+  ///
+  /// When a flush removes more rows than it adds, the table shrinks, and the rows beyond
+  /// the new size are moved into removed rows. Only the last rows, as many as are removed, can be moved.
+  void find_movable_rows(const List<Uint>& glb_idx, const std::set<Uint>& removed_rows, std::map<Uint,Uint>& movable_rows)
+  {
+    movable_rows.clear();
+    const Uint size = glb_idx.size();
+    const Uint nb_removed = std::min(size, static_cast<Uint>(removed_rows.size()));
+    for (Uint row=size-nb_removed; row<size; ++row)
+    {
+      if (removed_rows.count(row) == 0)
+        movable_rows[glb_idx[row]] = row;
+    }
+  }
+
+  /// @brief Record the changes of a flush in a change log
+  ///
+  /// Rows that are not removed keep their place, unless they are moved from beyond the new size.
+  /// The removed rows within the new size, and the rows beyond the old size, are therefore the
+  /// only ones that changed. Each of them is either a moved row, recognized by its global index, or a new row.
+  void record_flush(const List<Uint>& glb_idx, const Uint old_size, const std::set<Uint>& removed_rows,
+                    std::map<Uint,Uint>& movable_rows, RowChanges& changes)
+  {
+    const Uint new_size = glb_idx.size();
+    const std::vector<Uint> removed(removed_rows.begin(), removed_rows.end());
+    std::vector< std::pair<Uint,Uint> > moved;
+    std::vector<Uint> added;
+
+    std::vector<Uint> changed_rows;
+    boost_foreach (const Uint row, removed_rows)
+    {
+      if (row < new_size)
+        changed_rows.push_back(row);
+    }
+    for (Uint row=old_size; row<new_size; ++row)
+      changed_rows.push_back(row);
+
+    boost_foreach (const Uint row, changed_rows)
+    {
+      std::map<Uint,Uint>::iterator movable = (new_size < old_size ? movable_rows.find(glb_idx[row]) : movable_rows.end());
+      if (movable != movable_rows.end())
+      {
+        moved.push_back(std::make_pair(movable->second,row));
+        movable_rows.erase(movable);
+      }
+      else
+      {
+        added.push_back(row);
+      }
+    }
+    changes.record(removed,moved,added,new_size);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 MeshAdaptor::MeshAdaptor(mesh::Mesh &mesh)
 {
   has_node_buffers = false;
@@ -179,6 +239,7 @@ MeshAdaptor::MeshAdaptor(mesh::Mesh &mesh)
   node_flush_required = false;
 
   m_mesh = mesh.handle<Mesh>();
+  m_changes.reset(*m_mesh);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -210,11 +271,17 @@ void MeshAdaptor::finish()
   restore_element_node_connectivity();
   cf3_assert( ! is_node_connectivity_global );
 
-  m_mesh->raise_mesh_changed();
+  // Only rebuilds the glb_to_loc maps if they could not be updated at each flush
+  rebuild_node_glb_to_loc_map();
+
+  m_mesh->raise_mesh_changed(m_changes);
 
   // Change following flags as "raise_mesh_changed" took care of this
   node_glb_to_loc_needs_rebuild=false;
   node_elem_connectivity_needs_rebuild=false;
+
+  // Further changes are relative to the consistent mesh
+  m_changes.reset(*m_mesh);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -259,6 +326,8 @@ void MeshAdaptor::clear_element_buffers()
   added_elements.resize(m_mesh->elements().size());
   added_elements.clear();
 
+  removed_element_rows.assign(m_mesh->elements().size(),std::set<Uint>());
+
   has_element_buffers = false;
 }
 
@@ -304,6 +373,8 @@ void MeshAdaptor::clear_node_buffers()
   added_nodes.resize(m_mesh->dictionaries().size());
   added_nodes.clear();
 
+  removed_node_rows.assign(m_mesh->dictionaries().size(),std::set<Uint>());
+
   has_node_buffers = false;
 }
 
@@ -413,11 +484,55 @@ void MeshAdaptor::remove_element(const Uint entities_idx, const Uint elem_loc_id
   for (Uint space_idx=0; space_idx<element_connected_nodes[entities_idx].size(); ++space_idx)
     element_connected_nodes[entities_idx][space_idx]->rm_row(elem_loc_idx);
   added_elements[entities_idx].erase(m_mesh->elements()[entities_idx]->glb_idx()[elem_loc_idx]);
+  if (elem_loc_idx < m_mesh->elements()[entities_idx]->glb_idx().size())
+  {
+    removed_element_rows[entities_idx].insert(elem_loc_idx);
+    record_removed_element_nodes(entities_idx,elem_loc_idx);
+  }
   elem_flush_required = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void MeshAdaptor::record_removed_element_nodes(const Uint entities_idx, const Uint elem_loc_idx)
+{
+  if ( ! m_changes.applies_to(*m_mesh) )
+    return;
+
+  // Elements added since the baseline are not in the node to element connectivity
+  Uint baseline_elem_idx;
+  if ( ! m_changes.elements(entities_idx).baseline_index(elem_loc_idx,baseline_elem_idx) )
+    return;
+
+  if (is_node_connectivity_global)
+    rebuild_node_glb_to_loc_map();
+
+  std::vector<Uint> baseline_nodes;
+  boost_foreach(const Handle<Space>& space, m_mesh->elements()[entities_idx]->spaces())
+  {
+    const Uint dict_idx = space->dict_idx();
+    const common::Map<boost::uint64_t,Uint>& glb_to_loc = space->dict().glb_to_loc();
+    baseline_nodes.clear();
+    boost_foreach(const Uint node, space->connectivity()[elem_loc_idx])
+    {
+      Uint loc_node = node;
+      if (is_node_connectivity_global)
+      {
+        common::Map<boost::uint64_t,Uint>::const_iterator found = glb_to_loc.find(node);
+        if (found == glb_to_loc.end())
+          continue;
+        loc_node = found->second;
+      }
+      Uint baseline_node;
+      if (m_changes.nodes(dict_idx).baseline_index(loc_node,baseline_node))
+        baseline_nodes.push_back(baseline_node);
+    }
+    m_changes.add_removed_element_nodes(entities_idx,dict_idx,baseline_elem_idx,baseline_nodes);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void MeshAdaptor::add_node(const PackedNode& packed_node)
 {
   if (has_node_buffers == false)
@@ -459,6 +574,8 @@ void MeshAdaptor::remove_node(const Uint dict_idx, const Uint node_loc_idx)
   for (Uint fields_idx=0; fields_idx<node_field_values[dict_idx].size(); ++fields_idx)
     node_field_values[dict_idx][fields_idx]->rm_row(node_loc_idx);
   added_nodes[dict_idx].erase(m_mesh->dictionaries()[dict_idx]->glb_idx()[node_loc_idx]);
+  if (node_loc_idx < m_mesh->dictionaries()[dict_idx]->glb_idx().size())
+    removed_node_rows[dict_idx].insert(node_loc_idx);
   node_flush_required = true;
 }
 
@@ -469,8 +586,15 @@ void MeshAdaptor::flush_elements()
   if (elem_flush_required)
   {
     CFdebug << "MeshAdaptor: flushing elements" << CFendl;
+    const bool log_changes = m_changes.applies_to(*m_mesh);
     for (Uint c=0; c<m_mesh->elements().size(); ++c)
     {
+      const common::List<Uint>& glb_idx = m_mesh->elements()[c]->glb_idx();
+      const Uint old_size = glb_idx.size();
+      std::map<Uint,Uint> movable_rows;
+      if (log_changes)
+        detail::find_movable_rows(glb_idx,removed_element_rows[c],movable_rows);
+
       if (element_glb_idx[c])
         element_glb_idx[c]->flush();
       if (element_rank[c])
@@ -480,6 +604,10 @@ void MeshAdaptor::flush_elements()
         if (element_connected_nodes[c][s])
           element_connected_nodes[c][s]->flush();
       }
+
+      if (log_changes)
+        detail::record_flush(glb_idx,old_size,removed_element_rows[c],movable_rows,m_changes.elements(c));
+      removed_element_rows[c].clear();
     }
     added_elements.clear();
     elem_flush_required = false;
@@ -494,8 +622,18 @@ void MeshAdaptor::flush_nodes()
   if (node_flush_required)
   {
     CFdebug << "MeshAdaptor: flushing nodes" << CFendl;
+    const bool log_changes = m_changes.applies_to(*m_mesh);
+    // A glb_to_loc map that matches the nodes before this flush is updated with the changes of the flush
+    const bool update_glb_to_loc = !node_glb_to_loc_needs_rebuild;
     for (Uint c=0; c<m_mesh->dictionaries().size(); ++c)
     {
+      Dictionary& dict = *m_mesh->dictionaries()[c];
+      const common::List<Uint>& glb_idx = dict.glb_idx();
+      const Uint old_size = glb_idx.size();
+      std::map<Uint,Uint> movable_rows;
+      if (log_changes || update_glb_to_loc)
+        detail::find_movable_rows(glb_idx,removed_node_rows[c],movable_rows);
+
       if (node_glb_idx[c])
         node_glb_idx[c]->flush();
       if (node_rank[c])
@@ -506,10 +644,20 @@ void MeshAdaptor::flush_nodes()
           node_field_values[c][f]->flush();
       }
       added_nodes.clear();
+
+      if (log_changes || update_glb_to_loc)
+      {
+        RowChanges flush_changes(old_size);
+        detail::record_flush(glb_idx,old_size,removed_node_rows[c],movable_rows,flush_changes);
+        if (log_changes)
+          m_changes.nodes(c).record(flush_changes);
+        if (update_glb_to_loc)
+          dict.update_map_glb_to_loc(flush_changes);
+      }
+      removed_node_rows[c].clear();
     }
     node_flush_required = false;
     node_elem_connectivity_needs_rebuild = true;
-    node_glb_to_loc_needs_rebuild = true;
   }
 }
 
@@ -836,6 +984,12 @@ void MeshAdaptor::rebuild_node_to_element_connectivity()
       dict.rebuild_node_to_element_connectivity();
     }
     node_elem_connectivity_needs_rebuild = false;
+
+    // The connectivity is up to date with all flushed changes, which makes it the new baseline
+    if (elem_flush_required || node_flush_required)
+      m_changes.invalidate();
+    else
+      m_changes.reset(*m_mesh);
   }
 }
 
@@ -1051,47 +1205,21 @@ void MeshAdaptor::fix_node_ranks()
   rebuild_node_glb_to_loc_map();
   boost_foreach (const Handle<Dictionary>& dict, m_mesh->dictionaries())
   {
-    // nodes to send to other cpu's
     std::vector<boost::uint64_t> glb_nodes(dict->size());
     for (Uint n=0; n<glb_nodes.size(); ++n)
-    {
-      // fill the nodes to send to other cpu's
       glb_nodes[n] = dict->glb_idx()[n];
 
-      // assign the rank to be ourself to start with. The rank can only become lower.
-      cf3_assert(n<dict->rank().size());
-      dict->rank()[n] = PE::Comm::instance().rank();
-    }
+    // The rank of a node is the lowest rank that has the node
+    PE::DistributedDirectory directory;
+    directory.insert(glb_nodes);
+    std::vector<Uint> owners;
+    directory.find_owners(glb_nodes,owners);
 
-    // Every cpu broadcasts to cpu's with higher rank
-    for (Uint root=0; root<PE::Comm::instance().size(); ++root)
+    cf3_assert(dict->rank().size() == glb_nodes.size());
+    for (Uint n=0; n<glb_nodes.size(); ++n)
     {
-      //    CFinfo << "broadcasting from root " << root << CFendl;
-      PE::Comm::instance().barrier();
-
-      std::vector<boost::uint64_t> glb_nodes_from_root(0);
-      PE::Comm::instance().broadcast(glb_nodes,glb_nodes_from_root,root);
-
-      // cpu's with higher rank will adapt the ranks of the nodes
-      if (PE::Comm::instance().rank() > root)
-      {
-
-        boost_foreach(const boost::uint64_t& glb_node, glb_nodes_from_root)
-        {
-          if (dict->glb_to_loc().exists(glb_node))
-          {
-            Uint loc_node = dict->glb_to_loc()[glb_node];
-            cf3_assert(dict->glb_idx()[loc_node]==glb_node);
-            cf3_assert(loc_node<dict->rank().size());
-            // if the rank is yourself, it means that the glb_node has not been found
-            // before. Change then the rank to the broacasting cpu.
-            if (dict->rank()[loc_node] == PE::Comm::instance().rank())
-            {
-              dict->rank()[loc_node] = std::min(root,dict->rank()[loc_node]);
-            }
-          }
-        }
-      }
+      cf3_assert(owners[n] <= PE::Comm::instance().rank());
+      dict->rank()[n] = owners[n];
     }
   }
 
@@ -1175,7 +1303,7 @@ void MeshAdaptor::fix_node_ranks(const std::vector< std::vector<boost::uint64_t>
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void MeshAdaptor::grow_overlap()
+void MeshAdaptor::grow_overlap(const Uint nb_layers)
 {
 
   flush_nodes();
@@ -1245,28 +1373,62 @@ void MeshAdaptor::grow_overlap()
 
   rebuild_node_glb_to_loc_map();
 
+  // Nodes and elements are marked with pid+1 once visited for a pid, so the marks
+  // don't need to be cleared between pid's
+  std::vector<Uint> node_visited(geometry_dict.size(),0);
+  std::vector< std::vector<Uint> > elem_visited(m_mesh->elements().size());
+  for (Uint entities_idx=0; entities_idx<m_mesh->elements().size(); ++entities_idx)
+    elem_visited[entities_idx].resize(m_mesh->elements()[entities_idx]->size(),0);
+
+  std::vector<Uint> front, next_front;
   for (Uint pid=0; pid<PE::Comm::instance().size(); ++pid)
   {
     if (pid != PE::Comm::instance().rank())
     {
+      const Uint mark = pid+1;
+      front.clear();
       boost_foreach (const boost::uint64_t& glb_node, recv_elem_glb_nodes[pid])
       {
         if (geometry_dict.glb_to_loc().exists(glb_node))
         {
           const Uint loc_node = geometry_dict.glb_to_loc()[glb_node];
           cf3_assert(loc_node<geometry_dict.size());
-//          CFdebug << "[0] found glb_node " << glb_node+1 <<      "   :";
+          if (node_visited[loc_node] != mark)
+          {
+            node_visited[loc_node] = mark;
+            front.push_back(loc_node);
+          }
+        }
+      }
+
+      // Every layer consists of the elements connected to the nodes of the previous layer
+      for (Uint layer=0; layer<nb_layers && !front.empty(); ++layer)
+      {
+        const bool last_layer = (layer+1 == nb_layers);
+        next_front.clear();
+        boost_foreach (const Uint loc_node, front)
+        {
           boost_foreach(const SpaceElem& elem, geometry_dict.connectivity()[loc_node])
           {
-//            CFdebug << " " << elem.glb_idx()+1;
-            //if (elem.rank() == PE::Comm::instance().rank())
+            const Uint entities_idx = elem.comp->support().entities_idx();
+            if (elem_visited[entities_idx][elem.idx] == mark)
+              continue;
+            elem_visited[entities_idx][elem.idx] = mark;
+            exported_elements_loc_id[pid][entities_idx].push_back(elem.idx);
+
+            if (last_layer)
+              continue;
+            boost_foreach(const Uint elem_node, elem.comp->connectivity()[elem.idx])
             {
-              const Uint entities_idx = elem.comp->support().entities_idx();
-              exported_elements_loc_id[pid][entities_idx].push_back(elem.idx);
+              if (node_visited[elem_node] != mark)
+              {
+                node_visited[elem_node] = mark;
+                next_front.push_back(elem_node);
+              }
             }
           }
-//          CFdebug << CFendl;
         }
+        front.swap(next_front);
       }
     }
   }
@@ -1298,6 +1460,9 @@ void MeshAdaptor::combine_mesh(const Mesh& other_mesh)
 {
   restore_element_node_connectivity();
   CFdebug << "Adding mesh " << other_mesh.uri() << CFendl;
+
+  // Entities, dictionaries and rows are added without buffers, which the change log cannot follow
+  m_changes.invalidate();
   const Uint dim = std::max(other_mesh.dimension(),m_mesh->dimension());
   if (m_mesh->dimension() == 0) // It is not initialized yet
   {
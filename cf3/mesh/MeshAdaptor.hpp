@@ -18,6 +18,8 @@
 #include "common/Table.hpp"
 #include "common/DynTable.hpp"
 
+#include "mesh/MeshChangeLog.hpp"
+
 namespace cf3 {
 namespace mesh {
 
@@ -41,6 +43,10 @@ namespace mesh {
 ///  - remove_node()
 /// The changes are NOT applied until finally the function finish() is called.
 /// This also puts the mesh back in a consistent state, and updates mesh statistics
+///
+/// Every flush of elements and nodes is recorded in a change log (see changes()),
+/// which finish() passes on to Mesh::raise_mesh_changed(), so that the node to element
+/// connectivity is only updated for the rows that changed.
 /// @author Willem Deconinck
 class MeshAdaptor
 {
@@ -67,6 +73,9 @@ public:
   /// @post Mesh is back in consistent state!
   void finish();
 
+  /// @brief Changes of elements and nodes that were flushed since the mesh was last consistent
+  const MeshChangeLog& changes() const { return m_changes; }
+
   /// @name Elementary operations, should not be called usually
   //@{
 
@@ -138,7 +147,7 @@ public:
   ///       after element modifications are done.
   void restore_element_node_connectivity();
 
-  /// @brief rebuild dictionary.glb_to_loc() map with flushed nodes included
+  /// @brief rebuild dictionary.glb_to_loc() map with flushed nodes included, if it could not be updated at each flush
   void rebuild_node_glb_to_loc_map();
 
   /// @brief rebuild dictionary.connectivity() map with flushed nodes and elements included
@@ -157,11 +166,17 @@ public:
   ///       Call finish() to notify the mesh of updates.
   void move_elements(const std::vector< std::vector< std::vector<Uint> > >& exported_elements_loc_id);
 
-  /// @brief Create an additional cell-layer of overlap between pid's
+  /// @brief Create additional cell-layers of overlap between pid's
   ///
+  /// All layers are added in a single exchange: every pid sends the elements within
+  /// nb_layers rings of the boundary nodes of the other pid's, found by a breadth-first
+  /// search through its own node-to-element connectivity.
+  /// @param [in] nb_layers  The number of cell-layers to add
+  /// @note Layers that extend beyond the pid's that are adjacent to the boundary are truncated,
+  ///       so each partition should be at least nb_layers cells wide.
   /// @post nodes and elements are flushed, and node-ranks are uniquely defined in all pid's.
   ///       Call finish() to notify the mesh of updates.
-  void grow_overlap();
+  void grow_overlap(const Uint nb_layers=1);
 
   /// @brief Add another mesh to this mesh
   void combine_mesh(const Mesh& other_mesh);
@@ -236,7 +251,7 @@ private:
   /// @brief Node buffers for field values
   std::vector< std::vector< boost::shared_ptr<common::Table<Real>::Buffer> > > node_field_values;
 
-  /// @brief flag if dictionary.glb_to_loc() must be rebuilt
+  /// @brief flag if dictionary.glb_to_loc() must be rebuilt, because nodes changed without a flush
   bool node_glb_to_loc_needs_rebuild;
 
   /// @brief flag if dictionary.connectivity() must be rebuilt
@@ -258,6 +273,18 @@ private:
 
   bool has_node_buffers;
 
+  /// @brief Rows of the element tables removed since the last flush, per entities
+  std::vector< std::set<Uint> > removed_element_rows;
+
+  /// @brief Rows of the node tables removed since the last flush, per dictionary
+  std::vector< std::set<Uint> > removed_node_rows;
+
+  /// @brief Log of all flushed changes since the mesh was last consistent
+  MeshChangeLog m_changes;
+
+  /// @brief Keep the nodes of an element that is removed, in the change log
+  void record_removed_element_nodes(const Uint entities_idx, const Uint elem_loc_idx);
+
 #if 0
   void fix_node_ranks(const std::vector< std::vector<boost::uint64_t> >& nodes);
 #endif
@@ -0,0 +1,28 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "mesh/MeshCache.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+MeshCache::MeshCache ( const std::string& name  ) :
+  Component ( name )
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MeshCache::~MeshCache()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
@@ -0,0 +1,66 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_MeshCache_hpp
+#define cf3_mesh_MeshCache_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Component.hpp"
+
+#include "mesh/LibMesh.hpp"
+
+namespace cf3 {
+namespace common { class URI; }
+namespace mesh {
+
+  class Mesh;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Keeps fast loading copies of meshes read from slower file formats
+///
+/// LoadMesh asks the cache for a copy of a source file before parsing it,
+/// and stores the parsed mesh in the cache afterwards.
+/// A copy is only used while the source file and the dimension it was read with
+/// are unchanged, which implementations check through a hash of both.
+class Mesh_API MeshCache : public common::Component
+{
+public: // functions
+
+  /// Contructor
+  /// @param name of the component
+  MeshCache ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~MeshCache();
+
+  /// Get the class name
+  static std::string type_name () { return "MeshCache"; }
+
+  /// @brief Read the cached copy of a source file into a mesh
+  /// @param [in]     source     the file the mesh was originally read from
+  /// @param [in]     dimension  the coordinate dimension option the source is read with
+  /// @param [in,out] mesh       the mesh to read into
+  /// @return false if there is no up to date copy, leaving the mesh untouched
+  virtual bool read(const common::URI& source, const Uint dimension, Mesh& mesh) = 0;
+
+  /// @brief Store a copy of a mesh that was just read from a source file
+  /// @param [in] source     the file the mesh was read from
+  /// @param [in] dimension  the coordinate dimension option the source was read with
+  /// @param [in] mesh       the mesh as read from the source
+  virtual void write(const common::URI& source, const Uint dimension, const Mesh& mesh) = 0;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_MeshCache_hpp
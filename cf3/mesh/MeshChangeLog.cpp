@@ -0,0 +1,224 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "common/Foreach.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshChangeLog.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+RowChanges::RowChanges(const Uint size)
+{
+  reset(size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RowChanges::reset(const Uint size)
+{
+  m_baseline_size = size;
+  m_size = size;
+  m_removed.clear();
+  m_moved.clear();
+  m_moved_from.clear();
+  m_added.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RowChanges::record(const std::vector<Uint>& removed,
+                        const std::vector< std::pair<Uint,Uint> >& moved,
+                        const std::vector<Uint>& added,
+                        const Uint new_size)
+{
+  // A removed row was either added since the baseline, which is then simply forgotten,
+  // or it is a baseline row, possibly moved before
+  boost_foreach(const Uint row, removed)
+  {
+    if (m_added.erase(row))
+      continue;
+    std::map<Uint,Uint>::iterator from = m_moved_from.find(row);
+    if (from != m_moved_from.end())
+    {
+      m_removed.insert(from->second);
+      m_moved.erase(from->second);
+      m_moved_from.erase(from);
+    }
+    else
+    {
+      cf3_assert(row < m_baseline_size);
+      m_removed.insert(row);
+    }
+  }
+
+  // Look up where all moved rows come from, before assigning any target,
+  // as a target row of one move can be the source row of another move
+  std::vector<bool> source_is_added(moved.size(), false);
+  std::vector<Uint> source_baseline(moved.size(), 0);
+  for (Uint m=0; m<moved.size(); ++m)
+  {
+    const Uint row = moved[m].first;
+    if (m_added.erase(row))
+    {
+      source_is_added[m] = true;
+      continue;
+    }
+    std::map<Uint,Uint>::iterator from = m_moved_from.find(row);
+    if (from != m_moved_from.end())
+    {
+      source_baseline[m] = from->second;
+      m_moved.erase(from->second);
+      m_moved_from.erase(from);
+    }
+    else
+    {
+      cf3_assert(row < m_baseline_size);
+      source_baseline[m] = row;
+    }
+  }
+  for (Uint m=0; m<moved.size(); ++m)
+  {
+    const Uint row = moved[m].second;
+    if (source_is_added[m])
+    {
+      m_added.insert(row);
+    }
+    else if (source_baseline[m] != row) // a row moved back to its baseline index is unchanged
+    {
+      m_moved[source_baseline[m]] = row;
+      m_moved_from[row] = source_baseline[m];
+    }
+  }
+
+  m_added.insert(added.begin(), added.end());
+  m_size = new_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RowChanges::record(const RowChanges& changes)
+{
+  cf3_assert(changes.baseline_size() == m_size);
+  record(std::vector<Uint>(changes.removed().begin(), changes.removed().end()),
+         std::vector< std::pair<Uint,Uint> >(changes.moved().begin(), changes.moved().end()),
+         std::vector<Uint>(changes.added().begin(), changes.added().end()),
+         changes.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RowChanges::baseline_index(const Uint current, Uint& baseline) const
+{
+  if (m_added.count(current))
+    return false;
+  std::map<Uint,Uint>::const_iterator from = m_moved_from.find(current);
+  if (from != m_moved_from.end())
+  {
+    baseline = from->second;
+    return true;
+  }
+  cf3_assert(current < m_baseline_size);
+  baseline = current;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool RowChanges::current_index(const Uint baseline, Uint& current) const
+{
+  if (m_removed.count(baseline))
+    return false;
+  std::map<Uint,Uint>::const_iterator to = m_moved.find(baseline);
+  current = (to != m_moved.end() ? to->second : baseline);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+MeshChangeLog::MeshChangeLog() :
+  m_is_valid(false),
+  m_baseline_revision(0u)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MeshChangeLog::reset(const Mesh& mesh)
+{
+  m_is_valid = true;
+  m_baseline_revision = mesh.revision();
+  m_entities = mesh.elements();
+  m_dictionaries = mesh.dictionaries();
+
+  m_elements.resize(m_entities.size());
+  for (Uint entities_idx=0; entities_idx<m_entities.size(); ++entities_idx)
+    m_elements[entities_idx].reset(m_entities[entities_idx]->size());
+
+  m_nodes.resize(m_dictionaries.size());
+  for (Uint dict_idx=0; dict_idx<m_dictionaries.size(); ++dict_idx)
+    m_nodes[dict_idx].reset(m_dictionaries[dict_idx]->size());
+
+  m_removed_element_nodes.assign(m_entities.size(), std::vector< std::map< Uint, std::vector<Uint> > >(m_dictionaries.size()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MeshChangeLog::invalidate()
+{
+  m_is_valid = false;
+  m_entities.clear();
+  m_dictionaries.clear();
+  m_elements.clear();
+  m_nodes.clear();
+  m_removed_element_nodes.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool MeshChangeLog::applies_to(const Mesh& mesh) const
+{
+  return m_is_valid && m_entities == mesh.elements() && m_dictionaries == mesh.dictionaries();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MeshChangeLog::add_removed_element_nodes(const Uint entities_idx, const Uint dict_idx, const Uint elem, const std::vector<Uint>& nodes)
+{
+  cf3_assert(entities_idx < m_removed_element_nodes.size());
+  cf3_assert(dict_idx < m_removed_element_nodes[entities_idx].size());
+  m_removed_element_nodes[entities_idx][dict_idx][elem] = nodes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool MeshChangeLog::empty() const
+{
+  boost_foreach(const RowChanges& changes, m_elements)
+  {
+    if (!changes.empty())
+      return false;
+  }
+  boost_foreach(const RowChanges& changes, m_nodes)
+  {
+    if (!changes.empty())
+      return false;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
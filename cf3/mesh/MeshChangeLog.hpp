@@ -0,0 +1,172 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_MeshChangeLog_hpp
+#define cf3_mesh_MeshChangeLog_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "common/Handle.hpp"
+
+#include "mesh/LibMesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+  class Dictionary;
+  class Entities;
+  class Mesh;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Rows removed, moved and added in a table since a baseline
+///
+/// Rows are identified by their index in the baseline table ("baseline index")
+/// or by their index in the current table ("current index").
+/// Rows that are not removed or moved keep their index.
+class Mesh_API RowChanges
+{
+public:
+
+  /// Constructor, with the number of rows of the baseline table
+  RowChanges(const Uint size = 0);
+
+  /// Start again from a baseline table with given number of rows
+  void reset(const Uint size);
+
+  /// @brief Record the changes of one flush of the table
+  /// @param [in] removed   Rows removed, in the numbering before the flush
+  /// @param [in] moved     Rows moved, from the numbering before to the numbering after the flush
+  /// @param [in] added     New rows, in the numbering after the flush
+  /// @param [in] new_size  Number of rows after the flush
+  void record(const std::vector<Uint>& removed,
+              const std::vector< std::pair<Uint,Uint> >& moved,
+              const std::vector<Uint>& added,
+              const Uint new_size);
+
+  /// Record the changes of another log, whose baseline is the current table of this log
+  void record(const RowChanges& changes);
+
+  /// @brief Baseline index of a current row
+  /// @return false if the row was added since the baseline
+  bool baseline_index(const Uint current, Uint& baseline) const;
+
+  /// @brief Current index of a baseline row
+  /// @return false if the row was removed since the baseline
+  bool current_index(const Uint baseline, Uint& current) const;
+
+  /// Number of rows of the baseline table
+  Uint baseline_size() const { return m_baseline_size; }
+
+  /// Number of rows of the current table
+  Uint size() const { return m_size; }
+
+  /// Removed rows, as baseline indices
+  const std::set<Uint>& removed() const { return m_removed; }
+
+  /// Moved rows, from baseline to current index
+  const std::map<Uint,Uint>& moved() const { return m_moved; }
+
+  /// Added rows, as current indices
+  const std::set<Uint>& added() const { return m_added; }
+
+  /// True if no row changed since the baseline
+  bool empty() const { return m_removed.empty() && m_moved.empty() && m_added.empty(); }
+
+private:
+
+  Uint m_baseline_size;
+  Uint m_size;
+  std::set<Uint> m_removed;
+  std::map<Uint,Uint> m_moved;
+  std::map<Uint,Uint> m_moved_from; ///< inverse of m_moved
+  std::set<Uint> m_added;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Changes of the elements and nodes of a mesh since a baseline
+///
+/// MeshAdaptor records every flush of elements and nodes in this log, so that
+/// structures derived from the mesh can be updated for the changed rows only,
+/// instead of being rebuilt from scratch (see Mesh::raise_mesh_changed()).
+/// For each removed element, the nodes it was connected to are kept as well,
+/// as these are gone from the element-node connectivity once the element is flushed.
+///
+/// Changes that cannot be described by removed, moved and added rows, such as
+/// the creation of new Entities or Dictionaries, invalidate the log. Derived
+/// structures must then be rebuilt from scratch.
+class Mesh_API MeshChangeLog
+{
+public:
+
+  /// Constructor, giving an invalid log
+  MeshChangeLog();
+
+  /// Start a new log, with the current elements and nodes of the mesh as baseline
+  void reset(const Mesh& mesh);
+
+  /// Mark the log as incomplete
+  void invalidate();
+
+  /// Mesh::revision() of the baseline
+  Uint baseline_revision() const { return m_baseline_revision; }
+
+  /// True if the log was started, and no untracked change happened
+  bool is_valid() const { return m_is_valid; }
+
+  /// True if the log is valid, and the mesh still has the entities and dictionaries of the baseline
+  bool applies_to(const Mesh& mesh) const;
+
+  /// Row changes of the elements in Mesh::elements()[entities_idx]
+  RowChanges& elements(const Uint entities_idx) { return m_elements[entities_idx]; }
+  const RowChanges& elements(const Uint entities_idx) const { return m_elements[entities_idx]; }
+
+  /// Row changes of the nodes in Mesh::dictionaries()[dict_idx]
+  RowChanges& nodes(const Uint dict_idx) { return m_nodes[dict_idx]; }
+  const RowChanges& nodes(const Uint dict_idx) const { return m_nodes[dict_idx]; }
+
+  /// Keep the nodes of a removed element, both as baseline indices
+  void add_removed_element_nodes(const Uint entities_idx, const Uint dict_idx, const Uint elem, const std::vector<Uint>& nodes);
+
+  /// Nodes of the removed elements in a space, as baseline indices and indexed by baseline element index
+  const std::map< Uint, std::vector<Uint> >& removed_element_nodes(const Uint entities_idx, const Uint dict_idx) const
+  { return m_removed_element_nodes[entities_idx][dict_idx]; }
+
+  /// True if no element or node changed since the baseline
+  bool empty() const;
+
+private:
+
+  bool m_is_valid;
+
+  Uint m_baseline_revision;
+
+  /// Entities and dictionaries of the baseline, in the order of the mesh
+  std::vector< Handle<Entities> > m_entities;
+  std::vector< Handle<Dictionary> > m_dictionaries;
+
+  std::vector<RowChanges> m_elements;
+  std::vector<RowChanges> m_nodes;
+
+  /// Nodes of removed elements: [entities_idx][dict_idx][elem] --> nodes
+  std::vector< std::vector< std::map< Uint, std::vector<Uint> > > > m_removed_element_nodes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_MeshChangeLog_hpp
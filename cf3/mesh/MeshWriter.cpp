@@ -101,6 +101,29 @@ MeshWriter::MeshWriter ( const std::string& name  ) :
       .mark_basic()
       .link_to(&m_region_filter  .enable_interior_faces)
       .link_to(&m_entities_filter.enable_interior_faces);
+
+  // Option to write all fields in single precision
+  m_single_precision = false;
+  options().add("single_precision", m_single_precision)
+      .pretty_name("Single Precision")
+      .description("Write all fields in single precision, if supported by the format. Coordinates keep full precision. "
+                   "Fields can also be marked individually using Field::set_single_precision()")
+      .link_to(&m_single_precision);
+
+  // Option to write binary data
+  m_binary = false;
+  options().add("binary", m_binary)
+      .pretty_name("Binary")
+      .description("Write the data in binary form, if supported by the format. "
+                   "Binary files are smaller and much faster to write than ASCII files")
+      .link_to(&m_binary);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool MeshWriter::single_precision(const Field& field) const
+{
+  return m_single_precision || field.single_precision();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
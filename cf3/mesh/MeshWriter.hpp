@@ -55,6 +55,12 @@ public: // functions
 
   virtual void write_from_to(const Mesh& mesh, const common::URI& file_path);
 
+protected: // functions
+
+  /// @return true if the given field is to be written in single precision,
+  /// either because it is marked so or because the writer is configured for it
+  bool single_precision(const Field& field) const;
+
 private: // functions
 
   virtual void write() {};
@@ -91,6 +97,8 @@ protected:
   std::vector<Handle<Region const> >   m_regions;            ///< Handle to configured regions
   std::vector<Handle<Entities const> > m_filtered_entities;  ///< Handle to selected entities
   bool                                 m_enable_overlap;     ///< If true, writing of overlap will be enabled
+  bool                                 m_single_precision;   ///< If true, all fields are written in single precision
+  bool                                 m_binary;             ///< If true, data is written in binary form, if the format supports it
 
 };
 
@@ -4,11 +4,13 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <set>
 
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
 
+#include "common/Core.hpp"
 #include "common/Foreach.hpp"
 #include "common/Log.hpp"
 #include "common/Builder.hpp"
@@ -17,6 +19,7 @@
 #include "common/OptionT.hpp"
 #include "common/OptionArray.hpp"
 #include "common/OptionComponent.hpp"
+#include "common/ThreadPool.hpp"
 
 #include "common/PE/Comm.hpp"
 #include "common/PE/debug.hpp"
@@ -50,7 +53,7 @@ cf3::common::ComponentBuilder < Octtree, Component, LibMesh > Octtree_Builder;
 ////////////////////////////////////////////////////////////////////////////////
 
 Octtree::Octtree( const std::string& name )
-  : Component(name), m_dim(0), m_N(3), m_D(3), m_octtree_idx(3)
+  : Component(name), m_dim(0), m_N(3), m_D(3), m_partition_tree_built(false)
 {
 
   options().add("mesh", m_mesh)
@@ -68,6 +71,15 @@ Octtree::Octtree( const std::string& name )
       .description("The number of cells in each direction of the comb. "
                         "Takes precedence over \"Number of Elements per Octtree Cell\". ")
       .pretty_name("Number of Cells");
+
+  options().add( "nb_elems_per_leaf", 4u )
+      .description("The maximum number of elements in a leaf of the tree of element bounding boxes, used to locate coordinates")
+      .pretty_name("Number of Elements per Leaf");
+
+  options().add( "nb_partition_boxes", 4u )
+      .description("The number of boxes in each direction used to summarize the region covered by this rank. "
+                   "These boxes are exchanged to find which ranks may contain a coordinate.")
+      .pretty_name("Number of Partition Boxes");
 }
 
 
@@ -111,6 +123,10 @@ void Octtree::create_octtree()
     }
   }
 
+  m_N.resize(3);
+  for (Uint d=m_dim; d<3; ++d)
+    m_N[d] = 1;
+
   CFdebug << "Octtree:" << CFendl;
   CFdebug << "--------" << CFendl;
   for (Uint d=0; d<m_dim; ++d)
@@ -119,77 +135,143 @@ void Octtree::create_octtree()
   }
   CFdebug << "V = " << V << CFendl;
 
-  // initialize the octtree
-  m_octtree.resize(boost::extents[std::max(Uint(1),m_N[XX])][std::max(Uint(1),m_N[YY])][std::max(Uint(1),m_N[ZZ])]);
+  // the octtree cells are grouped in a coarse grid of partition boxes, each enclosing the nodes of its elements
+  const Uint nb_partition_boxes = std::max(1u, options().value<Uint>("nb_partition_boxes"));
+  Uint nb_coarse_cells = 1;
+  for (Uint d=0; d<m_dim; ++d)
+    nb_coarse_cells *= nb_partition_boxes;
+  const Uint box_size = 2*m_dim;
+  std::vector<Real> coarse_boxes(nb_coarse_cells*box_size);
+  for (Uint b=0; b<nb_coarse_cells; ++b)
+  {
+    for (Uint d=0; d<m_dim; ++d)
+    {
+      coarse_boxes[b*box_size+d]       =  real_max();
+      coarse_boxes[b*box_size+m_dim+d] = -real_max();
+    }
+  }
+  std::vector<bool> coarse_cell_used(nb_coarse_cells,false);
 
-  RealVector centroid(m_dim);
-  std::vector<Uint> octtree_idx(3);
+  // collect the elements
+  m_elements.clear();
+  m_elements.reserve(nb_elems);
   boost_foreach (Elements& elements, find_components_recursively_with_filter<Elements>(*m_mesh,IsElementsVolume()))
   {
-    Uint nb_nodes_per_element = elements.geometry_space().connectivity().row_size();
-    RealMatrix coordinates;
-    elements.geometry_space().allocate_coordinates(coordinates);
-
     for (Uint elem_idx=0; elem_idx<elements.size(); ++elem_idx)
+      m_elements.push_back(Entity(elements,elem_idx));
+  }
+
+  // the octtree cell of their centroid, and the bounding box of their nodes, computed concurrently
+  std::vector<Uint> element_cell(m_elements.size());
+  std::vector<Uint> element_coarse_cell(m_elements.size());
+  std::vector<Real> element_boxes(m_elements.size()*box_size);
+  Core::instance().thread_pool().parallel_for(0, m_elements.size(),
+      boost::bind(&Octtree::locate_elements, this, _1, _2, nb_partition_boxes,
+                  boost::ref(element_cell), boost::ref(element_coarse_cell), boost::ref(element_boxes)));
+
+  for (Uint e=0; e<m_elements.size(); ++e)
+  {
+    const Uint coarse_idx = element_coarse_cell[e];
+    coarse_cell_used[coarse_idx] = true;
+    const Real* box = &element_boxes[e*box_size];
+    Real* coarse_box = &coarse_boxes[coarse_idx*box_size];
+    for (Uint d=0; d<m_dim; ++d)
     {
-      elements.geometry_space().put_coordinates(coordinates,elem_idx);
-      elements.element_type().compute_centroid(coordinates,centroid);
-      for (Uint d=0; d<m_dim; ++d)
-      {
-        cf3_assert((centroid[d] - m_bounding_box.min()[d])/m_D[d] >= 0);
-        octtree_idx[d]=std::min((Uint) std::floor( (centroid[d] - m_bounding_box.min()[d])/m_D[d]), m_N[d]-1 );
-      }
-      m_octtree[octtree_idx[XX]][octtree_idx[YY]][octtree_idx[ZZ]].push_back(Entity(elements,elem_idx));
+      coarse_box[d]       = std::min(coarse_box[d],       box[d]);
+      coarse_box[m_dim+d] = std::max(coarse_box[m_dim+d], box[m_dim+d]);
     }
   }
 
+  // sort the elements by octtree cell, with a counting sort
+  const Uint nb_cells = m_N[XX]*m_N[YY]*m_N[ZZ];
+  m_cell_start.assign(nb_cells+1,0u);
+  boost_foreach(const Uint cell, element_cell)
+    ++m_cell_start[cell+1];
+  for (Uint c=0; c<nb_cells; ++c)
+    m_cell_start[c+1] += m_cell_start[c];
+  m_cell_elements.resize(m_elements.size());
+  std::vector<Uint> cell_fill(m_cell_start.begin(),m_cell_start.end()-1);
+  for (Uint e=0; e<element_cell.size(); ++e)
+    m_cell_elements[cell_fill[element_cell[e]]++] = e;
+
+  // the element bounding boxes adapt to the mesh, and are used to locate coordinates
+  m_element_tree.build(m_dim,element_boxes,std::max(1u,options().value<Uint>("nb_elems_per_leaf")));
+
+  m_partition_boxes.clear();
+  for (Uint b=0; b<nb_coarse_cells; ++b)
+  {
+    if (coarse_cell_used[b])
+      m_partition_boxes.insert(m_partition_boxes.end(), coarse_boxes.begin()+b*box_size, coarse_boxes.begin()+(b+1)*box_size);
+  }
+  m_partition_tree_built = false;
 
-  // Uint total=0;
-  //
-  // switch (m_dim)
-  // {
-  //   case DIM_2D:
-  //     for (Uint i=0; i<m_N[0]; ++i)
-  //       for (Uint j=0; j<m_N[1]; ++j)
-  //       {
-  //         Uint k=0;
-  //         // CFinfo << "("<<i<<","<<j<<") has elems ";
-  //         // if (m_octtree[i][j][k].size())
-  //         //   CFinfo << mesh::to_vector(m_octtree[i][j][k]).transpose() << CFendl;
-  //         // else
-  //         //   CFinfo << CFendl;
-  //         total += m_octtree[i][j][k].size();
-  //       }
-  //     break;
-  //   case DIM_3D:
-  //     for (Uint i=0; i<m_N[0]; ++i)
-  //       for (Uint j=0; j<m_N[1]; ++j)
-  //         for (Uint k=0; k<m_N[2]; ++k)
-  //         {
-  //           // CFinfo << "("<<i<<","<<j<<","<<k<<") has elems ";
-  //           // if (m_octtree[i][j][k].size())
-  //           //   CFinfo << mesh::to_vector(m_octtree[i][j][k]).transpose() << CFendl;
-  //           // else
-  //           //   CFinfo << CFendl;
-  //           total += m_octtree[i][j][k].size();
-  //         }
-  //     break;
-  //   default:
-  //     break;
-  // }
-  //
-  // CFinfo << "total = " << total << " of " << m_nb_elems << CFendl;
+  CFdebug << PERank << "Octtree: " << m_elements.size() << " elements, " << m_element_tree.nb_nodes() << " tree nodes, "
+          << memory_footprint() << " bytes" << CFendl;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+
+void Octtree::locate_elements(const Uint begin, const Uint end, const Uint nb_partition_boxes,
+                              std::vector<Uint>& element_cell, std::vector<Uint>& element_coarse_cell,
+                              std::vector<Real>& element_boxes) const
+{
+  const Uint box_size = 2*m_dim;
+  RealVector centroid(m_dim);
+  std::vector<Uint> octtree_idx(3,0u);
+  RealMatrix coordinates;
+  const Entities* coordinates_comp = NULL;
+  for (Uint e=begin; e<end; ++e)
+  {
+    const Entity& element = m_elements[e];
+    if (element.comp != coordinates_comp)
+    {
+      element.allocate_coordinates(coordinates);
+      coordinates_comp = element.comp;
+    }
+    element.put_coordinates(coordinates);
+    element.element_type().compute_centroid(coordinates,centroid);
+
+    Uint coarse_idx = 0;
+    for (Uint d=0; d<m_dim; ++d)
+    {
+      cf3_assert((centroid[d] - m_bounding_box.min()[d])/m_D[d] >= 0);
+      octtree_idx[d]=std::min((Uint) std::floor( (centroid[d] - m_bounding_box.min()[d])/m_D[d]), m_N[d]-1 );
+      coarse_idx = coarse_idx*nb_partition_boxes + (octtree_idx[d]*nb_partition_boxes)/m_N[d];
+    }
+    element_cell[e] = cell_index(octtree_idx[XX],octtree_idx[YY],octtree_idx[ZZ]);
+    element_coarse_cell[e] = coarse_idx;
+
+    Real* box = &element_boxes[e*box_size];
+    for (Uint d=0; d<m_dim; ++d)
+    {
+      box[d]       = coordinates(0,d);
+      box[m_dim+d] = coordinates(0,d);
+    }
+    for (Uint n=1; n<coordinates.rows(); ++n)
+    {
+      for (Uint d=0; d<m_dim; ++d)
+      {
+        box[d]       = std::min(box[d],       coordinates(n,d));
+        box[m_dim+d] = std::max(box[m_dim+d], coordinates(n,d));
+      }
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////
 
 void Octtree::find_cell_ranks( const boost::multi_array<Real,2>& coordinates, std::vector<Uint>& ranks )
 {
+  if ( !is_created() )
+    create_octtree();
+
+  const bool parallel = Comm::instance().is_active() && Comm::instance().size() > 1;
+  const Uint my_rank = parallel ? Comm::instance().rank() : 0u;
+
   ranks.resize(coordinates.size());
 
   Entity dummy;
-  std::deque<Uint> missing_cells;
+  std::vector<Uint> missing_cells;
 
   RealVector coord(m_dim);
 
@@ -199,7 +281,7 @@ void Octtree::find_cell_ranks( const boost::multi_array<Real,2>& coordinates, st
       coord[d] = coordinates[i][d];
     if( find_element(coord,dummy) ) // if element is found on this rank
     {
-      ranks[i] = Comm::instance().rank();
+      ranks[i] = my_rank;
     }
     else
     {
@@ -208,72 +290,113 @@ void Octtree::find_cell_ranks( const boost::multi_array<Real,2>& coordinates, st
     }
   }
 
-  std::vector<Real> send_coords(m_dim*missing_cells.size());
-  std::vector<Real> recv_coords;
+  if ( !parallel )
+    return;
 
-  Uint c(0);
-  boost_foreach(const Uint i, missing_cells)
-  {
-    for(Uint d=0; d<m_dim; ++d)
-      send_coords[c++]=coordinates[i][d];
-  }
+  if ( !m_partition_tree_built )
+    build_partition_tree();
 
-  for (Uint root=0; root<PE::Comm::instance().size(); ++root)
+  // Send each missing coordinate only to the ranks with a partition box around it
+  const Uint nb_procs = Comm::instance().size();
+  static const Real tolerance = 100*math::Consts::eps();
+  std::vector< std::vector<Real> > send_coords(nb_procs);
+  std::vector< std::vector<Uint> > send_idx(nb_procs);
+  std::vector<Uint> boxes;
+  std::vector<Uint> candidates;
+  boost_foreach(const Uint i, missing_cells)
   {
+    for (Uint d=0; d<m_dim; ++d)
+      coord[d] = coordinates[i][d];
 
-    recv_coords.resize(0);
-    PE::Comm::instance().broadcast(send_coords,recv_coords,root,m_dim);
+    boxes.clear();
+    m_partition_tree.find_boxes(coord,boxes,tolerance);
 
-    // size is only because it doesn't get resized for this rank
-    std::vector<Uint> send_found(missing_cells.size(),math::Consts::uint_max());
+    candidates.clear();
+    boost_foreach(const Uint box, boxes)
+    {
+      if (m_partition_box_rank[box] != my_rank)
+        candidates.push_back(m_partition_box_rank[box]);
+    }
+    std::sort(candidates.begin(),candidates.end());
+    candidates.erase(std::unique(candidates.begin(),candidates.end()),candidates.end());
 
-    if (root!=Comm::instance().rank())
+    boost_foreach(const Uint p, candidates)
     {
-      std::vector<RealVector> recv_coordinates(recv_coords.size()/m_dim) ;
-      boost_foreach(RealVector& realvec, recv_coordinates)
-          realvec.resize(m_dim);
+      for (Uint d=0; d<m_dim; ++d)
+        send_coords[p].push_back(coordinates[i][d]);
+      send_idx[p].push_back(i);
+    }
+  }
 
-      c=0;
-      for (Uint i=0; i<recv_coordinates.size(); ++i)
-      {
-        for(Uint d=0; d<m_dim; ++d)
-          recv_coordinates[i][d]=recv_coords[c++];
-      }
+  std::vector< std::vector<Real> > recv_coords;
+  Comm::instance().all_to_all(send_coords,recv_coords);
 
-      send_found.resize(recv_coordinates.size());
-      for (Uint i=0; i<recv_coordinates.size(); ++i)
-      {
-        if( find_element(recv_coordinates[i],dummy) ) // if element found on this rank
-        {
-          send_found[i] = Comm::instance().rank();
-        }
-        else
-          send_found[i] = math::Consts::uint_max();
-      }
+  // Answer with this rank if the coordinate is found here
+  std::vector< std::vector<Uint> > send_found(nb_procs);
+  for (Uint p=0; p<nb_procs; ++p)
+  {
+    const Uint nb_coords = recv_coords[p].size()/m_dim;
+    send_found[p].resize(nb_coords);
+    for (Uint i=0; i<nb_coords; ++i)
+    {
+      for (Uint d=0; d<m_dim; ++d)
+        coord[d] = recv_coords[p][i*m_dim+d];
+      send_found[p][i] = find_element(coord,dummy) ? my_rank : math::Consts::uint_max();
     }
+  }
 
-    std::vector<Uint> recv_found(missing_cells.size()*Comm::instance().size());
-    PE::Comm::instance().gather(send_found,recv_found,root);
+  std::vector< std::vector<Uint> > recv_found;
+  Comm::instance().all_to_all(send_found,recv_found);
 
-    if( root==Comm::instance().rank())
+  for (Uint p=0; p<nb_procs; ++p)
+  {
+    cf3_assert(recv_found[p].size() == send_idx[p].size());
+    for (Uint i=0; i<send_idx[p].size(); ++i)
+      ranks[send_idx[p][i]] = std::min(recv_found[p][i], ranks[send_idx[p][i]]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Octtree::build_partition_tree()
+{
+  const Uint nb_procs = Comm::instance().size();
+  const Uint box_size = 2*m_dim;
+
+  // Gather the number of boxes of every rank, then the boxes themselves, padded to the largest number
+  const Uint nb_boxes = m_partition_boxes.size()/box_size;
+  std::vector<Uint> nb_boxes_per_rank;
+  Comm::instance().all_gather(nb_boxes,nb_boxes_per_rank);
+  const Uint max_nb_boxes = *std::max_element(nb_boxes_per_rank.begin(),nb_boxes_per_rank.end());
+
+  std::vector<Real> all_boxes;
+  m_partition_box_rank.clear();
+  if (max_nb_boxes > 0)
+  {
+    std::vector<Real> send_boxes(max_nb_boxes*box_size,0.);
+    std::copy(m_partition_boxes.begin(),m_partition_boxes.end(),send_boxes.begin());
+    std::vector<Real> recv_boxes;
+    Comm::instance().all_gather(send_boxes,recv_boxes);
+
+    for (Uint p=0; p<nb_procs; ++p)
     {
-      const Uint stride = missing_cells.size();
-      for (Uint i=0; i<missing_cells.size(); ++i)
-      {
-        for(Uint p=0; p<Comm::instance().size(); ++p)
-        {
-          ranks[missing_cells[i]] = std::min(recv_found[i+p*stride] , ranks[missing_cells[i]]);
-        }
-      }
+      const Uint offset = p*max_nb_boxes*box_size;
+      all_boxes.insert(all_boxes.end(), recv_boxes.begin()+offset, recv_boxes.begin()+offset+nb_boxes_per_rank[p]*box_size);
+      m_partition_box_rank.insert(m_partition_box_rank.end(), nb_boxes_per_rank[p], p);
     }
   }
+
+  m_partition_tree.build(m_dim,all_boxes);
+  m_partition_tree_built = true;
+
+  CFdebug << PERank << "Octtree: " << nb_boxes << " local partition boxes, " << m_partition_tree.nb_boxes() << " in total" << CFendl;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 bool Octtree::find_octtree_cell(const RealVector& coordinate, std::vector<Uint>& octtree_idx)
 {
-  if (m_octtree.num_elements() == 0)
+  if ( !is_created() )
     create_octtree();
 
   static const Real tolerance = 100*math::Consts::eps();
@@ -308,11 +431,7 @@ void Octtree::gather_elements_around_idx(const std::vector<Uint>& octtree_idx, c
 
   if (ring == 0)
   {
-    boost_foreach(const Entity& element, m_octtree[octtree_idx[XX]][octtree_idx[YY]][octtree_idx[ZZ]])
-    {
-      cf3_assert(element.comp);
-      elements.push_back(element);
-    }
+    add_cell_elements(octtree_idx[XX],octtree_idx[YY],octtree_idx[ZZ],elements);
     return;
   }
   else
@@ -338,11 +457,7 @@ void Octtree::gather_elements_around_idx(const std::vector<Uint>& octtree_idx, c
             {
               if ( i == irmin || i == irmax || j == jrmin || j == jrmax || k == krmin || k == krmax)
               {
-                boost_foreach(const Entity& element, m_octtree[i][j][k])
-                {
-                  cf3_assert(element.comp);
-                  elements.push_back(element);
-                }
+                add_cell_elements(i,j,k,elements);
               }
             }
           }
@@ -363,11 +478,7 @@ void Octtree::gather_elements_around_idx(const std::vector<Uint>& octtree_idx, c
           {
             if ( i == irmin || i == irmax || j == jrmin || j == jrmax )
             {
-              boost_foreach(const Entity& element, m_octtree[i][j][k])
-              {
-                cf3_assert(element.comp);
-                elements.push_back(element);
-              }
+              add_cell_elements(i,j,k,elements);
             }
           }
         }
@@ -382,11 +493,7 @@ void Octtree::gather_elements_around_idx(const std::vector<Uint>& octtree_idx, c
         {
           if ( i == irmin || i == irmax)
           {
-            boost_foreach(const Entity& element, m_octtree[i][j][k])
-            {
-              cf3_assert(element.comp);
-              elements.push_back(element);
-            }
+            add_cell_elements(i,j,k,elements);
           }
         }
 
@@ -416,54 +523,56 @@ bool Octtree::find_element(const RealVector& target_coord, Entity& element)
   if ( !is_created() )
     create_octtree();
 
+  static const Real tolerance = 100*math::Consts::eps();
+
   cf3_assert(target_coord.size() <= (long)m_dim);
   RealVector t_coord(m_dim);
   for (Uint d=0; d<target_coord.size(); ++d)
     t_coord[d] = target_coord[d];
 
-  for (Uint t=0; t<target_coord.size(); ++t)
-
-  if (find_octtree_cell(t_coord,m_octtree_idx))
+  // only the elements whose bounding box contains the coordinate are tested
+  m_candidates.clear();
+  m_element_tree.find_boxes(t_coord,m_candidates,tolerance);
+  boost_foreach(const Uint candidate, m_candidates)
   {
-    m_elements_pool.clear();
-    Uint pool_size = 0;
-    Uint rings=0;
-    for ( ; pool_size==0 ; ++rings)
-    {
-      pool_size=m_elements_pool.size();
-      gather_elements_around_idx(m_octtree_idx,rings,m_elements_pool);
-      boost_foreach(const Entity& pool_elem, boost::make_iterator_range(m_elements_pool.begin()+pool_size,m_elements_pool.end()))
-      {
-        cf3_assert(is_not_null(pool_elem.comp));
-        const RealMatrix elem_coordinates = pool_elem.get_coordinates();
-        if (pool_elem.element_type().is_coord_in_element(t_coord,elem_coordinates))
-        {
-          element = pool_elem;
-          return true;
-        }
-      }
-    }
-    // if arrived here, keep searching
-    // it means no element has been found. The search is enlarged with one more ring, for possible misses.
-    gather_elements_around_idx(m_octtree_idx,rings,m_elements_pool);
-    boost_foreach(const Entity& pool_elem, boost::make_iterator_range(m_elements_pool.begin()+pool_size,m_elements_pool.end()))
+    const Entity& elem = m_elements[candidate];
+    cf3_assert(is_not_null(elem.comp));
+    elem.allocate_coordinates(m_elem_coordinates);
+    elem.put_coordinates(m_elem_coordinates);
+    if (elem.element_type().is_coord_in_element(t_coord,m_elem_coordinates))
     {
-      cf3_assert(is_not_null(pool_elem.comp));
-      const RealMatrix elem_coordinates = pool_elem.get_coordinates();
-      if (pool_elem.element_type().is_coord_in_element(t_coord,elem_coordinates))
-      {
-        element = pool_elem;
-        return true;
-      }
+      element = elem;
+      return true;
     }
   }
-  // if arrived here, it means no element has been found in the octtree cell. Give up.
+  // if arrived here, it means no element contains the coordinate. Give up.
   element = Entity();
-  CFdebug << "coord " << t_coord.transpose() << " has not been found in the octtree cell" << CFendl;
+  CFdebug << "coord " << t_coord.transpose() << " has not been found in the octtree" << CFendl;
   return false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Octtree::add_cell_elements(const Uint i, const Uint j, const Uint k, std::vector<Entity>& elements) const
+{
+  const Uint cell = cell_index(i,j,k);
+  for (Uint c=m_cell_start[cell]; c<m_cell_start[cell+1]; ++c)
+  {
+    cf3_assert(m_elements[m_cell_elements[c]].comp);
+    elements.push_back(m_elements[m_cell_elements[c]]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::size_t Octtree::memory_footprint() const
+{
+  return sizeof(Entity) * m_elements.capacity() +
+         sizeof(Uint) * (m_cell_elements.capacity() + m_cell_start.capacity()) +
+         m_element_tree.memory_footprint();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
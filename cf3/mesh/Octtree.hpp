@@ -13,6 +13,7 @@
 #include "common/BoostArray.hpp"
 
 #include "math/BoundingBox.hpp"
+#include "math/BoundingBoxTree.hpp"
 
 #include "mesh/Elements.hpp"
 
@@ -26,7 +27,12 @@ namespace mesh {
 
 //////////////////////////////////////////////////////////////////////////////
 
-/// This class defines neutral mesh format reader
+/// @brief Spatial index of the volume elements of a mesh
+///
+/// Coordinates are located with a bounding volume hierarchy over the element bounding boxes,
+/// which adapts to graded meshes. The elements are also binned in a structured grid of cells
+/// by their centroid, to gather elements in rings around a cell.
+/// All data is stored in flat arrays.
 /// @author Willem Deconinck
 class Mesh_API Octtree : public common::Component
 {
@@ -34,7 +40,6 @@ class Mesh_API Octtree : public common::Component
 private: // typedefs
 
   typedef std::pair<const Elements*,Uint> Point;
-  typedef boost::multi_array<std::vector<Entity> ,3> ArrayT;
   typedef std::vector<const Point*> Pointcloud;
 
 public: // functions
@@ -52,6 +57,7 @@ public: // functions
   Entity find_element(const RealVector& target_coord);
 
   /// @brief Find which element contains a given coordinate
+  /// @note Only the elements whose bounding box contains the coordinate are tested
   /// @return if element was found
   virtual bool find_element(const RealVector& target_coord, Entity& element);
 
@@ -69,15 +75,54 @@ public: // functions
   /// @note subsequent calls with increasing value for ring starting from 0, will assemble everything within the last passed ring value.
   void gather_elements_around_idx(const std::vector<Uint>& octtree_idx, const Uint ring, std::vector<Entity>& element_pool);
 
+  /// @brief Find the rank that owns an element containing each coordinate
+  /// @param coordinates [in]  The coordinates to look for, one per row
+  /// @param ranks       [out] This rank if the coordinate is found locally, otherwise the lowest other rank
+  ///                          containing it, or math::Consts::uint_max() if no rank contains it
+  /// @note Collective. Coordinates that are not found locally are only sent to the ranks
+  ///       whose partition boxes contain them.
   void find_cell_ranks( const boost::multi_array<Real,2>& coordinates, std::vector<Uint>& ranks );
 
-  bool is_created() const { return m_octtree.num_elements()!=0; }
+  bool is_created() const { return !m_cell_start.empty(); }
 
   const Uint dimension() { return m_dim; }
 
+  /// Number of bytes used by the cells and the tree of element bounding boxes
+  std::size_t memory_footprint() const;
+
+private: // functions
+
+  /// Gather the partition boxes of all ranks in m_partition_tree. Collective.
+  void build_partition_tree();
+
+  /// Compute the octtree cell, partition box and bounding box of the elements [begin,end) of m_elements.
+  /// Ranges of elements are handled concurrently by create_octtree().
+  void locate_elements(const Uint begin, const Uint end, const Uint nb_partition_boxes,
+                       std::vector<Uint>& element_cell, std::vector<Uint>& element_coarse_cell,
+                       std::vector<Real>& element_boxes) const;
+
+  /// Index of cell (i,j,k) in m_cell_start
+  Uint cell_index(const Uint i, const Uint j, const Uint k) const { return (i*m_N[YY] + j)*m_N[ZZ] + k; }
+
+  /// Append the elements of cell (i,j,k)
+  void add_cell_elements(const Uint i, const Uint j, const Uint k, std::vector<Entity>& elements) const;
+
 private: // data
 
-  ArrayT m_octtree;
+  /// All volume elements of the mesh
+  std::vector<Entity> m_elements;
+
+  /// Indices in m_elements, sorted by cell
+  std::vector<Uint> m_cell_elements;
+
+  /// Elements of cell c are m_cell_elements[m_cell_start[c]] up to m_cell_elements[m_cell_start[c+1]]
+  std::vector<Uint> m_cell_start;
+
+  /// Bounding volume hierarchy of the element bounding boxes. Box i belongs to m_elements[i].
+  math::BoundingBoxTree m_element_tree;
+
+  /// Elements found in m_element_tree, reused to avoid allocations
+  std::vector<Uint> m_candidates;
 
   Uint m_dim;
   std::vector<Uint> m_N;
@@ -85,12 +130,24 @@ private: // data
 
   Handle<Mesh> m_mesh;
 
-  std::vector<Uint> m_octtree_idx;
-
-  std::vector<Entity> m_elements_pool;
+  /// Coordinates of the element being tested, reused to avoid allocations
+  RealMatrix m_elem_coordinates;
 
   math::BoundingBox m_bounding_box;
 
+  /// Boxes around groups of local elements, summarizing the region this rank covers.
+  /// 2*m_dim values per box: minimum coordinates followed by maximum coordinates
+  std::vector<Real> m_partition_boxes;
+
+  /// Partition boxes of all ranks
+  math::BoundingBoxTree m_partition_tree;
+
+  /// Rank owning each box in m_partition_tree
+  std::vector<Uint> m_partition_box_rank;
+
+  /// True if m_partition_tree contains the current partition boxes of all ranks
+  bool m_partition_tree_built;
+
 }; // end Octtree
 
 ////////////////////////////////////////////////////////////////////////////////
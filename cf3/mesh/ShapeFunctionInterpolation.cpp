@@ -59,15 +59,20 @@ void ShapeFunctionInterpolation::compute_interpolation_weights(const RealVector&
 
   const SpaceElem& element = stencil[0];
 
-  RealMatrix element_coords = element.comp->support().geometry_space().get_coordinates(element.idx);
-  RealVector mapped_coord   = element.comp->support().element_type().mapped_coordinate(coordinate,element_coords);
-  RealVector sf_values = element.shape_function().value(mapped_coord);
+  const Space& geometry_space = element.comp->support().geometry_space();
+  const ElementType& element_type = element.comp->support().element_type();
+  geometry_space.allocate_coordinates(m_element_coords);
+  geometry_space.put_coordinates(m_element_coords,element.idx);
+  m_mapped_coord.resize(element_type.shape_function().dimensionality());
+  element_type.compute_mapped_coordinate(coordinate,m_element_coords,m_mapped_coord);
+  m_sf_values.resize(element.shape_function().nb_nodes());
+  element.shape_function().compute_value(m_mapped_coord,m_sf_values);
   source_field_points.resize(element.shape_function().nb_nodes());
   source_field_weights.resize(source_field_points.size());
   for (Uint n=0; n<source_field_points.size(); ++n)
   {
     source_field_points[n] = element.nodes()[n];
-    source_field_weights[n] = sf_values[n];
+    source_field_weights[n] = m_sf_values[n];
   }
 }
 
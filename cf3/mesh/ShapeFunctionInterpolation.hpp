@@ -33,6 +33,13 @@ public:
 
   virtual void compute_interpolation_weights(const RealVector& coordinate, const std::vector<SpaceElem>& stencil,
                                              std::vector<Uint>& source_field_points, std::vector<Real>& source_field_weights);
+
+private:
+
+  /// Work arrays, reused between calls to avoid allocations
+  RealMatrix m_element_coords;
+  RealVector m_mapped_coord;
+  RealRowVector m_sf_values;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
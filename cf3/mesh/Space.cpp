@@ -128,23 +128,74 @@ void Space::configure_shape_function()
     m_connectivity->set_row_size(m_shape_function->nb_nodes());
     m_connectivity->resize(m_support->size());
   }
+
+  // Interpolation from the geometry nodes, used by put_computed_coordinates()
+  m_geometry_interpolation.resize(0,0);
+  try
+  {
+    const ShapeFunction& geometry_sf = m_support->element_type().shape_function();
+    const RealMatrix& local_coordinates = m_shape_function->local_coordinates();
+    RealMatrix interpolation(m_shape_function->nb_nodes(),geometry_sf.nb_nodes());
+    for (Uint node=0; node<m_shape_function->nb_nodes(); ++node)
+    {
+      interpolation.row(node) = geometry_sf.value( local_coordinates.row(node) );
+    }
+    m_geometry_interpolation = interpolation;
+  }
+  catch (NotImplemented&)
+  {
+    // Some shape functions (e.g. points) can't be evaluated. put_computed_coordinates() reports this when used.
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 RealMatrix Space::compute_coordinates(const Uint elem_idx) const
 {
-  const ShapeFunction& space_sf       = shape_function();
-  const Entities&     geometry       = support();
-  const ElementType&   geometry_etype = geometry.element_type();
-  const ShapeFunction& geometry_sf    = geometry_etype.shape_function();
-  RealMatrix geometry_coordinates = geometry.geometry_space().get_coordinates(elem_idx);
-  RealMatrix space_coordinates(space_sf.nb_nodes(),geometry_etype.dimension());
-  for (Uint node=0; node<space_sf.nb_nodes(); ++node)
+  RealMatrix space_coordinates;
+  allocate_coordinates(space_coordinates);
+  put_computed_coordinates(space_coordinates,elem_idx);
+  return space_coordinates;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Space::put_computed_coordinates(RealMatrix& coordinates, const Uint elem_idx) const
+{
+  if (m_geometry_interpolation.size() == 0)
+    throw NotImplemented(FromHere(), "Coordinates of space "+uri().string()+" can't be interpolated from the geometry shape function");
+
+  const Space& geometry_space = support().geometry_space();
+  Connectivity::ConstRow geometry_nodes = geometry_space.connectivity()[elem_idx];
+  const Field& geometry_coordinates = geometry_space.dict().coordinates();
+
+  cf3_assert(m_geometry_interpolation.rows() == coordinates.rows());
+  cf3_assert(m_geometry_interpolation.cols() == geometry_nodes.size());
+  cf3_assert(coordinates.cols() == geometry_coordinates.row_size());
+
+  coordinates.setZero();
+  for (Uint g=0; g<m_geometry_interpolation.cols(); ++g)
   {
-    space_coordinates.row(node) = geometry_sf.value( space_sf.local_coordinates().row(node) ) * geometry_coordinates;
+    Field::ConstRow geometry_node = geometry_coordinates[geometry_nodes[g]];
+    for (Uint node=0; node<coordinates.rows(); ++node)
+    {
+      const Real weight = m_geometry_interpolation(node,g);
+      for (Uint j=0; j<coordinates.cols(); ++j)
+      {
+        coordinates(node,j) += weight * geometry_node[j];
+      }
+    }
   }
-  return space_coordinates;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Space::raw_coordinates(const Uint elem_idx, const Uint*& nodes, const Real*& coordinates, Uint& row_size) const
+{
+  const Field& coordinates_field = dict().coordinates();
+  nodes = connectivity().array()[elem_idx].origin();
+  coordinates = coordinates_field.array().data();
+  row_size = coordinates_field.row_size();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
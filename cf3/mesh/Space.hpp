@@ -9,6 +9,7 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "common/Assertions.hpp"
 #include "common/Table_fwd.hpp"
 
 #include "math/MatrixTypes.hpp"
@@ -143,6 +144,38 @@ public: // functions
   /// @param [out] coordinates element coordinates (nb_nodes x dimension)
   void put_coordinates(RealMatrix& coordinates, const Uint elem_idx) const;
 
+  /// @brief Lookup element coordinates into a matrix of any Eigen type
+  ///
+  /// With a fixed-size matrix, such as ElementTypeBase::NodesT of the element type,
+  /// looping over elements does not touch the heap at all.
+  /// @param [in]  elem_idx    element index
+  /// @param [out] coordinates element coordinates (nb_nodes x dimension)
+  template<typename MatrixT>
+  void put_coordinates(Eigen::MatrixBase<MatrixT>& coordinates, const Uint elem_idx) const
+  {
+    const Uint* nodes;
+    const Real* coordinates_data;
+    Uint coordinates_row_size;
+    raw_coordinates(elem_idx, nodes, coordinates_data, coordinates_row_size);
+    cf3_assert(coordinates.cols() == coordinates_row_size);
+    for (Uint i=0; i<coordinates.rows(); ++i)
+    {
+      const Real* node_coordinates = coordinates_data + nodes[i]*coordinates_row_size;
+      for (Uint j=0; j<coordinates.cols(); ++j)
+      {
+        coordinates(i,j) = node_coordinates[j];
+      }
+    }
+  }
+
+  /// @brief Compute element coordinates without allocating
+  ///
+  /// Same as compute_coordinates(), but in a matrix allocated by the caller with allocate_coordinates().
+  /// The interpolation from the geometry space is precomputed when the shape function is configured.
+  /// @param [out] coordinates element coordinates (nb_nodes x dimension)
+  /// @param [in]  elem_idx    element index
+  void put_computed_coordinates(RealMatrix& coordinates, const Uint elem_idx) const;
+
   /// @brief Allocate element coordinates
   ///
   /// Allocate a properly sized coordinates matrix. Can be used in conjunction with
@@ -159,8 +192,13 @@ private: // functions
   ///
   /// - Creates shape function
   /// - Resizes the connectivity table to the number of elements
+  /// - Computes the interpolation from the geometry space nodes
   void configure_shape_function();
 
+  /// Raw access to the connectivity row of an element and to the coordinates of the dictionary,
+  /// so the put_coordinates template does not need the full Table definitions
+  void raw_coordinates(const Uint elem_idx, const Uint*& nodes, const Real*& coordinates, Uint& row_size) const;
+
 private: // data
 
   /// Shape function of this space
@@ -176,6 +214,9 @@ private: // data
   Handle<Entities> m_support;
 
   Uint m_dict_idx; // friend class Mesh can assign this
+
+  /// Value of the geometry shape function in each node of this space (nb_nodes x nb_geometry_nodes)
+  RealMatrix m_geometry_interpolation;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -209,6 +250,8 @@ public:
   bool is_ghost() const;
   RealMatrix get_coordinates() const;
   void put_coordinates(RealMatrix& coordinates) const;
+  template<typename MatrixT>
+  void put_coordinates(Eigen::MatrixBase<MatrixT>& coordinates) const { comp->put_coordinates(coordinates,idx); }
   void allocate_coordinates(RealMatrix& coordinates) const;
   common::TableConstRow<Uint>::type nodes() const;
   //@}
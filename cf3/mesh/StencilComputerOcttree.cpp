@@ -71,8 +71,10 @@ void StencilComputerOcttree::configure_octtree()
 void StencilComputerOcttree::compute_stencil(const SpaceElem& element, std::vector<SpaceElem>& stencil)
 {
   cf3_assert(m_octtree);
-  RealMatrix coordinates = element.comp->support().geometry_space().get_coordinates(element.idx);
-  element.comp->support().element_type().compute_centroid(coordinates,m_centroid);
+  const Space& geometry_space = element.comp->support().geometry_space();
+  geometry_space.allocate_coordinates(m_coordinates);
+  geometry_space.put_coordinates(m_coordinates,element.idx);
+  element.comp->support().element_type().compute_centroid(m_coordinates,m_centroid);
   m_stencil.resize(0);
   if (m_octtree->find_octtree_cell(m_centroid,m_octtree_cell))
   {
@@ -49,6 +49,7 @@ private: // data
 
   std::vector<Uint> m_octtree_cell;
   RealVector m_centroid;
+  RealMatrix m_coordinates;
 
   std::vector<Entity> m_stencil;
 
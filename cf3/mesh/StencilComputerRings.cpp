@@ -4,7 +4,7 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
-#include <set>
+#include <algorithm>
 
 #include <boost/tuple/tuple.hpp>
 #include <boost/bind.hpp>
@@ -13,6 +13,10 @@
 #include "common/Foreach.hpp"
 #include "common/Log.hpp"
 #include "common/Builder.hpp"
+#include "common/Core.hpp"
+#include "common/DynTable.hpp"
+#include "common/List.hpp"
+#include "common/ThreadPool.hpp"
 #include "common/FindComponents.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
@@ -40,44 +44,270 @@ cf3::common::ComponentBuilder < StencilComputerRings, StencilComputer, LibMesh >
 
 //////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+  /// Grows the rings around a range of elements with a breadth-first search over the element adjacency.
+  /// Visited elements are marked in the stamp buffer of the thread, shared by all its ranges.
+  /// Without a stencil table, only the stencil sizes are computed. With one, the stencils are written sorted by global index.
+  struct RingSearch
+  {
+    RingSearch(const std::vector<Uint>& adjacency_offsets, const std::vector<Uint>& adjacency, const std::vector<Uint>& glb_idx, const Uint nb_rings,
+               std::vector<StampBuffer>& buffers, std::vector<Uint>& stencil_offsets, std::vector<Uint>* stencil) :
+      m_adjacency_offsets(adjacency_offsets), m_adjacency(adjacency), m_glb_idx(glb_idx), m_nb_rings(nb_rings),
+      m_buffers(buffers), m_stencil_offsets(stencil_offsets), m_stencil(stencil)
+    {
+    }
+
+    /// Orders elements by global index, and by position in the numbering for equal global indices
+    struct GlbIdxLess
+    {
+      GlbIdxLess(const std::vector<Uint>& glb_idx) : m_glb_idx(glb_idx) {}
+      bool operator()(const Uint a, const Uint b) const
+      {
+        return m_glb_idx[a] < m_glb_idx[b] || (m_glb_idx[a] == m_glb_idx[b] && a < b);
+      }
+      const std::vector<Uint>& m_glb_idx;
+    };
+
+    void operator()(const Uint range_begin, const Uint range_end) const
+    {
+      StampBuffer& buffer = m_buffers[Core::instance().thread_pool().current_worker()];
+      if(buffer.stamps.empty())
+        buffer.stamps.assign(m_glb_idx.size(), 0);
+      std::vector<Uint>& stamps = buffer.stamps;
+
+      std::vector<Uint> found;
+      for(Uint elem = range_begin; elem != range_end; ++elem)
+      {
+        const Uint stamp = buffer.next_stamp();
+        found.clear();
+        found.push_back(elem);
+        stamps[elem] = stamp;
+        Uint ring_begin = 0;
+        for(Uint ring = 0; ring != m_nb_rings && ring_begin != found.size(); ++ring)
+        {
+          const Uint ring_end = found.size();
+          for(Uint i = ring_begin; i != ring_end; ++i)
+          {
+            const Uint current = found[i];
+            for(Uint k = m_adjacency_offsets[current]; k != m_adjacency_offsets[current+1]; ++k)
+            {
+              const Uint neighbor = m_adjacency[k];
+              if(stamps[neighbor] != stamp)
+              {
+                stamps[neighbor] = stamp;
+                found.push_back(neighbor);
+              }
+            }
+          }
+          ring_begin = ring_end;
+        }
+
+        if(is_null(m_stencil))
+        {
+          m_stencil_offsets[elem+1] = found.size();
+        }
+        else
+        {
+          std::sort(found.begin(), found.end(), GlbIdxLess(m_glb_idx));
+          std::copy(found.begin(), found.end(), m_stencil->begin() + m_stencil_offsets[elem]);
+        }
+      }
+    }
+
+    const std::vector<Uint>& m_adjacency_offsets;
+    const std::vector<Uint>& m_adjacency;
+    const std::vector<Uint>& m_glb_idx;
+    const Uint m_nb_rings;
+    std::vector<StampBuffer>& m_buffers;
+    std::vector<Uint>& m_stencil_offsets;
+    std::vector<Uint>* m_stencil;
+  };
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 StencilComputerRings::StencilComputerRings( const std::string& name )
-  : StencilComputer(name), m_nb_rings(0)
+  : StencilComputer(name), m_nb_rings(0), m_threaded(true), m_stencils_built(false), m_mesh_revision(0)
 {
   options().add("nb_rings", m_nb_rings)
       .description("Number of neighboring rings of elements in stencil")
       .pretty_name("Number of Rings")
-      .link_to(&m_nb_rings);
+      .link_to(&m_nb_rings)
+      .attach_trigger( boost::bind( &StencilComputerRings::invalidate_stencils, this ) );
+
+  options().add("threaded", m_threaded)
+      .description("Build the stencils of all elements using the thread pool")
+      .pretty_name("Threaded")
+      .link_to(&m_threaded);
+
+  options().option("dict").attach_trigger( boost::bind( &StencilComputerRings::invalidate_stencils, this ) );
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 void StencilComputerRings::compute_stencil(const SpaceElem& element, std::vector<SpaceElem>& stencil)
 {
-  std::set<SpaceElem> included;
-  compute_neighbors(included,element);
+  // Rebuild if the structures of the mesh were updated since the last build
+  if (!m_stencils_built || m_space_index.count(element.comp) == 0 ||
+      (is_not_null(m_mesh) && m_mesh->revision() != m_mesh_revision))
+    build_stencils();
+
+  const Uint elem = element_index(element);
+  const Uint stencil_size = m_stencil_offsets[elem+1] - m_stencil_offsets[elem];
+
+  if (stencil_size < m_min_stencil_size)
+    CFwarn << "stencil size computed for element " << element << " is " << stencil_size <<". This is smaller than the requested " << m_min_stencil_size << "." << CFendl;
+
+  stencil.clear(); stencil.reserve(stencil_size);
+  for (Uint k=m_stencil_offsets[elem]; k!=m_stencil_offsets[elem+1]; ++k)
+    stencil.push_back(space_elem(m_stencil[k]));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void StencilComputerRings::build_stencils()
+{
+  if (is_null(m_dict))
+    throw SetupError(FromHere(), "Option \"dict\" is not configured in "+uri().string());
+
+  m_mesh = find_parent_component_ptr<Mesh>(*m_dict);
+  m_mesh_revision = is_not_null(m_mesh) ? m_mesh->revision() : 0u;
+
+  number_elements();
+  build_adjacency();
+
+  const Uint nb_elems = m_glb_idx.size();
+  m_stencil_offsets.assign(nb_elems+1, 0);
+  m_stencil.clear();
+
+  // First count, then fill the stencils, so they can be written in place
+  ThreadPool& pool = Core::instance().thread_pool();
+  std::vector<detail::StampBuffer> buffers(pool.nb_threads()+1);
+  const detail::RingSearch count(m_adjacency_offsets, m_adjacency, m_glb_idx, m_nb_rings, buffers, m_stencil_offsets, 0);
+  if (m_threaded)
+    pool.parallel_for(0, nb_elems, count);
+  else
+    count(0, nb_elems);
+
+  for (Uint elem=0; elem!=nb_elems; ++elem)
+    m_stencil_offsets[elem+1] += m_stencil_offsets[elem];
+  m_stencil.resize(m_stencil_offsets.back());
+
+  const detail::RingSearch fill(m_adjacency_offsets, m_adjacency, m_glb_idx, m_nb_rings, buffers, m_stencil_offsets, &m_stencil);
+  if (m_threaded)
+    pool.parallel_for(0, nb_elems, fill);
+  else
+    fill(0, nb_elems);
+
+  m_stencils_built = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint StencilComputerRings::element_index(const SpaceElem& element) const
+{
+  std::map<const Space*, Uint>::const_iterator it = m_space_index.find(element.comp);
+  cf3_assert(it != m_space_index.end());
+  return m_space_offsets[it->second] + element.idx;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SpaceElem StencilComputerRings::space_elem(const Uint element_index) const
+{
+  const Uint space_idx = std::upper_bound(m_space_offsets.begin(), m_space_offsets.end(), element_index) - m_space_offsets.begin() - 1;
+  return SpaceElem(*m_spaces[space_idx], element_index - m_space_offsets[space_idx]);
+}
 
-  if (included.size() < m_min_stencil_size)
-    CFwarn << "stencil size computed for element " << element << " is " << included.size() <<". This is smaller than the requested " << m_min_stencil_size << "." << CFendl;
+////////////////////////////////////////////////////////////////////////////////
 
-  stencil.clear(); stencil.reserve(included.size());
-  boost_foreach (const SpaceElem& elem, included)
-    stencil.push_back(elem);
+void StencilComputerRings::invalidate_stencils()
+{
+  m_stencils_built = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void StencilComputerRings::compute_neighbors(std::set<SpaceElem>& included, const SpaceElem& element, const Uint level)
+void StencilComputerRings::number_elements()
 {
-  included.insert(element);
+  m_spaces.clear();
+  m_space_offsets.clear();
+  m_space_index.clear();
+  m_glb_idx.clear();
+
+  boost_foreach(const Handle<Space>& space, m_dict->spaces())
+  {
+    m_space_index[space.get()] = m_spaces.size();
+    m_spaces.push_back(space);
+    m_space_offsets.push_back(m_glb_idx.size());
+    const common::List<Uint>& glb_idx = space->support().glb_idx();
+    for (Uint e=0; e!=space->size(); ++e)
+      m_glb_idx.push_back(glb_idx[e]);
+  }
+
+  if (m_spaces.empty())
+    throw SetupError(FromHere(), "Dictionary "+m_dict->uri().string()+" has no spaces");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void StencilComputerRings::build_adjacency()
+{
+  const Uint nb_elems = m_glb_idx.size();
+  const common::DynTable<SpaceElem>& node_to_elem = m_dict->connectivity();
+
+  m_adjacency_offsets.assign(nb_elems+1, 0);
+  m_adjacency.clear();
+
+  // The geometry adjacency is the node dual graph cached by the mesh, renumbered to the spaces of the dictionary
+  if (is_not_null(m_mesh) && m_dict == m_mesh->geometry_fields().handle<Dictionary>())
+  {
+    const DualGraph& graph = m_mesh->dual_graph(DualGraph::NODE_NEIGHBORS);
+    std::vector<Uint> graph_to_stencil(graph.size());
+    for (Uint space_idx=0; space_idx!=m_spaces.size(); ++space_idx)
+    {
+      const Uint entities_idx = m_spaces[space_idx]->support().entities_idx();
+      for (Uint e=0; e!=m_spaces[space_idx]->size(); ++e)
+        graph_to_stencil[graph.element_index(entities_idx,e)] = m_space_offsets[space_idx] + e;
+    }
+
+    m_adjacency.reserve(graph.neighbors().size());
+    for (Uint space_idx=0; space_idx!=m_spaces.size(); ++space_idx)
+    {
+      const Uint entities_idx = m_spaces[space_idx]->support().entities_idx();
+      for (Uint e=0; e!=m_spaces[space_idx]->size(); ++e)
+      {
+        const Uint graph_elem = graph.element_index(entities_idx,e);
+        for (Uint k=graph.offsets()[graph_elem]; k!=graph.offsets()[graph_elem+1]; ++k)
+          m_adjacency.push_back(graph_to_stencil[graph.neighbors()[k]]);
+        m_adjacency_offsets[m_space_offsets[space_idx] + e + 1] = m_adjacency.size();
+      }
+    }
+    return;
+  }
 
-  if (level < m_nb_rings)
+  std::vector<Uint> stamps(nb_elems, 0);
+  for (Uint space_idx=0; space_idx!=m_spaces.size(); ++space_idx)
   {
-    boost_foreach(Uint node_idx, element.nodes())
+    const Connectivity& connectivity = m_spaces[space_idx]->connectivity();
+    for (Uint e=0; e!=connectivity.size(); ++e)
     {
-      boost_foreach(const SpaceElem& neighbor_elem, m_dict->connectivity()[node_idx])
+      const Uint elem = m_space_offsets[space_idx] + e;
+      stamps[elem] = elem+1;
+      boost_foreach(const Uint node_idx, connectivity[e])
       {
-        compute_neighbors(included,neighbor_elem,level+1);
+        boost_foreach(const SpaceElem& neighbor_elem, node_to_elem[node_idx])
+        {
+          const Uint neighbor = element_index(neighbor_elem);
+          if (stamps[neighbor] != elem+1)
+          {
+            stamps[neighbor] = elem+1;
+            m_adjacency.push_back(neighbor);
+          }
+        }
       }
+      m_adjacency_offsets[elem+1] = m_adjacency.size();
     }
   }
 }
@@ -9,7 +9,7 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
-#include <set>
+#include <map>
 #include "mesh/StencilComputer.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -17,9 +17,17 @@
 namespace cf3 {
 namespace mesh {
 
+  class Mesh;
+  class Space;
+
 //////////////////////////////////////////////////////////////////////////////
 
 /// @brief Compute the stencil around an element, consisting of rings of neighboring cells
+///
+/// The stencils of all elements of the dictionary are built at once, on first use, and kept
+/// in a compact CSR table until the dictionary or the number of rings changes, or the structures
+/// of the mesh are updated (see Mesh::revision()), e.g. by Mesh::raise_mesh_changed().
+/// Elements are numbered consecutively over the spaces of the dictionary.
 /// @author Willem Deconinck
 class Mesh_API StencilComputerRings : public StencilComputer {
 
@@ -32,14 +40,62 @@ public: // functions
 
   virtual void compute_stencil(const SpaceElem& element, std::vector<SpaceElem>& stencil);
 
+  /// Build the element adjacency and the stencils of all elements
+  void build_stencils();
+
+  /// Stencil of element i is stencil()[stencil_offsets()[i]] up to stencil()[stencil_offsets()[i+1]]
+  const std::vector<Uint>& stencil_offsets() const { return m_stencil_offsets; }
+
+  /// Concatenated stencils, in the consecutive element numbering
+  const std::vector<Uint>& stencil() const { return m_stencil; }
+
+  /// Index of an element in the consecutive numbering
+  Uint element_index(const SpaceElem& element) const;
+
+  /// Element corresponding to an index in the consecutive numbering
+  SpaceElem space_elem(const Uint element_index) const;
+
 private: // functions
 
-  void compute_neighbors(std::set<SpaceElem>& included, const SpaceElem& element, const Uint level=0);
+  /// Discard the stencils, so they are rebuilt on the next use
+  void invalidate_stencils();
+
+  /// Number the elements of all spaces consecutively
+  void number_elements();
+
+  /// Element-to-element adjacency through shared nodes
+  void build_adjacency();
 
 private: // data
   
   Uint m_nb_rings;
-  
+
+  /// Build the stencils using the thread pool
+  bool m_threaded;
+
+  /// True if the stencils are up to date
+  bool m_stencils_built;
+
+  /// Mesh of the dictionary, and its revision when the stencils were built
+  Handle<Mesh> m_mesh;
+  Uint m_mesh_revision;
+
+  /// Spaces of the dictionary, and the index of their first element in the consecutive numbering
+  std::vector< Handle<Space> > m_spaces;
+  std::vector<Uint> m_space_offsets;
+  std::map<const Space*, Uint> m_space_index;
+
+  /// Global index of each element, to order the stencils like before
+  std::vector<Uint> m_glb_idx;
+
+  /// CSR element adjacency, without the element itself
+  std::vector<Uint> m_adjacency_offsets;
+  std::vector<Uint> m_adjacency;
+
+  /// CSR stencil table
+  std::vector<Uint> m_stencil_offsets;
+  std::vector<Uint> m_stencil;
+
 }; // end StencilComputerRings
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -20,6 +20,7 @@ const char * Tags::topology ()     { return "topology"; }
 const char * Tags::coordinates ()  { return "coordinates"; }
 const char * Tags::nodes ()        { return "nodes"; }
 const char * Tags::nodes_used ()   { return "nodes_used"; }
+const char * Tags::overlap_depth () { return "overlap_depth"; }
 
 const char * Tags::global_indices ()  { return "global_indices"; }
 const char * Tags::map_global_to_local ()  { return "map_global_to_local"; }
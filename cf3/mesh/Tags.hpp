@@ -31,6 +31,7 @@ public:
   static const char * coordinates ();
   static const char * nodes ();
   static const char * nodes_used ();
+  static const char * overlap_depth ();
 
   static const char * global_indices ();
   static const char * map_global_to_local ();
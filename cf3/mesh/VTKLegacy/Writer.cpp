@@ -4,6 +4,7 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <iostream>
 
 #include <boost/assign/list_of.hpp>
@@ -56,6 +57,74 @@ std::vector<std::string> Writer::get_extensions()
 
 /////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+
+/// True if the machine stores the least significant byte first
+bool is_little_endian()
+{
+  const int one = 1;
+  return *reinterpret_cast<const char*>(&one) == 1;
+}
+
+/// Write a block of values. In ASCII mode, values_per_line values are put on each line. In binary mode, the values are
+/// converted to big endian in-place and written at once, as required by the legacy VTK format.
+template<typename T>
+void write_block(std::ostream& file, std::vector<T>& values, const Uint values_per_line, const bool binary)
+{
+  if(values.empty())
+    return;
+
+  const Uint nb_values = values.size();
+  if(binary)
+  {
+    if(is_little_endian())
+    {
+      char* bytes = reinterpret_cast<char*>(&values[0]);
+      for(Uint i = 0; i != nb_values; ++i)
+        std::reverse(bytes + i*sizeof(T), bytes + (i+1)*sizeof(T));
+    }
+    file.write(reinterpret_cast<const char*>(&values[0]), nb_values*sizeof(T));
+    return;
+  }
+
+  for(Uint i = 0; i != nb_values; ++i)
+  {
+    file << " " << values[i];
+    if((i+1) % values_per_line == 0)
+      file << "\n";
+  }
+}
+
+/// Binary data must be followed by a newline before the next keyword. ASCII lines already end with one.
+void end_block(std::ostream& file, const bool binary)
+{
+  if(binary)
+    file << "\n";
+}
+
+/// Write the variable of length var_length starting at var_begin in every row of the table.
+/// 2D vectors get a zero third component.
+template<typename T>
+void write_variable(std::ostream& file, const common::Table<Real>& table, const Uint var_begin, const Uint var_length, const bool binary)
+{
+  const Uint nb_rows = table.size();
+  const Uint out_length = var_length == 2 ? 3 : var_length;
+  std::vector<T> values(nb_rows*out_length, T(0));
+  for(Uint i = 0; i != nb_rows; ++i)
+  {
+    const common::Table<Real>::ConstRow row = table[i];
+    for(Uint j = 0; j != var_length; ++j)
+      values[i*out_length+j] = static_cast<T>(row[var_begin+j]);
+  }
+  write_block(file, values, out_length, binary);
+  end_block(file, binary);
+}
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 void Writer::write()
 {
   // if the file is present open it
@@ -66,7 +135,7 @@ void Writer::write()
     path = boost::filesystem::basename(path) + "_P" + to_str(PE::Comm::instance().rank()) + boost::filesystem::extension(path);
   }
 
-  file.open(path,std::ios_base::out);
+  file.open(path, m_binary ? std::ios_base::out | std::ios_base::binary : std::ios_base::out);
   if (!file) // didn't open so throw exception
   {
      throw boost::filesystem::filesystem_error( path.string() + " failed to open",
@@ -76,7 +145,7 @@ void Writer::write()
   file
     << "# vtk DataFile Version 2.0\n"
     << "Exported by COOLFLuiD\n"
-    << "ASCII\n"
+    << (m_binary ? "BINARY\n" : "ASCII\n")
     << "DATASET UNSTRUCTURED_GRID\n";
 
   const Field& coords = m_mesh->geometry_fields().coordinates();
@@ -85,14 +154,7 @@ void Writer::write()
 
   // Output point coordinates
   file << "POINTS " << npoints << " double\n";
-  for(Uint i = 0; i != npoints; ++i)
-  {
-    const Field::ConstRow row = coords[i];
-    for(Uint j = 0; j != dim; ++j)
-      file << " " << row[j];
-    if(dim == 2) file << " " << 0.;
-    file << "\n";
-  }
+  detail::write_variable<double>(file, coords, 0, dim, m_binary);
 
   // map for element types
   std::map<GeoShape::Type,int> etype_map = boost::assign::map_list_of
@@ -113,8 +175,9 @@ void Writer::write()
     }
   }
 
-  // Output connectivity data
+  // Output connectivity data, one block per element type, each row starting with the number of nodes
   file << "\nCELLS " << nb_elems << " " << nb_nodes << "\n";
+  std::vector<int> cells;
   boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
   {
     if(elements.element_type().dimensionality() == dim && elements.element_type().order() == 1 && etype_map.count(elements.element_type().shape()))
@@ -122,29 +185,31 @@ void Writer::write()
       const Uint n_elems = elements.size();
       const Connectivity& conn_table = elements.geometry_space().connectivity();
       const Uint n_el_nodes = elements.element_type().nb_nodes();
+      cells.resize(n_elems*(n_el_nodes+1));
+      std::vector<int>::iterator cell = cells.begin();
       for(Uint i = 0; i != n_elems; ++i)
       {
-        file << " " << n_el_nodes;
+        *cell++ = n_el_nodes;
         const Connectivity::ConstRow row = conn_table[i];
         for(Uint j = 0; j != n_el_nodes; ++j)
-          file << " " << row[j];
-        file << "\n";
+          *cell++ = row[j];
       }
+      detail::write_block(file, cells, n_el_nodes+1, m_binary);
     }
   }
+  detail::end_block(file, m_binary);
 
   // Output element types
   file << "\nCELL_TYPES " << nb_elems << "\n";
+  std::vector<int> cell_types;
+  cell_types.reserve(nb_elems);
   boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
   {
     if(elements.element_type().dimensionality() == dim && elements.element_type().order() == 1 && etype_map.count(elements.element_type().shape()))
-    {
-      const int vtk_e_type = etype_map[elements.element_type().shape()];
-      const Uint n_elems = elements.size();
-      for(Uint i = 0; i != n_elems; ++i)
-        file << " " << vtk_e_type << "\n";
-    }
+      cell_types.resize(cell_types.size() + elements.size(), etype_map[elements.element_type().shape()]);
   }
+  detail::write_block(file, cell_types, 1, m_binary);
+  detail::end_block(file, m_binary);
 
   // Output point fields TODO: support cell-centered data
   if(!m_fields.empty())
@@ -162,29 +227,33 @@ void Writer::write()
     if(field.size() != npoints)
       continue;
 
+    const bool single = single_precision(field);
+    const std::string data_type = single ? "float" : "double";
+
     for(Uint var_idx = 0; var_idx != field.nb_vars(); ++var_idx)
     {
       const std::string var_name = field.var_name(var_idx);
       const Uint var_begin = field.var_offset(var_name);
+      Uint var_length = 0;
       if(field.var_length(var_idx) == SCALAR)
       {
-        file << "SCALARS " << var_name << " double\nLOOKUP_TABLE default\n";
-        for(Uint i = 0; i != npoints; ++i)
-          file << " " << field[i][var_begin] << "\n";
+        file << "SCALARS " << var_name << " " << data_type << "\nLOOKUP_TABLE default\n";
+        var_length = 1;
       }
       else if(static_cast<Uint>(field.var_length(var_idx)) == dim)
       {
-        file << "VECTORS " << var_name << " double\n";
-        const Uint var_end = var_begin+dim;
-        for(Uint i = 0; i != npoints; ++i)
-        {
-          const Field::ConstRow row = field[i];
-          for(Uint j = var_begin; j != var_end; ++j)
-            file << " " << field[i][j];
-          if(dim == 2) file << " " << 0.;
-          file << "\n";
-        }
+        file << "VECTORS " << var_name << " " << data_type << "\n";
+        var_length = dim;
       }
+      else
+      {
+        continue;
+      }
+
+      if(single)
+        detail::write_variable<float>(file, field, var_begin, var_length, m_binary);
+      else
+        detail::write_variable<double>(file, field, var_begin, var_length, m_binary);
     }
   }
 
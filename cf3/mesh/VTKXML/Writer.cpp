@@ -137,6 +137,15 @@ namespace detail
       m_current_block.write(reinterpret_cast<const char*>(&value), m_wordsize);
     }
 
+    /// Append a floating point value, converted to the word size of the current array
+    void push_back_real(const Real value)
+    {
+      if(m_wordsize == sizeof(float))
+        push_back(static_cast<float>(value));
+      else
+        push_back(value);
+    }
+
     // Offset to put in the VTK XML (= offset after the _)
     Uint offset()
     {
@@ -381,13 +390,14 @@ void Writer::write()
         ? point_data.add_node("DataArray")
         : cell_data.add_node("DataArray");
 
-      data_array.set_attribute("type", sizeof(Real) == 4 ? "Float32" : "Float64");
+      const Uint wordsize = single_precision(field) ? sizeof(float) : sizeof(Real);
+      data_array.set_attribute("type", wordsize == 4 ? "Float32" : "Float64");
       data_array.set_attribute("NumberOfComponents", to_str(var_size == 2 && dim == 2 ? 3 : var_size));
       data_array.set_attribute("Name", var_name);
       data_array.set_attribute("format", "appended");
       data_array.set_attribute("offset", to_str(appended_data.offset()));
 
-      appended_data.start_array(field_size*(var_size == 2 && dim == 2 ? 3 : var_size), sizeof(Real));
+      appended_data.start_array(field_size*(var_size == 2 && dim == 2 ? 3 : var_size), wordsize);
 
       if(field.continuous())
       {
@@ -397,16 +407,16 @@ void Writer::write()
           {
             for(Uint j = var_begin; j != var_end; ++j)
             {
-              appended_data.push_back(field[i][j]);
+              appended_data.push_back_real(field[i][j]);
             }
-            appended_data.push_back(0.);
+            appended_data.push_back_real(0.);
           }
         }
         else
         {
           for(Uint i = 0; i != field_size; ++i)
             for(Uint j = var_begin; j != var_end; ++j)
-              appended_data.push_back(field[i][j]);
+              appended_data.push_back_real(field[i][j]);
         }
       }
       else
@@ -424,9 +434,9 @@ void Writer::write()
                 for(Uint j = var_begin; j != var_end; ++j)
                 {
                   /// @bug the field values of the space should be interpolated to the cell-centre, similar to the tecplot writer
-                  appended_data.push_back(field[field_connectivity[i][0]][j]);
+                  appended_data.push_back_real(field[field_connectivity[i][0]][j]);
                 }
-                appended_data.push_back(0.);
+                appended_data.push_back_real(0.);
               }
             }
             else
@@ -436,7 +446,7 @@ void Writer::write()
                 for(Uint j = var_begin; j != var_end; ++j)
                 {
                   /// @bug the field values of the space should be interpolated to the cell-centre, similar to the tecplot writer
-                  appended_data.push_back(field[field_connectivity[i][0]][j]);
+                  appended_data.push_back_real(field[field_connectivity[i][0]][j]);
                 }
               }
             }
@@ -75,6 +75,14 @@ WriteMesh::WriteMesh ( const std::string& name  ) :
       .mark_basic()
       .link_to(&m_fields);
 
+  m_binary = false;
+  m_binary_configured = false;
+  options().add("binary", m_binary)
+      .description("Write binary files, for the formats that support it. If not configured, the writer keeps its own setting.")
+      .pretty_name("Binary")
+      .link_to(&m_binary)
+      .attach_trigger(boost::bind(&WriteMesh::config_binary, this));
+
 
   // signals
 
@@ -112,7 +120,8 @@ void WriteMesh::update_list_of_available_writers()
     ("cf3.mesh.neu.Writer")
     ("cf3.mesh.tecplot.Writer")
     ("cf3.mesh.VTKLegacy.Writer")
-    ("cf3.mesh.VTKXML.Writer");
+    ("cf3.mesh.VTKXML.Writer")
+    ("cf3.mesh.native.Writer");
 
   boost_foreach(const std::string& writer_name, known_writers)
   {
@@ -236,12 +245,21 @@ void WriteMesh::write_mesh( const Mesh& mesh, const URI& file, const std::vector
   writer->options().set("fields",fields);
   writer->options().set("mesh",mesh.handle<Mesh>());
   writer->options().set("file", filepath);
+  if (m_binary_configured)
+    writer->options().set("binary", m_binary);
 
   writer->execute();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void WriteMesh::config_binary()
+{
+  m_binary_configured = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void WriteMesh::signal_write_mesh ( common::SignalArgs& node )
 {
   SignalOptions options( node );
@@ -67,6 +67,9 @@ protected: // helper functions
   /// updates the list of avialable readers and regists each one to the extension it supports
   void update_list_of_available_writers();
 
+  /// Marks the binary option as configured, so that it overrides the option of the writers
+  void config_binary();
+
 private: // data
 
   std::map<std::string,std::vector<Handle< mesh::MeshWriter > > > m_extensions_to_writers;
@@ -74,6 +77,8 @@ private: // data
   Handle<Mesh> m_mesh;
   common::URI m_file;
   std::vector<common::URI> m_fields;
+  bool m_binary;
+  bool m_binary_configured; ///< true once the binary option was set
 
 };
 
@@ -70,6 +70,9 @@ CreateField::CreateField( const std::string& name )
       .description("Functions to create of form 'var_1=func_var1 , var2_a=func_var2_a , var2_b=func_var2_b , var3=func_var3'")
       .mark_basic();
 
+  options().add("single_precision",false)
+      .description("Write the new field in single precision to output and checkpoint files");
+
   regist_signal ( "create_field" )
       .description( "Create a field in a given dictionary" )
       .pretty_name("Create Field" )
@@ -117,7 +120,8 @@ void CreateField::execute()
 
   std::vector<std::string> functions_str = options().value< std::vector<std::string> >("functions");
 
-  create_field(options().value<std::string>("name"),*dict,functions_str);
+  Handle<Field> field = create_field(options().value<std::string>("name"),*dict,functions_str);
+  field->set_single_precision(options().value<bool>("single_precision"));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -20,6 +20,7 @@
 
 #include "common/PE/Comm.hpp"
 #include "common/PE/debug.hpp"
+#include "common/PE/DistributedDirectory.hpp"
 
 #include "mesh/actions/GlobalConnectivity.hpp"
 #include "mesh/Region.hpp"
@@ -81,21 +82,14 @@ void GlobalConnectivity::execute()
   // Assert at compile time
   //BOOST_STATIC_ASSERT(sizeof(std::size_t) == sizeof(Uint));
 
-  // 1) make std::map<glb_node_idx,loc_node_idx>
-  // 2) Make node2elem connectivity (does not contain elements from other partitions)
-  // 3) foreach ghostnode, store connected owned elements
-  // 4) broadcast (3) to all, and store the map node to ghost elements
-  // 5) create the node to glb_elem_connectivity, as the combination of (2) and (4)
+  // 1) Make node2elem connectivity (does not contain elements from other partitions)
+  // 2) foreach ghostnode, store connected owned elements
+  // 3) insert (2) in a distributed directory, and look up the elements other ranks connect to each node
+  // 4) create the node to glb_elem_connectivity, as the combination of (1) and (3)
 
 
 
   //1)
-  std::map<Uint,Uint> node_glb2loc;
-  Uint loc_node_idx(0);
-  boost_foreach(Uint glb_node_idx, nodes_glb_idx.array())
-    node_glb2loc[glb_node_idx]=loc_node_idx++;
-
-  //2)
   Handle<Component> node2elem_handle = mesh.geometry_fields().get_child("node2elem");
   if (node2elem_handle)
     mesh.geometry_fields().remove_component("node2elem");
@@ -105,7 +99,7 @@ void GlobalConnectivity::execute()
   node2elem.setup(mesh.topology());
 
 
-  // 3)
+  // 2)
   Uint nb_ghost(0);
   for (Uint i=0; i<nodes.size(); ++i)
     if (nodes.is_ghost(i))
@@ -137,55 +131,28 @@ void GlobalConnectivity::execute()
     }
   }
 
-  // 4)
-  std::vector<std::vector<Uint> > glb_elem_connectivity(nodes.size());
-  nodes_glb_idx.resize(mesh.geometry_fields().size());
-
-  for (Uint root=0; root<PE::Comm::instance().size(); ++root)
-  {
-    std::vector<Uint> rcv_glb_node_idx(0);//ghostnode_glb_idx.size());
-    PE::Comm::instance().broadcast(ghostnode_glb_idx,rcv_glb_node_idx,root);
-    std::vector<Uint> rcv_glb_elem_connectivity(0);//ghostnode_glb_elem_connectivity.size());
-    PE::Comm::instance().broadcast(ghostnode_glb_elem_connectivity,rcv_glb_elem_connectivity,root);
-    std::vector<Uint> rcv_glb_elem_connectivity_start(0);//ghostnode_glb_elem_connectivity_start.size());
-    PE::Comm::instance().broadcast(ghostnode_glb_elem_connectivity_start,rcv_glb_elem_connectivity_start,root);
-
-    if (PE::Comm::instance().rank() != root)
-    {
-      for (Uint p=0; p<PE::Comm::instance().size(); ++p)
-      {
-        if (p == PE::Comm::instance().rank())
-        {
-          Uint rcv_idx(0);
-          boost_foreach(const std::size_t glb_node, rcv_glb_node_idx)
-          {
-            if (node_glb2loc.find(glb_node) != node_glb2loc.end())
-            {
-              //std::cout << "["<<PE::Comm::instance().rank() << "] owns ghostnode " << glb_node << " of [" << root << "]" << std::endl;
-              Uint loc_node_idx = node_glb2loc[glb_node];
-              for(Uint l=rcv_glb_elem_connectivity_start[rcv_idx]; l<rcv_glb_elem_connectivity_start[rcv_idx+1]; ++l)
-                glb_elem_connectivity[loc_node_idx].push_back(rcv_glb_elem_connectivity[l]);
-            }
-            ++rcv_idx;
-          }
-          break;
-        }
-      }
-    }
-  }
+  // 3)
+  std::vector<boost::uint64_t> ghostnode_keys(ghostnode_glb_idx.begin(),ghostnode_glb_idx.end());
+  PE::DistributedDirectory directory;
+  directory.insert(ghostnode_keys,ghostnode_glb_elem_connectivity,ghostnode_glb_elem_connectivity_start);
 
+  std::vector<boost::uint64_t> node_keys(nodes_glb_idx.array().begin(),nodes_glb_idx.array().end());
+  std::vector<Uint> rcv_glb_elem_connectivity;
+  std::vector<Uint> rcv_glb_elem_connectivity_start;
+  directory.find_payloads(node_keys,rcv_glb_elem_connectivity,rcv_glb_elem_connectivity_start);
 
+  // 4)
   DynTable<Uint>& nodes_glb_elem_connectivity = mesh.geometry_fields().glb_elem_connectivity();
 //  CFinfo << "nodes_glb_elem_connectivity = " << nodes_glb_elem_connectivity.uri() << CFendl;
-  nodes_glb_elem_connectivity.resize(glb_elem_connectivity.size());
-  for (Uint i=0; i<glb_elem_connectivity.size(); ++i)
+  nodes_glb_elem_connectivity.resize(nodes.size());
+  for (Uint i=0; i<nodes.size(); ++i)
   {
 //    CFinfo << "i = " << i << CFendl;
     cf3_assert(i<node2elem.connectivity().size());
     DynTable<Uint>::ConstRow elems = node2elem.connectivity()[i];
     cf3_assert(i<nodes_glb_elem_connectivity.size());
-    cf3_assert(i<glb_elem_connectivity.size());
-    nodes_glb_elem_connectivity[i].resize(glb_elem_connectivity[i].size() + elems.size());
+    const Uint nb_rcv_elems = rcv_glb_elem_connectivity_start[i+1] - rcv_glb_elem_connectivity_start[i];
+    nodes_glb_elem_connectivity[i].resize(nb_rcv_elems + elems.size());
     cnt = 0;
     boost_foreach(const Uint e, elems)
     {
@@ -194,10 +161,10 @@ void GlobalConnectivity::execute()
       cf3_assert(elem_idx < Handle<Elements>(elem_comp)->glb_idx().size());
       nodes_glb_elem_connectivity[i][cnt++] = Handle<Elements>(elem_comp)->glb_idx()[elem_idx];
     }
-    for (Uint j=0; j<glb_elem_connectivity[i].size(); ++j)
+    for (Uint j=rcv_glb_elem_connectivity_start[i]; j<rcv_glb_elem_connectivity_start[i+1]; ++j)
     {
       cf3_assert(cnt < nodes_glb_elem_connectivity[i].size());
-      nodes_glb_elem_connectivity[i][cnt++] = glb_elem_connectivity[i][j];
+      nodes_glb_elem_connectivity[i][cnt++] = rcv_glb_elem_connectivity[j];
     }
 
   }
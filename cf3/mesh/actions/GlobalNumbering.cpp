@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+#include <limits>
 #include <set>
 
 #include "common/Log.hpp"
@@ -18,8 +20,11 @@
 #include "common/PropertyList.hpp"
 #include "common/OptionT.hpp"
 #include "common/List.hpp"
+#include "common/Core.hpp"
+#include "common/ThreadPool.hpp"
 
 #include "common/PE/Comm.hpp"
+#include "common/PE/DistributedDirectory.hpp"
 #include "common/PE/debug.hpp"
 
 #include "math/MatrixTypesConversion.hpp"
@@ -34,6 +39,7 @@
 #include "mesh/Entities.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/BoundingBox.hpp"
+#include "mesh/ElementType.hpp"
 
 #include "mesh/actions/GlobalNumbering.hpp"
 
@@ -49,6 +55,36 @@ namespace actions {
 
   create_component_data_type( std::vector<boost::uint64_t> , mesh_actions_API , CVector_uint64 , "CVector<uint64>" );
 
+namespace {
+
+  /// Computes the centroids of a range of elements, to be hashed in one batch
+  struct ElementCentroids
+  {
+    ElementCentroids(const Entities& elements, boost::multi_array<Real,2>& centroids) :
+      m_elements(elements), m_centroids(centroids)
+    {
+    }
+
+    void operator()(const Uint range_begin, const Uint range_end) const
+    {
+      const ElementType& etype = m_elements.element_type();
+      RealMatrix element_coordinates(etype.nb_nodes(),m_elements.geometry_fields().coordinates().row_size());
+      RealVector centroid(etype.dimension());
+      for (Uint elem_idx=range_begin; elem_idx!=range_end; ++elem_idx)
+      {
+        m_elements.geometry_space().put_coordinates(element_coordinates,elem_idx);
+        etype.compute_centroid(element_coordinates,centroid);
+        for (Uint d=0; d<etype.dimension(); ++d)
+          m_centroids[elem_idx][d] = centroid[d];
+      }
+    }
+
+    const Entities& m_elements;
+    boost::multi_array<Real,2>& m_centroids;
+  };
+
+} // anonymous namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 
 common::ComponentBuilder < GlobalNumbering, MeshTransformer, mesh::actions::LibActions> GlobalNumbering_Builder;
@@ -124,38 +160,37 @@ void GlobalNumbering::execute()
   if ( is_null( mesh.geometry_fields().get_child("hilbert_indices") ) )
     mesh.geometry_fields().create_component<CVector_uint64>("hilbert_indices");
   CVector_uint64& hilbert_indices = *Handle<CVector_uint64>(mesh.geometry_fields().get_child("hilbert_indices"));
-  hilbert_indices.data().resize(coordinates.size());
-  Uint i(0);
-  boost_foreach(common::Table<Real>::ConstRow coords, coordinates.array() )
-  {
-//    hilbert_indices.data()[i]=node_hash_value(to_vector(coords));
-    math::copy(coords,coord_vec);
-    hilbert_indices.data()[i]=compute_glb_idx(coord_vec);
+  compute_glb_idx(coordinates.array(),hilbert_indices.data());
 
-    if (m_debug)
+  if (m_debug)
+  {
+    for (Uint i=0; i<coordinates.size(); ++i)
+    {
+      math::copy(coordinates[i],coord_vec);
       std::cout << "["<<PE::Comm::instance().rank() << "]  hashing node ("<< coord_vec.transpose() << ") to " << hilbert_indices.data()[i] << std::endl;
-    ++i;
+    }
   }
 
   boost_foreach( Entities& elements, find_components_recursively<Entities>(mesh) )
   {
-    RealMatrix element_coordinates(elements.element_type().nb_nodes(),coordinates.row_size());
-
     if ( is_null( elements.get_child("hilbert_indices") ) )
       elements.create_component<CVector_uint64>("hilbert_indices");
     CVector_uint64& hilbert_indices = *Handle<CVector_uint64>(elements.get_child("hilbert_indices"));
-    hilbert_indices.data().resize(elements.size());
 
-    for (Uint elem_idx=0; elem_idx<elements.size(); ++elem_idx)
+    const Uint dim = elements.element_type().dimension();
+    boost::multi_array<Real,2> centroids(boost::extents[elements.size()][dim]);
+    Core::instance().thread_pool().parallel_for(0, elements.size(), ElementCentroids(elements,centroids));
+    compute_glb_idx(centroids,hilbert_indices.data());
+
+    if (m_debug)
     {
-      elements.geometry_space().put_coordinates(element_coordinates,elem_idx);
-      RealVector centroid(elements.element_type().dimension());
-      elements.element_type().compute_centroid(element_coordinates,centroid);
-      hilbert_indices.data()[elem_idx]=compute_glb_idx(centroid);
-      if (m_debug)
+      RealVector centroid(dim);
+      for (Uint elem_idx=0; elem_idx<elements.size(); ++elem_idx)
+      {
+        for (Uint d=0; d<dim; ++d)
+          centroid[d] = centroids[elem_idx][d];
         std::cout << "["<<PE::Comm::instance().rank() << "]  hashing elem "<< elements.uri().path() << "["<<elem_idx<<"] ("<<centroid.transpose()<<") to " << hilbert_indices.data()[elem_idx] << std::endl;
-
-      //CFinfo << "hilbert_indices["<<elem_idx<<"] = " <<  hilbert_indices.data()[elem_idx] << CFendl;
+      }
     }
   }
 
@@ -186,16 +221,7 @@ void GlobalNumbering::execute()
 
   // now renumber
 
-  //------------------------------------------------------------------------------
-  // create node_hilbert2loc mapping
   Dictionary& nodes = mesh.geometry_fields();
-  std::map<boost::uint64_t,Uint> node_hilbert2loc;
-  Uint loc_node_idx(0);
-  boost_foreach(boost::uint64_t hilbert_idx, hilbert_indices.data())
-    node_hilbert2loc[hilbert_idx]=loc_node_idx++;
-
-  // Check if all nodes have been added to the map
-  cf3_assert(loc_node_idx==nodes.size());
 
   //------------------------------------------------------------------------------
   // get tot nb of owned indexes and communicate
@@ -245,15 +271,18 @@ void GlobalNumbering::execute()
 
 
   //------------------------------------------------------------------------------
-  // add glb_idx to owned nodes, broadcast/receive glb_idx for ghost nodes
+  // add glb_idx to owned nodes, look up glb_idx of ghost nodes
 
-  std::vector<boost::uint64_t> node_from(nb_owned_nodes);
-  std::vector<boost::uint64_t> node_to(nb_owned_nodes);
+  std::vector<boost::uint64_t> owned_node_keys;
+  std::vector<Uint> owned_node_glb_idx;
+  owned_node_keys.reserve(nb_owned_nodes);
+  owned_node_glb_idx.reserve(nb_owned_nodes);
+  std::vector<boost::uint64_t> ghost_node_keys;
+  std::vector<Uint> ghost_node_loc_idx;
 
   common::List<Uint>& nodes_glb_idx = mesh.geometry_fields().glb_idx();
   nodes_glb_idx.resize(nodes.size());
 
-  Uint cnt=0;
   Uint glb_id = start_id_per_proc[PE::Comm::instance().rank()];
   for (Uint i=0; i<nodes.size(); ++i)
   {
@@ -261,60 +290,30 @@ void GlobalNumbering::execute()
     if ( ! nodes.is_ghost(i) )
     {
       nodes_glb_idx[i] = glb_id++;
-      node_from[cnt] = hilbert_indices.data()[i];
-      node_to[cnt]   = nodes_glb_idx[i];
-      ++cnt;
+      owned_node_keys.push_back(hilbert_indices.data()[i]);
+      owned_node_glb_idx.push_back(nodes_glb_idx[i]);
     }
     else
     {
       nodes_glb_idx[i] = uint_max();
+      ghost_node_keys.push_back(hilbert_indices.data()[i]);
+      ghost_node_loc_idx.push_back(i);
     }
   }
 
-  for (Uint root=0; root<PE::Comm::instance().size(); ++root)
-  {
-
-    std::vector<boost::uint64_t> rcv_node_from(0);
-    PE::Comm::instance().broadcast(node_from,rcv_node_from,root);
-    std::vector<boost::uint64_t>        rcv_node_to(0);
-    PE::Comm::instance().broadcast(node_to,rcv_node_to,root);
-
-    if (m_debug)
-    {
-      std::cout << "["<<PE::Comm::instance().rank() << "]  received nodes from " << root << std::endl;
-    }
+  std::vector<Uint> ghost_node_glb_idx;
+  std::vector<Uint> ghost_node_rank;
+  find_ghost_global_indices(owned_node_keys,owned_node_glb_idx,ghost_node_keys,ghost_node_glb_idx,ghost_node_rank);
 
-    if (PE::Comm::instance().rank() != root)
-    {
-      for (Uint p=0; p<PE::Comm::instance().size(); ++p)
-      {
-        if (p == PE::Comm::instance().rank())
-        {
-          Uint rcv_idx(0);
-          boost_foreach(const boost::uint64_t hilbert_idx, rcv_node_from)
-          {
-            if ( node_hilbert2loc.count(hilbert_idx) )
-            {
-              const Uint loc_idx = node_hilbert2loc[hilbert_idx];
-              if (m_debug)
-                std::cout << "["<<PE::Comm::instance().rank() << "]  will change node "<< hilbert_idx << " (" << loc_idx<< ") to " << rcv_node_to[rcv_idx] << std::endl;
-              cf3_assert(rcv_idx < rcv_node_to.size());
-              nodes_glb_idx[loc_idx]=rcv_node_to[rcv_idx];
-              cf3_assert(loc_idx < nodes_rank.size());
-              cf3_assert_desc("node "+to_str(loc_idx)+ " with hilbert_idx " +to_str(hilbert_idx) +" must be a ghost, but is owned by "+to_str(nodes_rank[loc_idx]),nodes.is_ghost(loc_idx));
-              nodes_rank[loc_idx]=std::min(root,nodes_rank[loc_idx]);
-            }
-            ++rcv_idx;
-          }
-          break;
-        }
-      }
-    }
+  for (Uint g=0; g<ghost_node_loc_idx.size(); ++g)
+  {
+    const Uint loc_idx = ghost_node_loc_idx[g];
+    if (ghost_node_rank[g] == uint_max())
+      continue;
     if (m_debug)
-    {
-      std::cout << "["<<PE::Comm::instance().rank() << "]  changed nodes based on " << root << std::endl;
-    }
-
+      std::cout << "["<<PE::Comm::instance().rank() << "]  will change node "<< ghost_node_keys[g] << " (" << loc_idx<< ") to " << ghost_node_glb_idx[g] << std::endl;
+    nodes_glb_idx[loc_idx]=ghost_node_glb_idx[g];
+    nodes_rank[loc_idx]=std::min(ghost_node_rank[g],nodes_rank[loc_idx]);
   }
 
   if (m_debug)
@@ -342,29 +341,15 @@ void GlobalNumbering::execute()
     common::List<Uint>& elem_rank = elements.rank();
     elem_rank.resize(elements.size());
 
-    //------------------------------------------------------------------------------
-    // create elem_glb2loc mapping
-    Uint nb_owned_elems=0;
-    std::map<boost::uint64_t,Uint> elem_glb2loc;
-    std::map<boost::uint64_t,Uint>::iterator elem_glb2loc_it;
-    std::map<boost::uint64_t,Uint>::iterator hash_not_found = elem_glb2loc.end();
-
-    for (Uint e=0; e<elements.size(); ++e)
-    {
-      elem_glb2loc [ hilbert_indices[e] ] = e;
-      if ( ! elements.is_ghost(e) )
-        ++nb_owned_elems;
-    }
-
-
-    std::vector<boost::uint64_t> send_hash(nb_owned_elems);
-    std::vector<boost::uint64_t>   send_id(nb_owned_elems);
+    std::vector<boost::uint64_t> owned_elem_keys;
+    std::vector<Uint> owned_elem_glb_idx;
+    std::vector<boost::uint64_t> ghost_elem_keys;
+    std::vector<Uint> ghost_elem_loc_idx;
 
     common::List<Uint>& elements_glb_idx = elements.glb_idx();
     elements_glb_idx.resize(elements.size());
     cf3_assert(hilbert_indices.size() == elements.size());
 
-    Uint cnt(0);
     for (Uint e=0; e<elements.size(); ++e)
     {
 
@@ -374,50 +359,31 @@ void GlobalNumbering::execute()
           std::cout << "["<<PE::Comm::instance().rank() << "]  will change owned elem "<< hilbert_indices[e] << " (" << elements.uri().path() << "["<<e<<"]) to " << glb_id << std::endl;
 
         elements_glb_idx[e] = glb_id++;
-        send_hash[cnt] = hilbert_indices[e];
-        send_id[cnt]   = elements_glb_idx[e];
-        ++cnt;
+        owned_elem_keys.push_back(hilbert_indices[e]);
+        owned_elem_glb_idx.push_back(elements_glb_idx[e]);
       }
       else
       {
         elements_glb_idx[e] = uint_max();
+        ghost_elem_keys.push_back(hilbert_indices[e]);
+        ghost_elem_loc_idx.push_back(e);
       }
     } // end foreach elem_idx
-    cf3_assert(cnt == nb_owned_elems);
-
-    for (Uint root=0; root<PE::Comm::instance().size(); ++root)
-    {
-      std::vector<boost::uint64_t> recv_hash(0);
-      PE::Comm::instance().broadcast(send_hash,recv_hash,root);
-      std::vector<boost::uint64_t>        recv_id(0);
-      PE::Comm::instance().broadcast(send_id,recv_id,root);
-      if (PE::Comm::instance().rank() != root)
-      {
-        for (Uint p=0; p<PE::Comm::instance().size(); ++p)
-        {
-          if (p == PE::Comm::instance().rank())
-          {
-            Uint recv_idx(0);
-            boost_foreach(const boost::uint64_t hash, recv_hash)
-            {
-              elem_glb2loc_it = elem_glb2loc.find(hash);
-              if ( elem_glb2loc_it != hash_not_found )
-              {
-                if (m_debug)
-                  std::cout << "["<<PE::Comm::instance().rank() << "]  will change ghost elem "<< elem_glb2loc_it->first << " (" << elements.uri() << "[" << elem_glb2loc_it->second << "]) to " << recv_id[recv_idx] << std::endl;
-                elements_glb_idx[elem_glb2loc_it->second]=recv_id[recv_idx];
-                cf3_assert(elements.is_ghost(elem_glb2loc_it->second));
-                elem_rank[elem_glb2loc_it->second]=root;
-              }
-              ++recv_idx;
-            }
-            break;
-          }
-        }
-      }
-    } // end foreach broadcasting process
 
+    std::vector<Uint> ghost_elem_glb_idx;
+    std::vector<Uint> ghost_elem_rank;
+    find_ghost_global_indices(owned_elem_keys,owned_elem_glb_idx,ghost_elem_keys,ghost_elem_glb_idx,ghost_elem_rank);
 
+    for (Uint g=0; g<ghost_elem_loc_idx.size(); ++g)
+    {
+      const Uint loc_idx = ghost_elem_loc_idx[g];
+      if (ghost_elem_rank[g] == uint_max())
+        continue;
+      if (m_debug)
+        std::cout << "["<<PE::Comm::instance().rank() << "]  will change ghost elem "<< ghost_elem_keys[g] << " (" << elements.uri() << "[" << loc_idx << "]) to " << ghost_elem_glb_idx[g] << std::endl;
+      elements_glb_idx[loc_idx]=ghost_elem_glb_idx[g];
+      elem_rank[loc_idx]=ghost_elem_rank[g];
+    }
 
   } // end foreach elements
 
@@ -461,6 +427,50 @@ void GlobalNumbering::execute()
 
 //////////////////////////////////////////////////////////////////////////////
 
+void find_ghost_global_indices(const std::vector<boost::uint64_t>& owned_keys,
+                               const std::vector<Uint>& owned_glb_idx,
+                               const std::vector<boost::uint64_t>& ghost_keys,
+                               std::vector<Uint>& ghost_glb_idx,
+                               std::vector<Uint>& ghost_rank)
+{
+  cf3_assert(owned_keys.size() == owned_glb_idx.size());
+  ghost_glb_idx.assign(ghost_keys.size(), uint_max());
+  ghost_rank.assign(ghost_keys.size(), uint_max());
+
+  // Space filling curve keys are clustered, so each home rank gets a range of keys from a sample sort
+  PE::DistributedDirectory directory;
+  directory.partition_keys(owned_keys);
+
+  // Owners register (glb_idx, rank) as payload of their keys
+  const Uint my_rank = PE::Comm::instance().rank();
+  std::vector<Uint> payload;
+  std::vector<Uint> payload_start;
+  payload.reserve(2*owned_keys.size());
+  payload_start.reserve(owned_keys.size()+1);
+  payload_start.push_back(0u);
+  for (Uint i=0; i<owned_keys.size(); ++i)
+  {
+    payload.push_back(owned_glb_idx[i]);
+    payload.push_back(my_rank);
+    payload_start.push_back(payload.size());
+  }
+  directory.insert(owned_keys,payload,payload_start);
+
+  // Payloads are returned in order of increasing rank, so the first one is the lowest owning rank
+  std::vector<Uint> found;
+  std::vector<Uint> found_start;
+  directory.find_payloads(ghost_keys,found,found_start,true);
+  for (Uint i=0; i<ghost_keys.size(); ++i)
+  {
+    if (found_start[i] == found_start[i+1])
+      continue;
+    ghost_glb_idx[i] = found[found_start[i]];
+    ghost_rank[i] = found[found_start[i]+1];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 
 } // actions
 } // mesh
@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <boost/cstdint.hpp>
+
 #include "math/MatrixTypes.hpp"
 #include "mesh/MeshTransformer.hpp"
 #include "mesh/actions/LibActions.hpp"
@@ -52,6 +54,27 @@ private: // data
   bool m_debug;
 }; // end GlobalNumbering
 
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Find the global index and owner of entities that are ghosts on this rank, given a unique key per entity
+///
+/// The owned keys are registered in a common::PE::DistributedDirectory, with the global index and rank as payload.
+/// Its key ranges come from a sample sort of the owned keys (see DistributedDirectory::partition_keys()), so each
+/// home rank manages a roughly equally sized range of keys. This takes a fixed number of exchanges, each with
+/// O(N/P) data per rank, instead of broadcasting the owned entities of every rank to every other rank.
+/// This is a collective operation.
+/// @param [in]  owned_keys    Keys of the entities owned by this rank
+/// @param [in]  owned_glb_idx Global index of each owned entity
+/// @param [in]  ghost_keys    Keys of the ghost entities on this rank
+/// @param [out] ghost_glb_idx Global index of each ghost, or uint_max() if no rank owns the key
+/// @param [out] ghost_rank    Owning rank of each ghost, or uint_max() if no rank owns the key.
+///                            If several ranks own the same key, the lowest rank is returned.
+void mesh_actions_API find_ghost_global_indices(const std::vector<boost::uint64_t>& owned_keys,
+                                                const std::vector<Uint>& owned_glb_idx,
+                                                const std::vector<boost::uint64_t>& ghost_keys,
+                                                std::vector<Uint>& ghost_glb_idx,
+                                                std::vector<Uint>& ghost_rank);
+
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -4,8 +4,10 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <set>
 #include <map>
+#include <limits>
 
 #include "common/Log.hpp"
 #include "common/Builder.hpp"
@@ -31,6 +33,7 @@
 #include "mesh/Dictionary.hpp"
 #include "mesh/MeshElements.hpp"
 #include "mesh/Space.hpp"
+#include "mesh/Tags.hpp"
 
 #include "mesh/actions/GrowOverlap.hpp"
 
@@ -57,10 +60,14 @@ GrowOverlap::GrowOverlap( const std::string& name )
   std::string desc;
   desc =
       " Boundary nodes of one rank are communicated to other ranks.\n"
-      " Each other rank then communicates all elements that are connected \n"
-      " to these boundary nodes. \n"
+      " Each other rank then communicates all elements that are within \n"
+      " nb_layers rings of these boundary nodes. \n"
       " Missing nodes are then also communicated to complete the elements";
   properties()["description"] = desc;
+
+  options().add("nb_layers", 1u)
+      .pretty_name("Number of Layers")
+      .description("Number of cell-layers added to the overlap, all in a single exchange");
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -73,9 +80,130 @@ void GrowOverlap::execute()
 
   MeshAdaptor mesh_adaptor(*m_mesh);
   mesh_adaptor.prepare();
-  mesh_adaptor.grow_overlap();
+  mesh_adaptor.grow_overlap(options().value<Uint>("nb_layers"));
   mesh_adaptor.finish();
 
+  tag_overlap_depth();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  /// Replace the overlap depth list of a component by a new one of the given size
+  common::List<Uint>& create_overlap_depth(Component& parent, const Uint size)
+  {
+    Handle< List<Uint> > depth = find_component_ptr_with_tag< List<Uint> >(parent,mesh::Tags::overlap_depth());
+    if (is_not_null(depth))
+      parent.remove_component(*depth);
+    depth = parent.create_component< List<Uint> >(mesh::Tags::overlap_depth());
+    depth->add_tag(mesh::Tags::overlap_depth());
+    depth->properties()["brief"] = std::string("Depth in the overlap, 0 for owned entries");
+    depth->resize(size);
+    return *depth;
+  }
+
+  Handle< List<Uint> const > find_overlap_depth(const Component& parent, const Uint size)
+  {
+    Handle< List<Uint> const > depth = find_component_ptr_with_tag< List<Uint> >(parent,mesh::Tags::overlap_depth());
+    if (is_not_null(depth) && depth->size() != size)
+      depth.reset();
+    return depth;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void GrowOverlap::tag_overlap_depth()
+{
+  const Uint not_reached = std::numeric_limits<Uint>::max();
+  const Dictionary& geometry_dict = m_mesh->geometry_fields();
+  const std::vector< Handle<Entities> >& elements = m_mesh->elements();
+
+  // Owned elements form layer 0, every next layer consists of the elements that
+  // share a node with the previous layer
+  std::vector< std::vector<Uint> > elem_depth(elements.size());
+  std::vector<SpaceElem> front, next_front;
+  for (Uint entities_idx=0; entities_idx<elements.size(); ++entities_idx)
+  {
+    const Entities& entities = *elements[entities_idx];
+    elem_depth[entities_idx].resize(entities.size(),not_reached);
+    for (Uint elem=0; elem<entities.size(); ++elem)
+    {
+      if (!entities.is_ghost(elem))
+      {
+        elem_depth[entities_idx][elem] = 0;
+        front.push_back(SpaceElem(entities.geometry_space(),elem));
+      }
+    }
+  }
+
+  std::vector<bool> node_visited(geometry_dict.size(),false);
+  for (Uint depth=1; !front.empty(); ++depth)
+  {
+    next_front.clear();
+    boost_foreach (const SpaceElem& elem, front)
+    {
+      boost_foreach (const Uint node, elem.nodes())
+      {
+        if (node_visited[node])
+          continue;
+        node_visited[node] = true;
+        boost_foreach (const SpaceElem& neighbour, geometry_dict.connectivity()[node])
+        {
+          Uint& neighbour_depth = elem_depth[neighbour.comp->support().entities_idx()][neighbour.idx];
+          if (neighbour_depth == not_reached)
+          {
+            neighbour_depth = depth;
+            next_front.push_back(neighbour);
+          }
+        }
+      }
+    }
+    front.swap(next_front);
+  }
+
+  for (Uint entities_idx=0; entities_idx<elements.size(); ++entities_idx)
+  {
+    List<Uint>& depth = detail::create_overlap_depth(*elements[entities_idx],elements[entities_idx]->size());
+    std::copy(elem_depth[entities_idx].begin(),elem_depth[entities_idx].end(),depth.array().begin());
+  }
+
+  // A ghost node belongs to the shallowest layer that uses it, and at least to layer 1
+  boost_foreach (const Handle<Dictionary>& dict, m_mesh->dictionaries())
+  {
+    List<Uint>& depth = detail::create_overlap_depth(*dict,dict->size());
+    for (Uint node=0; node<dict->size(); ++node)
+      depth[node] = dict->is_ghost(node) ? not_reached : 0u;
+
+    boost_foreach (const Handle<Space>& space, dict->spaces())
+    {
+      const std::vector<Uint>& space_elem_depth = elem_depth[space->support().entities_idx()];
+      for (Uint elem=0; elem<space->size(); ++elem)
+      {
+        const Uint layer = std::max(space_elem_depth[elem],1u);
+        boost_foreach (const Uint node, space->connectivity()[elem])
+        {
+          if (depth[node] != 0)
+            depth[node] = std::min(depth[node],layer);
+        }
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+Handle< List<Uint> const > GrowOverlap::overlap_depth(const Entities& entities)
+{
+  return detail::find_overlap_depth(entities,entities.size());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+Handle< List<Uint> const > GrowOverlap::overlap_depth(const Dictionary& dict)
+{
+  return detail::find_overlap_depth(dict,dict.size());
 }
 
 //////////////////////////////////////////////////////////////////////////////
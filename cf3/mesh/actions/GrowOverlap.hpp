@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "common/List.hpp"
+
 #include "mesh/MeshTransformer.hpp"
 
 #include "mesh/actions/LibActions.hpp"
@@ -17,17 +19,27 @@
 
 namespace cf3 {
 namespace mesh {
+
+class Entities;
+class Dictionary;
+
 namespace actions {
 
 //////////////////////////////////////////////////////////////////////////////
 
-/// @brief Grow the overlap of the mesh with one layer
+/// @brief Grow the overlap of the mesh with one or more layers
 ///
 /// Boundary nodes of one rank are communicated to other ranks.
-/// Each other rank then communicates all elements that are connected
-/// to these boundary nodes.
+/// Each other rank then communicates all elements that are within
+/// "nb_layers" rings of these boundary nodes.
 /// Missing nodes are then also communicated to complete the elements
 ///
+/// Afterwards, every Entities component and every Dictionary holds a list tagged
+/// mesh::Tags::overlap_depth() with the depth of each element or node in the overlap:
+/// 0 for owned entries, 1 for the first ghost layer, and so on. A ghost node gets the
+/// smallest depth of the elements it belongs to, with a minimum of 1.
+/// The lists are only valid until the mesh changes again, check their size before use.
+///
 /// @author Willem Deconinck
 class mesh_actions_API GrowOverlap : public MeshTransformer
 {
@@ -41,6 +53,19 @@ public: // functions
 
   virtual void execute();
 
+  /// @brief Overlap depth of each element
+  /// @return a null handle if the overlap was not grown, or the elements changed since
+  static Handle< common::List<Uint> const > overlap_depth(const Entities& entities);
+
+  /// @brief Overlap depth of each node
+  /// @return a null handle if the overlap was not grown, or the nodes changed since
+  static Handle< common::List<Uint> const > overlap_depth(const Dictionary& dict);
+
+private: // functions
+
+  /// Compute the overlap depth of all elements and nodes, and store it in tagged lists
+  void tag_overlap_depth();
+
 }; // end GrowOverlap
 
 
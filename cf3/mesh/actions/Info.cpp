@@ -10,6 +10,10 @@
 #include "common/Foreach.hpp"
 #include "common/StringConversion.hpp"
 #include "common/PropertyList.hpp"
+#include "common/OptionList.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/PE/Comm.hpp"
 
 #include "mesh/Elements.hpp"
 #include "mesh/Region.hpp"
@@ -69,6 +73,14 @@ Info::Info( const std::string& name )
 	"          Information given: internal mesh hierarchy,\n"
 	"      element distribution for each region, and element type";
 	properties()["description"] = desc;
+
+  options().add("memory", false)
+      .description("Also print the memory footprint of the mesh structures, and per-rank totals")
+      .pretty_name("Memory");
+
+  options().add("memory_depth", 3u)
+      .description("Number of levels of the mesh tree printed in the memory footprint report (0 means full tree)")
+      .pretty_name("Memory Depth");
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -99,6 +111,47 @@ void Info::execute()
 
   }
 
+  if (options().value<bool>("memory"))
+    print_memory_footprint(mesh);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Info::print_memory_footprint(const Mesh& mesh)
+{
+  CFinfo << "Memory footprint:" << CFendl;
+  CFinfo << mesh.memory_tree(options().value<Uint>("memory_depth")) << CFflush;
+
+  // mesh footprint, process memory usage and high-water mark of this rank
+  std::vector<Real> local_stats(3);
+  local_stats[0] = static_cast<Real>(mesh.recursive_memory_footprint());
+  local_stats[1] = OSystem::instance().layer()->memory_usage();
+  local_stats[2] = OSystem::instance().layer()->memory_peak();
+
+  std::vector<Real> stats = local_stats;
+  if (PE::Comm::instance().is_active())
+    PE::Comm::instance().all_gather(local_stats,stats);
+
+  const Uint nb_ranks = stats.size()/3;
+  std::vector<Real> total(3,0.), maximum(3,0.);
+  for (Uint r=0; r<nb_ranks; ++r)
+  {
+    if (nb_ranks > 1)
+      CFinfo << "  rank " << r << " :  mesh [" << OSystemLayer::memory_str(stats[3*r+0])
+             << "]  process [" << OSystemLayer::memory_str(stats[3*r+1])
+             << "]  high-water mark [" << OSystemLayer::memory_str(stats[3*r+2]) << "]" << CFendl;
+    for (Uint i=0; i<3; ++i)
+    {
+      total[i] += stats[3*r+i];
+      maximum[i] = std::max(maximum[i],stats[3*r+i]);
+    }
+  }
+  CFinfo << "  total   :  mesh [" << OSystemLayer::memory_str(total[0])
+         << "]  process [" << OSystemLayer::memory_str(total[1])
+         << "]  high-water mark [" << OSystemLayer::memory_str(total[2]) << "]" << CFendl;
+  CFinfo << "  maximum :  mesh [" << OSystemLayer::memory_str(maximum[0])
+         << "]  process [" << OSystemLayer::memory_str(maximum[1])
+         << "]  high-water mark [" << OSystemLayer::memory_str(maximum[2]) << "]" << CFendl;
 }
 
 //////////////////////////////////////////////////////////////////////////////
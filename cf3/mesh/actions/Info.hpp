@@ -39,6 +39,7 @@ private: // functions
  
   std::string print_region_tree(const Region& region, Uint level=0);
   std::string print_elements(const Component& region, Uint level=0);
+  void print_memory_footprint(const Mesh& mesh);
   
 }; // end Info
 
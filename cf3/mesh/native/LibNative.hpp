@@ -0,0 +1,73 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_native_LibNative_hpp
+#define cf3_mesh_native_LibNative_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Library.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Define the macro native_API
+/// @note build system defines COOLFLUID_MESH_NATIVE_EXPORTS when compiling native files
+#ifdef COOLFLUID_MESH_NATIVE_EXPORTS
+#   define native_API      CF3_EXPORT_API
+#   define native_TEMPLATE
+#else
+#   define native_API      CF3_IMPORT_API
+#   define native_TEMPLATE CF3_TEMPLATE_EXTERN
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+/// @brief Library for I/O of the native binary mesh and restart format
+namespace native {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Class defines the native binary mesh format operations
+class native_API LibNative : public common::Library
+{
+public:
+
+  /// Constructor
+  LibNative ( const std::string& name) : common::Library(name) {   }
+
+  /// @return string of the library namespace
+  static std::string library_namespace() { return "cf3.mesh.native"; }
+
+  /// Static function that returns the library name.
+  /// Must be implemented for Library registration
+  /// @return name of the library
+  static std::string library_name() { return "native"; }
+
+  /// Static function that returns the description of the library.
+  /// Must be implemented for Library registration
+  /// @return description of the library
+
+  static std::string library_description()
+  {
+    return "This library implements the native binary mesh format operations.";
+  }
+
+  /// Gets the Class name
+  static std::string type_name() { return "LibNative"; }
+}; // LibNative
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // native
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_native_LibNative_hpp
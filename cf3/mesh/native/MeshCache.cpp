@@ -0,0 +1,128 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "common/BoostFilesystem.hpp"
+#include "common/Log.hpp"
+#include "common/Builder.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/native/MeshCache.hpp"
+#include "mesh/native/Reader.hpp"
+#include "mesh/native/Writer.hpp"
+#include "mesh/native/Shared.hpp"
+#include "mesh/Mesh.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3::common;
+
+namespace cf3 {
+namespace mesh {
+namespace native {
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < native::MeshCache, mesh::MeshCache, LibNative> aNativeMeshCache_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+MeshCache::MeshCache( const std::string& name )
+: mesh::MeshCache(name)
+{
+  properties()["brief"] = std::string("Caches meshes in the native binary format, next to their source file");
+
+  m_reader = create_static_component<Reader>("reader");
+  m_writer = create_static_component<Writer>("writer");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+URI MeshCache::cache_file(const URI& source)
+{
+  return URI(source.path()+".cf3mesh", URI::Scheme::FILE);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+Uint MeshCache::source_hash(const URI& source, const Uint dimension)
+{
+  const boost::filesystem::path path(source.path());
+  boost::crc_32_type crc;
+  if (boost::filesystem::file_size(path) != 0) // empty files cannot be mapped
+  {
+    boost::iostreams::mapped_file_source mapped_file(path.string());
+    crc.process_bytes(mapped_file.data(),mapped_file.size());
+  }
+  const boost::uint32_t dim = dimension;
+  crc.process_bytes(&dim,sizeof(dim));
+  return crc.checksum();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool MeshCache::read(const URI& source, const Uint dimension, Mesh& mesh)
+{
+  const URI file = cache_file(source);
+  const boost::filesystem::path path(file.path());
+  if ( !boost::filesystem::exists(path) && !boost::filesystem::exists(part_path(path,0,2)) )
+    return false;
+
+  // All ranks check the header of the first part, so that they take the same decision
+  Header header;
+  try
+  {
+    header = Reader::read_header(path);
+  }
+  catch (FileFormatError&)
+  {
+    CFwarn << "Ignoring incompatible mesh cache " << path.string() << CFendl;
+    return false;
+  }
+  if (header.source_hash != source_hash(source,dimension))
+    return false;
+
+  CFinfo << "Reading " << source.path() << " from mesh cache " << path.string() << CFendl;
+  m_reader->options().set("mesh",mesh.handle<Mesh>());
+  m_reader->options().set("file",file);
+  m_reader->options().set("dimension",dimension);
+  m_reader->execute();
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void MeshCache::write(const URI& source, const Uint dimension, const Mesh& mesh)
+{
+  const URI file = cache_file(source);
+  const boost::filesystem::path path(file.path());
+  const Uint nb_parts = PE::Comm::instance().is_active() ? PE::Comm::instance().size() : 1u;
+  const Uint rank     = PE::Comm::instance().is_active() ? PE::Comm::instance().rank() : 0u;
+
+  try
+  {
+    // A single part file from a serial run would hide the parts written now
+    if (nb_parts > 1 && rank == 0 && boost::filesystem::exists(path))
+      boost::filesystem::remove(path);
+
+    m_writer->options().set("source_hash",source_hash(source,dimension));
+    m_writer->write_from_to(mesh,file);
+    CFinfo << "Stored " << source.path() << " in mesh cache " << path.string() << CFendl;
+  }
+  catch (boost::filesystem::filesystem_error& e)
+  {
+    CFwarn << "Could not store " << source.path() << " in mesh cache: " << e.what() << CFendl;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // native
+} // mesh
+} // cf3
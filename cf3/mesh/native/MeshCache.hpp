@@ -0,0 +1,73 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_native_MeshCache_hpp
+#define cf3_mesh_native_MeshCache_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/URI.hpp"
+
+#include "mesh/MeshCache.hpp"
+
+#include "mesh/native/LibNative.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace native {
+
+  class Reader;
+  class Writer;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Caches meshes in the native binary format, next to their source file
+///
+/// The copy of "mesh.neu" is stored as "mesh.neu.cf3mesh", or as one part per rank
+/// "mesh.neu_P<rank>.cf3mesh" in parallel. The header of every part holds a CRC-32
+/// of the source file and the dimension it was read with; the copy is only read
+/// when this hash matches. Reading memory-maps the parts (see native::Reader), and
+/// restores the partitioned mesh directly when the number of ranks is unchanged.
+/// Failing to write a copy, e.g. in a read-only directory, only gives a warning.
+class native_API MeshCache : public mesh::MeshCache
+{
+public: // functions
+
+  /// constructor
+  MeshCache( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "MeshCache"; }
+
+  virtual bool read(const common::URI& source, const Uint dimension, Mesh& mesh);
+
+  virtual void write(const common::URI& source, const Uint dimension, const Mesh& mesh);
+
+  /// File the copy of a source file is stored in
+  static common::URI cache_file(const common::URI& source);
+
+  /// Hash of the contents of a source file, and the dimension it is read with
+  static Uint source_hash(const common::URI& source, const Uint dimension);
+
+private: // data
+
+  Handle<Reader> m_reader;
+
+  Handle<Writer> m_writer;
+
+}; // end MeshCache
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // native
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_native_MeshCache_hpp
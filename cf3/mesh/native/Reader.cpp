@@ -0,0 +1,415 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/tokenizer.hpp>
+
+#include "common/BoostFilesystem.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/Builder.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+
+#include "mesh/native/Reader.hpp"
+#include "mesh/native/Shared.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/MeshAdaptor.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Space.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3::common;
+
+namespace cf3 {
+namespace mesh {
+namespace native {
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < native::Reader, MeshReader, LibNative> aNativeReader_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Map a part file in memory, and check its header, size and checksum
+Header open_part(const boost::filesystem::path& file, boost::iostreams::mapped_file_source& mapped_file, const bool verify_checksum)
+{
+  if( !boost::filesystem::exists(file) )
+    throw boost::filesystem::filesystem_error( file.string() + " does not exist", boost::system::error_code() );
+
+  mapped_file.open(file.string());
+  if (mapped_file.size() < sizeof(Header))
+    throw FileFormatError(FromHere(), file.string()+" is too small to be a native coolfluid mesh file");
+
+  Header header;
+  std::memcpy(&header,mapped_file.data(),sizeof(Header));
+  header.check(file.string());
+
+  if (mapped_file.size() != sizeof(Header)+header.payload_size)
+    throw FileFormatError(FromHere(), file.string()+" is truncated: expected "+to_str(sizeof(Header)+header.payload_size)
+                          +" bytes, found "+to_str(mapped_file.size()));
+
+  if (verify_checksum)
+  {
+    boost::crc_32_type crc;
+    crc.process_bytes(mapped_file.data()+sizeof(Header),header.payload_size);
+    if (crc.checksum() != header.checksum)
+      throw FileFormatError(FromHere(), file.string()+" is corrupt: checksum mismatch");
+  }
+  return header;
+}
+
+/// Check the size of an array in the file against the expected size
+void check_array_size(const std::size_t found, const std::size_t expected, const std::string& what)
+{
+  if (found != expected)
+    throw FileFormatError(FromHere(), "Native mesh file has inconsistent size for "+what+": "
+                          +to_str(found)+" instead of "+to_str(expected));
+}
+
+/// Find or create the region with given path relative to the topology
+Region& access_region(Region& topology, const std::string& relative_path)
+{
+  typedef boost::tokenizer<boost::char_separator<char> > Tokenizer;
+  boost::char_separator<char> sep("/");
+  Tokenizer tokens(relative_path, sep);
+
+  Handle<Region> region = topology.handle<Region>();
+  for (Tokenizer::iterator tok_iter = tokens.begin(); tok_iter != tokens.end(); ++tok_iter)
+  {
+    if ( Handle<Region> found = Handle<Region>(region->get_child(*tok_iter)) )
+      region = found;
+    else
+      region = region->create_component<Region>(*tok_iter);
+  }
+  return *region;
+}
+
+/// Remove the nodes of a dictionary that are not used by any of its spaces,
+/// and renumber the connectivity tables accordingly
+void remove_unused_nodes(Dictionary& dict)
+{
+  dict.update_structures();
+
+  std::vector<bool> used(dict.size(),false);
+  boost_foreach(const Handle<Space>& space, dict.spaces())
+  {
+    const Connectivity& connectivity = space->connectivity();
+    for (Uint e=0; e<connectivity.size(); ++e)
+      boost_foreach(const Uint node, connectivity[e])
+        used[node] = true;
+  }
+
+  std::vector<Uint> new_idx(dict.size());
+  Uint nb_used = 0;
+  for (Uint n=0; n<dict.size(); ++n)
+  {
+    if (used[n])
+    {
+      new_idx[n] = nb_used;
+      if (nb_used != n)
+      {
+        dict.glb_idx()[nb_used] = dict.glb_idx()[n];
+        dict.rank()[nb_used] = dict.rank()[n];
+        boost_foreach(const Handle<Field>& field, dict.fields())
+          field->array()[nb_used] = field->array()[n];
+      }
+      ++nb_used;
+    }
+  }
+  dict.resize(nb_used);
+
+  boost_foreach(const Handle<Space>& space, dict.spaces())
+  {
+    Connectivity& connectivity = space->connectivity();
+    for (Uint e=0; e<connectivity.size(); ++e)
+      for (Uint n=0; n<connectivity.row_size(); ++n)
+        connectivity.array()[e][n] = new_idx[connectivity.array()[e][n]];
+  }
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Reader::Reader( const std::string& name )
+: MeshReader(name)
+{
+  m_verify_checksum = true;
+  options().add("verify_checksum", m_verify_checksum)
+      .pretty_name("Verify Checksum")
+      .description("Verify the checksum of every part before reading it")
+      .link_to(&m_verify_checksum);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> Reader::get_extensions()
+{
+  std::vector<std::string> extensions;
+  extensions.push_back(".cf3mesh");
+  return extensions;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+Header Reader::read_header(const boost::filesystem::path& path)
+{
+  // A single part is stored under the given name, multiple parts carry a "_P<part>" suffix
+  boost::filesystem::path first_part = path;
+  if ( !boost::filesystem::exists(first_part) )
+    first_part = part_path(path,0,2);
+
+  boost::filesystem::ifstream file(first_part,std::ios_base::in | std::ios_base::binary);
+  if (!file)
+    throw boost::filesystem::filesystem_error( path.string() + " does not exist", boost::system::error_code() );
+
+  Header header;
+  file.read(reinterpret_cast<char*>(&header),sizeof(Header));
+  if (!file)
+    throw FileFormatError(FromHere(), first_part.string()+" is too small to be a native coolfluid mesh file");
+  header.check(first_part.string());
+  return header;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::do_read_mesh_into(const URI& path, Mesh& mesh)
+{
+  const boost::filesystem::path fp(path.path());
+  const Uint nb_ranks = PE::Comm::instance().is_active() ? PE::Comm::instance().size() : 1u;
+  const Uint rank     = PE::Comm::instance().is_active() ? PE::Comm::instance().rank() : 0u;
+
+  const Header header = read_header(fp);
+
+  if (header.nb_parts == nb_ranks)
+  {
+    CFinfo << "Reading partitioned mesh " << fp.string() << CFendl;
+    read_part(part_path(fp,rank,nb_ranks),rank,nb_ranks,mesh,false);
+    mesh.update_structures();
+  }
+  else
+  {
+    CFinfo << "Redistributing mesh " << fp.string() << " written on " << header.nb_parts
+           << " ranks to " << nb_ranks << " ranks" << CFendl;
+    read_redistributed(fp,header.nb_parts,mesh);
+  }
+
+  mesh.raise_mesh_loaded();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_redistributed(const boost::filesystem::path& path, const Uint nb_parts, Mesh& mesh)
+{
+  const Uint nb_ranks = PE::Comm::instance().is_active() ? PE::Comm::instance().size() : 1u;
+  const Uint rank     = PE::Comm::instance().is_active() ? PE::Comm::instance().rank() : 0u;
+
+  const Header header = read_header(path);
+  if (mesh.dimension() == 0)
+    mesh.initialize_nodes(0,header.dimension);
+  mesh.metadata().properties()["time"] = static_cast<Real>(header.time);
+  mesh.metadata().properties()["iter"] = static_cast<Uint>(header.iter);
+
+  // Every rank combines the owned elements of its parts, as if they were read from separate files
+  MeshAdaptor mesh_adaptor(mesh);
+  for (Uint part=rank; part<nb_parts; part+=nb_ranks)
+  {
+    boost::shared_ptr<Mesh> part_mesh = allocate_component<Mesh>("part_"+to_str(part));
+    read_part(part_path(path,part,nb_parts),part,nb_parts,*part_mesh,true);
+    part_mesh->update_structures();
+    boost_foreach(const Handle<Entities>& entities, part_mesh->elements())
+    {
+      for (Uint e=0; e<entities->size(); ++e)
+        entities->rank()[e] = rank;
+    }
+    mesh_adaptor.combine_mesh(*part_mesh);
+  }
+  mesh_adaptor.remove_duplicate_elements_and_nodes();
+  mesh_adaptor.fix_node_ranks();
+  mesh_adaptor.finish();
+
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.LoadBalance","load_balance")->transform(mesh);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_part(const boost::filesystem::path& file, const Uint part, const Uint nb_parts, Mesh& mesh, const bool owned_only)
+{
+  boost::iostreams::mapped_file_source mapped_file;
+  const Header header = open_part(file,mapped_file,m_verify_checksum);
+  if (header.part != part || header.nb_parts != nb_parts)
+    throw FileFormatError(FromHere(), file.string()+" holds part "+to_str(header.part)+" of "+to_str(header.nb_parts)
+                          +", while part "+to_str(part)+" of "+to_str(nb_parts)+" was expected");
+  BinaryInput in(mapped_file.data()+sizeof(Header),mapped_file.data()+mapped_file.size());
+
+  if (mesh.dimension() == 0)
+    mesh.initialize_nodes(0,header.dimension);
+  else if (mesh.dimension() != header.dimension)
+    throw FileFormatError(FromHere(), file.string()+" has dimension "+to_str(header.dimension)
+                          +", while the mesh has dimension "+to_str(mesh.dimension()));
+
+  mesh.metadata().properties()["time"] = static_cast<Real>(header.time);
+  mesh.metadata().properties()["iter"] = static_cast<Uint>(header.iter);
+
+  // 1) Declaration of the dictionaries, to which spaces refer
+  const Uint nb_dicts = in.read<Uint>();
+  std::vector< Handle<Dictionary> > dicts(nb_dicts);
+  std::map< std::string, Handle<Dictionary> > dicts_by_name;
+  for (Uint d=0; d<nb_dicts; ++d)
+  {
+    const std::string dict_name = in.read_string();
+    const std::string dict_type = in.read_string();
+    if (dict_name == mesh.geometry_fields().name())
+      dicts[d] = mesh.geometry_fields().handle<Dictionary>();
+    else if ( Handle<Dictionary> found = Handle<Dictionary>(mesh.get_child(dict_name)) )
+      dicts[d] = found;
+    else
+      dicts[d] = mesh.create_component(dict_name,dict_type)->handle<Dictionary>();
+    dicts_by_name[dict_name] = dicts[d];
+  }
+
+  // 2) Entities with the connectivity of all their spaces
+  const Uint nb_entities = in.read<Uint>();
+  for (Uint i=0; i<nb_entities; ++i)
+  {
+    Region& region = access_region(mesh.topology(),in.read_string());
+    const std::string entities_name = in.read_string();
+    const std::string entities_type = in.read_string();
+    const std::string element_type  = in.read_string();
+
+    Handle<Entities> entities(region.get_child(entities_name));
+    if ( is_null(entities) )
+    {
+      boost::shared_ptr<Entities> created = build_component_abstract_type<Entities>(entities_type,entities_name);
+      region.add_component(created);
+      created->initialize(element_type,mesh.geometry_fields());
+      entities = created->handle<Entities>();
+    }
+
+    const Uint nb_elems = in.read_array_size();
+    entities->glb_idx().resize(nb_elems);
+    in.read_array_data(entities->glb_idx().array().data(),nb_elems);
+    check_array_size(in.read_array_size(),nb_elems,"ranks of "+entities->uri().path());
+    entities->rank().resize(nb_elems);
+    in.read_array_data(entities->rank().array().data(),nb_elems);
+
+    const Uint nb_spaces = in.read<Uint>();
+    std::vector< Handle<Space> > spaces(nb_spaces);
+    for (Uint s=0; s<nb_spaces; ++s)
+    {
+      const std::string dict_name = in.read_string();
+      const std::string shape_function = in.read_string();
+      const Uint row_size = in.read<Uint>();
+
+      if ( dicts_by_name.count(dict_name) == 0 )
+        throw FileFormatError(FromHere(), file.string()+" refers to undeclared dictionary "+dict_name);
+      Dictionary& dict = *dicts_by_name[dict_name];
+
+      if (&dict == &mesh.geometry_fields())
+        spaces[s] = entities->geometry_space().handle<Space>();
+      else if (dict.defined_for_entities(entities))
+        spaces[s] = entities->space(dict).handle<Space>();
+      else
+        spaces[s] = entities->create_space(shape_function,dict).handle<Space>();
+
+      Connectivity& connectivity = spaces[s]->connectivity();
+      connectivity.set_row_size(row_size);
+      connectivity.resize(nb_elems);
+      check_array_size(in.read_array_size(),nb_elems*row_size,"connectivity of "+spaces[s]->uri().path());
+      in.read_array_data(connectivity.array().data(),nb_elems*row_size);
+    }
+
+    if (owned_only)
+    {
+      Uint nb_owned = 0;
+      for (Uint e=0; e<nb_elems; ++e)
+      {
+        if (entities->rank()[e] != header.part)
+          continue;
+        if (nb_owned != e)
+        {
+          entities->glb_idx()[nb_owned] = entities->glb_idx()[e];
+          entities->rank()[nb_owned] = entities->rank()[e];
+          boost_foreach(const Handle<Space>& space, spaces)
+            space->connectivity().array()[nb_owned] = space->connectivity().array()[e];
+        }
+        ++nb_owned;
+      }
+      entities->resize(nb_owned);
+    }
+  }
+
+  // 3) Nodes of the dictionaries, with their fields
+  for (Uint d=0; d<nb_dicts; ++d)
+  {
+    Dictionary& dict = *dicts[d];
+    const Uint nb_nodes = in.read_array_size();
+    dict.resize(nb_nodes);
+    in.read_array_data(dict.glb_idx().array().data(),nb_nodes);
+    check_array_size(in.read_array_size(),nb_nodes,"ranks of "+dict.uri().path());
+    in.read_array_data(dict.rank().array().data(),nb_nodes);
+
+    const Uint nb_fields = in.read<Uint>();
+    for (Uint f=0; f<nb_fields; ++f)
+    {
+      const std::string field_name  = in.read_string();
+      const std::string description = in.read_string();
+      const Uint dimension = in.read<Uint>();
+      const Uint var_type  = in.read<Uint>();
+      const Uint row_size  = in.read<Uint>();
+
+      Handle<Field> field(dict.get_child(field_name));
+      if ( is_null(field) )
+      {
+        field = dict.create_component<Field>(field_name);
+        field->set_dict(dict);
+        field->create_descriptor(description,dimension);
+      }
+      field->set_var_type(static_cast<VarType>(var_type));
+      field->set_row_size(row_size);
+      field->resize(nb_nodes);
+
+      const Uint nb_tags = in.read<Uint>();
+      for (Uint t=0; t<nb_tags; ++t)
+      {
+        const std::string tag = in.read_string();
+        if ( !field->has_tag(tag) )
+          field->add_tag(tag);
+      }
+
+      field->properties()["time"] = in.read<Real>();
+      field->properties()["step"] = in.read<Uint>();
+      field->set_single_precision(in.read<Uint>() != 0u);
+
+      check_array_size(in.read_array_size(),nb_nodes*row_size,"values of "+field->uri().path());
+      in.read_array_data(field->array().data(),nb_nodes*row_size);
+    }
+    dict.update_structures();
+
+    if (owned_only)
+      remove_unused_nodes(dict);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // native
+} // mesh
+} // cf3
@@ -0,0 +1,86 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_native_Reader_hpp
+#define cf3_mesh_native_Reader_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/BoostFilesystem.hpp"
+
+#include "mesh/MeshReader.hpp"
+
+#include "mesh/native/LibNative.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace native {
+
+  struct Header;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Reads a mesh written by native::Writer
+///
+/// When the number of ranks equals the number of parts in the file, every rank
+/// memory-maps its own part and copies it straight into the mesh: global indices,
+/// ranks and ghost entities are restored as written, so that no global numbering,
+/// partitioning or overlap growing is necessary.
+/// When the number of ranks differs, the parts are distributed round-robin over the ranks,
+/// their ghost entities are dropped, and the combined mesh is load balanced again.
+class native_API Reader : public MeshReader
+{
+public: // functions
+
+  /// constructor
+  Reader( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "Reader"; }
+
+  virtual std::string get_format() { return "native"; }
+
+  virtual std::vector<std::string> get_extensions();
+
+  /// @return the header of the first part of a native mesh file, telling among others
+  ///         the number of parts
+  static Header read_header(const boost::filesystem::path& path);
+
+  /// Read a single part into a mesh
+  /// @param [in]     file        the part file
+  /// @param [in]     part        the part the file is expected to hold
+  /// @param [in]     nb_parts    the expected total number of parts
+  /// @param [in,out] mesh        the mesh to read into
+  /// @param [in]     owned_only  skip the ghost elements of this part, and the nodes
+  ///                             that are only used by ghost elements
+  /// @throws common::FileFormatError if the header of the file has a different part or number of parts
+  void read_part(const boost::filesystem::path& file, const Uint part, const Uint nb_parts, Mesh& mesh, const bool owned_only);
+
+private: // functions
+
+  virtual void do_read_mesh_into(const common::URI& path, Mesh& mesh);
+
+  /// Read parts written with a different number of ranks, and load balance the result
+  void read_redistributed(const boost::filesystem::path& path, const Uint nb_parts, Mesh& mesh);
+
+private: // data
+
+  /// verify the checksum of every part before reading it
+  bool m_verify_checksum;
+
+}; // end Reader
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // native
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_native_Reader_hpp
@@ -0,0 +1,135 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <ostream>
+
+#include <boost/static_assert.hpp>
+
+#include "common/StringConversion.hpp"
+
+#include "mesh/native/Shared.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace native {
+
+using namespace common;
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_STATIC_ASSERT(sizeof(Header) == 64);
+
+namespace {
+  const char magic_string[8] = "CF3MESH";
+  const boost::uint32_t format_version = 1u;
+  const boost::uint32_t byte_order_mark = 0x01020304u;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Header::Header() :
+  version(format_version),
+  byte_order(byte_order_mark),
+  uint_size(sizeof(Uint)),
+  real_size(sizeof(Real)),
+  part(0),
+  nb_parts(1),
+  dimension(0),
+  iter(0),
+  checksum(0),
+  source_hash(0),
+  payload_size(0),
+  time(0.)
+{
+  std::memcpy(magic,magic_string,sizeof(magic));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Header::check(const std::string& file) const
+{
+  if (std::memcmp(magic,magic_string,sizeof(magic)) != 0)
+    throw FileFormatError(FromHere(), file+" is not a native coolfluid mesh file");
+  if (version != format_version)
+    throw FileFormatError(FromHere(), file+" has format version "+to_str(version)+", expected "+to_str(format_version));
+  if (byte_order != byte_order_mark)
+    throw FileFormatError(FromHere(), file+" was written on a platform with different byte order");
+  if (uint_size != sizeof(Uint) || real_size != sizeof(Real))
+    throw FileFormatError(FromHere(), file+" was written with sizeof(Uint)="+to_str(uint_size)+
+                          " and sizeof(Real)="+to_str(real_size)+", which differs from this build");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BinaryOutput::BinaryOutput(std::ostream& stream) :
+  m_stream(stream),
+  m_size(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BinaryOutput::write(const void* data, const std::size_t bytes)
+{
+  m_stream.write(static_cast<const char*>(data),bytes);
+  m_crc.process_bytes(data,bytes);
+  m_size += bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BinaryOutput::write(const std::string& str)
+{
+  write(static_cast<boost::uint32_t>(str.size()));
+  write(str.data(),str.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BinaryInput::BinaryInput(const char* begin, const char* end) :
+  m_pos(begin),
+  m_end(end)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BinaryInput::read(void* data, const std::size_t bytes)
+{
+  if (static_cast<std::size_t>(m_end-m_pos) < bytes)
+    throw FileFormatError(FromHere(), "Unexpected end of native mesh payload");
+  std::memcpy(data,m_pos,bytes);
+  m_pos += bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string BinaryInput::read_string()
+{
+  const boost::uint32_t length = read<boost::uint32_t>();
+  if (static_cast<std::size_t>(m_end-m_pos) < length)
+    throw FileFormatError(FromHere(), "Unexpected end of native mesh payload");
+  std::string str(m_pos,length);
+  m_pos += length;
+  return str;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+boost::filesystem::path part_path(const boost::filesystem::path& path, const Uint part, const Uint nb_parts)
+{
+  if (nb_parts == 1)
+    return path;
+  return path.parent_path() / boost::filesystem::path(boost::filesystem::basename(path) + "_P" + to_str(part) + boost::filesystem::extension(path));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // native
+} // mesh
+} // cf3
@@ -0,0 +1,160 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_native_Shared_hpp
+#define cf3_mesh_native_Shared_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <iosfwd>
+#include <cstring>
+
+#include <boost/cstdint.hpp>
+#include <boost/crc.hpp>
+
+#include "common/BoostFilesystem.hpp"
+#include "common/BasicExceptions.hpp"
+
+#include "mesh/native/LibNative.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace native {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Fixed size header at the start of every native mesh file
+///
+/// A mesh written on N ranks is stored as N part files. Every part carries
+/// the total number of parts, so that a reader can decide between a direct
+/// read (same number of ranks) and a redistribution.
+/// The payload following the header is protected by a CRC-32 checksum.
+struct native_API Header
+{
+  /// Initializes magic, version and type sizes for the running platform
+  Header();
+
+  /// Throws common::FileFormatError if this header was not written
+  /// by a compatible writer
+  void check(const std::string& file) const;
+
+  char            magic[8];      ///< "CF3MESH"
+  boost::uint32_t version;       ///< format version
+  boost::uint32_t byte_order;    ///< 0x01020304 in the byte order of the writer
+  boost::uint32_t uint_size;     ///< sizeof(Uint) of the writer
+  boost::uint32_t real_size;     ///< sizeof(Real) of the writer
+  boost::uint32_t part;          ///< part (rank) stored in this file
+  boost::uint32_t nb_parts;      ///< total number of parts
+  boost::uint32_t dimension;     ///< coordinate dimension of the mesh
+  boost::uint32_t iter;          ///< iteration stored in the mesh metadata
+  boost::uint32_t checksum;      ///< CRC-32 of the payload
+  boost::uint32_t source_hash;   ///< hash of the file this mesh was converted from, zero if none
+  boost::uint64_t payload_size;  ///< number of bytes following the header
+  double          time;          ///< time stored in the mesh metadata
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Binary output stream that keeps track of size and checksum
+class native_API BinaryOutput
+{
+public:
+
+  /// constructor
+  BinaryOutput(std::ostream& stream);
+
+  /// Write raw bytes
+  void write(const void* data, const std::size_t bytes);
+
+  /// Write a string, prefixed by its length
+  void write(const std::string& str);
+
+  /// Write a plain-old-data value
+  template <typename T>
+  void write(const T& value) { write(&value,sizeof(T)); }
+
+  /// Write a contiguous array, prefixed by its number of entries
+  template <typename T>
+  void write_array(const T* data, const std::size_t count)
+  {
+    write(static_cast<boost::uint64_t>(count));
+    if (count)
+      write(static_cast<const void*>(data),count*sizeof(T));
+  }
+
+  /// @return the CRC-32 checksum of everything written so far
+  boost::uint32_t checksum() const { return m_crc.checksum(); }
+
+  /// @return the number of bytes written so far
+  boost::uint64_t size() const { return m_size; }
+
+private:
+
+  std::ostream& m_stream;
+  boost::crc_32_type m_crc;
+  boost::uint64_t m_size;
+
+}; // end BinaryOutput
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Bounds-checked reader of a binary payload kept in memory
+///
+/// The payload is typically a memory-mapped file, so that reading
+/// amounts to copying the arrays straight into the mesh tables.
+class native_API BinaryInput
+{
+public:
+
+  /// constructor
+  BinaryInput(const char* begin, const char* end);
+
+  /// Read raw bytes
+  void read(void* data, const std::size_t bytes);
+
+  /// Read a string, prefixed by its length
+  std::string read_string();
+
+  /// Read a plain-old-data value
+  template <typename T>
+  T read() { T value; read(&value,sizeof(T)); return value; }
+
+  /// Read the number of entries of an array written by BinaryOutput::write_array()
+  std::size_t read_array_size() { return static_cast<std::size_t>(read<boost::uint64_t>()); }
+
+  /// Read the entries of an array, after its size was read with read_array_size()
+  template <typename T>
+  void read_array_data(T* data, const std::size_t count)
+  {
+    if (count)
+      read(static_cast<void*>(data),count*sizeof(T));
+  }
+
+private:
+
+  const char* m_pos;
+  const char* m_end;
+
+}; // end BinaryInput
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @return the file storing a given part
+/// @note A single part is stored in the given path itself, more parts are stored
+///       in "<basename>_P<part><extension>", as done by the other mesh writers.
+native_API boost::filesystem::path part_path(const boost::filesystem::path& path, const Uint part, const Uint nb_parts);
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // native
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_native_Shared_hpp
@@ -0,0 +1,204 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <boost/algorithm/string/replace.hpp>
+
+#include "common/BoostFilesystem.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/Builder.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Tags.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+
+#include "mesh/native/Writer.hpp"
+#include "mesh/native/Shared.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/ShapeFunction.hpp"
+#include "mesh/Tags.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3::common;
+
+namespace cf3 {
+namespace mesh {
+namespace native {
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < native::Writer, MeshWriter, LibNative> aNativeWriter_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+Writer::Writer( const std::string& name )
+: MeshWriter(name)
+{
+  m_all_fields = true;
+  options().add("all_fields", m_all_fields)
+      .pretty_name("All Fields")
+      .description("Write all fields of all dictionaries, as needed for a restart. "
+                   "If false, only the coordinates and the fields given in the fields option are written.")
+      .link_to(&m_all_fields)
+      .mark_basic();
+
+  m_source_hash = 0u;
+  options().add("source_hash", m_source_hash)
+      .pretty_name("Source Hash")
+      .description("Hash of the file the mesh was read from, stored in the header so that "
+                   "a cached copy can be recognized as up to date (see native::MeshCache)")
+      .link_to(&m_source_hash);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> Writer::get_extensions()
+{
+  std::vector<std::string> extensions;
+  extensions.push_back(".cf3mesh");
+  return extensions;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write()
+{
+  const Uint nb_parts = PE::Comm::instance().is_active() ? PE::Comm::instance().size() : 1u;
+  const Uint part     = PE::Comm::instance().is_active() ? PE::Comm::instance().rank() : 0u;
+  const boost::filesystem::path path = part_path(boost::filesystem::path(m_file_path.path()),part,nb_parts);
+
+  boost::filesystem::fstream file;
+  file.open(path,std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!file) // didn't open so throw exception
+  {
+     throw boost::filesystem::filesystem_error( path.string() + " failed to open",
+                                                boost::system::error_code() );
+  }
+
+  Header header;
+  header.part = part;
+  header.nb_parts = nb_parts;
+  header.dimension = m_mesh->dimension();
+  header.iter = m_mesh->metadata().properties().value<Uint>("iter");
+  header.time = m_mesh->metadata().properties().value<Real>("time");
+
+  // Header is written twice: first as placeholder, then with the checksum.
+  // The source hash is only set in the final header, so that an interrupted
+  // write is never taken for an up to date cache.
+  file.write(reinterpret_cast<const char*>(&header),sizeof(Header));
+
+  // Dictionaries are declared first, as spaces of the entities refer to them
+  BinaryOutput out(file);
+  out.write(static_cast<Uint>(m_mesh->dictionaries().size()));
+  boost_foreach(const Handle<Dictionary>& dict, m_mesh->dictionaries())
+  {
+    out.write(dict->name());
+    out.write(dict->derived_type_name());
+  }
+  write_entities(out);
+  write_dictionaries(out);
+
+  header.checksum = out.checksum();
+  header.payload_size = out.size();
+  header.source_hash = static_cast<boost::uint32_t>(m_source_hash);
+  file.seekp(0,std::ios_base::beg);
+  file.write(reinterpret_cast<const char*>(&header),sizeof(Header));
+
+  if (!file)
+    throw boost::filesystem::filesystem_error( path.string() + " could not be written",
+                                               boost::system::error_code() );
+  file.close();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_dictionaries(BinaryOutput& out)
+{
+  boost_foreach(const Handle<Dictionary>& dict, m_mesh->dictionaries())
+  {
+    out.write_array(dict->glb_idx().array().data(),dict->size());
+    out.write_array(dict->rank().array().data(),dict->size());
+
+    std::vector< Handle<Field const> > fields;
+    boost_foreach(const Handle<Field>& field, dict->fields())
+    {
+      bool selected = m_all_fields || field->has_tag(mesh::Tags::coordinates());
+      boost_foreach(const Handle<Field const>& configured_field, m_fields)
+        selected = selected || configured_field.get() == field.get();
+      if (selected)
+        fields.push_back(field);
+    }
+
+    out.write(static_cast<Uint>(fields.size()));
+    boost_foreach(const Handle<Field const>& field, fields)
+    {
+      out.write(field->name());
+      out.write(field->descriptor().description());
+      out.write(field->descriptor().options().value<Uint>(common::Tags::dimension()));
+      out.write(static_cast<Uint>(field->var_type()));
+      out.write(field->row_size());
+
+      const std::vector<std::string> tags = field->get_tags();
+      out.write(static_cast<Uint>(tags.size()));
+      boost_foreach(const std::string& tag, tags)
+        out.write(tag);
+
+      out.write(field->properties().value<Real>("time"));
+      out.write(field->properties().value<Uint>("step"));
+      out.write(static_cast<Uint>(field->single_precision()));
+
+      out.write_array(field->array().data(),field->size()*field->row_size());
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_entities(BinaryOutput& out)
+{
+  out.write(static_cast<Uint>(m_mesh->elements().size()));
+  boost_foreach(const Handle<Entities>& entities, m_mesh->elements())
+  {
+    // Region path relative to the topology
+    std::string region_path = entities->parent()->uri().path();
+    boost::algorithm::replace_first(region_path,m_mesh->topology().uri().path(),"");
+
+    out.write(region_path);
+    out.write(entities->name());
+    out.write(entities->derived_type_name());
+    out.write(entities->element_type().derived_type_name());
+    out.write_array(entities->glb_idx().array().data(),entities->size());
+    out.write_array(entities->rank().array().data(),entities->size());
+
+    const std::vector< Handle<Space> > spaces = entities->spaces();
+    out.write(static_cast<Uint>(spaces.size()));
+    boost_foreach(const Handle<Space>& space, spaces)
+    {
+      const Connectivity& connectivity = space->connectivity();
+      out.write(space->dict().name());
+      out.write(space->shape_function().derived_type_name());
+      out.write(connectivity.row_size());
+      out.write_array(connectivity.array().data(),connectivity.size()*connectivity.row_size());
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // native
+} // mesh
+} // cf3
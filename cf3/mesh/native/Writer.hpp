@@ -0,0 +1,73 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_native_Writer_hpp
+#define cf3_mesh_native_Writer_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mesh/MeshWriter.hpp"
+
+#include "mesh/native/LibNative.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace native {
+
+  class BinaryOutput;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// @brief Writes a mesh in the native binary format, suitable for restarts
+///
+/// Every rank writes its own partition, including ghost entities, global indices,
+/// ranks, all dictionaries with their spaces, and the fields.
+/// Reading it back on the same number of ranks reproduces the partitioned mesh
+/// exactly, without repartitioning. The regions option is ignored, as
+/// a restart requires the complete mesh.
+class native_API Writer : public MeshWriter
+{
+public: // functions
+
+  /// constructor
+  Writer( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "Writer"; }
+
+  virtual void write();
+
+  virtual std::string get_format() { return "native"; }
+
+  virtual std::vector<std::string> get_extensions();
+
+private: // functions
+
+  void write_dictionaries(BinaryOutput& out);
+
+  void write_entities(BinaryOutput& out);
+
+private: // data
+
+  /// write all fields, instead of only the configured ones
+  bool m_all_fields;
+
+  /// hash of the file the mesh was read from, zero if none
+  Uint m_source_hash;
+
+}; // end Writer
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // native
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_native_Writer_hpp
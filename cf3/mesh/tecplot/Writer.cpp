@@ -4,8 +4,11 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <iostream>
-#include <set>
+
+#include <boost/assign/list_of.hpp>
+
 #include "common/BoostFilesystem.hpp"
 #include "common/Foreach.hpp"
 #include "common/Log.hpp"
@@ -73,7 +76,7 @@ void Writer::write()
     path = boost::filesystem::basename(path) + "_P" + to_str(PE::Comm::instance().rank()) + boost::filesystem::extension(path);
   }
 //  CFLog(VERBOSE, "Opening file " <<  path.string() << "\n");
-  file.open(path,std::ios_base::out);
+  file.open(path, m_binary ? std::ios_base::out | std::ios_base::binary : std::ios_base::out);
   if (!file) // didn't open so throw exception
   {
      throw boost::filesystem::filesystem_error( path.string() + " failed to open",
@@ -81,11 +84,210 @@ void Writer::write()
   }
 
 
-  write_file(file);
+  if (m_binary)
+    write_binary_file(file);
+  else
+    write_file(file);
 
   file.close();
 
 }
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+void write_int(std::ostream& file, const int value)
+{
+  file.write(reinterpret_cast<const char*>(&value), sizeof(int));
+}
+
+void write_float(std::ostream& file, const float value)
+{
+  file.write(reinterpret_cast<const char*>(&value), sizeof(float));
+}
+
+void write_double(std::ostream& file, const double value)
+{
+  file.write(reinterpret_cast<const char*>(&value), sizeof(double));
+}
+
+/// Strings are written as one 32 bit integer per character, followed by a zero
+void write_string(std::ostream& file, const std::string& str)
+{
+  boost_foreach(const char c, str)
+    write_int(file, c);
+  write_int(file, 0);
+}
+
+template<typename T>
+void write_block(std::ostream& file, const std::vector<T>& values)
+{
+  if (!values.empty())
+    file.write(reinterpret_cast<const char*>(&values[0]), values.size()*sizeof(T));
+}
+
+void write_ascii_values(std::ostream& file, const std::vector<Real>& values)
+{
+  for (Uint n=0; n<values.size(); ++n)
+  {
+    file << values[n] << " ";
+    CF3_BREAK_LINE(file,n)
+  }
+  file << "\n";
+}
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool Writer::build_zone(const Entities& elements, Zone& zone) const
+{
+  zone.elements = elements.handle<Entities>();
+  zone.nb_elems = elements.size();
+  if(m_enable_overlap == false)
+  {
+    for (Uint e=0; e<elements.size(); ++e)
+    {
+      if (elements.is_ghost(e))
+        --zone.nb_elems;
+    }
+  }
+
+  zone.name = elements.parent()->uri().path();
+  boost::algorithm::replace_first(zone.name,m_mesh->topology().uri().path()+"/","");
+
+  // tecplot doesn't handle zones with 0 elements
+  // which can happen in parallel, so skip them
+  if (zone.nb_elems == 0)
+    return false;
+
+  if (elements.element_type().order() != 1)
+  {
+    throw NotImplemented(FromHere(), "Tecplot can only output P1 elements. A new P1 space should be created, and used as geometry space");
+  }
+
+  zone.used_nodes = mesh::build_used_nodes_list(elements,m_mesh->geometry_fields(),m_enable_overlap);
+  zone.node_idx.clear();
+  for (Uint n=0; n<zone.used_nodes->size(); ++n)
+    zone.node_idx[ (*zone.used_nodes)[n] ] = n+1;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool Writer::cell_centred(const Field& field) const
+{
+  return field.discontinuous() && options().value<bool>("cell_centred");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool Writer::variable_values(const Zone& zone, const Field& field, const Uint var_idx, std::vector<Real>& values) const
+{
+  const Entities& elements = *zone.elements;
+  const common::List<Uint>& used_nodes = *zone.used_nodes;
+  values.clear();
+
+  // Continuous field in the geometry space: direct copy
+  if (field.continuous() && &field.dict() == &m_mesh->geometry_fields())
+  {
+    values.reserve(used_nodes.size());
+    boost_foreach(Uint n, used_nodes.array())
+      values.push_back(field[n][var_idx]);
+    return true;
+  }
+
+  if (!field.dict().defined_for_entities(elements.handle<Entities>()))
+    return false;
+
+  const Space& field_space = field.space(elements);
+  const ShapeFunction& sf = field_space.shape_function();
+  RealVector field_data (sf.nb_nodes());
+
+  if (cell_centred(field))
+  {
+    boost::shared_ptr< ShapeFunction > P0_cell_centred = boost::dynamic_pointer_cast<ShapeFunction>(build_component("cf3.mesh.LagrangeP0."+to_str(elements.element_type().shape_name()),"tmp_shape_func"));
+
+    /// get cell-centred local coordinates
+    const RealVector local_coords = P0_cell_centred->local_coordinates().row(0);
+    const RealRowVector sf_values = sf.value(local_coords);
+
+    values.reserve(zone.nb_elems);
+    for (Uint e=0; e<elements.size(); ++e)
+    {
+      if (m_enable_overlap || !elements.is_ghost(e))
+      {
+        Connectivity::ConstRow field_index = field_space.connectivity()[e];
+        /// set field data
+        for (Uint iState=0; iState<sf.nb_nodes(); ++iState)
+        {
+          field_data[iState] = field[field_index[iState]][var_idx];
+        }
+
+        /// evaluate field shape function in P0 space
+        values.push_back(sf_values*field_data);
+      }
+    }
+    return true;
+  }
+
+  // Interpolate to the geometry nodes. Discontinuous values are averaged.
+  values.assign(used_nodes.size(),0.);
+  std::vector<Uint> nodal_data_count(used_nodes.size(),0u);
+
+  RealMatrix interpolation(elements.geometry_space().shape_function().nb_nodes(),sf.nb_nodes());
+  const RealMatrix& geometry_local_coords = elements.geometry_space().shape_function().local_coordinates();
+  for (Uint g=0; g<interpolation.rows(); ++g)
+  {
+    interpolation.row(g) = sf.value(geometry_local_coords.row(g));
+  }
+
+  for (Uint e=0; e<elements.size(); ++e)
+  {
+    // Skip this element if it is a ghost cell and overlap is disabled
+    if (field.continuous() && !m_enable_overlap && elements.is_ghost(e))
+      continue;
+
+    // get the node indices of this element
+    Connectivity::ConstRow field_index = field_space.connectivity()[e];
+
+    /// set field data
+    for (Uint iState=0; iState<sf.nb_nodes(); ++iState)
+    {
+      field_data[iState] = field[field_index[iState]][var_idx];
+    }
+
+    /// evaluate field shape function in P0 space
+    RealVector geometry_field_data = interpolation*field_data;
+
+    Connectivity::ConstRow geom_nodes = elements.geometry_space().connectivity()[e];
+    cf3_assert(geometry_field_data.size()==geom_nodes.size());
+    for (Uint g=0; g<geom_nodes.size(); ++g)
+    {
+      std::map<Uint,Uint>::const_iterator node_it = zone.node_idx.find(geom_nodes[g]);
+      if (node_it == zone.node_idx.end())
+        continue;
+      const Uint node_idx = node_it->second-1;
+      cf3_assert(node_idx < values.size());
+      if (field.continuous())
+      {
+        values[node_idx] = geometry_field_data[g];
+      }
+      else
+      {
+        /// Average nodal values
+        const Real accumulated_weight = nodal_data_count[node_idx]/(nodal_data_count[node_idx]+1.0);
+        const Real add_weight = 1.0/(nodal_data_count[node_idx]+1.0);
+        values[node_idx] = accumulated_weight*values[node_idx] + add_weight*geometry_field_data[g];
+        ++nodal_data_count[node_idx];
+      }
+    }
+  }
+  return true;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 
 void Writer::write_file(std::fstream& file)
@@ -101,10 +303,15 @@ void Writer::write_file(std::fstream& file)
   }
 
   std::vector<Uint> cell_centered_var_ids;
+  // data type of every variable, coordinates are always written in double precision
+  std::vector<std::string> var_data_types(dimension,"DOUBLE");
+  bool has_single_precision_vars = false;
   Uint zone_var_id(dimension);
   boost_foreach(Handle<Field const> field_ptr, m_fields)
   {
     const Field& field = *field_ptr;
+    const bool single = single_precision(field);
+    has_single_precision_vars = has_single_precision_vars || single;
     for (Uint iVar=0; iVar<field.nb_vars(); ++iVar)
     {
       VarType var_type = field.var_length(iVar);
@@ -116,6 +323,7 @@ void Writer::write_file(std::fstream& file)
         {
           file << " \"" << var_name << "["<<i<<"]\"";
           ++zone_var_id;
+          var_data_types.push_back(single ? "SINGLE" : "DOUBLE");
           if (field.discontinuous())
             cell_centered_var_ids.push_back(zone_var_id);
         }
@@ -124,6 +332,7 @@ void Writer::write_file(std::fstream& file)
       {
         file << " \"" << var_name <<"\"";
         ++zone_var_id;
+        var_data_types.push_back(single ? "SINGLE" : "DOUBLE");
         if (field.discontinuous())
           cell_centered_var_ids.push_back(zone_var_id);
       }
@@ -134,8 +343,9 @@ void Writer::write_file(std::fstream& file)
 
   // loop over the element types
   // and create a zone in the tecplot file for each element type
-//  std::map<Handle<Component const>,Uint> zone_id;
   Uint zone_idx=0;
+  Zone zone;
+  std::vector<Real> values;
   boost_foreach (const Handle<Entities const>& elements_h, m_filtered_entities )
   {
     Entities const& elements = *elements_h;
@@ -143,57 +353,20 @@ void Writer::write_file(std::fstream& file)
     if (etype.shape() == GeoShape::POINT)
       continue;
 
-    Uint nb_elems = elements.size();
-
-    if(m_enable_overlap == false)
-    {
-      Uint nb_ghost_elems = 0;
-      for (Uint e=0; e<nb_elems; ++e)
-      {
-        if (elements.is_ghost(e))
-          ++nb_ghost_elems;
-      }
-      nb_elems -= nb_ghost_elems;
-    }
-
-    std::string zone_name = elements.parent()->uri().path();
-    boost::algorithm::replace_first(zone_name,m_mesh->topology().uri().path()+"/","");
-    std::set<std::string> zone_names;
-    if (zone_names.count(zone_name) == 0)
-    {
-      zone_idx++;
-      zone_names.insert(zone_name);
-    }
-//    zone_id[elements.handle<Component>()] = zone_idx++;
-
-    // tecplot doesn't handle zones with 0 elements
-    // which can happen in parallel, so skip them
-    if (nb_elems == 0)
+    zone_idx++;
+    if (!build_zone(elements,zone))
       continue;
-
-    if (etype.order() != 1)
-    {
-      throw NotImplemented(FromHere(), "Tecplot can only output P1 elements. A new P1 space should be created, and used as geometry space");
-    }
-
-    boost::shared_ptr< common::List<Uint> > used_nodes_ptr = mesh::build_used_nodes_list(elements,m_mesh->geometry_fields(),m_enable_overlap);
-    common::List<Uint>& used_nodes = *used_nodes_ptr;
-    std::map<Uint,Uint> zone_node_idx;
-    for (Uint n=0; n<used_nodes.size(); ++n)
-      zone_node_idx[ used_nodes[n] ] = n+1;
-
-    const Uint nbCellsInType  = elements.size();
-
+    const common::List<Uint>& used_nodes = *zone.used_nodes;
 
     // print zone header,
     // one zone per element type per cpu
     // therefore the title is dependent on those parameters
     file << "ZONE "
-         << "  T=\"STEP"<<m_mesh->metadata().properties().value<Uint>("iter") << ":" << zone_name << "\""
+         << "  T=\"STEP"<<m_mesh->metadata().properties().value<Uint>("iter") << ":" << zone.name << "\""
          << ", STRANDID="<<zone_idx
          << ", SOLUTIONTIME="<<m_mesh->metadata().properties().value<Real>("time")
          << ", N=" << used_nodes.size()
-         << ", E=" << nb_elems
+         << ", E=" << zone.nb_elems
          << ", DATAPACKING=BLOCK"
          << ", ZONETYPE=" << zone_type(etype);
     if (cell_centered_var_ids.size() && options().value<bool>("cell_centred"))
@@ -203,14 +376,15 @@ void Writer::write_file(std::fstream& file)
         file << ","<<cell_centered_var_ids[i];
       file << "]=CELLCENTERED)";
     }
+    if (has_single_precision_vars)
+    {
+      file << ", DT=(";
+      boost_foreach(const std::string& data_type, var_data_types)
+        file << data_type << " ";
+      file << ")";
+    }
     file << "\n\n";
 
-
-         //    fout << ", VARLOCATION=( [" << init_id << "]=CELLCENTERED )" ;
-         //   else
-         //    fout << ", VARLOCATION=( [" << init_id << "-" << end_id << "]=CELLCENTERED )" ;
-         // }
-
     file.setf(std::ios::scientific,std::ios::floatfield);
     file.precision(12);
 
@@ -233,6 +407,8 @@ void Writer::write_file(std::fstream& file)
     boost_foreach(Handle<Field const> field_ptr, m_fields)
     {
       const Field& field = *field_ptr;
+      // 9 significant digits are needed to read back a single precision value exactly
+      file.precision(single_precision(field) ? 9 : 12);
       Uint var_idx(0);
       for (Uint iVar=0; iVar<field.nb_vars(); ++iVar)
       {
@@ -242,173 +418,14 @@ void Writer::write_file(std::fstream& file)
 
         for (Uint i=0; i<static_cast<Uint>(var_type); ++i)
         {
-          if (field.continuous())
+          if (variable_values(zone,field,var_idx,values))
           {
-            // Continuous field with different space than geometry
-            if ( &field.dict() == &m_mesh->geometry_fields() )
-            {
-              boost_foreach(Uint n, used_nodes.array())
-              {
-                file << field[n][var_idx] << " ";
-                CF3_BREAK_LINE(file,n);
-              }
-              file << "\n";
-            }
-            // Continuous field with different space than geometry
-            else
-            {
-              if (field.dict().defined_for_entities(elements.handle<Entities>()) )
-              {
-                const Space& field_space = field.space(elements);
-                RealVector field_data (field_space.shape_function().nb_nodes());
-
-                std::vector<Real> nodal_data(used_nodes.size(),0.);
-
-                RealMatrix interpolation(elements.geometry_space().shape_function().nb_nodes(),field_space.shape_function().nb_nodes());
-                const RealMatrix& geometry_local_coords = elements.geometry_space().shape_function().local_coordinates();
-                const ShapeFunction& sf = field_space.shape_function();
-                for (Uint g=0; g<interpolation.rows(); ++g)
-                {
-                  interpolation.row(g) = sf.value(geometry_local_coords.row(g));
-                }
-
-                // Compute interpolated data in the vector nodal_data
-                for (Uint e=0; e<elements.size(); ++e)
-                {
-                  // Skip this element if it is a ghost cell and overlap is disabled
-                  if (m_enable_overlap || !elements.is_ghost(e))
-                  {
-                    // get the node indices of this element
-                    Connectivity::ConstRow field_index = field_space.connectivity()[e];
-
-                    /// set field data
-                    for (Uint iState=0; iState<field_space.shape_function().nb_nodes(); ++iState)
-                    {
-                      field_data[iState] = field[field_index[iState]][var_idx];
-                    }
-
-                    /// evaluate field shape function in P0 space
-                    RealVector geometry_field_data = interpolation*field_data;
-
-                    Connectivity::ConstRow geom_nodes = elements.geometry_space().connectivity()[e];
-                    cf3_assert(geometry_field_data.size()==geom_nodes.size());
-                    /// Average nodal values
-                    for (Uint g=0; g<geom_nodes.size(); ++g)
-                    {
-                      const Uint geom_node = geom_nodes[g];
-                      const Uint node_idx = zone_node_idx[geom_node]-1;
-                      cf3_assert(node_idx < nodal_data.size());
-                      nodal_data[node_idx] = geometry_field_data[g];
-                    }
-                  }
-                }
-                for (Uint n=0; n<nodal_data.size(); ++n)
-                {
-                  file << nodal_data[n] << " ";
-                  CF3_BREAK_LINE(file,n)
-                }
-                file << "\n";
-              }
-            }
+            detail::write_ascii_values(file,values);
           }
-          // Discontinuous fields
           else
           {
-            if (field.dict().defined_for_entities(elements.handle<Entities>()))
-            {
-              const Space& field_space = field.space(elements);
-              RealVector field_data (field_space.shape_function().nb_nodes());
-
-              if (options().value<bool>("cell_centred"))
-              {
-                boost::shared_ptr< ShapeFunction > P0_cell_centred = boost::dynamic_pointer_cast<ShapeFunction>(build_component("cf3.mesh.LagrangeP0."+to_str(elements.element_type().shape_name()),"tmp_shape_func"));
-
-                for (Uint e=0; e<elements.size(); ++e)
-                {
-                  if (m_enable_overlap || !elements.is_ghost(e))
-                  {
-                    Connectivity::ConstRow field_index = field_space.connectivity()[e];
-                    /// set field data
-                    for (Uint iState=0; iState<field_space.shape_function().nb_nodes(); ++iState)
-                    {
-                      field_data[iState] = field[field_index[iState]][var_idx];
-                    }
-
-                    /// get cell-centred local coordinates
-                    RealVector local_coords = P0_cell_centred->local_coordinates().row(0);
-
-                    /// evaluate field shape function in P0 space
-                    Real cell_centred_data = field_space.shape_function().value(local_coords)*field_data;
-
-                    /// Write cell centred value
-                    file << cell_centred_data << " ";
-                    CF3_BREAK_LINE(file,e);
-                  }
-                }
-                file << "\n";
-              }
-              else
-              {
-                std::vector<Real> nodal_data(used_nodes.size(),0.);
-                std::vector<Uint> nodal_data_count(used_nodes.size(),0u);
-
-                RealMatrix interpolation(elements.geometry_space().shape_function().nb_nodes(),field_space.shape_function().nb_nodes());
-                const RealMatrix& geometry_local_coords = elements.geometry_space().shape_function().local_coordinates();
-                const ShapeFunction& sf = field_space.shape_function();
-                for (Uint g=0; g<interpolation.rows(); ++g)
-                {
-                  interpolation.row(g) = sf.value(geometry_local_coords.row(g));
-                }
-
-                for (Uint e=0; e<elements.size(); ++e)
-                {
-                  Connectivity::ConstRow field_index = field_space.connectivity()[e];
-
-                  /// set field data
-                  for (Uint iState=0; iState<field_space.shape_function().nb_nodes(); ++iState)
-                  {
-                    field_data[iState] = field[field_index[iState]][var_idx];
-                  }
-
-                  /// evaluate field shape function in P0 space
-                  RealVector geometry_field_data = interpolation*field_data;
-
-                  Connectivity::ConstRow geom_nodes = elements.geometry_space().connectivity()[e];
-                  cf3_assert(geometry_field_data.size()==geom_nodes.size());
-                  /// Average nodal values
-                  for (Uint g=0; g<geom_nodes.size(); ++g)
-                  {
-                    const Uint geom_node = geom_nodes[g];
-                    if (zone_node_idx.find(geom_node) != zone_node_idx.end())
-                    {
-                      const Uint node_idx = zone_node_idx[geom_node]-1;
-                      cf3_assert(node_idx < nodal_data.size());
-                      const Real accumulated_weight = nodal_data_count[node_idx]/(nodal_data_count[node_idx]+1.0);
-                      const Real add_weight = 1.0/(nodal_data_count[node_idx]+1.0);
-                      nodal_data[node_idx] = accumulated_weight*nodal_data[node_idx] + add_weight*geometry_field_data[g];
-                      ++nodal_data_count[node_idx];
-                    }
-                  }
-                }
-
-                for (Uint n=0; n<nodal_data.size(); ++n)
-                {
-                  file << nodal_data[n] << " ";
-                    CF3_BREAK_LINE(file,n)
-                }
-                file << "\n";
-
-              }
-            }
-            else
-            {
-              // field not defined for this zone, so write zeros
-              if (options().value<bool>("cell_centred"))
-                file << nb_elems << "*" << 0.;
-              else
-                file << used_nodes.size() << "*" << 0.;
-              file << "\n";
-            }
+            // field not defined for this zone, so write zeros
+            file << (cell_centred(field) ? zone.nb_elems : used_nodes.size()) << "*" << 0. << "\n";
           }
           var_idx++;
         }
@@ -417,14 +434,16 @@ void Writer::write_file(std::fstream& file)
 
     file << "\n### connectivity\n\n";
     // write connectivity
+    const std::vector<Uint> nodes = zone_nodes(etype);
     const Connectivity& connectivity = elements.geometry_space().connectivity();
     for (Uint e=0; e<elements.size(); ++e)
     {
       if (m_enable_overlap || !elements.is_ghost(e))
       {
-        boost_foreach ( Uint n, connectivity[e])
+        Connectivity::ConstRow row = connectivity[e];
+        boost_foreach ( const Uint n, nodes)
         {
-          file << zone_node_idx[n] << " ";
+          file << zone.node_idx[row[n]] << " ";
         }
         file << "\n";
       }
@@ -434,6 +453,157 @@ void Writer::write_file(std::fstream& file)
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_binary_file(std::fstream& file)
+{
+  const Uint dimension = m_mesh->geometry_fields().coordinates().row_size();
+
+  // Variables, with data format (1 = float, 2 = double) and location (0 = nodes, 1 = cell centres)
+  std::vector<std::string> var_names;
+  std::vector<int> var_formats(dimension,2);
+  std::vector<int> var_locations(dimension,0);
+  for (Uint i = 0; i < dimension ; ++i)
+    var_names.push_back("x"+to_str(i));
+  boost_foreach(Handle<Field const> field_ptr, m_fields)
+  {
+    const Field& field = *field_ptr;
+    for (Uint iVar=0; iVar<field.nb_vars(); ++iVar)
+    {
+      const Uint var_length = static_cast<Uint>(field.var_length(iVar));
+      for (Uint i=0; i<var_length; ++i)
+      {
+        var_names.push_back(var_length > 1 ? field.var_name(iVar) + "[" + to_str(i) + "]" : field.var_name(iVar));
+        var_formats.push_back(single_precision(field) ? 1 : 2);
+        var_locations.push_back(cell_centred(field) ? 1 : 0);
+      }
+    }
+  }
+  const bool has_cell_centred_vars = std::count(var_locations.begin(),var_locations.end(),1) != 0;
+
+  std::vector<Zone> zones;
+  std::vector<Uint> strand_ids;
+  Uint zone_idx=0;
+  boost_foreach (const Handle<Entities const>& elements_h, m_filtered_entities )
+  {
+    if (elements_h->element_type().shape() == GeoShape::POINT)
+      continue;
+    zone_idx++;
+    zones.push_back(Zone());
+    if (build_zone(*elements_h,zones.back()))
+      strand_ids.push_back(zone_idx);
+    else
+      zones.pop_back();
+  }
+
+  // Header section
+  file.write("#!TDV112",8);
+  detail::write_int(file,1); // byte order
+  detail::write_int(file,0); // full file type
+  detail::write_string(file,"COOLFluiD Mesh Data");
+  detail::write_int(file,var_names.size());
+  boost_foreach(const std::string& var_name, var_names)
+    detail::write_string(file,var_name);
+
+  const Uint iter = m_mesh->metadata().properties().value<Uint>("iter");
+  const Real time = m_mesh->metadata().properties().value<Real>("time");
+  for (Uint z=0; z<zones.size(); ++z)
+  {
+    const Zone& zone = zones[z];
+    detail::write_float(file,299.); // zone marker
+    detail::write_string(file,"STEP"+to_str(iter)+":"+zone.name);
+    detail::write_int(file,-1); // no parent zone
+    detail::write_int(file,strand_ids[z]);
+    detail::write_double(file,time);
+    detail::write_int(file,-1); // not used
+    detail::write_int(file,binary_zone_type(zone.elements->element_type()));
+    detail::write_int(file,has_cell_centred_vars);
+    if (has_cell_centred_vars)
+    {
+      boost_foreach(const int location, var_locations)
+        detail::write_int(file,location);
+    }
+    detail::write_int(file,0); // no face neighbors
+    detail::write_int(file,0); // no user-defined face neighbor connections
+    detail::write_int(file,zone.used_nodes->size());
+    detail::write_int(file,zone.nb_elems);
+    detail::write_int(file,0); // I, J and K cell dimensions, unused
+    detail::write_int(file,0);
+    detail::write_int(file,0);
+    detail::write_int(file,0); // no auxiliary data
+  }
+  detail::write_float(file,357.); // end of header marker
+
+  // Data section. Min and max must precede the data, so all values of a zone are computed first.
+  std::vector< std::vector<Real> > zone_data(var_names.size());
+  std::vector<float> single_values;
+  std::vector<int> connectivity_values;
+  const common::Table<Real>& coordinates = m_mesh->geometry_fields().coordinates();
+  boost_foreach(const Zone& zone, zones)
+  {
+    const common::List<Uint>& used_nodes = *zone.used_nodes;
+    for (Uint d = 0; d < dimension; ++d)
+    {
+      zone_data[d].resize(used_nodes.size());
+      for (Uint n=0; n<used_nodes.size(); ++n)
+        zone_data[d][n] = coordinates[used_nodes[n]][d];
+    }
+
+    Uint zone_var = dimension;
+    boost_foreach(Handle<Field const> field_ptr, m_fields)
+    {
+      const Field& field = *field_ptr;
+      for (Uint var_idx=0; var_idx<field.row_size(); ++var_idx, ++zone_var)
+      {
+        if (!variable_values(zone,field,var_idx,zone_data[zone_var]))
+          zone_data[zone_var].assign(cell_centred(field) ? zone.nb_elems : used_nodes.size(), 0.);
+      }
+    }
+
+    detail::write_float(file,299.); // zone marker
+    boost_foreach(const int format, var_formats)
+      detail::write_int(file,format);
+    detail::write_int(file,0); // no passive variables
+    detail::write_int(file,0); // no variable sharing
+    detail::write_int(file,-1); // no connectivity sharing
+    boost_foreach(const std::vector<Real>& values, zone_data)
+    {
+      detail::write_double(file,values.empty() ? 0. : *std::min_element(values.begin(),values.end()));
+      detail::write_double(file,values.empty() ? 0. : *std::max_element(values.begin(),values.end()));
+    }
+    for (Uint var=0; var<zone_data.size(); ++var)
+    {
+      if (var_formats[var] == 1)
+      {
+        single_values.assign(zone_data[var].begin(),zone_data[var].end());
+        detail::write_block(file,single_values);
+      }
+      else
+      {
+        detail::write_block(file,zone_data[var]);
+      }
+    }
+
+    // zero-based connectivity
+    const Entities& elements = *zone.elements;
+    const std::vector<Uint> nodes = zone_nodes(elements.element_type());
+    const Connectivity& connectivity = elements.geometry_space().connectivity();
+    connectivity_values.clear();
+    connectivity_values.reserve(zone.nb_elems*nodes.size());
+    for (Uint e=0; e<elements.size(); ++e)
+    {
+      if (m_enable_overlap || !elements.is_ghost(e))
+      {
+        Connectivity::ConstRow row = connectivity[e];
+        boost_foreach ( const Uint n, nodes)
+          connectivity_values.push_back(zone.node_idx.find(row[n])->second-1);
+      }
+    }
+    detail::write_block(file,connectivity_values);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
 
 std::string Writer::zone_type(const ElementType& etype) const
 {
@@ -448,6 +618,39 @@ std::string Writer::zone_type(const ElementType& etype) const
   cf3_assert_desc("should not be here",false);
   return "INVALID";
 }
+
+/////////////////////////////////////////////////////////////////////////////
+
+int Writer::binary_zone_type(const ElementType& etype) const
+{
+  if ( etype.shape() == GeoShape::LINE)     return 1;
+  if ( etype.shape() == GeoShape::TRIAG)    return 2;
+  if ( etype.shape() == GeoShape::QUAD)     return 3;
+  if ( etype.shape() == GeoShape::TETRA)    return 4;
+  if ( etype.shape() == GeoShape::PYRAM)    return 5;
+  if ( etype.shape() == GeoShape::PRISM)    return 5;
+  if ( etype.shape() == GeoShape::HEXA)     return 5;
+  if ( etype.shape() == GeoShape::POINT)    return 1;
+  cf3_assert_desc("should not be here",false);
+  return -1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<Uint> Writer::zone_nodes(const ElementType& etype) const
+{
+  std::vector<Uint> nodes;
+  // bricks with coalesced nodes
+  if ( etype.shape() == GeoShape::PYRAM)
+    return boost::assign::list_of<Uint>(0)(1)(2)(3)(4)(4)(4)(4);
+  if ( etype.shape() == GeoShape::PRISM)
+    return boost::assign::list_of<Uint>(0)(1)(2)(2)(3)(4)(5)(5);
+  if ( etype.shape() == GeoShape::POINT)
+    return boost::assign::list_of<Uint>(0)(0);
+  for (Uint n=0; n<etype.nb_nodes(); ++n)
+    nodes.push_back(n);
+  return nodes;
+}
 ////////////////////////////////////////////////////////////////////////////////
 
 } // tecplot
@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "common/List.hpp"
+
 #include "mesh/MeshWriter.hpp"
 #include "mesh/GeoShape.hpp"
 
@@ -19,6 +21,8 @@
 namespace cf3 {
 namespace mesh {
   class ElementType;
+  class Entities;
+  class Field;
 namespace tecplot {
 
 //////////////////////////////////////////////////////////////////////////////
@@ -48,10 +52,41 @@ public: // functions
 
 private: // functions
 
+  /// One zone per element type per cpu
+  struct Zone
+  {
+    Handle<Entities const> elements;
+    std::string name;
+    Uint nb_elems;                                        ///< number of elements written, excluding ghosts if overlap is disabled
+    boost::shared_ptr< common::List<Uint> > used_nodes;  ///< geometry nodes of the zone
+    std::map<Uint,Uint> node_idx;                         ///< one-based index in used_nodes, for each geometry node
+  };
+
+  /// Write in the ASCII format
   void write_file(std::fstream& file);
 
+  /// Write in the binary format (version 112), with whole arrays per variable
+  void write_binary_file(std::fstream& file);
+
+  /// Fill in the zone for the given elements
+  /// @return false if the zone has no elements and must be skipped
+  bool build_zone(const Entities& elements, Zone& zone) const;
+
+  /// True if the field is written as cell centred data
+  bool cell_centred(const Field& field) const;
+
+  /// Compute the values of variable var_idx of the field, for each node or cell of the zone
+  /// @return false if the field is not defined in the zone
+  bool variable_values(const Zone& zone, const Field& field, const Uint var_idx, std::vector<Real>& values) const;
+
   std::string zone_type(const ElementType& etype) const;
 
+  /// Zone type code used in the binary format
+  int binary_zone_type(const ElementType& etype) const;
+
+  /// Element nodes in the order of the tecplot zone type, repeating nodes for shapes written as coalesced bricks
+  std::vector<Uint> zone_nodes(const ElementType& etype) const;
+
 private: // data
 
 
@@ -0,0 +1,60 @@
+# Reader for history files written by cf3.solver.History with option format="binary"
+#
+# Usage:
+#   import history
+#   columns = history.read('history.bin')
+#   plot(columns['time'], columns['probe_p'])
+
+import struct
+import numpy
+
+def read(filename):
+  """Read a binary history file, and return a dict mapping every column name to a numpy array.
+  Columns added after the first entries are padded with zeros for the earlier entries,
+  as in the tab separated format."""
+  f = open(filename,'rb')
+  try:
+    data = f.read()
+  finally:
+    f.close()
+
+  if data[0:7] != b'CF3HIST':
+    raise Exception(filename+' is not a binary history file')
+  (version,) = struct.unpack_from('=I',data,8)
+  if version != 1:
+    raise Exception(filename+' has unsupported version '+str(version))
+
+  names = []
+  chunks = []   # list of (nb_rows, names of columns, column-major array)
+  pos = 12
+  while pos < len(data):
+    (tag,) = struct.unpack_from('=I',data,pos)
+    pos += 4
+    if tag == ord('V'):
+      (nb_columns,) = struct.unpack_from('=I',data,pos)
+      pos += 4
+      names = []
+      for c in range(nb_columns):
+        (length,) = struct.unpack_from('=I',data,pos)
+        pos += 4
+        names.append(data[pos:pos+length].decode('ascii'))
+        pos += length
+    elif tag == ord('D'):
+      (nb_rows,nb_columns) = struct.unpack_from('=II',data,pos)
+      pos += 8
+      values = numpy.frombuffer(data,dtype=numpy.float64,count=nb_rows*nb_columns,offset=pos)
+      pos += 8*nb_rows*nb_columns
+      chunks.append((nb_rows,list(names),values.reshape(nb_columns,nb_rows)))
+    else:
+      raise Exception(filename+' is corrupt: unknown chunk at byte '+str(pos-4))
+
+  total_rows = sum([chunk[0] for chunk in chunks])
+  columns = {}
+  row = 0
+  for (nb_rows,chunk_names,values) in chunks:
+    for c in range(len(chunk_names)):
+      if chunk_names[c] not in columns:
+        columns[chunk_names[c]] = numpy.zeros(total_rows)
+      columns[chunk_names[c]][row:row+nb_rows] = values[c]
+    row += nb_rows
+  return columns
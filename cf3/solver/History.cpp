@@ -6,12 +6,15 @@
 
 #include <iomanip>
 
+#include <boost/cstdint.hpp>
+
 #include "common/BoostFilesystem.hpp"
 #include "common/PropertyList.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
 #include "common/Builder.hpp"
 #include "common/Signal.hpp"
+#include "common/Foreach.hpp"
 
 
 #include "solver/History.hpp"
@@ -29,6 +32,8 @@ History::History ( const std::string& name ) :
   Component(name)
 {
   m_table_needs_resize = false;
+  m_nb_logged_columns = 0;
+  m_nb_buffered_entries = 0;
   m_table = create_static_component< Table<Real> >("table");
   m_variables = create_static_component< math::VariablesDescriptor >("variables");
 
@@ -46,6 +51,20 @@ History::History ( const std::string& name ) :
       .description("Log file for history")
       .mark_basic();
 
+  Option& format_option = options().add("format",std::string("tsv"))
+      .description("Format of the log file: \"tsv\" rewrites the file when variables are added, "
+                   "\"binary\" appends columnar chunks that are never rewritten")
+      .mark_basic();
+  format_option.restricted_list().push_back(std::string("tsv"));
+  format_option.restricted_list().push_back(std::string("binary"));
+
+  options().add("chunk_size",100u)
+      .description("Number of entries gathered before a chunk is appended to a binary log file");
+
+  options().add("max_rows",0u)
+      .description("Maximum number of entries kept in memory when logging in binary format. "
+                   "Older entries are only available in the log file. Zero keeps all entries.");
+
   regist_signal ( "write" )
       .description( "Write history" )
       .pretty_name("Write" )
@@ -57,8 +76,10 @@ History::History ( const std::string& name ) :
 
 History::~History()
 {
-  if (m_file)
+  if (m_file.is_open())
   {
+    if (binary_format())
+      write_binary_chunk();
     m_file.close();
   }
 }
@@ -124,10 +145,15 @@ void History::save_entry()
 
   bool resized = resize_if_necessary();
   m_buffer->add_row(this_entry.data());
+  ++m_nb_buffered_entries;
 
   if (m_logging)
   {
-    if (PE::Comm::instance().rank() == 0)
+    if (PE::Comm::instance().rank() == 0 && binary_format())
+    {
+      log_binary_entry(this_entry.data());
+    }
+    else if (PE::Comm::instance().rank() == 0)
     {
       if (resized)
         m_file.close();
@@ -146,6 +172,115 @@ void History::save_entry()
       }
     }
   }
+
+  trim_table(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool History::binary_format() const
+{
+  return options().value<std::string>("format") == "binary";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void History::log_binary_entry(const std::vector<Real>& entry)
+{
+  if (!m_file.is_open())
+  {
+    open_file(m_file,options().value<URI>("file"),true);
+    const char magic[8] = "CF3HIST";
+    const boost::uint32_t version = 1u;
+    m_file.write(magic,sizeof(magic));
+    m_file.write(reinterpret_cast<const char*>(&version),sizeof(version));
+    m_nb_logged_columns = 0;
+  }
+
+  if (entry.size() != m_nb_logged_columns)
+  {
+    // pending entries still belong to the previous set of variables
+    write_binary_chunk();
+    write_binary_variables();
+  }
+
+  m_pending_entries.insert(m_pending_entries.end(),entry.begin(),entry.end());
+
+  const Uint chunk_size = std::max(1u,options().value<Uint>("chunk_size"));
+  if (m_pending_entries.size() >= chunk_size*m_nb_logged_columns)
+    write_binary_chunk();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void History::write_binary_variables()
+{
+  const std::vector<std::string> names = column_names();
+  const boost::uint32_t tag = 'V';
+  const boost::uint32_t nb_columns = names.size();
+  m_file.write(reinterpret_cast<const char*>(&tag),sizeof(tag));
+  m_file.write(reinterpret_cast<const char*>(&nb_columns),sizeof(nb_columns));
+  boost_foreach(const std::string& name, names)
+  {
+    const boost::uint32_t length = name.size();
+    m_file.write(reinterpret_cast<const char*>(&length),sizeof(length));
+    m_file.write(name.data(),length);
+  }
+  m_nb_logged_columns = names.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void History::write_binary_chunk()
+{
+  if (m_pending_entries.empty() || m_nb_logged_columns == 0)
+    return;
+
+  const boost::uint32_t tag = 'D';
+  const boost::uint32_t nb_columns = m_nb_logged_columns;
+  const boost::uint32_t nb_rows = m_pending_entries.size() / nb_columns;
+  m_file.write(reinterpret_cast<const char*>(&tag),sizeof(tag));
+  m_file.write(reinterpret_cast<const char*>(&nb_rows),sizeof(nb_rows));
+  m_file.write(reinterpret_cast<const char*>(&nb_columns),sizeof(nb_columns));
+
+  // Transpose to columns, so that a reader can map every column as one array
+  std::vector<double> column(nb_rows);
+  for (Uint col=0; col<nb_columns; ++col)
+  {
+    for (Uint row=0; row<nb_rows; ++row)
+      column[row] = m_pending_entries[row*nb_columns+col];
+    m_file.write(reinterpret_cast<const char*>(&column[0]),nb_rows*sizeof(double));
+  }
+  m_file.flush();
+  m_pending_entries.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void History::trim_table(const bool force)
+{
+  const Uint max_rows = options().value<Uint>("max_rows");
+  if (max_rows == 0 || !m_logging || !binary_format())
+    return;
+
+  // Trimming only when max_rows entries were added since the last trim
+  // keeps the cost of shifting the table constant per entry
+  if (!force && m_nb_buffered_entries < max_rows)
+    return;
+
+  if(is_not_null(m_buffer))
+    m_buffer->flush();
+  m_nb_buffered_entries = 0;
+
+  const Uint nb_rows = m_table->size();
+  if (nb_rows <= max_rows)
+    return;
+
+  const Uint first_kept = nb_rows - max_rows;
+  Table<Real>::ArrayT& rows = m_table->array();
+  for (Uint row=0; row<max_rows; ++row)
+    rows[row] = rows[first_kept+row];
+  m_table->resize(max_rows);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -154,6 +289,9 @@ void History::flush()
 {
   if(is_not_null(m_buffer))
     m_buffer->flush();
+  m_nb_buffered_entries = 0;
+  if (m_file.is_open() && binary_format())
+    write_binary_chunk();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -161,6 +299,7 @@ void History::flush()
 Handle<Table<Real> const> History::table()
 {
   flush();
+  trim_table(true);
   return m_table;
 }
 
@@ -199,10 +338,10 @@ void History::signal_write(common::SignalArgs& args)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void History::open_file(boost::filesystem::fstream& file, const common::URI& file_uri)
+void History::open_file(boost::filesystem::fstream& file, const common::URI& file_uri, const bool binary)
 {
   boost::filesystem::path path (file_uri.path());
-  file.open(path,std::ios_base::out);
+  file.open(path,binary ? std::ios_base::out | std::ios_base::binary : std::ios_base::out);
   if (!file) // didn't open so throw exception
   {
     throw boost::filesystem::filesystem_error( path.string() + " failed to open",
@@ -218,22 +357,32 @@ std::string History::file_header() const
   std::stringstream ss;
 
   ss << "#";
+  boost_foreach(const std::string& name, column_names())
+    ss << "\t" << std::setw(16) << name;
+  ss << "\n";
+  return ss.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> History::column_names() const
+{
+  std::vector<std::string> names;
+  names.reserve(m_variables->size());
   for (Uint var_idx=0; var_idx<m_variables->nb_vars(); ++var_idx)
   {
     const Uint var_length = m_variables->var_length(var_idx);
     if (var_length == 1)
     {
-      ss << "\t" << std::setw(16) << m_variables->user_variable_name(var_idx);
+      names.push_back(m_variables->user_variable_name(var_idx));
     }
     else
     {
       for (Uint i=0; i<var_length; ++i)
-        ss << "\t" << std::setw(16) << m_variables->user_variable_name(var_idx)<<"["<<i<<"]";
+        names.push_back(m_variables->user_variable_name(var_idx)+"["+to_str(i)+"]");
     }
-
   }
-  ss << "\n";
-  return ss.str();
+  return names;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
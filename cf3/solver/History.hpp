@@ -39,6 +39,23 @@ class HistoryEntry;
 /// The history file to be rewritten, including the new variables, putting zero's
 /// for the non-existent past entries.
 ///
+/// With option "format" set to "binary", the log file is instead an append-only
+/// stream of chunks, which is never rewritten:
+/// - a file header: the 8 characters "CF3HIST", followed by the format version (uint32)
+/// - a variables chunk: tag 'V' (uint32), number of columns (uint32), and for every
+///   column its name as length (uint32) followed by the characters.
+///   A new variables chunk is appended whenever variables are added.
+/// - a data chunk: tag 'D' (uint32), number of rows (uint32), number of columns (uint32),
+///   followed by the values as doubles, column by column.
+///   Entries are gathered in memory until "chunk_size" entries are available, or flush() is called.
+///
+/// All values are stored in the byte order of the writing machine.
+/// Because the file then holds the complete history, option "max_rows" can bound the
+/// number of entries kept in the table. table() returns at most "max_rows" entries, the most
+/// recent ones. In between, the oldest entries are only dropped once "max_rows" entries were
+/// added since the last trim, so the table may hold up to 2*"max_rows"-1 entries in memory.
+/// cf3/python/history.py reads these files.
+///
 /// Example:\n
 /// @code
 /// boost::shared_ptr<History> history = allocate_component<History>("history");
@@ -107,14 +124,15 @@ public:
   void write_file(boost::filesystem::fstream& file);
 
   /// @brief Read access to the table storing the history
-  /// @note This flushes the buffer first, so that most recent information is available
+  /// @note This flushes the buffer first, so that most recent information is available,
+  ///       and drops the entries beyond option "max_rows"
   Handle<common::Table<Real> const> table();
 
   /// @brief Information of every variable stored in history
   Handle<math::VariablesDescriptor const> variables() const;
 
 
-  /// @brief Flush the buffer in the table
+  /// @brief Flush the buffer in the table, and the pending entries of a binary log file
   void flush();
 
   /// @brief make a Entry object that can be written to any output stream
@@ -123,7 +141,7 @@ public:
 private: // functions
 
   /// @brief open a file with given URI
-  static void open_file(boost::filesystem::fstream& file, const common::URI& file_uri);
+  static void open_file(boost::filesystem::fstream& file, const common::URI& file_uri, const bool binary=false);
 
   /// @brief resize table and rebuild buffer if needed
   bool resize_if_necessary();
@@ -131,6 +149,25 @@ private: // functions
   /// @brief return the log-file header in string format
   std::string file_header() const;
 
+  /// @brief return the name of every column of the table
+  std::vector<std::string> column_names() const;
+
+  /// @brief true if the log file is written in binary chunks
+  bool binary_format() const;
+
+  /// @brief append an entry to the binary log file, writing a chunk when it is full
+  void log_binary_entry(const std::vector<Real>& entry);
+
+  /// @brief append a variables chunk describing the current columns to the binary log file
+  void write_binary_variables();
+
+  /// @brief append the pending entries as a data chunk to the binary log file
+  void write_binary_chunk();
+
+  /// @brief drop the oldest entries from the table, if it holds more than allowed by option "max_rows"
+  /// @param [in] force  trim now, instead of waiting until "max_rows" entries were added since the last trim
+  void trim_table(const bool force);
+
 private: // data
 
   /// Flag to check if the history has to be logged
@@ -152,6 +189,15 @@ private: // data
   /// If so, the table needs to be resized.
   bool m_table_needs_resize;
 
+  /// Entries not yet written to the binary log file, stored row after row
+  std::vector<Real> m_pending_entries;
+
+  /// Number of columns announced in the last variables chunk of the binary log file
+  Uint m_nb_logged_columns;
+
+  /// Number of entries added to the buffer since the last trim of the table
+  Uint m_nb_buffered_entries;
+
 }; // History
 
 ////////////////////////////////////////////////////////////////////////////////
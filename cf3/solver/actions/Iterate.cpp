@@ -86,6 +86,9 @@ void Iterate::execute ()
 
     ActionDirector::execute();
 
+    // print the messages collected on all ranks, if log aggregation is enabled
+    Logger::instance().aggregate();
+
     // update the iteration
     ++m_iter;
   }
@@ -43,6 +43,11 @@ ProbePostProcHistory::ProbePostProcHistory(const std::string &name) : ProbePostP
       .description("Variables to log in the history component")
       .link_to(&m_vars)
       .mark_basic();
+  m_save_entry = true;
+  options().add("save_entry",m_save_entry)
+      .description("Save a history entry after setting the variables. "
+                   "Turn off for all but the last probe sharing a history, to log all probes in one entry.")
+      .link_to(&m_save_entry);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -56,7 +61,8 @@ void ProbePostProcHistory::execute()
 
     m_history->set(m_probe->name()+"_"+var_name,m_probe->properties().value<Real>(var_name));
   }
-  m_history->save_entry();
+  if (m_save_entry)
+    m_history->save_entry();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
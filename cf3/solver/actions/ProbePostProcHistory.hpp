@@ -21,7 +21,9 @@ namespace actions {
 
 /// @brief ProbePostProcHistory class to attach to a probe
 ///
-/// This allows to log probed variables to a solver::History component
+/// This allows to log probed variables to a solver::History component.
+/// Many probes sharing one history are best logged with the history in binary format,
+/// which appends new variables instead of rewriting the log file.
 /// @author Willem Deconinck
 class solver_actions_API ProbePostProcHistory : public ProbePostProcessor {
 public:
@@ -42,6 +44,7 @@ private:
 
   Handle<History> m_history;
   std::vector<std::string> m_vars;
+  bool m_save_entry;
 
 };
 
@@ -135,6 +135,10 @@ struct BlockAssignmentOp<SystemRHSTag, OpTagT>
   template<typename LSST, typename RhsT, typename DataT>
   void operator()(LSST& lss, const RhsT& rhs, const DataT& data) const
   {
+    // A matrix-free matrix is computing a product by running the assembly
+    if(lss.matrix().is_applying())
+      return;
+
     // TODO: We take some shortcuts here that assume the same shape function for every variable. Storage order for the system is i.e. uvp, uvp, ...
     static const Uint mat_size = DataT::EMatrixSizeT::value;
     static const Uint nb_dofs = mat_size / DataT::SupportT::EtypeT::nb_nodes;
@@ -195,6 +199,9 @@ boost::proto::transform< RHSAccumulator >
     template<typename LSST, typename RhsT>
     void assign_single_variable(LSST& lss_term, const RhsT& rhs, typename impl::data_param data, const Uint var_offset) const
     {
+      if(lss_term.matrix().is_applying())
+        return;
+
       math::LSS::System& lss = lss_term.lss();
       // TODO: We take some shortcuts here that assume the same shape function for every variable. Storage order for the system is i.e. uvp, uvp, ...
       static const Uint mat_size = boost::remove_reference<DataT>::type::EMatrixSizeT::value;
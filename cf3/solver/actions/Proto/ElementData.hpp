@@ -38,6 +38,7 @@
 #include "ElementMatrix.hpp"
 #include "ElementOperations.hpp"
 #include "FieldSync.hpp"
+#include "GaussPoints.hpp"
 #include "Terminals.hpp"
 
 namespace cf3 {
@@ -200,6 +201,18 @@ public:
     compute_normal_dispatch(boost::mpl::bool_<EtypeT::dimension - EtypeT::dimensionality == 1>(), mapped_coords);
   }
 
+  /// Precompute everything for Gauss point gauss_idx of the given order, taking the shape function values from the table
+  template<Uint Order>
+  void compute_at_gauss_point(const Uint gauss_idx) const
+  {
+    typedef GaussShapeFunctionTable<EtypeT, Order, EtypeT::shape> TableT;
+    const typename EtypeT::MappedCoordsT mapped_coords = TableT::GaussT::instance().coords.col(gauss_idx);
+    m_sf = TableT::instance().values[gauss_idx];
+    compute_coordinates();
+    compute_jacobian(mapped_coords);
+    compute_normal(mapped_coords);
+  }
+
 private:
   void compute_normal_dispatch(boost::mpl::false_, const typename EtypeT::MappedCoordsT&) const
   {
@@ -431,6 +444,14 @@ public:
     compute_values_dispatch(boost::mpl::bool_<EtypeT::dimension == EtypeT::dimensionality>(), mapped_coords);
   }
 
+  /// Precompute the cached values at Gauss point gauss_idx of the given order, using the tabulated shape functions.
+  /// Requires the jacobian of the support to be computed at the same point.
+  template<Uint Order>
+  void compute_values_at_gauss_point(const Uint gauss_idx) const
+  {
+    compute_tabulated_dispatch<Order>(boost::mpl::bool_<EtypeT::dimension == EtypeT::dimensionality>(), gauss_idx);
+  }
+
   /// Calculate and return the interpolation at given mapped coords
   EvalT eval(const MappedCoordsT& mapped_coords) const
   {
@@ -488,6 +509,22 @@ private:
     m_gradient.noalias() = m_support.jacobian_inverse() * m_mapped_gradient_matrix;
   }
 
+  /// Tabulated precompute for non-volume EtypeT
+  template<Uint Order>
+  void compute_tabulated_dispatch(boost::mpl::false_, const Uint gauss_idx) const
+  {
+    m_sf = GaussShapeFunctionTable<EtypeT, Order, SupportEtypeT::shape>::instance().values[gauss_idx];
+    m_eval(m_sf, m_element_values);
+  }
+
+  /// Tabulated precompute for volume EtypeT
+  template<Uint Order>
+  void compute_tabulated_dispatch(boost::mpl::true_, const Uint gauss_idx) const
+  {
+    compute_tabulated_dispatch<Order>(boost::mpl::false_(), gauss_idx);
+    m_gradient.noalias() = m_support.jacobian_inverse() * GaussShapeFunctionTable<EtypeT, Order, SupportEtypeT::shape>::instance().mapped_gradients[gauss_idx];
+  }
+
   /// Value of the field in each element node
   ValueT m_element_values;
 
@@ -872,6 +909,15 @@ public:
     boost::mpl::for_each< boost::mpl::range_c<int, 0, NbVarsT::value> >(PrecomputeData<ExprT>(m_variables_data, mapped_coords));
   }
 
+  /// Precompute element matrices at Gauss point gauss_idx of the given order, for the variables found in expr.
+  /// Equivalent to precompute_element_matrices at the point coordinates, but the shape functions come from a table
+  template<Uint Order, typename ExprT>
+  void precompute_element_matrices_at_gauss_point(const Uint gauss_idx, const ExprT& e)
+  {
+    m_support.template compute_at_gauss_point<Order>(gauss_idx);
+    boost::mpl::for_each< boost::mpl::range_c<int, 0, NbVarsT::value> >(PrecomputeGaussData<Order, ExprT>(m_variables_data, gauss_idx));
+  }
+
   /// Return the type of the data stored for variable I (I being an Integral Constant in the boost::mpl sense)
   template<typename I>
   struct DataType
@@ -1106,6 +1152,48 @@ private:
     const typename SupportEtypeT::MappedCoordsT& m_mapped_coords;
   };
 
+  /// Precompute variables data at a Gauss point, using the tabulated shape functions
+  template<Uint Order, typename ExprT>
+  struct PrecomputeGaussData
+  {
+    PrecomputeGaussData(VariablesDataT& vars_data, const Uint gauss_idx) :
+      m_variables_data(vars_data),
+      m_gauss_idx(gauss_idx)
+    {
+    }
+
+    template<typename I>
+    void operator()(const I&)
+    {
+      apply(typename boost::result_of<UsesVar<I::value>(ExprT)>::type(), boost::fusion::at<I>(m_variables_data));
+    }
+
+    void apply(boost::mpl::false_, const boost::mpl::void_&)
+    {
+    }
+
+    template<typename T>
+    void apply(boost::mpl::true_, T*& d)
+    {
+      d->template compute_values_at_gauss_point<Order>(m_gauss_idx);
+    }
+
+    template<Uint Dim, bool IsEquationVar>
+    void apply(boost::mpl::true_, EtypeTVariableData<ElementBased<Dim>, SupportEtypeT, Dim, IsEquationVar>*&)
+    {
+    }
+
+    // Variable is not used - do nothing
+    template<typename T>
+    void apply(boost::mpl::false_, T*& d)
+    {
+    }
+
+  private:
+    VariablesDataT& m_variables_data;
+    const Uint m_gauss_idx;
+  };
+
   /// Set the element on each stored data item
   struct FillRhs
   {
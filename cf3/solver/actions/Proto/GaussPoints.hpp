@@ -67,6 +67,43 @@ boost::proto::transform<GaussWeightEval>
   };
 };
 
+/// Shape function values and mapped gradients of EtypeT, tabulated at the Gauss points of the given order and shape.
+/// They only depend on the element type, so they are computed once instead of once per element and per Gauss point.
+template<typename EtypeT, Uint Order, mesh::GeoShape::Type Shape>
+struct GaussShapeFunctionTable
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef mesh::Integrators::GaussMappedCoords<Order, Shape> GaussT;
+  static const Uint nb_points = GaussT::nb_points;
+
+  typedef typename EtypeT::SF::ValueT ValueT;
+  typedef typename EtypeT::SF::GradientT GradientT;
+
+  /// Shape function values at each Gauss point
+  ValueT values[nb_points];
+
+  /// Gradients with respect to the mapped coordinates at each Gauss point
+  GradientT mapped_gradients[nb_points];
+
+  static const GaussShapeFunctionTable<EtypeT, Order, Shape>& instance()
+  {
+    static GaussShapeFunctionTable<EtypeT, Order, Shape> table;
+    return table;
+  }
+
+private:
+  GaussShapeFunctionTable()
+  {
+    for(Uint i = 0; i != nb_points; ++i)
+    {
+      const typename EtypeT::MappedCoordsT mapped_coords = GaussT::instance().coords.col(i);
+      EtypeT::SF::compute_value(mapped_coords, values[i]);
+      EtypeT::SF::compute_gradient(mapped_coords, mapped_gradients[i]);
+    }
+  }
+};
+
 /// Static constant for the Gauss integration order
 template<Uint Order>
 struct GaussOrder
@@ -47,6 +47,11 @@ option( CF3_ENABLE_UNIT_TESTS        "Enable creation of unit tests"    ON  )
 option( CF3_ENABLE_PERFORMANCE_TESTS "Run the performance tests"        OFF )
 option( CF3_ENABLE_ACCEPTANCE_TESTS  "Run the acceptance tests"         ON  )
 
+set( CF3_BENCHMARK_SCALE "1" CACHE STRING "Factor applied to the problem sizes of the performance tests")
+set( CF3_BENCHMARK_DIR "${CMAKE_BINARY_DIR}/benchmarks" CACHE PATH "Directory where the performance tests write their JSON results")
+mark_as_advanced(CF3_BENCHMARK_SCALE)
+mark_as_advanced(CF3_BENCHMARK_DIR)
+
 option( CF3_INSTALL_UNIT_TESTS       "Enable testing applications install"   OFF )
 
 # MPI options
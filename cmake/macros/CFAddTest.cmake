@@ -27,6 +27,9 @@
 # - DEPENDS
 #      list of targets this test depends on (LIBS are automatically a dependency already)
 #
+# Tests are labeled with their profile (unit-test, acceptance-test, performance-test),
+# so "ctest -L performance-test" runs only the performance tests.
+#
 # After calling this function, the test is added to one of the following lists:
 #   - CF3_ENABLED_UTESTS
 #   - CF3_DISABLED_UTESTS
@@ -228,6 +231,13 @@ function( coolfluid_add_test )
       else()
         add_test( ${_TEST_NAME} ${_TEST_COMMAND} ${_PAR_ARGUMENTS} )
       endif()
+      set_tests_properties(${_TEST_NAME} PROPERTIES LABELS ${_TEST_PROFILE})
+
+      # performance tests store their results for the benchmarks target (see Tools/Testing/BenchmarkFixture.hpp)
+      if(_PAR_PTEST)
+        set_tests_properties(${_TEST_NAME} PROPERTIES ENVIRONMENT
+          "CF3_BENCHMARK_OUTPUT=${CF3_BENCHMARK_DIR}/${_TEST_NAME}.json;CF3_BENCHMARK_SCALE=${CF3_BENCHMARK_SCALE}")
+      endif()
       if(_TEST_SCALING)
         add_test("${_TEST_NAME}-scaling" ${PYTHON_EXECUTABLE} ${CMAKE_SOURCE_DIR}/tools/test-mpi-scalability.py ${MPIEXEC} ${CMAKE_CURRENT_BINARY_DIR}/${_TEST_NAME} ${CF3_MPI_TESTS_MAX_NB_PROCS} ${_PAR_ARGUMENTS})
       endif()
@@ -244,6 +254,7 @@ function( coolfluid_add_test )
       add_test(NAME ${_TEST_NAME}
                COMMAND ${SCRIPT_COMMAND} ${CMAKE_CURRENT_SOURCE_DIR}/${_TEST_FILES} ${_PAR_ARGUMENTS})
       set_tests_properties(${_TEST_NAME} PROPERTIES ENVIRONMENT "PYTHONPATH=${coolfluid_BINARY_DIR}/dso")
+      set_tests_properties(${_TEST_NAME} PROPERTIES LABELS ${_TEST_PROFILE})
 
       if(_TEST_SCALING)
         coolfluid_log("Scaling requested for python test. Not implemented yet in build system.")
@@ -264,6 +275,7 @@ function( coolfluid_add_test )
                         DEPENDS coolfluid-command)
       add_test( NAME ${_TEST_NAME}
                 COMMAND coolfluid-command -f ${_TEST_SCRIPT} )
+      set_tests_properties(${_TEST_NAME} PROPERTIES LABELS ${_TEST_PROFILE})
 
       if(_TEST_SCALING)
         coolfluid_log("Scaling requested for python test. Not implemented yet in build system.")
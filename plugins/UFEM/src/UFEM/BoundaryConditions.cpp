@@ -60,7 +60,8 @@ struct BoundaryConditions::Implementation
     m_physical_model(),
     dirichlet(m_component.options().add("lss", Handle<LSS::System>())
               .pretty_name("LSS")
-              .description("The referenced linear system solver"))
+              .description("The referenced linear system solver")),
+    m_batch_dirichlet(true)
   {
     m_component.options().add(solver::Tags::regions(), std::vector<URI>())
       .pretty_name("Regions")
@@ -70,6 +71,10 @@ struct BoundaryConditions::Implementation
       .pretty_name("Physical Model")
       .description("Physical Model")
       .link_to(&m_physical_model);
+    m_component.options().add("batch_dirichlet", true)
+      .pretty_name("Batch Dirichlet")
+      .description("Collect the dirichlet conditions of all boundary conditions and apply them to the linear system at once")
+      .link_to(&m_batch_dirichlet);
   }
 
   boost::shared_ptr< Action > create_constant_scalar_bc(const std::string& region_name, const std::string& variable_name)
@@ -174,6 +179,7 @@ struct BoundaryConditions::Implementation
   DirichletBC dirichlet;
   std::vector<URI> m_region_uris;
   std::string m_solution_tag;
+  bool m_batch_dirichlet;
 };
 
 BoundaryConditions::BoundaryConditions(const std::string& name) :
@@ -211,6 +217,28 @@ BoundaryConditions::~BoundaryConditions()
 {
 }
 
+void BoundaryConditions::execute()
+{
+  Handle<LSS::System> lss = options().value< Handle<LSS::System> >("lss");
+  if(!m_implementation->m_batch_dirichlet || is_null(lss) || !lss->is_created())
+  {
+    ActionDirector::execute();
+    return;
+  }
+
+  lss->begin_dirichlet_batch();
+  try
+  {
+    ActionDirector::execute();
+  }
+  catch(...)
+  {
+    lss->end_dirichlet_batch();
+    throw;
+  }
+  lss->end_dirichlet_batch();
+}
+
 Handle<common::Action> BoundaryConditions::add_constant_bc(const std::string& region_name, const std::string& variable_name)
 {
   const VariablesDescriptor& descriptor = find_component_with_tag<VariablesDescriptor>(m_implementation->physical_model().variable_manager(), m_implementation->m_solution_tag);
@@ -33,6 +33,12 @@ public: // functions
   /// Get the class name
   static std::string type_name () { return "BoundaryConditions"; }
 
+  /// Execute the boundary conditions. With the option "batch_dirichlet" set, the dirichlet conditions
+  /// of all actions are collected and applied to the linear system together, after the last action has run.
+  /// Contributions of other actions, such as Neumann conditions, therefore never modify a dirichlet constrained row,
+  /// regardless of their position in the sequence. See LSS::System::begin_dirichlet_batch for the details.
+  virtual void execute();
+
   /// Create constant dirichlet BC
   /// @param region_name Name of the boundary region. Must be unique in the problem region
   /// @param variable_name Name of the variable for which to set the BC
@@ -8,12 +8,15 @@
 #include "common/Log.hpp"
 #include "common/Signal.hpp"
 #include "common/Builder.hpp"
+#include "common/OptionComponent.hpp"
+#include "common/OptionList.hpp"
 #include <common/List.hpp>
 #include <common/PropertyList.hpp>
 
 #include "math/VariableManager.hpp"
 #include "math/VariablesDescriptor.hpp"
 
+#include "math/LSS/Matrix.hpp"
 #include "math/LSS/System.hpp"
 
 #include "mesh/Domain.hpp"
@@ -118,6 +121,18 @@ void LSSAction::execute()
 
   CFdebug << "Running with LSS " << options().option("lss").value_str() << CFendl;
 
+  // A matrix-free matrix executes the assembly again to compute products
+  Handle<LSS::Matrix> matrix = m_implementation->m_lss->matrix();
+  if(is_not_null(matrix) && matrix->options().check("assembly") && is_null(matrix->options().value< Handle<common::Action> >("assembly")))
+  {
+    Handle<common::Action> assembly(get_child("Assembly"));
+    if(is_not_null(assembly))
+    {
+      CFdebug << "Using " << assembly->uri().path() << " to compute products with matrix-free matrix " << matrix->uri().path() << CFendl;
+      matrix->options().set("assembly", assembly);
+    }
+  }
+
   solver::ActionDirector::execute();
 }
 
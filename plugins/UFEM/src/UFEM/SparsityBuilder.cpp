@@ -4,14 +4,18 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+#include <map>
 #include <set>
 
+#include "common/DynTable.hpp"
 #include "common/FindComponents.hpp"
 #include "common/List.hpp"
 #include "common/PE/Comm.hpp"
 
 #include "mesh/Region.hpp"
 #include "mesh/Mesh.hpp"
+#include "mesh/MeshChangeLog.hpp"
 #include "mesh/Dictionary.hpp"
 #include "mesh/Field.hpp"
 #include "mesh/Functions.hpp"
@@ -28,25 +32,33 @@ using namespace mesh;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region> >& regions, const Dictionary& dictionary, std::vector<Uint>& node_connectivity, std::vector<Uint>& start_indices, List<Uint>& gids, List<Uint>& ranks, List<Uint>& used_node_map)
+namespace detail
 {
-  // Get some data from the dictionary
-  const Uint nb_global_nodes = dictionary.size();
-  const List<Uint>& dict_gid = dictionary.glb_idx();
-  const List<Uint>& dict_rank = dictionary.rank();
 
-  const Uint my_rank = PE::Comm::instance().rank();
-  const Uint nb_procs = PE::Comm::instance().size();
-
-  // Build a list of used entities
-  std::vector< Handle<Entities const> > used_entities;
+/// The volume elements of the regions
+std::vector< Handle<Entities const> > used_entities(const std::vector< Handle<Region> >& regions)
+{
+  std::vector< Handle<Entities const> > result;
   BOOST_FOREACH(const Handle<Region>& region, regions)
   {
     BOOST_FOREACH(const Entities& entities, find_components_recursively_with_filter<Entities>(*region, IsElementsVolume()))
     {
-      used_entities.push_back(entities.handle<Entities>());
+      result.push_back(entities.handle<Entities>());
     }
   }
+  return result;
+}
+
+/// Number the nodes of the used entities, and give them GIDs that are contiguous on each rank
+boost::shared_ptr< List<Uint> > number_used_nodes(const std::vector< Handle<Entities const> >& used_entities, const Dictionary& dictionary, List<Uint>& gids, List<Uint>& ranks, List<Uint>& used_node_map)
+{
+  // Get some data from the dictionary
+  const Uint nb_global_nodes = dictionary.size();
+  const List<Uint>& dict_gid = dictionary.glb_idx();
+  const List<Uint>& dict_rank = dictionary.rank();
+
+  const Uint my_rank = PE::Comm::instance().rank();
+  const Uint nb_procs = PE::Comm::instance().size();
 
   // Build used node list, together with a mapping from old node ID to ID in the node list, as well as the new GIDs
   boost::shared_ptr< List<Uint> > used_nodes_ptr = build_used_nodes_list(used_entities, dictionary, true);
@@ -153,6 +165,19 @@ boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region>
     }
   }
 
+  return used_nodes_ptr;
+}
+
+} // detail
+
+////////////////////////////////////////////////////////////////////////////////
+
+boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region> >& regions, const Dictionary& dictionary, std::vector<Uint>& node_connectivity, std::vector<Uint>& start_indices, List<Uint>& gids, List<Uint>& ranks, List<Uint>& used_node_map)
+{
+  const std::vector< Handle<Entities const> > used_entities = detail::used_entities(regions);
+  boost::shared_ptr< List<Uint> > used_nodes_ptr = detail::number_used_nodes(used_entities, dictionary, gids, ranks, used_node_map);
+  const Uint nb_used_nodes = used_nodes_ptr->size();
+
   std::vector< std::set<Uint> > connectivity_sets(nb_used_nodes);
   start_indices.assign(nb_used_nodes+1, 0);
 
@@ -190,6 +215,113 @@ boost::shared_ptr< List<Uint> > build_sparsity(const std::vector< Handle<Region>
   return used_nodes_ptr;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+boost::shared_ptr< List<Uint> > update_sparsity(const std::vector< Handle<Region> >& regions, const Dictionary& dictionary, const MeshChangeLog& changes, const List<Uint>& old_used_nodes, std::vector<Uint>& node_connectivity, std::vector<Uint>& start_indices, List<Uint>& gids, List<Uint>& ranks, List<Uint>& used_node_map)
+{
+  const Mesh& mesh = find_parent_component<Mesh>(dictionary);
+  Uint dict_idx = 0;
+  while(dict_idx != mesh.dictionaries().size() && mesh.dictionaries()[dict_idx].get() != &dictionary)
+    ++dict_idx;
+
+  if(!changes.applies_to(mesh) || dict_idx == mesh.dictionaries().size())
+  {
+    node_connectivity.clear();
+    return build_sparsity(regions, dictionary, node_connectivity, start_indices, gids, ranks, used_node_map);
+  }
+
+  const RowChanges& node_changes = changes.nodes(dict_idx);
+  cf3_assert(node_changes.size() == dictionary.size());
+
+  // The GIDs are renumbered by all ranks
+  const std::vector< Handle<Entities const> > used_entities = detail::used_entities(regions);
+  boost::shared_ptr< List<Uint> > used_nodes_ptr = detail::number_used_nodes(used_entities, dictionary, gids, ranks, used_node_map);
+  const List<Uint>& used_nodes = *used_nodes_ptr;
+  const Uint nb_used_nodes = used_nodes.size();
+
+  // Only the nodes of the removed and added elements can change neighbours
+  std::vector<bool> is_touched(dictionary.size(), false);
+  std::set<const Entities*> used_entities_set;
+  BOOST_FOREACH(const Handle<Entities const>& elements, used_entities)
+  {
+    used_entities_set.insert(elements.get());
+    const Connectivity& connectivity = elements->geometry_space().connectivity();
+    BOOST_FOREACH(const Uint elem, changes.elements(elements->entities_idx()).added())
+    {
+      BOOST_FOREACH(const Uint node, connectivity[elem])
+        is_touched[node] = true;
+    }
+
+    typedef std::map< Uint, std::vector<Uint> > RemovedElementNodesT;
+    const RemovedElementNodesT& removed_element_nodes = changes.removed_element_nodes(elements->entities_idx(), dict_idx);
+    for(RemovedElementNodesT::const_iterator removed = removed_element_nodes.begin(); removed != removed_element_nodes.end(); ++removed)
+    {
+      BOOST_FOREACH(const Uint baseline_node, removed->second)
+      {
+        Uint node;
+        if(node_changes.current_index(baseline_node, node))
+          is_touched[node] = true;
+      }
+    }
+  }
+
+  // Row of each baseline node in the old sparsity
+  const Uint not_used = nb_used_nodes + old_used_nodes.size();
+  std::vector<Uint> old_used_node_map(node_changes.baseline_size(), not_used);
+  for(Uint i = 0; i != old_used_nodes.size(); ++i)
+    old_used_node_map[old_used_nodes[i]] = i;
+
+  std::vector<Uint> old_node_connectivity;
+  old_node_connectivity.swap(node_connectivity);
+  std::vector<Uint> old_start_indices;
+  old_start_indices.swap(start_indices);
+
+  node_connectivity.reserve(old_node_connectivity.size());
+  start_indices.assign(nb_used_nodes+1, 0);
+  std::vector<Uint> row;
+  for(Uint i = 0; i != nb_used_nodes; ++i)
+  {
+    const Uint node = used_nodes[i];
+    row.clear();
+
+    // Untouched nodes keep their neighbours, which are only renumbered
+    Uint baseline_node;
+    bool renumbered = !is_touched[node] && node_changes.baseline_index(node, baseline_node) && old_used_node_map[baseline_node] != not_used;
+    if(renumbered)
+    {
+      const Uint old_row = old_used_node_map[baseline_node];
+      for(Uint j = old_start_indices[old_row]; j != old_start_indices[old_row+1]; ++j)
+      {
+        Uint connected_node;
+        if(!node_changes.current_index(old_used_nodes[old_node_connectivity[j]], connected_node))
+        {
+          renumbered = false;
+          break;
+        }
+        row.push_back(used_node_map[connected_node]);
+      }
+    }
+
+    if(!renumbered)
+    {
+      row.clear();
+      BOOST_FOREACH(const SpaceElem& space_elem, dictionary.connectivity()[node])
+      {
+        if(!used_entities_set.count(&space_elem.comp->support()))
+          continue;
+        BOOST_FOREACH(const Uint connected_node, space_elem.nodes())
+          row.push_back(used_node_map[connected_node]);
+      }
+    }
+
+    std::sort(row.begin(), row.end());
+    row.erase(std::unique(row.begin(), row.end()), row.end());
+    node_connectivity.insert(node_connectivity.end(), row.begin(), row.end());
+    start_indices[i+1] = node_connectivity.size();
+  }
+
+  return used_nodes_ptr;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
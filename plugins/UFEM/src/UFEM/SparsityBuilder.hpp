@@ -18,6 +18,7 @@ namespace cf3 {
   namespace mesh {
     class Region;
     class Dictionary;
+    class MeshChangeLog;
   }
 namespace UFEM {
 
@@ -31,6 +32,17 @@ namespace UFEM {
 /// Size is number of nodes + 1, so the last item is the size of node_connectivity
 UFEM_API boost::shared_ptr< common::List< Uint > > build_sparsity(const std::vector< Handle<mesh::Region> >& regions, const mesh::Dictionary& dictionary, std::vector<Uint>& node_connectivity, std::vector<Uint>& start_indices, common::List<Uint>& gids, common::List<Uint>& ranks, common::List<Uint>& used_node_map);
 
+/// Update the sparsity structure built by build_sparsity() after the mesh changed.
+/// Only the nodes of the removed and added elements get their connected nodes from the mesh,
+/// the others keep their old connected nodes, renumbered. The used nodes and their GIDs are
+/// numbered again as by build_sparsity(), which is collective.
+/// The sparsity is rebuilt if the log does not apply to the mesh of the dictionary.
+/// @param changes Changes of the mesh since the sparsity was built, e.g. Mesh::changes_since()
+/// @param old_used_nodes The used node list returned when the sparsity was built
+/// @param node_connectivity,start_indices The sparsity when it was built, updated on return
+/// @pre The node to element connectivity of the dictionary is up to date
+UFEM_API boost::shared_ptr< common::List< Uint > > update_sparsity(const std::vector< Handle<mesh::Region> >& regions, const mesh::Dictionary& dictionary, const mesh::MeshChangeLog& changes, const common::List<Uint>& old_used_nodes, std::vector<Uint>& node_connectivity, std::vector<Uint>& start_indices, common::List<Uint>& gids, common::List<Uint>& ranks, common::List<Uint>& used_node_map);
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 } // UFEM
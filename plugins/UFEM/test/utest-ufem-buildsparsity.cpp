@@ -19,6 +19,8 @@
 
 #include "mesh/Domain.hpp"
 #include "mesh/LagrangeP1/Line1D.hpp"
+#include "mesh/MeshAdaptor.hpp"
+#include "mesh/MeshChangeLog.hpp"
 
 #include "solver/Model.hpp"
 
@@ -297,6 +299,63 @@ BOOST_AUTO_TEST_CASE( Sparsity3DHexaChannel )
   lss.matrix()->print("utest-ufem-buildsparsity_heat_matrix_3DHexaChannel.plt");
 }
 
+BOOST_AUTO_TEST_CASE( UpdateSparsity2DQuads )
+{
+  Model& model = *root.create_component<Model>("ModelUpdate");
+  Domain& domain = model.create_domain("Domain");
+
+  boost::shared_ptr<MeshGenerator> create_rectangle = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","create_rectangle");
+  create_rectangle->options().set("mesh",domain.uri()/"Mesh");
+  create_rectangle->options().set("lengths",std::vector<Real>(DIM_2D, 5.));
+  create_rectangle->options().set("nb_cells",std::vector<Uint>(DIM_2D, 5u));
+  Mesh& mesh = create_rectangle->generate();
+  const std::vector< Handle<Region> > regions(1, mesh.topology().handle<Region>());
+
+  std::vector<Uint> node_connectivity, starting_indices;
+  Handle< List<Uint> > gids = domain.create_component< List<Uint> >("GIDs");
+  Handle< List<Uint> > ranks = domain.create_component< List<Uint> >("Ranks");
+  Handle< List<Uint> > used_node_map = domain.create_component< List<Uint> >("used_node_map");
+  boost::shared_ptr< List<Uint> > used_nodes = UFEM::build_sparsity(regions, mesh.geometry_fields(), node_connectivity, starting_indices, *gids, *ranks, *used_node_map);
+  const Uint revision = mesh.revision();
+
+  // Remove a corner cell with its corner node, and two inner cells of which one is added again
+  Handle<Entities> cells;
+  for(Uint i = 0; i != mesh.elements().size(); ++i)
+  {
+    if(mesh.elements()[i]->element_type().dimensionality() == DIM_2D)
+      cells = mesh.elements()[i];
+  }
+  BOOST_REQUIRE(is_not_null(cells));
+  const Uint cells_idx = cells->entities_idx();
+
+  MeshAdaptor mesh_adaptor(mesh);
+  mesh_adaptor.prepare();
+  mesh_adaptor.make_element_node_connectivity_global();
+  PackedElement removed_elem(mesh,cells_idx,7);
+  mesh_adaptor.remove_element(cells_idx,0);
+  mesh_adaptor.remove_element(cells_idx,7);
+  mesh_adaptor.remove_element(cells_idx,12);
+  mesh_adaptor.add_element(removed_elem);
+  mesh_adaptor.flush_elements();
+  mesh_adaptor.finish();
+
+  const MeshChangeLog* changes = mesh.changes_since(revision);
+  BOOST_REQUIRE(changes);
+  boost::shared_ptr< List<Uint> > updated_used_nodes = UFEM::update_sparsity(regions, mesh.geometry_fields(), *changes, *used_nodes, node_connectivity, starting_indices, *gids, *ranks, *used_node_map);
+
+  // Compare with a sparsity built from scratch
+  std::vector<Uint> rebuilt_connectivity, rebuilt_indices;
+  Handle< List<Uint> > rebuilt_gids = domain.create_component< List<Uint> >("RebuiltGIDs");
+  Handle< List<Uint> > rebuilt_ranks = domain.create_component< List<Uint> >("RebuiltRanks");
+  Handle< List<Uint> > rebuilt_node_map = domain.create_component< List<Uint> >("rebuilt_used_node_map");
+  boost::shared_ptr< List<Uint> > rebuilt_used_nodes = UFEM::build_sparsity(regions, mesh.geometry_fields(), rebuilt_connectivity, rebuilt_indices, *rebuilt_gids, *rebuilt_ranks, *rebuilt_node_map);
+
+  BOOST_CHECK(updated_used_nodes->array() == rebuilt_used_nodes->array());
+  BOOST_CHECK(gids->array() == rebuilt_gids->array());
+  BOOST_CHECK_EQUAL_COLLECTIONS(starting_indices.begin(), starting_indices.end(), rebuilt_indices.begin(), rebuilt_indices.end());
+  BOOST_CHECK_EQUAL_COLLECTIONS(node_connectivity.begin(), node_connectivity.end(), rebuilt_connectivity.begin(), rebuilt_connectivity.end());
+}
+
 BOOST_AUTO_TEST_CASE( Heat1DComponent )
 {
   Core::instance().environment().options().set("log_level", 4u);
@@ -7,13 +7,18 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for ActionDirector"
 
+#include <algorithm>
 #include <iostream>
 
 #include <boost/test/unit_test.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
 
 #include "common/CF.hpp"
 #include "common/ActionDirector.hpp"
 #include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/OptionList.hpp"
 #include "common/Foreach.hpp"
 #include "common/URI.hpp"
 
@@ -83,6 +88,60 @@ BOOST_AUTO_TEST_CASE(ActionDirectorStream)
   BOOST_CHECK_EQUAL(test_action3_handle->value, 8);
 }
 
+/// Action that records the order of execution, for testing purposes
+struct RecordOrderAction : Action
+{
+  RecordOrderAction(const std::string& name) : Action(name) {}
+  static std::string type_name () { return "RecordOrderAction"; }
+  virtual void execute()
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+    order.push_back(name());
+  }
+
+  static Uint position(const std::string& name)
+  {
+    return std::find(order.begin(), order.end(), name) - order.begin();
+  }
+
+  static boost::mutex mutex;
+  static std::vector<std::string> order;
+};
+
+boost::mutex RecordOrderAction::mutex;
+std::vector<std::string> RecordOrderAction::order;
+
+BOOST_AUTO_TEST_CASE(ActionDirectorConcurrent)
+{
+  Core::instance().environment().options().set("nb_threads", 4u);
+
+  Handle<ActionDirector> director = Core::instance().root().create_component<ActionDirector>("concurrent_director");
+  director->create_component<RecordOrderAction>("a");
+  director->create_component<RecordOrderAction>("b");
+  director->create_component<RecordOrderAction>("c");
+  director->create_component<RecordOrderAction>("d");
+  director->options().set("concurrent", true);
+  director->options().set("disabled_actions", std::vector<std::string>(1, "b"));
+
+  std::vector<std::string> dependencies;
+  dependencies.push_back("b:a");
+  dependencies.push_back("c:b");
+  director->options().set("dependencies", dependencies);
+
+  director->execute();
+
+  // b is disabled, but c still runs after a
+  BOOST_CHECK_EQUAL(RecordOrderAction::order.size(), 3u);
+  BOOST_CHECK(RecordOrderAction::position("a") < RecordOrderAction::position("c"));
+  BOOST_CHECK_EQUAL(RecordOrderAction::position("b"), 3u);
+
+  dependencies.push_back("a:c");
+  director->options().set("dependencies", dependencies);
+  BOOST_CHECK_THROW(director->execute(), SetupError);
+
+  Core::instance().environment().options().set("nb_threads", 1u);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -157,6 +157,42 @@ BOOST_AUTO_TEST_CASE ( test_Map_copy_std_map )
 
 //////////////////////////////////////////////////////////////////////////////
 
+/// True for the entries with an odd value
+struct OddValue
+{
+  bool operator()(const std::pair<int,int>& entry) const { return entry.second % 2 != 0; }
+};
+
+BOOST_AUTO_TEST_CASE ( test_Map_erase_if_and_merge )
+{
+  boost::shared_ptr< Map<int,int> > map_ptr ( allocate_component< Map<int,int> > ("map"));
+  Map<int,int>& map = *map_ptr;
+
+  for (int i=0; i<10; ++i)
+    map.push_back(2*i,i);
+  map.sort_keys();
+
+  // keys 0, 4, 8, 12 and 16 remain, still sorted
+  map.erase_if(OddValue());
+  BOOST_CHECK_EQUAL(map.size(), 5u);
+
+  std::vector< std::pair<int,int> > pairs;
+  pairs.push_back(std::make_pair(13,-1));
+  pairs.push_back(std::make_pair(-3,-2));
+  pairs.push_back(std::make_pair(5,-3));
+  map.merge(pairs);
+  BOOST_CHECK_EQUAL(map.size(), 8u);
+
+  const int expected_keys[] = {-3, 0, 4, 5, 8, 12, 13, 16};
+  for (Uint i=0; i<map.size(); ++i)
+    BOOST_CHECK_EQUAL((map.begin()+i)->first, expected_keys[i]);
+  BOOST_CHECK_EQUAL(map[5], -3);
+  BOOST_CHECK_EQUAL(map[8], 4);
+  BOOST_CHECK(!map.exists(2));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 
 BOOST_AUTO_TEST_SUITE_END()
 
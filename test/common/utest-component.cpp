@@ -17,6 +17,9 @@
 #include "common/FindComponents.hpp"
 #include "common/Group.hpp"
 #include "common/Link.hpp"
+#include "common/List.hpp"
+#include "common/DynTable.hpp"
+#include "common/Table.hpp"
 #include "common/OptionList.hpp"
 #include "common/PropertyList.hpp"
 
@@ -297,6 +300,42 @@ BOOST_AUTO_TEST_CASE( clear )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( memory_footprint )
+{
+  boost::shared_ptr<Component> root = allocate_component<Group> ( "root" );
+  BOOST_CHECK_EQUAL(root->recursive_memory_footprint(), 0u);
+
+  Handle< Table<Real> > table = root->create_component< Table<Real> >("table");
+  table->set_row_size(3);
+  table->resize(10);
+  BOOST_CHECK_EQUAL(table->memory_footprint(), 30u*sizeof(Real));
+
+  Handle<Component> group = root->create_component<Group>("group");
+  Handle< List<Uint> > list = group->create_component< List<Uint> >("list");
+  list->resize(7);
+  BOOST_CHECK_EQUAL(list->memory_footprint(), 7u*sizeof(Uint));
+
+  Handle< DynTable<Uint> > dyntable = group->create_component< DynTable<Uint> >("dyntable");
+  dyntable->resize(2);
+  dyntable->set_row_size(0,4);
+  BOOST_CHECK(dyntable->memory_footprint() >= 4u*sizeof(Uint) + 2u*sizeof(std::vector<Uint>));
+
+  // links must not count the data of their target twice
+  group->create_component<Link>("link")->link_to(*table);
+
+  BOOST_CHECK_EQUAL(group->recursive_memory_footprint(), list->memory_footprint() + dyntable->memory_footprint());
+  BOOST_CHECK_EQUAL(root->recursive_memory_footprint(), table->memory_footprint() + group->recursive_memory_footprint());
+
+  const std::string report = root->memory_tree();
+  BOOST_CHECK(report.find("table") != std::string::npos);
+  BOOST_CHECK(report.find("dyntable") != std::string::npos);
+
+  // components below the threshold are not reported
+  BOOST_CHECK(root->memory_tree(0, table->memory_footprint()+1).find("table") == std::string::npos);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -12,14 +12,52 @@
 #include <boost/iostreams/device/back_inserter.hpp>
 
 #include <iostream>
+#include <sstream>
 
 #include "common/Log.hpp"
+#include "common/LogAsyncWriter.hpp"
+#include "common/LogStringForwarder.hpp"
+#include "common/StringConversion.hpp"
 
 using namespace std;
 using namespace boost;
 using namespace cf3;
 using namespace cf3::common;
 
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+/// Keeps the messages sent to the STRING destination
+class MessageRecorder : public LogStringForwarder
+{
+public:
+  virtual void message(const std::string & str) { messages.push_back(str); }
+
+  std::vector<std::string> messages;
+};
+
+/// Redirects std::cout to a string while in scope
+class CoutCapture
+{
+public:
+  CoutCapture() : m_old_buffer(std::cout.rdbuf(m_buffer.rdbuf())) {}
+  ~CoutCapture() { std::cout.rdbuf(m_old_buffer); }
+
+  std::string text() const { return m_buffer.str(); }
+
+private:
+  std::ostringstream m_buffer;
+  std::streambuf * m_old_buffer;
+};
+
+/// Number of occurrences of a substring
+Uint count_occurrences(const std::string & text, const std::string & what)
+{
+  Uint result = 0;
+  for(std::string::size_type pos = text.find(what) ; pos != std::string::npos ; pos = text.find(what, pos + what.size()))
+    ++result;
+  return result;
+}
+
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -64,6 +102,134 @@ BOOST_AUTO_TEST_CASE( FlushBuffer )
   CFinfo << "3. this is flushed CFlog line 2" << CFendl;
 }
 
+BOOST_AUTO_TEST_CASE( AsyncOutput )
+{
+  LogAsyncWriter writer;
+  LogStream stream("AsyncOutput", INFO, &writer);
+  CoutCapture capture;
+
+  writer.set_running(true);
+  BOOST_CHECK(writer.is_running());
+  for(Uint i = 0; i != 5; ++i)
+    stream << "asynchronous message " << i << CFendl;
+  writer.flush();
+  writer.set_running(false);
+  stream << "synchronous message" << CFendl;
+
+  // everything is written, in order
+  const std::string text = capture.text();
+  std::string::size_type pos = 0;
+  for(Uint i = 0; i != 5; ++i)
+  {
+    pos = text.find("asynchronous message " + to_str(i), pos);
+    BOOST_CHECK(pos != std::string::npos);
+  }
+  BOOST_CHECK(text.find("synchronous message", pos + std::string("asynchronous message 4").size()) != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( RateLimit )
+{
+  LogStream stream("RateLimit", INFO);
+  stream.useDestination(LogStream::SCREEN, false);
+  MessageRecorder recorder;
+  stream.addStringForwarder(&recorder);
+
+  stream.setRateLimit(2);
+  for(Uint i = 0; i != 5; ++i)
+    stream << FromHere() << "message " << i << CFendl;
+  BOOST_CHECK_EQUAL(recorder.messages.size(), 2u);
+
+  // other locations have their own count
+  stream << FromHere() << "other location" << CFendl;
+  BOOST_CHECK_EQUAL(recorder.messages.size(), 3u);
+
+  stream.setRateLimit(0);
+  for(Uint i = 0; i != 5; ++i)
+    stream << FromHere() << "message " << i << CFendl;
+  BOOST_CHECK_EQUAL(recorder.messages.size(), 8u);
+}
+
+BOOST_AUTO_TEST_CASE( Aggregate )
+{
+  LogStream stream("Aggregate", INFO);
+  BOOST_CHECK(!stream.isAggregating());
+
+  stream.setAggregate(true);
+  BOOST_CHECK(stream.isAggregating());
+  BOOST_CHECK(stream.isDestinationUsed(LogStream::AGGREGATE));
+  BOOST_CHECK(!stream.isDestinationUsed(LogStream::SCREEN));
+
+  CoutCapture capture;
+  stream << "aggregated message" << CFendl;
+  stream << "aggregated message" << CFendl;
+  stream << "other message" << CFendl;
+  BOOST_CHECK_EQUAL(count_occurrences(capture.text(), "aggregated message"), 0u);
+
+  // on a single rank, repeated messages are all output, without rank count
+  stream.aggregate();
+  const std::string text = capture.text();
+  BOOST_CHECK_EQUAL(count_occurrences(text, "aggregated message"), 2u);
+  BOOST_CHECK_EQUAL(count_occurrences(text, "other message"), 1u);
+  BOOST_CHECK_EQUAL(count_occurrences(text, "ranks]"), 0u);
+
+  stream.setAggregate(false);
+  BOOST_CHECK(stream.isDestinationUsed(LogStream::SCREEN));
+}
+
+BOOST_AUTO_TEST_CASE( AggregatePendingOnDestruction )
+{
+  CoutCapture capture;
+  {
+    LogStream stream("AggregatePending", INFO);
+    stream.setAggregate(true);
+
+    stream << "first message" << CFendl;
+    stream.aggregate();
+    stream << "late message" << CFendl;
+    BOOST_CHECK_EQUAL(count_occurrences(capture.text(), "late message"), 0u);
+  }
+
+  // the message logged after the last aggregation is not lost
+  BOOST_CHECK_EQUAL(count_occurrences(capture.text(), "first message"), 1u);
+  BOOST_CHECK_EQUAL(count_occurrences(capture.text(), "late message"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE( LoggerAggregate )
+{
+  Logger::instance().set_aggregate(true);
+
+  // errors and warnings are never held back
+  BOOST_CHECK(!Logger::instance().getStream(ERROR).isAggregating());
+  BOOST_CHECK(!Logger::instance().getStream(WARNING).isAggregating());
+  BOOST_CHECK(Logger::instance().getStream(INFO).isAggregating());
+  BOOST_CHECK(Logger::instance().getStream(DEBUG).isAggregating());
+
+  Logger::instance().set_aggregate(false);
+  BOOST_CHECK(!Logger::instance().getStream(INFO).isAggregating());
+  BOOST_CHECK(!Logger::instance().getStream(DEBUG).isAggregating());
+}
+
+BOOST_AUTO_TEST_CASE( MergeMessages )
+{
+  // rank 0 sends "a" twice and "b", rank 1 sends "a" and "c", rank 2 sends "a"
+  const std::string rank0("a\n\0a\n\0b\n\0\0", 10);
+  const std::string rank1("a\n\0c\n\0\0", 7);
+  const std::string rank2("a\n\0\0", 4);
+  const std::string all = rank0 + rank1 + rank2;
+  std::vector<char> data(all.begin(), all.end());
+  std::vector<int> sizes;
+  sizes.push_back(rank0.size());
+  sizes.push_back(rank1.size());
+  sizes.push_back(rank2.size());
+
+  BOOST_CHECK_EQUAL(LogStream::mergeMessages(data, sizes), "a [3/3 ranks]\na\nb\nc\n");
+
+  // a single rank keeps its repeated messages
+  sizes.assign(1, rank0.size());
+  data.assign(rank0.begin(), rank0.end());
+  BOOST_CHECK_EQUAL(LogStream::mergeMessages(data, sizes), "a\na\nb\n");
+}
+
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
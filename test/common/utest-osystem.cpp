@@ -63,6 +63,8 @@ BOOST_AUTO_TEST_CASE( layer )
   BOOST_CHECK( OSystem::instance().layer()->process_id() > 0 );
 
   BOOST_CHECK( OSystem::instance().layer()->memory_usage() > 0 );
+
+  BOOST_CHECK( OSystem::instance().layer()->memory_peak() > 0 );
 }
 
 //////////////////////////////////////////////////////////////////////////////
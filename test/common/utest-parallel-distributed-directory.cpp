@@ -0,0 +1,184 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+//
+// IMPORTANT:
+// run it both on 1 and many cores
+// for example: mpirun -np 4 ./utest-parallel-distributed-directory --report_level=confirm or --report_level=detailed
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::common::PE::DistributedDirectory"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <limits>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/PE/Comm.hpp"
+#include "common/PE/DistributedDirectory.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct DistributedDirectoryFixture
+{
+  DistributedDirectoryFixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  int m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( DistributedDirectorySuite, DistributedDirectoryFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init )
+{
+  PE::Comm::instance().init(m_argc,m_argv);
+  BOOST_CHECK_EQUAL( PE::Comm::instance().is_active() , true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( owners )
+{
+  const Uint rank = PE::Comm::instance().rank();
+  const Uint nb_ids = 20;
+
+  // rank r has the ids [5*r, 5*r+nb_ids), so every id is shared with the neighbouring ranks
+  std::vector<PE::DistributedDirectory::KeyT> my_ids;
+  for (Uint i=0; i<nb_ids; ++i)
+    my_ids.push_back(5*rank+i);
+
+  PE::DistributedDirectory directory;
+  directory.insert(my_ids);
+
+  std::vector<Uint> owners;
+  directory.find_owners(my_ids,owners);
+  BOOST_CHECK_EQUAL(owners.size(), my_ids.size());
+  for (Uint i=0; i<my_ids.size(); ++i)
+  {
+    // lowest rank r with 5*r <= id
+    const Uint expected = my_ids[i] < nb_ids ? 0u : (my_ids[i]-nb_ids)/5 + 1;
+    BOOST_CHECK_EQUAL(owners[i], expected);
+  }
+
+  // nobody inserted this id
+  std::vector<PE::DistributedDirectory::KeyT> unknown(1, 1000000u);
+  directory.find_owners(unknown,owners);
+  BOOST_CHECK_EQUAL(owners[0], std::numeric_limits<Uint>::max());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( payloads )
+{
+  const Uint rank = PE::Comm::instance().rank();
+  const Uint nb_procs = PE::Comm::instance().size();
+
+  // every rank inserts ids 0 and 1; id 0 carries the rank, id 1 carries the rank twice
+  std::vector<PE::DistributedDirectory::KeyT> ids;
+  ids.push_back(0u);
+  ids.push_back(1u);
+  std::vector<Uint> payload;
+  payload.push_back(rank);
+  payload.push_back(rank);
+  payload.push_back(rank);
+  std::vector<Uint> payload_start;
+  payload_start.push_back(0u);
+  payload_start.push_back(1u);
+  payload_start.push_back(3u);
+
+  PE::DistributedDirectory directory;
+  directory.insert(ids,payload,payload_start);
+
+  std::vector<Uint> found, found_start;
+  directory.find_payloads(ids,found,found_start);
+  BOOST_CHECK_EQUAL(found_start.size(), 3u);
+  BOOST_CHECK_EQUAL(found_start[1], nb_procs-1);
+  BOOST_CHECK_EQUAL(found_start[2], 3*(nb_procs-1));
+
+  // payloads of the other ranks, in order of increasing rank
+  Uint idx = 0;
+  for (Uint p=0; p<nb_procs; ++p)
+  {
+    if (p == rank)
+      continue;
+    BOOST_CHECK_EQUAL(found[found_start[0]+idx], p);
+    BOOST_CHECK_EQUAL(found[found_start[1]+2*idx], p);
+    BOOST_CHECK_EQUAL(found[found_start[1]+2*idx+1], p);
+    ++idx;
+  }
+
+  directory.find_payloads(ids,found,found_start,true);
+  BOOST_CHECK_EQUAL(found_start[2], 3*nb_procs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( partitioned_keys )
+{
+  const Uint rank = PE::Comm::instance().rank();
+  const Uint nb_procs = PE::Comm::instance().size();
+  const Uint nb_ids = 100;
+
+  // Ids clustered in a narrow range per rank, with a large gap between ranks
+  std::vector<PE::DistributedDirectory::KeyT> my_ids;
+  for (Uint i=0; i<nb_ids; ++i)
+    my_ids.push_back(1000000u*rank + 3*i);
+
+  PE::DistributedDirectory directory;
+  directory.partition_keys(my_ids);
+
+  // Home ranks increase with the id, and each rank manages about the same number of ids
+  Uint nb_home_ids = 0;
+  for (Uint i=0; i<my_ids.size(); ++i)
+  {
+    if (i != 0)
+      BOOST_CHECK(directory.home_rank(my_ids[i-1]) <= directory.home_rank(my_ids[i]));
+    BOOST_CHECK(directory.home_rank(my_ids[i]) < nb_procs);
+  }
+  directory.insert(my_ids);
+  for (Uint p=0; p<nb_procs; ++p)
+  {
+    for (Uint i=0; i<nb_ids; ++i)
+    {
+      if (directory.home_rank(1000000u*p + 3*i) == rank)
+        ++nb_home_ids;
+    }
+  }
+  BOOST_CHECK(nb_home_ids >= nb_ids/2);
+  BOOST_CHECK(nb_home_ids <= 2*nb_ids);
+
+  std::vector<Uint> owners;
+  directory.find_owners(my_ids,owners);
+  for (Uint i=0; i<my_ids.size(); ++i)
+    BOOST_CHECK_EQUAL(owners[i], rank);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize )
+{
+  PE::Comm::instance().finalize();
+  BOOST_CHECK_EQUAL( PE::Comm::instance().is_active() , false );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
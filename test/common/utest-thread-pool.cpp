@@ -0,0 +1,151 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for ThreadPool, TaskGroup and TaskGraph"
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/ThreadPool.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+void fill_range(std::vector<Uint>& values, const Uint begin, const Uint end)
+{
+  for (Uint i=begin; i<end; ++i)
+    values[i] += i;
+}
+
+void throw_error()
+{
+  throw ValueNotFound(FromHere(), "expected error");
+}
+
+/// Records the order in which tasks finish
+struct Recorder
+{
+  void record(const Uint task)
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+    order.push_back(task);
+  }
+
+  Uint position(const Uint task) const
+  {
+    return std::find(order.begin(),order.end(),task) - order.begin();
+  }
+
+  boost::mutex mutex;
+  std::vector<Uint> order;
+};
+
+/// Counts the indices of a range in the slot of the executing thread, without locking
+void count_per_worker(const ThreadPool& pool, std::vector<Uint>& counts, const Uint begin, const Uint end)
+{
+  counts[pool.current_worker()] += end-begin;
+}
+
+/// Task that starts nested tasks on the same pool, and waits for them
+void nested_parallel_for(ThreadPool& pool, std::vector<Uint>& values, const Uint begin, const Uint end)
+{
+  pool.parallel_for(begin,end,boost::bind(&fill_range,boost::ref(values),_1,_2),1);
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( ThreadPoolSuite )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( parallel_for )
+{
+  // a pool without workers, and pools with workers
+  for (Uint nb_threads=0; nb_threads<4; ++nb_threads)
+  {
+    ThreadPool pool(nb_threads);
+    std::vector<Uint> values(10000,0);
+    pool.parallel_for(0,values.size(),boost::bind(&fill_range,boost::ref(values),_1,_2));
+    for (Uint i=0; i<values.size(); ++i)
+      BOOST_CHECK_EQUAL(values[i], i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( current_worker )
+{
+  ThreadPool pool(3);
+  BOOST_CHECK_EQUAL(pool.current_worker(), pool.nb_threads());
+
+  // every thread gets its own slot
+  std::vector<Uint> counts(pool.nb_threads()+1,0);
+  pool.parallel_for(0,100000,boost::bind(&count_per_worker,boost::cref(pool),boost::ref(counts),_1,_2),10);
+  Uint total = 0;
+  for (Uint i=0; i<counts.size(); ++i)
+    total += counts[i];
+  BOOST_CHECK_EQUAL(total, 100000u);
+}
+
+BOOST_AUTO_TEST_CASE( nested_tasks )
+{
+  ThreadPool pool(2);
+  std::vector<Uint> values(1000,0);
+  pool.parallel_for(0,values.size(),boost::bind(&nested_parallel_for,boost::ref(pool),boost::ref(values),_1,_2),100);
+  for (Uint i=0; i<values.size(); ++i)
+    BOOST_CHECK_EQUAL(values[i], i);
+}
+
+BOOST_AUTO_TEST_CASE( exceptions )
+{
+  ThreadPool pool(2);
+  TaskGroup group(pool);
+  group.run(&throw_error);
+  BOOST_CHECK_THROW(group.wait(), ParallelError);
+}
+
+BOOST_AUTO_TEST_CASE( task_graph )
+{
+  ThreadPool pool(3);
+  Recorder recorder;
+  TaskGraph graph;
+  std::vector<Uint> tasks;
+  for (Uint i=0; i<6; ++i)
+    tasks.push_back(graph.add_task(boost::bind(&Recorder::record,&recorder,i)));
+  graph.add_dependency(tasks[1],tasks[0]);
+  graph.add_dependency(tasks[2],tasks[1]);
+  graph.add_dependency(tasks[5],tasks[2]);
+  graph.add_dependency(tasks[5],tasks[4]);
+  graph.run(pool);
+
+  BOOST_CHECK_EQUAL(recorder.order.size(), 6u);
+  BOOST_CHECK(recorder.position(0) < recorder.position(1));
+  BOOST_CHECK(recorder.position(1) < recorder.position(2));
+  BOOST_CHECK(recorder.position(2) < recorder.position(5));
+  BOOST_CHECK(recorder.position(4) < recorder.position(5));
+
+  TaskGraph cyclic;
+  const Uint a = cyclic.add_task(boost::bind(&Recorder::record,&recorder,0u));
+  const Uint b = cyclic.add_task(boost::bind(&Recorder::record,&recorder,1u));
+  cyclic.add_dependency(a,b);
+  cyclic.add_dependency(b,a);
+  BOOST_CHECK_THROW(cyclic.run(pool), SetupError);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//////////////////////////////////////////////////////////////////////////////
@@ -13,7 +13,7 @@
 #include <Eigen/Dense>
 
 #include "common/CF.hpp"
-#include "Tools/Testing/TimedTestFixture.hpp"
+#include "Tools/Testing/BenchmarkFixture.hpp"
 
 using namespace std;
 using namespace Eigen;
@@ -30,34 +30,43 @@ struct nat
   double * cf_restrict data;
 };
 
-#define MSIZE 1000000
 #define LSIZE 4
 
-BOOST_FIXTURE_TEST_SUITE( VectorBenchmarkSuite, TimedTestFixture )
+struct EigenBenchmarkFixture : BenchmarkFixture
+{
+  EigenBenchmarkFixture() : nb_products(scaled(1000000)) {}
+
+  /// Number of matrix products in each test
+  const int nb_products;
+};
+
+BOOST_FIXTURE_TEST_SUITE( VectorBenchmarkSuite, EigenBenchmarkFixture )
 
 ///////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_CASE( dgemv_eigen_dynamic )
 {
   std::vector< MatrixXd > ma;
-  ma.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  ma.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     ma[i] = MatrixXd::Constant( LSIZE, LSIZE, 2.0);
 
   std::vector< VectorXd > vb;
-  vb.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  vb.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     vb[i] = VectorXd::Constant( LSIZE, 5.0);
 
   std::vector< VectorXd > vc;
-  vc.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  vc.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     vc[i] = VectorXd::Constant( LSIZE, 0.0);
 
   restart_timer();
 
-  for ( int i = 0; i < MSIZE; ++i )
+  for ( int i = 0; i < nb_products; ++i )
     vc[i].noalias() = ma[i] * vb[i];
+
+  record("products", nb_products, "products");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -68,24 +77,26 @@ BOOST_AUTO_TEST_CASE( dgemv_eigen_fixed )
   typedef Matrix< double, LSIZE, 1     >  VectorSd;
 
   std::vector< MatrixSd > ma;
-  ma.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  ma.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     ma[i] = MatrixSd::Constant( LSIZE, LSIZE, 2.0);
 
   std::vector< VectorSd > vb;
-  vb.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  vb.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     vb[i] = VectorSd::Constant( LSIZE, 5.0 );
 
   std::vector< VectorSd > vc;
-  vc.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  vc.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     vc[i] = VectorSd::Constant( LSIZE, 0.0 );
 
   restart_timer();
 
-  for ( int i = 0; i < MSIZE; ++i )
+  for ( int i = 0; i < nb_products; ++i )
     vc[i].noalias() = ma[i] * vb[i];
+
+  record("products", nb_products, "products");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -93,24 +104,24 @@ BOOST_AUTO_TEST_CASE( dgemv_eigen_fixed )
 // BOOST_AUTO_TEST_CASE( dgemv_matrixt )
 // {
 //   std::vector< RealMatrix > ma;
-//   ma.resize( MSIZE );
-//   for ( int i = 0; i < MSIZE; ++i )
+//   ma.resize( nb_products );
+//   for ( int i = 0; i < nb_products; ++i )
 //   {
 //     ma[i].resize( LSIZE, LSIZE );
 //     ma[i] = 2.0;
 //   }
 //
 //   std::vector< RealVector > vb;
-//   vb.resize( MSIZE );
-//   for ( int i = 0; i < MSIZE; ++i )
+//   vb.resize( nb_products );
+//   for ( int i = 0; i < nb_products; ++i )
 //   {
 //     vb[i].resize( LSIZE );
 //     vb[i] = 5.0;
 //   }
 //
 //   std::vector< RealVector > vc;
-//   vc.resize( MSIZE );
-//   for ( int i = 0; i < MSIZE; ++i )
+//   vc.resize( nb_products );
+//   for ( int i = 0; i < nb_products; ++i )
 //   {
 //     vc[i].resize( LSIZE );
 //     vc[i] = 0.0;
@@ -118,7 +129,7 @@ BOOST_AUTO_TEST_CASE( dgemv_eigen_fixed )
 //
 //   restart_timer();
 //
-//   for ( int i = 0; i < MSIZE; ++i )
+//   for ( int i = 0; i < nb_products; ++i )
 //     vc[i] = ma[i] * vb[i];
 // }
 
@@ -127,24 +138,24 @@ BOOST_AUTO_TEST_CASE( dgemv_eigen_fixed )
 BOOST_AUTO_TEST_CASE( dgemv_native )
 {
   std::vector< nat > ma;
-  ma.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  ma.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
   {
     ma[i].data = new double [ LSIZE * LSIZE ];
     for ( int j = 0; j < LSIZE*LSIZE; ++j ) ma[i].data[j] = 2.0;
   }
 
   std::vector< nat > vb;
-  vb.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  vb.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
   {
     vb[i].data = new double [ LSIZE ];
     for ( int j = 0; j < LSIZE; ++j ) vb[i].data[j] = 5.0;
   }
 
   std::vector< nat > vc;
-  vc.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  vc.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
   {
       vc[i].data = new double [ LSIZE ];
       for ( int j = 0; j < LSIZE; ++j ) vc[i].data[j] = 0.0;
@@ -152,13 +163,15 @@ BOOST_AUTO_TEST_CASE( dgemv_native )
 
   restart_timer();
 
-  for ( int e = 0; e < MSIZE; ++e )
+  for ( int e = 0; e < nb_products; ++e )
     for ( int i = 0; i < LSIZE; ++i )
     {
       const unsigned n = LSIZE;
       for (Uint j = 0, k = i*n; j < n; ++j, ++k)
         vc[e].data[i] += ma[e].data[k] * vb[e].data[j];
     }
+
+  record("products", nb_products, "products");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -166,24 +179,26 @@ BOOST_AUTO_TEST_CASE( dgemv_native )
 BOOST_AUTO_TEST_CASE( dgemm_eigen_dynamic )
 {
   std::vector< MatrixXd > ma;
-  ma.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  ma.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     ma[i] = MatrixXd::Constant( LSIZE, LSIZE, 2.0);
 
   std::vector< MatrixXd > mb;
-  mb.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  mb.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     mb[i] = MatrixXd::Constant( LSIZE, LSIZE, 7.0);
 
   std::vector< MatrixXd > mc;
-  mc.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  mc.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     mc[i] = MatrixXd::Constant( LSIZE, LSIZE, 0.0);
 
   restart_timer();
 
-  for ( int i = 0; i < MSIZE; ++i )
+  for ( int i = 0; i < nb_products; ++i )
     mc[i].noalias() = ma[i] * mb[i];
+
+  record("products", nb_products, "products");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -193,24 +208,26 @@ BOOST_AUTO_TEST_CASE( dgemm_eigen_fixed )
   typedef Matrix< double, LSIZE, LSIZE >  MatrixSd;
 
   std::vector< MatrixSd > ma;
-  ma.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  ma.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     ma[i] = MatrixSd::Constant( LSIZE, LSIZE, 2.0);
 
   std::vector< MatrixSd > mb;
-  mb.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  mb.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     mb[i] = MatrixSd::Constant( LSIZE, LSIZE, 7.0);
 
   std::vector< MatrixSd > mc;
-  mc.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  mc.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
     mc[i] = MatrixSd::Constant( LSIZE, LSIZE, 0.0);
 
   restart_timer();
 
-  for ( int i = 0; i < MSIZE; ++i )
+  for ( int i = 0; i < nb_products; ++i )
     mc[i].noalias() = ma[i] * mb[i];
+
+  record("products", nb_products, "products");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -218,24 +235,24 @@ BOOST_AUTO_TEST_CASE( dgemm_eigen_fixed )
 // BOOST_AUTO_TEST_CASE( dgemm_matrixt )
 // {
 //   std::vector< RealMatrix > ma;
-//   ma.resize( MSIZE );
-//   for ( int i = 0; i < MSIZE; ++i )
+//   ma.resize( nb_products );
+//   for ( int i = 0; i < nb_products; ++i )
 //   {
 //     ma[i].resize( LSIZE, LSIZE );
 //     ma[i] = 2.0;
 //   }
 //
 //   std::vector< RealMatrix > mb;
-//   mb.resize( MSIZE );
-//   for ( int i = 0; i < MSIZE; ++i )
+//   mb.resize( nb_products );
+//   for ( int i = 0; i < nb_products; ++i )
 //   {
 //     mb[i].resize( LSIZE, LSIZE );
 //     mb[i] = 7.0;
 //   }
 //
 //   std::vector< RealMatrix > mc;
-//   mc.resize( MSIZE );
-//   for ( int i = 0; i < MSIZE; ++i )
+//   mc.resize( nb_products );
+//   for ( int i = 0; i < nb_products; ++i )
 //   {
 //     mc[i].resize( LSIZE, LSIZE );
 //     mc[i] = 0.0;
@@ -243,7 +260,7 @@ BOOST_AUTO_TEST_CASE( dgemm_eigen_fixed )
 //
 //   restart_timer();
 //
-//   for ( int i = 0; i < MSIZE; ++i )
+//   for ( int i = 0; i < nb_products; ++i )
 //     mc[i] = ma[i] * mb[i];
 // }
 
@@ -252,24 +269,24 @@ BOOST_AUTO_TEST_CASE( dgemm_eigen_fixed )
 BOOST_AUTO_TEST_CASE( dgemm_native )
 {
   std::vector< nat > ma;
-  ma.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  ma.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
   {
     ma[i].data = new double [ LSIZE * LSIZE ];
     for ( int j = 0; j < LSIZE*LSIZE; ++j ) ma[i].data[j] = 2.0;
   }
 
   std::vector< nat > mb;
-  mb.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  mb.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
   {
     mb[i].data = new double [ LSIZE * LSIZE ];
     for ( int j = 0; j < LSIZE*LSIZE; ++j ) mb[i].data[j] = 7.0;
   }
 
   std::vector< nat > mc;
-  mc.resize( MSIZE );
-  for ( int i = 0; i < MSIZE; ++i )
+  mc.resize( nb_products );
+  for ( int i = 0; i < nb_products; ++i )
   {
     mc[i].data = new double [ LSIZE * LSIZE ];
     for ( int j = 0; j < LSIZE*LSIZE; ++j ) mc[i].data[j] = 0.0;
@@ -277,7 +294,7 @@ BOOST_AUTO_TEST_CASE( dgemm_native )
 
   restart_timer();
 
-  for ( int e = 0; e < MSIZE; ++e )
+  for ( int e = 0; e < nb_products; ++e )
   {
     const size_t nc = LSIZE;
     const size_t m  = LSIZE;
@@ -307,6 +324,8 @@ BOOST_AUTO_TEST_CASE( dgemm_native )
       }
     }
   }
+
+  record("products", nb_products, "products");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
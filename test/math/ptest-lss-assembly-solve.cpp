@@ -0,0 +1,159 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark assembly and solution of a linear system"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/OptionList.hpp"
+
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+#include "common/PE/CommWrapper.hpp"
+
+#include "math/LSS/Matrix.hpp"
+#include "math/LSS/System.hpp"
+#include "math/LSS/Vector.hpp"
+
+#include "Tools/Testing/BenchmarkFixture.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::math;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Five point stencil on a square grid of n x n nodes, with a diagonal shifted to keep the matrix well conditioned
+struct LSSBenchmarkFixture : Tools::Testing::BenchmarkFixture
+{
+  LSSBenchmarkFixture()
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    matrix_builder = argc > 1 ? std::string(argv[1]) : std::string("cf3.math.LSS.TrilinosCrsMatrix");
+    n = scaled(argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 100u);
+  }
+
+  Uint node(const Uint i, const Uint j) const { return i*n + j; }
+
+  /// Nodes connected to node (i,j), including itself
+  void neighbours(const Uint i, const Uint j, std::vector<Uint>& result) const
+  {
+    result.clear();
+    result.push_back(node(i,j));
+    if (i > 0)   result.push_back(node(i-1,j));
+    if (i+1 < n) result.push_back(node(i+1,j));
+    if (j > 0)   result.push_back(node(i,j-1));
+    if (j+1 < n) result.push_back(node(i,j+1));
+  }
+
+  LSS::System& lss()
+  {
+    return *Handle<LSS::System>(Core::instance().root().get_child("LSS"));
+  }
+
+  std::string matrix_builder;
+  Uint n;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( LSSBenchmarkSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Create, LSSBenchmarkFixture )
+{
+  Component& root = Core::instance().root();
+  PE::CommPattern& cp = *root.create_component<PE::CommPattern>("commpattern");
+
+  std::vector<Uint> gid(n*n), rank(n*n, 0u), conn, startidx(1, 0u), row;
+  for (Uint i=0; i<n; ++i)
+  {
+    for (Uint j=0; j<n; ++j)
+    {
+      gid[node(i,j)] = node(i,j);
+      neighbours(i,j,row);
+      conn.insert(conn.end(), row.begin(), row.end());
+      startidx.push_back(conn.size());
+    }
+  }
+  cp.insert("gid",gid,1,false);
+  cp.setup(cp.get_child("gid")->handle<PE::CommWrapper>(),rank);
+
+  Handle<LSS::System> lss = root.create_component<LSS::System>("LSS");
+  lss->options().set("matrix_builder", matrix_builder);
+  lss->create(cp, 1u, conn, startidx);
+  set_work(n*n, "rows");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Assemble, LSSBenchmarkFixture )
+{
+  LSS::Matrix& matrix = *lss().matrix();
+  LSS::Vector& rhs = *lss().rhs();
+  lss().reset();
+
+  // The right hand side is the row sum, so the solution is one everywhere
+  std::vector<Uint> row;
+  for (Uint i=0; i<n; ++i)
+  {
+    for (Uint j=0; j<n; ++j)
+    {
+      const Uint r = node(i,j);
+      neighbours(i,j,row);
+      matrix.add_value(r, r, 4.1);
+      Real row_sum = 4.1;
+      for (Uint k=1; k<row.size(); ++k)
+      {
+        matrix.add_value(row[k], r, -1.);
+        row_sum -= 1.;
+      }
+      rhs.add_value(r, row_sum);
+    }
+  }
+  set_work(n*n, "rows");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Solve, LSSBenchmarkFixture )
+{
+  lss().solve();
+  set_work(n*n, "rows");
+
+  LSS::Vector& solution = *lss().solution();
+  for (Uint r=0; r<n*n; ++r)
+  {
+    Real value;
+    solution.get_value(r, value);
+    BOOST_CHECK_CLOSE(value, 1., 1e-3);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Terminate )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,175 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the matrix-free LSS matrix"
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Action.hpp"
+#include "common/Core.hpp"
+#include "common/OptionList.hpp"
+
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+#include "common/PE/CommWrapper.hpp"
+
+#include "math/LSS/System.hpp"
+#include "math/LSS/Matrix.hpp"
+#include "math/LSS/Vector.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::common::PE;
+using namespace cf3::math;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const Uint nb_nodes = 20;
+const Uint neq = 2;
+
+/// Assembles a chain of line elements with two coupled equations per node
+class ChainAssembly : public common::Action
+{
+public:
+  ChainAssembly(const std::string& name) : common::Action(name)
+  {
+  }
+
+  static std::string type_name() { return "ChainAssembly"; }
+
+  virtual void execute()
+  {
+    LSS::Matrix& matrix = *lss->matrix();
+    LSS::BlockAccumulator block;
+    block.resize(2, neq);
+    const Real stiffness[2][2] = { { 1.1, -1. }, { -1., 1.1 } };
+    const Real coupling[neq][neq] = { { 2., 0.5 }, { 0.3, 1. } };
+    for(Uint e = 0; e != nb_nodes-1; ++e)
+    {
+      block.indices[0] = e;
+      block.indices[1] = e+1;
+      for(Uint i = 0; i != 2; ++i)
+        for(Uint j = 0; j != neq; ++j)
+          for(Uint k = 0; k != 2; ++k)
+            for(Uint l = 0; l != neq; ++l)
+              block.mat(i*neq+j, k*neq+l) = (1. + 0.1*e) * stiffness[i][k] * coupling[j][l];
+      matrix.add_values(block);
+      if(!matrix.is_applying())
+      {
+        block.rhs.setConstant(1.);
+        lss->rhs()->add_rhs_values(block);
+      }
+    }
+  }
+
+  Handle<LSS::System> lss;
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( MatrixFreeSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( CompareWithAssembled )
+{
+  Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+
+  Component& root = Core::instance().root();
+  CommPattern& cp = *root.create_component<CommPattern>("commpattern");
+
+  std::vector<Uint> gid, rnk, conn, startidx;
+  startidx.push_back(0);
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    gid.push_back(i);
+    rnk.push_back(0);
+    if(i != 0)
+      conn.push_back(i-1);
+    conn.push_back(i);
+    if(i != nb_nodes-1)
+      conn.push_back(i+1);
+    startidx.push_back(conn.size());
+  }
+  cp.insert("gid",gid,1,false);
+  cp.setup(cp.get_child("gid")->handle<common::PE::CommWrapper>(),rnk);
+
+  Handle<LSS::System> assembled = root.create_component<LSS::System>("Assembled");
+  assembled->options().set("matrix_builder", std::string("cf3.math.LSS.TrilinosCrsMatrix"));
+  assembled->create(cp, neq, conn, startidx);
+  Handle<ChainAssembly> assembled_assembly = root.create_component<ChainAssembly>("AssembledAssembly");
+  assembled_assembly->lss = assembled;
+
+  Handle<LSS::System> matrix_free = root.create_component<LSS::System>("MatrixFree");
+  matrix_free->options().set("matrix_builder", std::string("cf3.math.LSS.TrilinosMatrixFree"));
+  matrix_free->create(cp, neq, conn, startidx);
+  Handle<ChainAssembly> matrix_free_assembly = root.create_component<ChainAssembly>("MatrixFreeAssembly");
+  matrix_free_assembly->lss = matrix_free;
+  matrix_free->matrix()->options().set("assembly", Handle<common::Action>(matrix_free_assembly));
+
+  for(Uint symmetric = 0; symmetric != 2; ++symmetric)
+  {
+    assembled->reset();
+    matrix_free->reset();
+    assembled_assembly->execute();
+    matrix_free_assembly->execute();
+
+    // Diagonal blocks are stored
+    Real assembled_value, matrix_free_value;
+    assembled->matrix()->get_value(3, 2, assembled_value);
+    matrix_free->matrix()->get_value(3, 2, matrix_free_value);
+    BOOST_CHECK_EQUAL(matrix_free_value, assembled_value);
+
+    std::vector<Uint> bc_nodes, bc_eqs;
+    std::vector<Real> bc_values;
+    for(Uint j = 0; j != neq; ++j)
+    {
+      bc_nodes.push_back(0); bc_eqs.push_back(j); bc_values.push_back(1.+j);
+      bc_nodes.push_back(nb_nodes-1); bc_eqs.push_back(j); bc_values.push_back(-2.);
+    }
+    assembled->dirichlet(bc_nodes, bc_eqs, bc_values, symmetric);
+    matrix_free->dirichlet(bc_nodes, bc_eqs, bc_values, symmetric);
+
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      for(Uint j = 0; j != neq; ++j)
+      {
+        assembled->rhs()->get_value(i, j, assembled_value);
+        matrix_free->rhs()->get_value(i, j, matrix_free_value);
+        BOOST_CHECK_SMALL(matrix_free_value - assembled_value, 1e-12);
+      }
+    }
+
+    assembled->solve();
+    matrix_free->solve();
+
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      for(Uint j = 0; j != neq; ++j)
+      {
+        assembled->solution()->get_value(i, j, assembled_value);
+        matrix_free->solution()->get_value(i, j, matrix_free_value);
+        BOOST_CHECK_SMALL(matrix_free_value - assembled_value, 1e-6 * std::max(1., std::abs(assembled_value)));
+      }
+    }
+  }
+
+  Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
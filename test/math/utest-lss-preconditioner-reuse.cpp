@@ -0,0 +1,221 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the preconditioner reuse policies of cf3::math::LSS::TrilinosStratimikosStrategy"
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+#include "common/PE/CommWrapper.hpp"
+
+#include "math/LSS/Matrix.hpp"
+#include "math/LSS/SolutionStrategy.hpp"
+#include "math/LSS/System.hpp"
+#include "math/LSS/Vector.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::math;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Five point stencil on a square grid of n x n nodes, with a diagonal shifted to keep the matrix well conditioned
+struct PreconditionerReuseFixture
+{
+  PreconditionerReuseFixture() : n(10u), nb_solves(6u)
+  {
+  }
+
+  Uint node(const Uint i, const Uint j) const { return i*n + j; }
+
+  /// Nodes connected to node (i,j), including itself
+  void neighbours(const Uint i, const Uint j, std::vector<Uint>& result) const
+  {
+    result.clear();
+    result.push_back(node(i,j));
+    if (i > 0)   result.push_back(node(i-1,j));
+    if (i+1 < n) result.push_back(node(i+1,j));
+    if (j > 0)   result.push_back(node(i,j-1));
+    if (j+1 < n) result.push_back(node(i,j+1));
+  }
+
+  /// Create a system with the given reuse policy
+  LSS::System& create_system(const std::string& name, const std::string& reuse_policy)
+  {
+    Component& root = Core::instance().root();
+    PE::CommPattern& cp = *root.create_component<PE::CommPattern>("commpattern_" + name);
+
+    std::vector<Uint> gid(n*n), rank(n*n, 0u), conn, startidx(1, 0u), row;
+    for (Uint i=0; i<n; ++i)
+    {
+      for (Uint j=0; j<n; ++j)
+      {
+        gid[node(i,j)] = node(i,j);
+        neighbours(i,j,row);
+        conn.insert(conn.end(), row.begin(), row.end());
+        startidx.push_back(conn.size());
+      }
+    }
+    cp.insert("gid",gid,1,false);
+    cp.setup(cp.get_child("gid")->handle<PE::CommWrapper>(),rank);
+
+    LSS::System& lss = *root.create_component<LSS::System>(name);
+    lss.options().set("matrix_builder", std::string("cf3.math.LSS.TrilinosCrsMatrix"));
+    lss.create(cp, 1u, conn, startidx);
+    lss.solution_strategy()->options().set("preconditioner_reuse", reuse_policy);
+    lss.solution_strategy()->options().set("print_settings", false);
+    return lss;
+  }
+
+  /// Assemble the system with the given diagonal. The right hand side is the row sum, so the solution is one everywhere.
+  void assemble(LSS::System& lss, const Real diagonal)
+  {
+    LSS::Matrix& matrix = *lss.matrix();
+    LSS::Vector& rhs = *lss.rhs();
+    lss.reset();
+
+    std::vector<Uint> row;
+    for (Uint i=0; i<n; ++i)
+    {
+      for (Uint j=0; j<n; ++j)
+      {
+        const Uint r = node(i,j);
+        neighbours(i,j,row);
+        matrix.add_value(r, r, diagonal);
+        Real row_sum = diagonal;
+        for (Uint k=1; k<row.size(); ++k)
+        {
+          matrix.add_value(row[k], r, -1.);
+          row_sum -= 1.;
+        }
+        rhs.add_value(r, row_sum);
+      }
+    }
+  }
+
+  /// Solve nb_solves times with changing matrix values, returning if the preconditioner was rebuilt for each solve
+  std::vector<bool> solve_repeatedly(LSS::System& lss)
+  {
+    const PropertyList& properties = lss.solution_strategy()->properties();
+    std::vector<bool> rebuilt;
+    Real total_setup_time = 0.;
+    Real total_solve_time = 0.;
+    for (Uint s=0; s<nb_solves; ++s)
+    {
+      assemble(lss, 4.1 + 0.1*s);
+      lss.solve();
+      rebuilt.push_back(properties.value<bool>("preconditioner_rebuilt"));
+
+      // The timings of each solve add up to the totals
+      const Real setup_time = properties.value<Real>("setup_time");
+      const Real solve_time = properties.value<Real>("solve_time");
+      BOOST_CHECK(setup_time >= 0.);
+      BOOST_CHECK(solve_time > 0.);
+      total_setup_time += setup_time;
+      total_solve_time += solve_time;
+      BOOST_CHECK_CLOSE(properties.value<Real>("total_setup_time"), total_setup_time, 1e-8);
+      BOOST_CHECK_CLOSE(properties.value<Real>("total_solve_time"), total_solve_time, 1e-8);
+      BOOST_CHECK(properties.value<int>("iterations") > 0);
+
+      // A reused preconditioner still gives the solution
+      for (Uint r=0; r<n*n; ++r)
+      {
+        Real value;
+        lss.solution()->get_value(r, value);
+        BOOST_CHECK_CLOSE(value, 1., 1e-3);
+      }
+    }
+    BOOST_CHECK_EQUAL(properties.value<Uint>("nb_preconditioner_setups"), static_cast<Uint>(std::count(rebuilt.begin(), rebuilt.end(), true)));
+    return rebuilt;
+  }
+
+  /// Check the rebuilds against a string of 1 (rebuilt) and 0 (reused) per solve
+  void check_rebuilt(const std::vector<bool>& rebuilt, const std::string& expected)
+  {
+    std::string result;
+    for (Uint s=0; s<rebuilt.size(); ++s)
+      result += rebuilt[s] ? '1' : '0';
+    BOOST_CHECK_EQUAL(result, expected);
+  }
+
+  Uint n;
+  Uint nb_solves;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( PreconditionerReuseSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Full, PreconditionerReuseFixture )
+{
+  check_rebuilt(solve_repeatedly(create_system("full", "full")), "111111");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Symbolic, PreconditionerReuseFixture )
+{
+  // The preconditioner is recomputed for the new values every solve, keeping its symbolic setup
+  check_rebuilt(solve_repeatedly(create_system("symbolic", "symbolic")), "111111");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Count, PreconditionerReuseFixture )
+{
+  LSS::System& lss = create_system("count", "count");
+  lss.solution_strategy()->options().set("reuse_count", 2u);
+  check_rebuilt(solve_repeatedly(lss), "101010");
+
+  LSS::System& lss_4 = create_system("count_4", "count");
+  lss_4.solution_strategy()->options().set("reuse_count", 4u);
+  check_rebuilt(solve_repeatedly(lss_4), "100010");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Iterations, PreconditionerReuseFixture )
+{
+  // The iteration count never grows by a factor 10000
+  LSS::System& lss = create_system("iterations", "iterations");
+  lss.solution_strategy()->options().set("reuse_degradation", 1e6);
+  check_rebuilt(solve_repeatedly(lss), "100000");
+
+  // Any solve with a reused preconditioner counts as degraded, so the next one rebuilds it
+  LSS::System& lss_degraded = create_system("iterations_degraded", "iterations");
+  lss_degraded.solution_strategy()->options().set("reuse_degradation", -100.);
+  check_rebuilt(solve_repeatedly(lss_degraded), "101010");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Terminate )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
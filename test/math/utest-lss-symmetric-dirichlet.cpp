@@ -86,6 +86,8 @@ struct LSSSymmetricDirichletFixture
   /// build a test system
   void build_system(LSS::System& sys, common::PE::CommPattern& cp)
   {
+    node_connectivity.clear();
+    starting_indices.clear();
     if (irank==0)
     {
       node_connectivity += 0,1,0,1,2,1,2;
@@ -101,6 +103,125 @@ struct LSSSymmetricDirichletFixture
     sys.create(cp,neq,node_connectivity,starting_indices);
   }
 
+  /// true if the node with local index node is updated by this rank
+  bool is_owned(const Uint node) const
+  {
+    return rank_updatable[node] == static_cast<Uint>(irank);
+  }
+
+  /// reset the system and fill the owned rows with distinct values, so misplaced entries show up
+  void fill_system(LSS::System& sys)
+  {
+    sys.reset();
+    const Uint nb_nodes = starting_indices.size()-1;
+    for(Uint row_node = 0; row_node != nb_nodes; ++row_node)
+    {
+      if(!is_owned(row_node))
+        continue;
+      for(Uint i = 0; i != static_cast<Uint>(neq); ++i)
+      {
+        const Uint row = row_node*neq+i;
+        for(Uint col_idx = starting_indices[row_node]; col_idx != starting_indices[row_node+1]; ++col_idx)
+        {
+          for(Uint j = 0; j != static_cast<Uint>(neq); ++j)
+          {
+            const Uint col = node_connectivity[col_idx]*neq+j;
+            sys.matrix()->set_value(col, row, 1. + row + 0.1*col);
+          }
+        }
+        sys.rhs()->set_value(row, 0.5*row);
+      }
+    }
+  }
+
+  /// compare the owned rows of the matrix, rhs and solution of two systems
+  void check_equal(LSS::System& sys, LSS::System& ref)
+  {
+    Real val, ref_val;
+    const Uint nb_nodes = starting_indices.size()-1;
+    for(Uint row_node = 0; row_node != nb_nodes; ++row_node)
+    {
+      if(!is_owned(row_node))
+        continue;
+      for(Uint i = 0; i != static_cast<Uint>(neq); ++i)
+      {
+        const Uint row = row_node*neq+i;
+        for(Uint col_idx = starting_indices[row_node]; col_idx != starting_indices[row_node+1]; ++col_idx)
+        {
+          for(Uint j = 0; j != static_cast<Uint>(neq); ++j)
+          {
+            const Uint col = node_connectivity[col_idx]*neq+j;
+            sys.matrix()->get_value(col, row, val);
+            ref.matrix()->get_value(col, row, ref_val);
+            BOOST_CHECK_SMALL(val - ref_val, 1e-12);
+          }
+        }
+        sys.rhs()->get_value(row, val);
+        ref.rhs()->get_value(row, ref_val);
+        BOOST_CHECK_SMALL(val - ref_val, 1e-12);
+        sys.solution()->get_value(row, val);
+        ref.solution()->get_value(row, ref_val);
+        BOOST_CHECK_SMALL(val - ref_val, 1e-12);
+      }
+    }
+  }
+
+  /// several conditions on the owned nodes of each rank, with values that change between passes
+  void dirichlet_conditions(const Uint pass, std::vector<Uint>& blockrows, std::vector<Uint>& eqs, std::vector<Real>& values)
+  {
+    const Uint first = irank == 0 ? 0 : 1;
+    blockrows.clear();
+    eqs.clear();
+    values.clear();
+    blockrows += first, first+1, first;
+    eqs += 0, 1, 1;
+    values += 1. + pass, 2. - pass, 3. + 2.*pass;
+  }
+
+  /// apply several conditions as a batch and one by one, and compare the result over several passes
+  void check_batch(const bool preserve_symmetry)
+  {
+    neq = 2;
+    boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+    common::PE::CommPattern& cp = *cp_ptr;
+    build_commpattern(cp);
+
+    boost::shared_ptr<LSS::System> ref(common::allocate_component<LSS::System>("ref"));
+    boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+    ref->options().option("matrix_builder").change_value(matrix_builder);
+    sys->options().option("matrix_builder").change_value(matrix_builder);
+    build_system(*ref,cp);
+    build_system(*sys,cp);
+
+    std::vector<Uint> blockrows, eqs;
+    std::vector<Real> values;
+    // the later passes reuse the positions computed in the first one
+    for(Uint pass = 0; pass != 3; ++pass)
+    {
+      dirichlet_conditions(pass, blockrows, eqs, values);
+      const Uint nb_entries = blockrows.size();
+
+      fill_system(*ref);
+      for(Uint e = 0; e != nb_entries; ++e)
+        ref->dirichlet(blockrows[e], eqs[e], values[e], preserve_symmetry);
+
+      fill_system(*sys);
+      if(pass == 0)
+      {
+        sys->dirichlet(blockrows, eqs, values, preserve_symmetry);
+      }
+      else
+      {
+        sys->begin_dirichlet_batch();
+        for(Uint e = 0; e != nb_entries; ++e)
+          sys->dirichlet(blockrows[e], eqs[e], values[e], preserve_symmetry);
+        sys->end_dirichlet_batch();
+      }
+
+      check_equal(*sys, *ref);
+    }
+  }
+
   /// main solver selector
   std::string solvertype;
   std::string matrix_builder;
@@ -209,6 +330,149 @@ BOOST_AUTO_TEST_CASE( test_complete_system )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( test_batch_dirichlet )
+{
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  build_commpattern(cp);
+
+  // reference system with the conditions applied one by one, and a system using batches
+  boost::shared_ptr<LSS::System> ref(common::allocate_component<LSS::System>("ref"));
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  ref->options().option("matrix_builder").change_value(matrix_builder);
+  sys->options().option("matrix_builder").change_value(matrix_builder);
+  build_system(*ref,cp);
+  build_system(*sys,cp);
+
+  const Uint bc_row = irank == 0 ? 1 : 0;
+  ref->matrix()->set_row(0, 0, 2, 1);
+  ref->matrix()->set_row(1, 0, 2, 1);
+  ref->matrix()->set_row(2, 0, 2, 1);
+  ref->dirichlet(bc_row, 0, 10., true);
+
+  // second pass reuses the positions computed in the first
+  for(Uint pass = 0; pass != 2; ++pass)
+  {
+    sys->reset();
+    sys->matrix()->set_row(0, 0, 2, 1);
+    sys->matrix()->set_row(1, 0, 2, 1);
+    sys->matrix()->set_row(2, 0, 2, 1);
+    sys->begin_dirichlet_batch();
+    sys->dirichlet(bc_row, 0, 10., true);
+    sys->end_dirichlet_batch();
+
+    Real val, ref_val;
+    for(Uint i = 0; i != 3; ++i)
+    {
+      sys->rhs()->get_value(i, val);
+      ref->rhs()->get_value(i, ref_val);
+      BOOST_CHECK_EQUAL(val, ref_val);
+      sys->solution()->get_value(i, val);
+      ref->solution()->get_value(i, ref_val);
+      BOOST_CHECK_EQUAL(val, ref_val);
+    }
+
+    if(irank == 0)
+    {
+      sys->matrix()->get_value(0, 0, val);
+      BOOST_CHECK_EQUAL(val, 2.);
+      sys->matrix()->get_value(1, 0, val);
+      BOOST_CHECK_EQUAL(val, 0.);
+      sys->matrix()->get_value(0, 1, val);
+      BOOST_CHECK_EQUAL(val, 0.);
+      sys->matrix()->get_value(1, 1, val);
+      BOOST_CHECK_EQUAL(val, 1.);
+      sys->matrix()->get_value(2, 1, val);
+      BOOST_CHECK_EQUAL(val, 0.);
+    }
+    else
+    {
+      sys->matrix()->get_value(0, 1, val);
+      BOOST_CHECK_EQUAL(val, 0.);
+      sys->matrix()->get_value(1, 1, val);
+      BOOST_CHECK_EQUAL(val, 2.);
+      sys->matrix()->get_value(2, 2, val);
+      BOOST_CHECK_EQUAL(val, 2.);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_batch_dirichlet_nonsymmetric )
+{
+  check_batch(false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_batch_dirichlet_symmetric )
+{
+  check_batch(true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_batch_dirichlet_order )
+{
+  neq = 2;
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  build_commpattern(cp);
+
+  boost::shared_ptr<LSS::System> ref(common::allocate_component<LSS::System>("ref"));
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  ref->options().option("matrix_builder").change_value(matrix_builder);
+  sys->options().option("matrix_builder").change_value(matrix_builder);
+  build_system(*ref,cp);
+  build_system(*sys,cp);
+
+  const Uint first = irank == 0 ? 0 : 1;
+  const Uint row = first*neq;
+  Real val;
+
+  // The conditions are applied at the end of the batch, after changes made in between
+  fill_system(*sys);
+  sys->begin_dirichlet_batch();
+  sys->dirichlet(first, 0, 5.);
+  sys->rhs()->set_value(first, 0, 7.);
+  sys->matrix()->add_value(row, row, 3.);
+  sys->rhs()->get_value(first, 0, val);
+  BOOST_CHECK_EQUAL(val, 7.);
+  sys->end_dirichlet_batch();
+  sys->rhs()->get_value(first, 0, val);
+  BOOST_CHECK_EQUAL(val, 5.);
+  sys->solution()->get_value(first, 0, val);
+  BOOST_CHECK_EQUAL(val, 5.);
+  sys->matrix()->get_value(row, row, val);
+  BOOST_CHECK_EQUAL(val, 1.);
+
+  // Only the last of repeated conditions is applied, also to the columns moved to the rhs
+  fill_system(*ref);
+  ref->dirichlet(first, 1, 4., true);
+  fill_system(*sys);
+  sys->begin_dirichlet_batch();
+  sys->dirichlet(first, 1, 1., true);
+  sys->dirichlet(first, 1, 4., true);
+  sys->end_dirichlet_batch();
+  check_equal(*sys, *ref);
+
+  // Conditions with a different symmetry setting are applied in the order of the calls
+  fill_system(*ref);
+  ref->dirichlet(first, 0, 1., true);
+  ref->dirichlet(first+1, 1, 2., false);
+  ref->dirichlet(first, 1, 3., true);
+  fill_system(*sys);
+  sys->begin_dirichlet_batch();
+  sys->dirichlet(first, 0, 1., true);
+  sys->dirichlet(first+1, 1, 2., false);
+  sys->dirichlet(first, 1, 3., true);
+  sys->end_dirichlet_batch();
+  check_equal(*sys, *ref);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( finalize_mpi )
 {
   CFinfo.setFilterRankZero(true);
@@ -0,0 +1,121 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::math::BoundingBoxTree"
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+#include "math/BoundingBoxTree.hpp"
+
+using namespace cf3;
+using namespace cf3::math;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct BoundingBoxTreeTests_Fixture
+{
+  /// Add a 2D box to the list of boxes
+  void add_box(const Real xmin, const Real ymin, const Real xmax, const Real ymax)
+  {
+    boxes.push_back(xmin);
+    boxes.push_back(ymin);
+    boxes.push_back(xmax);
+    boxes.push_back(ymax);
+  }
+
+  /// Indices of the boxes containing a point, found by testing all boxes
+  std::vector<Uint> brute_force(const RealVector& point) const
+  {
+    std::vector<Uint> found;
+    for (Uint b=0; b<boxes.size()/4; ++b)
+    {
+      if (point[0] >= boxes[4*b] && point[1] >= boxes[4*b+1] && point[0] <= boxes[4*b+2] && point[1] <= boxes[4*b+3])
+        found.push_back(b);
+    }
+    return found;
+  }
+
+  std::vector<Real> boxes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( BoundingBoxTreeTests_TestSuite, BoundingBoxTreeTests_Fixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( empty_tree )
+{
+  BoundingBoxTree tree;
+  tree.build(2u,boxes);
+  BOOST_CHECK(tree.empty());
+
+  RealVector point(2);
+  point << 0.5, 0.5;
+  std::vector<Uint> found;
+  tree.find_boxes(point,found);
+  BOOST_CHECK(found.empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( overlapping_boxes )
+{
+  // a grid of 10x10 unit boxes, each enlarged by a quarter, so neighbours overlap
+  for (Uint i=0; i<10; ++i)
+    for (Uint j=0; j<10; ++j)
+      add_box(i-0.25, j-0.25, i+1.25, j+1.25);
+
+  BoundingBoxTree tree;
+  tree.build(2u,boxes,3u);
+  BOOST_CHECK_EQUAL(tree.nb_boxes(), 100u);
+  BOOST_CHECK(tree.nb_nodes() < 200u);
+
+  RealVector point(2);
+  std::vector<Uint> found;
+  for (Real x=-0.5; x<11.; x+=0.35)
+  {
+    for (Real y=-0.5; y<11.; y+=0.35)
+    {
+      point << x, y;
+      found.clear();
+      tree.find_boxes(point,found);
+      std::sort(found.begin(),found.end());
+      const std::vector<Uint> expected = brute_force(point);
+      BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(),found.end(),expected.begin(),expected.end());
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( tolerance )
+{
+  add_box(0., 0., 1., 1.);
+  add_box(2., 0., 3., 1.);
+
+  BoundingBoxTree tree;
+  tree.build(2u,boxes,1u);
+
+  RealVector point(2);
+  point << 1.05, 0.5;
+  std::vector<Uint> found;
+  tree.find_boxes(point,found);
+  BOOST_CHECK(found.empty());
+
+  tree.find_boxes(point,found,0.1);
+  BOOST_CHECK_EQUAL(found.size(), 1u);
+  BOOST_CHECK_EQUAL(found[0], 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -8,6 +8,9 @@
 #define BOOST_TEST_MODULE "Test module for cf3::mesh::HilbertNumbering"
 
 
+#include <cmath>
+#include <cstdlib>
+
 #include <boost/test/unit_test.hpp>
 
 #include "common/Log.hpp"
@@ -17,6 +20,7 @@
 
 #include "math/Consts.hpp"
 #include "math/Hilbert.hpp"
+#include "math/Morton.hpp"
 
 using namespace cf3;
 using namespace cf3::math;
@@ -132,6 +136,256 @@ BOOST_AUTO_TEST_CASE( test_hilbert_3d )
   CFinfo << "uint_max()             = " << uint_max() << CFendl;
 }
 
+BOOST_AUTO_TEST_CASE( test_hilbert_ties )
+{
+  // A point equally close to several vertices goes to the first one in label order
+  BoundingBox bounding_box(RealVector2(0.,0.),RealVector2(1.,1.));
+  Hilbert compute_hilbert(bounding_box, 1);
+  BOOST_CHECK_EQUAL(compute_hilbert(RealVector2(0.5,0.5)), 0u);
+  BOOST_CHECK_EQUAL(compute_hilbert(RealVector2(0.5,0.25)), 0u);
+  BOOST_CHECK_EQUAL(compute_hilbert(RealVector2(0.25,0.5)), 0u);
+  BOOST_CHECK_EQUAL(compute_hilbert(RealVector2(0.75,0.5)), 2u);
+  BOOST_CHECK_EQUAL(compute_hilbert(RealVector2(0.5,0.75)), 1u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Check that the cell centres of a grid of 2^levels cells per direction get all keys once,
+/// and, for a Hilbert curve, that cells with consecutive keys share a face
+template <typename CurveT>
+void check_grid(const Uint dim, const Uint levels, const bool adjacent)
+{
+  const Uint n = 1u << levels;
+  const Uint nb_cells = dim == 2 ? n*n : n*n*n;
+  BoundingBox bounding_box(RealVector::Constant(dim,-1.),RealVector::Constant(dim,3.));
+  CurveT compute_key(bounding_box, levels);
+  BOOST_CHECK_EQUAL(compute_key.max_key(), nb_cells-1u);
+
+  std::vector<Uint> cell_of_key(nb_cells, nb_cells);
+  std::vector<Uint> cell_idx(3,0u);
+  RealVector centre(dim);
+  for (Uint c=0; c<nb_cells; ++c)
+  {
+    cell_idx[0] = c % n;
+    cell_idx[1] = (c / n) % n;
+    cell_idx[2] = c / (n*n);
+    for (Uint d=0; d<dim; ++d)
+      centre[d] = -1. + 4.*(cell_idx[d]+0.5)/n;
+    const boost::uint64_t key = compute_key(centre);
+    BOOST_REQUIRE(key < nb_cells);
+    BOOST_CHECK_EQUAL(cell_of_key[key], nb_cells);
+    cell_of_key[key] = c;
+  }
+
+  if (!adjacent)
+    return;
+  for (Uint key=1; key<nb_cells; ++key)
+  {
+    const Uint a = cell_of_key[key-1];
+    const Uint b = cell_of_key[key];
+    const Uint distance = std::abs(int(a%n) - int(b%n)) + std::abs(int(a/n%n) - int(b/n%n)) + std::abs(int(a/(n*n)) - int(b/(n*n)));
+    BOOST_CHECK_EQUAL(distance, 1u);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_hilbert_grid )
+{
+  check_grid<Hilbert>(2,5,true);
+  check_grid<Hilbert>(3,4,true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Check that the batch version gives the same keys as the point version
+template <typename CurveT>
+void check_batch(const Uint dim, const Uint levels)
+{
+  BoundingBox bounding_box(RealVector::Constant(dim,0.),RealVector::Constant(dim,1.));
+  CurveT compute_key(bounding_box, levels);
+
+  const Uint nb_points = 1000;
+  boost::multi_array<Real,2> coordinates(boost::extents[nb_points][dim]);
+  std::srand(1);
+  for (Uint i=0; i<nb_points; ++i)
+    for (Uint d=0; d<dim; ++d)
+      coordinates[i][d] = i % 4 == 0 ? (std::rand() % 9) / 8. : std::rand() / Real(RAND_MAX);
+
+  std::vector<boost::uint64_t> keys;
+  compute_key(coordinates, keys);
+  BOOST_REQUIRE_EQUAL(keys.size(), nb_points);
+
+  RealVector point(dim);
+  for (Uint i=0; i<nb_points; ++i)
+  {
+    for (Uint d=0; d<dim; ++d)
+      point[d] = coordinates[i][d];
+    BOOST_CHECK_EQUAL(keys[i], compute_key(point));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_hilbert_batch )
+{
+  check_batch<Hilbert>(1,30);
+  check_batch<Hilbert>(2,20);
+  check_batch<Hilbert>(3,20);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief The original recursive Hilbert algorithm, kept as a reference for the iterative one
+///
+/// At every level the box is split in the sub-boxes around its vertices. The point goes to the
+/// sub-box around the closest vertex, the first vertex label winning ties, and the vertex labels
+/// of that sub-box are rearranged so that the curve stays continuous.
+class ReferenceHilbert
+{
+public:
+
+  ReferenceHilbert(const BoundingBox& bounding_box, const Uint levels) :
+    m_dim(bounding_box.dim()),
+    m_max_level(levels)
+  {
+    // Vertices A,B,C,D of a square, and A,B,C,D,E,F,G,H of a cube, as (min,max) selectors
+    static const Uint corners_2d[4][2] = { {0,0}, {0,1}, {1,1}, {1,0} };
+    static const Uint corners_3d[8][3] = { {0,0,0}, {0,0,1}, {1,0,1}, {1,0,0}, {1,1,0}, {1,1,1}, {0,1,1}, {0,1,0} };
+    m_box_0.resize(1u << m_dim, RealVector(m_dim));
+    for (Uint v=0; v<m_box_0.size(); ++v)
+      for (Uint d=0; d<m_dim; ++d)
+      {
+        const Uint corner = m_dim == 2 ? corners_2d[v][d] : corners_3d[v][d];
+        m_box_0[v][d] = corner ? bounding_box.max()[d] : bounding_box.min()[d];
+      }
+  }
+
+  boost::uint64_t operator()(const RealVector& point) const
+  {
+    std::vector<RealVector> box = m_box_0;
+    boost::uint64_t key = 0;
+    recursive_algorithm(point,box,0,key);
+    return key;
+  }
+
+private:
+
+  void recursive_algorithm(const RealVector& p, std::vector<RealVector>& box, const Uint level, boost::uint64_t& key) const
+  {
+    // The sub-box around vertex q gets vertex L at the midpoint of the vertices q and sub_box[q][L]
+    static const Uint sub_box_2d[4][4] = { {0,3,2,1}, {0,1,2,3}, {0,1,2,3}, {2,1,0,3} };
+    static const Uint sub_box_3d[8][8] = { {0,7,4,3,2,5,6,1},
+                                           {0,1,6,7,4,5,2,3},
+                                           {0,1,2,3,4,5,6,7},
+                                           {6,1,0,7,4,3,2,5},
+                                           {2,5,4,3,0,7,6,1},
+                                           {0,1,2,3,4,5,6,7},
+                                           {4,5,2,3,0,1,6,7},
+                                           {6,1,2,5,4,3,0,7} };
+
+    Uint quadrant = 0;
+    Real min_distance = Consts::real_max();
+    for (Uint v=0; v<box.size(); ++v)
+    {
+      const Real distance = (p-box[v]).squaredNorm();
+      if (distance < min_distance)
+      {
+        quadrant = v;
+        min_distance = distance;
+      }
+    }
+
+    std::vector<RealVector> sub_box(box.size());
+    for (Uint v=0; v<box.size(); ++v)
+      sub_box[v] = 0.5*(box[quadrant] + box[m_dim == 2 ? sub_box_2d[quadrant][v] : sub_box_3d[quadrant][v]]);
+    box = sub_box;
+
+    key += (boost::uint64_t) std::ldexp((long double) quadrant / box.size(), m_dim*(m_max_level-level));
+
+    if (level+1 < m_max_level)
+      recursive_algorithm(p,box,level+1,key);
+  }
+
+  Uint m_dim;
+  Uint m_max_level;
+  std::vector<RealVector> m_box_0;
+};
+
+/// Random integer in [0, 2^levels]
+boost::uint64_t random_grid_index(const Uint levels)
+{
+  const boost::uint64_t r = (boost::uint64_t(std::rand()) << 31) ^ boost::uint64_t(std::rand()) ^ (boost::uint64_t(std::rand()) << 16);
+  return r % ((boost::uint64_t(1) << levels) + 1u);
+}
+
+/// Check the keys of random points, and of vertices and cell centres of the grid of 2^levels
+/// cells per direction, against the recursive algorithm, at every level
+void check_reference(const Uint dim, const Uint max_levels)
+{
+  BoundingBox bounding_box(RealVector::Constant(dim,-1.),RealVector::Constant(dim,3.));
+  const Uint nb_points = 300;
+  std::srand(2);
+  RealVector point(dim);
+  for (Uint levels=1; levels<=max_levels; ++levels)
+  {
+    Hilbert compute_key(bounding_box, levels);
+    ReferenceHilbert compute_reference_key(bounding_box, levels);
+    const Real cell_size = std::ldexp(4.,-int(levels));
+    for (Uint i=0; i<nb_points; ++i)
+    {
+      for (Uint d=0; d<dim; ++d)
+      {
+        switch (i % 3)
+        {
+        case 0: point[d] = -1. + 4.*(std::rand() / Real(RAND_MAX)); break;
+        case 1: point[d] = -1. + cell_size*random_grid_index(levels); break;
+        case 2: point[d] = -1. + cell_size*(std::min(random_grid_index(levels), (boost::uint64_t(1) << levels) - 1u) + 0.5); break;
+        }
+      }
+      const boost::uint64_t key = compute_key(point);
+      const boost::uint64_t reference_key = compute_reference_key(point);
+      if (key != reference_key)
+      {
+        BOOST_ERROR("levels " << levels << ": key of (" << point.transpose() << ") is " << key << " instead of " << reference_key);
+        return;
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( test_hilbert_reference )
+{
+  check_reference(2,32);
+  check_reference(3,21);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_morton )
+{
+  BoundingBox bounding_box_2d(RealVector2(0.,0.),RealVector2(1.,1.));
+  Morton compute_morton_2d(bounding_box_2d, 1);
+  BOOST_CHECK_EQUAL(compute_morton_2d(RealVector2(0.25,0.25)), 0u);
+  BOOST_CHECK_EQUAL(compute_morton_2d(RealVector2(0.75,0.25)), 1u);
+  BOOST_CHECK_EQUAL(compute_morton_2d(RealVector2(0.25,0.75)), 2u);
+  BOOST_CHECK_EQUAL(compute_morton_2d(RealVector2(0.75,0.75)), 3u);
+
+  // Points outside the bounding box belong to the closest cell
+  BOOST_CHECK_EQUAL(compute_morton_2d(RealVector2(-1.,2.)), 2u);
+
+  BoundingBox bounding_box_3d(RealVector3(0.,0.,0.),RealVector3(1.,1.,1.));
+  Morton compute_morton_3d(bounding_box_3d, 2);
+  BOOST_CHECK_EQUAL(compute_morton_3d(RealVector3(0.875,0.125,0.375)), 13u);
+  BOOST_CHECK_EQUAL(compute_morton_3d(RealVector3(1.,1.,1.)), compute_morton_3d.max_key());
+
+  // 21 levels in 3D use 63 bits
+  Morton compute_morton_fine(bounding_box_3d, 21);
+  BOOST_CHECK_EQUAL(compute_morton_fine(RealVector3(1.,1.,1.)), compute_morton_fine.max_key());
+  BOOST_CHECK_EQUAL(compute_morton_fine.max_key(), (boost::uint64_t(1) << 63) - 1u);
+
+  check_grid<Morton>(2,5,false);
+  check_grid<Morton>(3,4,false);
+  check_batch<Morton>(2,32);
+  check_batch<Morton>(3,21);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_CASE( terminate )
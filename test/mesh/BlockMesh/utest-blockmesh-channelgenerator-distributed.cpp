@@ -0,0 +1,273 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for distributed generation with cf3::mesh::BlockMesh::ChannelGenerator"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include <boost/foreach.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/FindComponents.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+
+#include "common/PE/Comm.hpp"
+
+#include "math/MatrixTypes.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/Space.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+//////////////////////////////////////////////////////////////////////////////
+
+struct ChannelGeneratorFixture
+{
+  ChannelGeneratorFixture() : grading(0.3)
+  {
+  }
+
+  /// Global number of owned elements and their total volume or area, per region
+  typedef std::map< std::string, std::pair<Uint, Real> > RegionSummaryT;
+
+  Mesh& generate(const std::string& mesh_name, const bool distributed)
+  {
+    Component& root = Core::instance().root();
+    boost::shared_ptr<MeshGenerator> generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.BlockMesh.ChannelGenerator", mesh_name + "_generator");
+    root.add_component(generator);
+    generator->options().set("mesh", root.uri()/mesh_name);
+    generator->options().set("x_segments", 13u);
+    generator->options().set("y_segments_half", 4u);
+    generator->options().set("z_segments", 5u);
+    generator->options().set("grading", grading);
+    generator->options().set("cell_overlap", 0u);
+    generator->options().set("distributed", distributed);
+    generator->execute();
+    return *Handle<Mesh>(root.get_child(mesh_name));
+  }
+
+  RegionSummaryT summarize(const Mesh& mesh)
+  {
+    RegionSummaryT result;
+    RealMatrix nodes;
+    BOOST_FOREACH(const Elements& elements, find_components_recursively<Elements>(mesh))
+    {
+      const ElementType& etype = elements.element_type();
+      nodes.resize(etype.nb_nodes(), etype.dimension());
+      Uint nb_owned = 0;
+      Real measure = 0.;
+      for(Uint elem = 0; elem != elements.size(); ++elem)
+      {
+        if(elements.is_ghost(elem))
+          continue;
+        elements.geometry_space().put_coordinates(nodes, elem);
+        measure += etype.dimensionality() == etype.dimension() ? etype.volume(nodes) : etype.area(nodes);
+        ++nb_owned;
+      }
+      Uint global_nb_owned = nb_owned;
+      Real global_measure = measure;
+      if(PE::Comm::instance().is_active())
+      {
+        PE::Comm::instance().all_reduce(PE::plus(), &nb_owned, 1, &global_nb_owned);
+        PE::Comm::instance().all_reduce(PE::plus(), &measure, 1, &global_measure);
+      }
+      result[elements.parent()->name()] = std::make_pair(global_nb_owned, global_measure);
+    }
+    return result;
+  }
+
+  /// Global index and coordinates of the owned nodes of all ranks
+  void gather_owned_nodes(const Mesh& mesh, std::vector<Uint>& gids, std::vector<Real>& coords)
+  {
+    const Dictionary& geometry_dict = mesh.geometry_fields();
+    const Field& coordinates = geometry_dict.coordinates();
+    const bool has_gids = geometry_dict.glb_idx().size() == geometry_dict.size();
+    std::vector<Uint> local_gids;
+    std::vector<Real> local_coords;
+    for(Uint i = 0; i != geometry_dict.size(); ++i)
+    {
+      if(geometry_dict.is_ghost(i))
+        continue;
+      local_gids.push_back(has_gids ? geometry_dict.glb_idx()[i] : i);
+      local_coords.insert(local_coords.end(), coordinates[i].begin(), coordinates[i].end());
+    }
+
+    gids.clear();
+    coords.clear();
+    if(!PE::Comm::instance().is_active())
+    {
+      gids = local_gids;
+      coords = local_coords;
+      return;
+    }
+    std::vector< std::vector<Uint> > recv_gids;
+    std::vector< std::vector<Real> > recv_coords;
+    PE::Comm::instance().all_gather(local_gids, recv_gids);
+    PE::Comm::instance().all_gather(local_coords, recv_coords);
+    for(Uint proc = 0; proc != recv_gids.size(); ++proc)
+    {
+      gids.insert(gids.end(), recv_gids[proc].begin(), recv_gids[proc].end());
+      coords.insert(coords.end(), recv_coords[proc].begin(), recv_coords[proc].end());
+    }
+  }
+
+  static bool close(const Real a, const Real b)
+  {
+    return std::abs(a - b) < 1e-10;
+  }
+
+  /// Sorted distinct values of one coordinate, i.e. the grid lines in that direction
+  std::vector<Real> grid_lines(const std::vector<Real>& coords, const Uint direction)
+  {
+    std::vector<Real> result;
+    for(Uint i = direction; i < coords.size(); i += 3)
+      result.push_back(coords[i]);
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end(), close), result.end());
+    return result;
+  }
+
+  /// Index of the grid line at the given position, or the number of lines if there is none
+  Uint line_index(const std::vector<Real>& lines, const Real position)
+  {
+    for(Uint i = 0; i != lines.size(); ++i)
+    {
+      if(close(lines[i], position))
+        return i;
+    }
+    return lines.size();
+  }
+
+  Real grading;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( ChannelGeneratorDistributed, ChannelGeneratorFixture )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  Core::instance().environment().options().set("log_level", 1u);
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+}
+
+BOOST_AUTO_TEST_CASE( CompareWithBlocks )
+{
+  const RegionSummaryT blocks_summary = summarize(generate("blocks_mesh", false));
+  const RegionSummaryT distributed_summary = summarize(generate("distributed_mesh", true));
+
+  BOOST_CHECK_EQUAL(blocks_summary.size(), 7);
+  BOOST_CHECK_EQUAL(distributed_summary.size(), blocks_summary.size());
+  for(RegionSummaryT::const_iterator it = blocks_summary.begin(); it != blocks_summary.end(); ++it)
+  {
+    RegionSummaryT::const_iterator distributed_it = distributed_summary.find(it->first);
+    BOOST_REQUIRE(distributed_it != distributed_summary.end());
+    BOOST_CHECK_EQUAL(distributed_it->second.first, it->second.first);
+    BOOST_CHECK_CLOSE(distributed_it->second.second, it->second.second, 1e-8);
+  }
+
+  // Default channel of 10 x 1 x 10
+  BOOST_CHECK_EQUAL(distributed_summary.find("interior")->second.first, 13*8*5);
+  BOOST_CHECK_CLOSE(distributed_summary.find("interior")->second.second, 100., 1e-8);
+  BOOST_CHECK_CLOSE(distributed_summary.find("left")->second.second, 10., 1e-8);
+  BOOST_CHECK_CLOSE(distributed_summary.find("bottom")->second.second, 100., 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( NodeCoordinates )
+{
+  std::vector<Uint> blocks_gids, distributed_gids;
+  std::vector<Real> blocks_coords, distributed_coords;
+  gather_owned_nodes(*Handle<Mesh>(Core::instance().root().get_child("blocks_mesh")), blocks_gids, blocks_coords);
+  gather_owned_nodes(*Handle<Mesh>(Core::instance().root().get_child("distributed_mesh")), distributed_gids, distributed_coords);
+
+  // The nodes of the block mesh lie on a graded grid of 14 x 9 x 6 lines
+  const Uint nb_x_nodes = 14, nb_y_nodes = 9, nb_z_nodes = 6;
+  BOOST_REQUIRE_EQUAL(blocks_gids.size(), nb_x_nodes*nb_y_nodes*nb_z_nodes);
+  const std::vector<Real> x_lines = grid_lines(blocks_coords, XX);
+  const std::vector<Real> y_lines = grid_lines(blocks_coords, YY);
+  const std::vector<Real> z_lines = grid_lines(blocks_coords, ZZ);
+  BOOST_REQUIRE_EQUAL(x_lines.size(), nb_x_nodes);
+  BOOST_REQUIRE_EQUAL(y_lines.size(), nb_y_nodes);
+  BOOST_REQUIRE_EQUAL(z_lines.size(), nb_z_nodes);
+  BOOST_CHECK_CLOSE((y_lines[1] - y_lines[0]) / (y_lines[4] - y_lines[3]), grading, 1e-6);
+  BOOST_CHECK_CLOSE((y_lines[8] - y_lines[7]) / (y_lines[5] - y_lines[4]), grading, 1e-6);
+
+  // The distributed mesh numbers its nodes with the Y index running fastest and the X index slowest,
+  // so the global index of each node gives the block mesh grid lines it must lie on
+  BOOST_REQUIRE_EQUAL(distributed_gids.size(), blocks_gids.size());
+  std::vector<bool> found(distributed_gids.size(), false);
+  for(Uint n = 0; n != distributed_gids.size(); ++n)
+  {
+    const Uint gid = distributed_gids[n];
+    BOOST_REQUIRE(gid < found.size());
+    BOOST_CHECK(!found[gid]);
+    found[gid] = true;
+    const Uint i = gid / (nb_y_nodes*nb_z_nodes);
+    const Uint k = (gid / nb_y_nodes) % nb_z_nodes;
+    const Uint j = gid % nb_y_nodes;
+    BOOST_CHECK_EQUAL(line_index(x_lines, distributed_coords[3*n+XX]), i);
+    BOOST_CHECK_EQUAL(line_index(y_lines, distributed_coords[3*n+YY]), j);
+    BOOST_CHECK_EQUAL(line_index(z_lines, distributed_coords[3*n+ZZ]), k);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( GhostNodes )
+{
+  Mesh& mesh = *Handle<Mesh>(Core::instance().root().get_child("distributed_mesh"));
+  Dictionary& geometry_dict = mesh.geometry_fields();
+  const Field& coordinates = geometry_dict.coordinates();
+
+  // The global node count only includes owned nodes
+  Uint nb_owned = 0;
+  for(Uint i = 0; i != geometry_dict.size(); ++i)
+    nb_owned += geometry_dict.is_ghost(i) ? 0 : 1;
+  Uint global_nb_owned = nb_owned;
+  if(PE::Comm::instance().is_active())
+    PE::Comm::instance().all_reduce(PE::plus(), &nb_owned, 1, &global_nb_owned);
+  BOOST_CHECK_EQUAL(global_nb_owned, 14*9*6);
+
+  // Ghost coordinates, computed locally, must match the coordinates on the owning rank
+  Field& synchronized = geometry_dict.create_field("synchronized_coordinates", 3);
+  for(Uint i = 0; i != geometry_dict.size(); ++i)
+  {
+    for(Uint j = 0; j != 3; ++j)
+      synchronized[i][j] = geometry_dict.is_ghost(i) ? 0. : coordinates[i][j];
+  }
+  synchronized.parallelize();
+  synchronized.synchronize();
+  for(Uint i = 0; i != geometry_dict.size(); ++i)
+  {
+    for(Uint j = 0; j != 3; ++j)
+      BOOST_CHECK_EQUAL(synchronized[i][j], coordinates[i][j]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( Terminate )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -17,6 +17,8 @@
 #include "common/PE/debug.hpp"
 #include "common/PE/Comm.hpp"
 
+#include "math/Consts.hpp"
+
 #include "mesh/actions/GlobalConnectivity.hpp"
 #include "mesh/actions/GlobalNumbering.hpp"
 #include "mesh/MeshTransformer.hpp"
@@ -105,6 +107,47 @@ BOOST_AUTO_TEST_CASE( build )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( find_ghost_global_indices_by_key )
+{
+  const Uint nb_procs = Comm::instance().size();
+  const Uint rank = Comm::instance().rank();
+  const Uint nb_keys = 50;
+
+  // key k is owned by rank k%nb_procs, and is a ghost everywhere else
+  std::vector<boost::uint64_t> owned_keys, ghost_keys;
+  std::vector<Uint> owned_glb_idx;
+  for (Uint k=0; k<nb_keys; ++k)
+  {
+    const boost::uint64_t key = static_cast<boost::uint64_t>(k)*1000003u + 7u;
+    if (k%nb_procs == rank)
+    {
+      owned_keys.push_back(key);
+      owned_glb_idx.push_back(k);
+    }
+    else
+    {
+      ghost_keys.push_back(key);
+    }
+  }
+  // a key that nobody owns
+  ghost_keys.push_back(3u);
+
+  std::vector<Uint> ghost_glb_idx, ghost_rank;
+  find_ghost_global_indices(owned_keys,owned_glb_idx,ghost_keys,ghost_glb_idx,ghost_rank);
+
+  BOOST_CHECK_EQUAL(ghost_glb_idx.size(), ghost_keys.size());
+  for (Uint g=0; g<ghost_keys.size()-1; ++g)
+  {
+    const Uint k = (ghost_keys[g]-7u)/1000003u;
+    BOOST_CHECK_EQUAL(ghost_glb_idx[g], k);
+    BOOST_CHECK_EQUAL(ghost_rank[g], k%nb_procs);
+  }
+  BOOST_CHECK_EQUAL(ghost_glb_idx.back(), math::Consts::uint_max());
+  BOOST_CHECK_EQUAL(ghost_rank.back(), math::Consts::uint_max());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( Terminate )
 {
   PE::Comm::instance().finalize();
@@ -0,0 +1,168 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark mesh generation, input/output, face building and interpolation"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Interpolator.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshReader.hpp"
+#include "mesh/MeshWriter.hpp"
+#include "mesh/MeshTransformer.hpp"
+
+#include "Tools/Testing/BenchmarkFixture.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct MeshBenchmarkFixture : Tools::Testing::BenchmarkFixture
+{
+  MeshBenchmarkFixture()
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    nb_cells = scaled(argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 20u);
+  }
+
+  /// Generate a unit cube of hexahedra
+  Mesh& generate(const std::string& name, const Uint nb_cells_per_dir, const Real length = 1., const Real offset = 0.)
+  {
+    boost::shared_ptr< MeshGenerator > mesh_generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","mesh_generator_"+name);
+    mesh_generator->options().set("mesh",Core::instance().root().uri()/name);
+    mesh_generator->options().set("lengths",std::vector<Real>(3,length));
+    mesh_generator->options().set("offsets",std::vector<Real>(3,offset));
+    mesh_generator->options().set("nb_cells",std::vector<Uint>(3,nb_cells_per_dir));
+    return mesh_generator->generate();
+  }
+
+  Mesh& mesh()
+  {
+    return *Handle<Mesh>(Core::instance().root().get_child("mesh"));
+  }
+
+  Real nb_elements()
+  {
+    return static_cast<Real>(mesh().properties().value<Uint>("local_nb_cells"));
+  }
+
+  /// Write the benchmark mesh with the given writer, and read it back if a reader is given
+  void write_read(const std::string& format, const std::string& extension, const bool read)
+  {
+    const URI file("benchmark-mesh" + extension);
+
+    boost::shared_ptr< MeshWriter > writer = build_component_abstract_type<MeshWriter>("cf3.mesh."+format+".Writer","writer");
+    restart_timer();
+    writer->write_from_to(mesh(),file);
+    record(format + " write", nb_elements(), "elements");
+
+    if (!read)
+      return;
+
+    boost::shared_ptr< MeshReader > reader = build_component_abstract_type<MeshReader>("cf3.mesh."+format+".Reader","reader");
+    Mesh& read_mesh = *Core::instance().root().create_component<Mesh>("read_mesh_" + format);
+    restart_timer();
+    reader->read_mesh_into(file,read_mesh);
+    record(format + " read", nb_elements(), "elements");
+
+    BOOST_CHECK_EQUAL(read_mesh.properties().value<Uint>("local_nb_cells"), mesh().properties().value<Uint>("local_nb_cells"));
+    Core::instance().root().remove_component(read_mesh);
+  }
+
+  /// Number of cells in each direction
+  Uint nb_cells;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( MeshBenchmarkSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  int argc = boost::unit_test::framework::master_test_suite().argc;
+  char** argv = boost::unit_test::framework::master_test_suite().argv;
+  Core::instance().initiate(argc,argv);
+  PE::Comm::instance().init(argc,argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Generate, MeshBenchmarkFixture )
+{
+  generate("mesh",nb_cells);
+  set_work(nb_elements(),"elements");
+  BOOST_CHECK_EQUAL(mesh().properties().value<Uint>("local_nb_cells"), nb_cells*nb_cells*nb_cells);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( WriteRead, MeshBenchmarkFixture )
+{
+  write_read("gmsh",".msh",true);
+  write_read("neu",".neu",true);
+  write_read("native",".cf3mesh",true);
+  write_read("tecplot",".plt",false);
+  write_read("VTKLegacy",".vtk",false);
+  write_read("VTKXML",".pvtu",false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( BuildFaces, MeshBenchmarkFixture )
+{
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.BuildFaces","build_faces")->transform(mesh());
+  set_work(nb_elements(),"elements");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Interpolation, MeshBenchmarkFixture )
+{
+  // Target nodes are all inside the source mesh, and do not coincide with its nodes
+  Mesh& target = generate("target",nb_cells+1,0.98,0.01);
+  Field& interpolated = target.geometry_fields().create_field("interpolated","interpolated[vector]");
+
+  boost::shared_ptr< Interpolator > interpolator = allocate_component<Interpolator>("interpolator");
+  restart_timer();
+  interpolator->interpolate(mesh().geometry_fields().coordinates(),interpolated);
+  record("interpolate", interpolated.size(), "points");
+
+  // Coordinates are reproduced exactly by the linear shape functions
+  const Field& target_coords = target.geometry_fields().coordinates();
+  for (Uint n=0; n<interpolated.size(); ++n)
+    for (Uint d=0; d<interpolated.row_size(); ++d)
+      BOOST_CHECK_SMALL(interpolated[n][d] - target_coords[n][d], 1e-10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Terminate )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
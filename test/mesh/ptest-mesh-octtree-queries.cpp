@@ -0,0 +1,200 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark coordinate queries in mesh::Octtree on graded meshes"
+
+#include <cmath>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Table.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/Octtree.hpp"
+
+#include "Tools/Testing/BenchmarkFixture.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct OcttreeQueriesFixture : Tools::Testing::BenchmarkFixture
+{
+  OcttreeQueriesFixture()
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    nb_cells = scaled(argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 100u);
+    nb_queries = scaled(argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 10000u);
+  }
+
+  /// Create a square mesh whose cells are graded towards the origin with the given power
+  Mesh& graded_mesh(const std::string& name, const Real power)
+  {
+    boost::shared_ptr< MeshGenerator > mesh_generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","mesh_generator_"+name);
+    mesh_generator->options().set("mesh",Core::instance().root().uri()/name);
+    mesh_generator->options().set("lengths",std::vector<Real>(2,1.));
+    mesh_generator->options().set("nb_cells",std::vector<Uint>(2,nb_cells));
+    Mesh& mesh = mesh_generator->generate();
+
+    Table<Real>& coords = mesh.geometry_fields().coordinates();
+    for (Uint n=0; n<coords.size(); ++n)
+    {
+      coords[n][XX] = std::pow(coords[n][XX],power);
+      coords[n][YY] = std::pow(coords[n][YY],power);
+    }
+    mesh.update_statistics();
+    return mesh;
+  }
+
+  /// Element centroids, picked pseudo-randomly, so the queries concentrate where the mesh is fine.
+  /// The element each centroid was taken from is the only one containing it.
+  void query_points(Mesh& mesh, std::vector<RealVector>& points, std::vector<Entity>& point_elements)
+  {
+    std::vector<Entity> elements;
+    boost_foreach(Elements& elems, find_components_recursively_with_filter<Elements>(mesh,IsElementsVolume()))
+      for (Uint e=0; e<elems.size(); ++e)
+        elements.push_back(Entity(elems,e));
+
+    points.assign(nb_queries,RealVector(2));
+    point_elements.resize(nb_queries);
+    RealMatrix elem_coords;
+    Uint seed = 12345u;
+    for (Uint q=0; q<nb_queries; ++q)
+    {
+      seed = 1664525u*seed + 1013904223u;
+      const Entity& elem = elements[seed % elements.size()];
+      point_elements[q] = elem;
+      elem.allocate_coordinates(elem_coords);
+      elem.put_coordinates(elem_coords);
+      elem.element_type().compute_centroid(elem_coords,points[q]);
+    }
+  }
+
+  /// Locate a coordinate by testing the elements in growing rings of structured cells
+  bool find_in_rings(Octtree& octtree, const RealVector& coord, std::vector<Entity>& pool, Entity& element)
+  {
+    std::vector<Uint> octtree_idx(3,0u);
+    if (!octtree.find_octtree_cell(coord,octtree_idx))
+      return false;
+    pool.clear();
+    RealMatrix elem_coords;
+    for (Uint ring=0; ring<2 || pool.empty(); ++ring)
+    {
+      const Uint pool_size = pool.size();
+      octtree.gather_elements_around_idx(octtree_idx,ring,pool);
+      for (Uint e=pool_size; e<pool.size(); ++e)
+      {
+        pool[e].allocate_coordinates(elem_coords);
+        pool[e].put_coordinates(elem_coords);
+        if (pool[e].element_type().is_coord_in_element(coord,elem_coords))
+        {
+          element = pool[e];
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  Uint nb_cells;
+  Uint nb_queries;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( OcttreeQueriesSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  int argc = boost::unit_test::framework::master_test_suite().argc;
+  char** argv = boost::unit_test::framework::master_test_suite().argv;
+  Core::instance().initiate(argc,argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( GradedQueries, OcttreeQueriesFixture )
+{
+  const Real powers[] = {1., 2., 4.};
+  for (Uint i=0; i<3; ++i)
+  {
+    const std::string name = "graded_" + boost::lexical_cast<std::string>(powers[i]);
+    Mesh& mesh = graded_mesh(name,powers[i]);
+
+    Octtree& octtree = *mesh.create_component<Octtree>("octtree");
+    octtree.options().set("mesh",mesh.handle<Mesh>());
+
+    restart_timer();
+    octtree.create_octtree();
+    record(name + " build", mesh.properties().value<Uint>("local_nb_cells"), "elements");
+    std::cout << "<DartMeasurement name=\"" << name << " memory\" type=\"numeric/integer\">" << octtree.memory_footprint() << "</DartMeasurement>" << std::endl;
+
+    std::vector<RealVector> points;
+    std::vector<Entity> point_elements;
+    query_points(mesh,points,point_elements);
+
+    Uint nb_found_rings = 0;
+    std::vector<Entity> pool;
+    std::vector<Entity> ring_elements(nb_queries);
+    restart_timer();
+    for (Uint q=0; q<nb_queries; ++q)
+      nb_found_rings += find_in_rings(octtree,points[q],pool,ring_elements[q]);
+    record(name + " ring queries", nb_queries, "queries");
+
+    Uint nb_found_tree = 0;
+    std::vector<Entity> tree_elements(nb_queries);
+    restart_timer();
+    for (Uint q=0; q<nb_queries; ++q)
+      nb_found_tree += octtree.find_element(points[q],tree_elements[q]);
+    record(name + " tree queries", nb_queries, "queries");
+
+    BOOST_CHECK_EQUAL(nb_found_tree, nb_queries);
+    BOOST_CHECK_EQUAL(nb_found_rings, nb_queries);
+
+    // Both lookups find the element the centroid belongs to
+    Uint nb_mismatches = 0;
+    for (Uint q=0; q<nb_queries; ++q)
+    {
+      if (tree_elements[q] != point_elements[q] || ring_elements[q] != point_elements[q])
+      {
+        if (nb_mismatches++ < 10)
+          BOOST_ERROR(name << ": query " << q << " at (" << points[q].transpose() << ") finds " << tree_elements[q]
+                      << " in the tree and " << ring_elements[q] << " in the rings, instead of " << point_elements[q]);
+      }
+    }
+    BOOST_CHECK_EQUAL(nb_mismatches, 0u);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Terminate )
+{
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
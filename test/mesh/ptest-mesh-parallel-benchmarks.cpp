@@ -0,0 +1,132 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark mesh partitioning and field synchronization"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshTransformer.hpp"
+
+#include "Tools/Testing/BenchmarkFixture.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct ParallelMeshBenchmarkFixture : Tools::Testing::BenchmarkFixture
+{
+  ParallelMeshBenchmarkFixture()
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    nb_cells = scaled(argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 20u);
+    nb_synchronizations = argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 10u;
+  }
+
+  Mesh& mesh()
+  {
+    return *Handle<Mesh>(Core::instance().root().get_child("mesh"));
+  }
+
+  Real nb_elements()
+  {
+    return static_cast<Real>(mesh().properties().value<Uint>("global_nb_cells"));
+  }
+
+  /// Number of cells in each direction
+  Uint nb_cells;
+
+  /// Number of times the field is synchronized
+  Uint nb_synchronizations;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( ParallelMeshBenchmarkSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  int argc = boost::unit_test::framework::master_test_suite().argc;
+  char** argv = boost::unit_test::framework::master_test_suite().argv;
+  Core::instance().initiate(argc,argv);
+  PE::Comm::instance().init(argc,argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Generate, ParallelMeshBenchmarkFixture )
+{
+  boost::shared_ptr< MeshGenerator > mesh_generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","mesh_generator");
+  mesh_generator->options().set("mesh",Core::instance().root().uri()/"mesh");
+  mesh_generator->options().set("lengths",std::vector<Real>(3,1.));
+  mesh_generator->options().set("nb_cells",std::vector<Uint>(3,nb_cells));
+  mesh_generator->generate();
+  set_work(nb_elements(),"elements");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Partitions the mesh, and builds the global numbering and the overlap
+BOOST_FIXTURE_TEST_CASE( LoadBalance, ParallelMeshBenchmarkFixture )
+{
+  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.LoadBalance","load_balancer")->transform(mesh());
+  set_work(nb_elements(),"elements");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_CASE( Synchronize, ParallelMeshBenchmarkFixture )
+{
+  Field& field = mesh().geometry_fields().create_field("node_rank");
+  restart_timer();
+  field.parallelize();
+  record("parallelize", field.size(), "nodes");
+
+  const List<Uint>& node_rank = mesh().geometry_fields().rank();
+  const Uint rank = PE::Comm::instance().rank();
+  for (Uint i=0; i<nb_synchronizations; ++i)
+  {
+    for (Uint n=0; n<field.size(); ++n)
+      field[n][0] = rank;
+    field.synchronize();
+  }
+  record("synchronize", static_cast<Real>(nb_synchronizations*field.size()), "nodes");
+
+  // Ghost nodes hold the rank of their owner
+  for (Uint n=0; n<field.size(); ++n)
+    BOOST_CHECK_EQUAL(static_cast<Uint>(field[n][0]), node_rank[n]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Terminate )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
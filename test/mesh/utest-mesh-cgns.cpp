@@ -22,10 +22,12 @@
 #include "common/LibLoader.hpp"
 #include "common/Core.hpp"
 #include "common/Environment.hpp"
+#include "common/FindComponents.hpp"
 
 #include "mesh/Mesh.hpp"
 #include "mesh/Region.hpp"
 #include "mesh/Elements.hpp"
+#include "mesh/Dictionary.hpp"
 #include "common/Table.hpp"
 #include "mesh/MeshReader.hpp"
 #include "mesh/MeshWriter.hpp"
@@ -686,6 +688,44 @@ BOOST_AUTO_TEST_CASE( ReadUnstructured )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( ReadUnstructuredDistributed )
+{
+  boost::shared_ptr< MeshReader > meshreader = build_component_abstract_type<MeshReader>("cf3.mesh.CGNS.Reader","meshreader");
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>("grid_c_serial");
+  meshreader->read_mesh_into("grid_c.cgns",mesh);
+
+  Uint nb_elems = 0;
+  BOOST_FOREACH(const Elements& elements, find_components_recursively<Elements>(mesh.topology()))
+    nb_elems += elements.size();
+
+  // Read the file in two parts, as two processes would
+  const Uint nb_parts = 2;
+  Uint nb_elems_in_parts = 0;
+  Uint nb_nodes_in_parts = 0;
+  for (Uint part=0; part<nb_parts; ++part)
+  {
+    boost::shared_ptr< MeshReader > part_reader = build_component_abstract_type<MeshReader>("cf3.mesh.CGNS.Reader","meshreader");
+    part_reader->options().set("distributed",true);
+    part_reader->options().set("part",part);
+    part_reader->options().set("nb_parts",nb_parts);
+    Mesh& part_mesh = *Core::instance().root().create_component<Mesh>("grid_c_part"+to_str(part));
+    part_reader->read_mesh_into("grid_c.cgns",part_mesh);
+
+    BOOST_FOREACH(const Elements& elements, find_components_recursively<Elements>(part_mesh.topology()))
+      nb_elems_in_parts += elements.size();
+
+    // each part reads its own nodes and the nodes of its elements, not the whole grid
+    const Uint nb_nodes = part_mesh.geometry_fields().size();
+    BOOST_CHECK(nb_nodes > 0);
+    BOOST_CHECK(nb_nodes < mesh.geometry_fields().size());
+    nb_nodes_in_parts += nb_nodes;
+  }
+  BOOST_CHECK_EQUAL(nb_elems_in_parts, nb_elems);
+  BOOST_CHECK(nb_nodes_in_parts >= mesh.geometry_fields().size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( ReadCGNS_Structured )
 {
 
@@ -0,0 +1,313 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Tests incremental mesh updates with cf3::mesh::MeshChangeLog"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+
+#include "common/Core.hpp"
+#include "common/DynTable.hpp"
+#include "common/OptionList.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/FaceCellConnectivity.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshAdaptor.hpp"
+#include "mesh/MeshChangeLog.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/Space.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct MeshChangeLog_Fixture
+{
+  /// Generate a 2D mesh of 4 x 3 quads, without boundary elements
+  Mesh& generate(const std::string& name)
+  {
+    boost::shared_ptr< MeshGenerator > mesh_generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","mesh_generator_"+name);
+    Core::instance().root().add_component(mesh_generator);
+    mesh_generator->options().set("mesh",Core::instance().root().uri()/name);
+    mesh_generator->options().set("lengths",std::vector<Real>(2,1.));
+    std::vector<Uint> nb_cells(2);
+    nb_cells[0] = 4;
+    nb_cells[1] = 3;
+    mesh_generator->options().set("nb_cells",nb_cells);
+    mesh_generator->options().set("bdry",false);
+    return mesh_generator->generate();
+  }
+
+  /// Check that the updated node to element connectivity equals a rebuilt one
+  void check_against_rebuild(Dictionary& dict)
+  {
+    const DynTable<SpaceElem>::ArrayT updated = dict.connectivity().array();
+    dict.rebuild_node_to_element_connectivity();
+    BOOST_CHECK_EQUAL(updated.size(), dict.connectivity().size());
+    BOOST_CHECK(updated == dict.connectivity().array());
+  }
+
+  /// Check that the updated glb_to_loc map equals a rebuilt one
+  void check_map_against_rebuild(Dictionary& dict)
+  {
+    const std::vector< std::pair<boost::uint64_t,Uint> > updated(dict.glb_to_loc().begin(), dict.glb_to_loc().end());
+    dict.rebuild_map_glb_to_loc();
+    const std::vector< std::pair<boost::uint64_t,Uint> > rebuilt(dict.glb_to_loc().begin(), dict.glb_to_loc().end());
+    BOOST_CHECK_EQUAL(updated.size(), dict.size());
+    BOOST_CHECK(updated == rebuilt);
+  }
+
+  /// Cell of a face, as entities, element index and face number in the element
+  typedef std::pair< std::pair<const Entities*,Uint>, Uint > FaceCellT;
+
+  /// Cells of the faces, by sorted face nodes
+  typedef std::map< std::vector<Uint>, std::set<FaceCellT> > FaceCellsT;
+
+  /// Faces of a face to cell connectivity, independent of their numbering
+  FaceCellsT face_cells(const FaceCellConnectivity& face_to_cell)
+  {
+    FaceCellsT result;
+    for (Uint face=0; face<face_to_cell.size(); ++face)
+    {
+      std::vector<Uint> nodes = face_to_cell.face_nodes(face);
+      const Uint first_node = nodes[0];
+      std::sort(nodes.begin(),nodes.end());
+      std::set<FaceCellT>& cells = result[nodes];
+      for (Uint c=0; c<2; ++c)
+      {
+        const Entity& cell = face_to_cell.connectivity()[face][c];
+        if (is_not_null(cell.comp))
+          cells.insert(std::make_pair(std::make_pair(static_cast<const Entities*>(cell.comp),cell.idx),face_to_cell.face_number()[face][c]));
+      }
+      BOOST_CHECK_EQUAL(face_to_cell.is_bdry_face()[face], cells.size() == 1);
+
+      // The rotation gives the first face node of the first cell in the face of the second cell
+      if (cells.size() == 2)
+      {
+        const Entity& cell = face_to_cell.connectivity()[face][1];
+        const Uint face_nb = face_to_cell.face_number()[face][1];
+        const Uint rotation = face_to_cell.cell_rotation()[face][1];
+        BOOST_CHECK_EQUAL(cell.get_nodes()[cell.element_type().faces().nodes_range(face_nb)[rotation]], first_node);
+      }
+    }
+    BOOST_CHECK_EQUAL(result.size(), face_to_cell.size());
+    return result;
+  }
+
+  /// Check that the updated face to cell connectivity has the same faces as a rebuilt one
+  void check_faces_against_rebuild(FaceCellConnectivity& face_to_cell)
+  {
+    const FaceCellsT updated = face_cells(face_to_cell);
+    face_to_cell.build_connectivity();
+    BOOST_CHECK(updated == face_cells(face_to_cell));
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( MeshChangeLog_TestSuite, MeshChangeLog_Fixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( RowChangesOverFlushes )
+{
+  RowChanges changes(6);
+  BOOST_CHECK(changes.empty());
+
+  // Row 1 removed, last row moved into it
+  changes.record(std::vector<Uint>(1,1), std::vector< std::pair<Uint,Uint> >(1,std::make_pair(5u,1u)), std::vector<Uint>(), 5);
+  BOOST_CHECK_EQUAL(changes.removed().size(), 1u);
+  BOOST_CHECK_EQUAL(changes.moved().find(5)->second, 1u);
+
+  // The moved row is removed again, another row moved into it, and a new row appended
+  changes.record(std::vector<Uint>(1,1), std::vector< std::pair<Uint,Uint> >(1,std::make_pair(4u,1u)), std::vector<Uint>(1,4), 5);
+  BOOST_CHECK_EQUAL(changes.baseline_size(), 6u);
+  BOOST_CHECK_EQUAL(changes.size(), 5u);
+  BOOST_CHECK_EQUAL(changes.removed().size(), 2u);
+  BOOST_CHECK(changes.removed().count(1));
+  BOOST_CHECK(changes.removed().count(5));
+  BOOST_CHECK_EQUAL(changes.moved().size(), 1u);
+  BOOST_CHECK_EQUAL(changes.moved().find(4)->second, 1u);
+  BOOST_CHECK_EQUAL(changes.added().size(), 1u);
+  BOOST_CHECK(changes.added().count(4));
+
+  Uint idx;
+  BOOST_CHECK(!changes.baseline_index(4,idx));
+  BOOST_CHECK(changes.baseline_index(1,idx));
+  BOOST_CHECK_EQUAL(idx, 4u);
+  BOOST_CHECK(changes.baseline_index(3,idx));
+  BOOST_CHECK_EQUAL(idx, 3u);
+  BOOST_CHECK(!changes.current_index(5,idx));
+  BOOST_CHECK(changes.current_index(4,idx));
+  BOOST_CHECK_EQUAL(idx, 1u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( RemoveElementsAndNodes )
+{
+  Mesh& mesh = generate("mesh_remove");
+  Dictionary& dict = mesh.geometry_fields();
+  BOOST_CHECK_EQUAL(dict.size(), 20u);
+
+  MeshAdaptor mesh_adaptor(mesh);
+  mesh_adaptor.prepare();
+  mesh_adaptor.make_element_node_connectivity_global();
+
+  // The corner node 0 is only used by element 0
+  mesh_adaptor.remove_element(0,0);
+  mesh_adaptor.remove_element(0,5);
+  mesh_adaptor.remove_node(0,0);
+  mesh_adaptor.flush_elements();
+  mesh_adaptor.flush_nodes();
+
+  const MeshChangeLog& changes = mesh_adaptor.changes();
+  BOOST_CHECK(changes.applies_to(mesh));
+  BOOST_CHECK_EQUAL(changes.elements(0).removed().size(), 2u);
+  BOOST_CHECK_EQUAL(changes.elements(0).moved().size(), 2u);
+  BOOST_CHECK_EQUAL(changes.nodes(0).removed().size(), 1u);
+  BOOST_CHECK_EQUAL(changes.nodes(0).moved().size(), 1u);
+  BOOST_CHECK_EQUAL(changes.removed_element_nodes(0,0).find(0)->second.size(), 4u);
+
+  // The flush updated the glb_to_loc map
+  check_map_against_rebuild(dict);
+
+  mesh_adaptor.finish();
+  BOOST_CHECK(mesh_adaptor.changes().empty());
+  BOOST_CHECK_EQUAL(mesh.elements()[0]->size(), 10u);
+  BOOST_CHECK_EQUAL(dict.size(), 19u);
+  check_against_rebuild(dict);
+  check_map_against_rebuild(dict);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( RemoveAndAddNodes )
+{
+  Mesh& mesh = generate("mesh_nodes");
+  Dictionary& dict = mesh.geometry_fields();
+
+  MeshAdaptor mesh_adaptor(mesh);
+  mesh_adaptor.prepare();
+
+  // Remove two nodes, one of which is added again with the same global index, over two flushes
+  PackedNode removed_node(mesh,0,7);
+  mesh_adaptor.remove_node(0,7);
+  mesh_adaptor.remove_node(0,3);
+  mesh_adaptor.flush_nodes();
+  check_map_against_rebuild(dict);
+  BOOST_CHECK(!dict.glb_to_loc().exists(removed_node.glb_idx()));
+
+  mesh_adaptor.add_node(removed_node);
+  mesh_adaptor.flush_nodes();
+  BOOST_CHECK_EQUAL(dict.size(), 19u);
+  BOOST_CHECK(dict.glb_to_loc().exists(removed_node.glb_idx()));
+  BOOST_CHECK_EQUAL(dict.glb_idx()[dict.glb_to_loc()[removed_node.glb_idx()]], removed_node.glb_idx());
+  check_map_against_rebuild(dict);
+
+  const RowChanges& node_changes = mesh_adaptor.changes().nodes(0);
+  BOOST_CHECK_EQUAL(node_changes.removed().size(), 2u);
+  BOOST_CHECK_EQUAL(node_changes.added().size(), 1u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( RemoveAndAddElements )
+{
+  Mesh& mesh = generate("mesh_add");
+  Dictionary& dict = mesh.geometry_fields();
+
+  MeshAdaptor mesh_adaptor(mesh);
+  mesh_adaptor.prepare();
+  mesh_adaptor.make_element_node_connectivity_global();
+
+  // Remove two elements, and add one of them again
+  PackedElement removed_elem(mesh,0,5);
+  mesh_adaptor.remove_element(0,5);
+  mesh_adaptor.remove_element(0,2);
+  mesh_adaptor.add_element(removed_elem);
+  mesh_adaptor.flush_elements();
+
+  const RowChanges& elem_changes = mesh_adaptor.changes().elements(0);
+  BOOST_CHECK_EQUAL(elem_changes.size(), 11u);
+  BOOST_CHECK_EQUAL(elem_changes.removed().size(), 2u);
+  BOOST_CHECK_EQUAL(elem_changes.added().size(), 1u);
+
+  mesh_adaptor.finish();
+  BOOST_CHECK_EQUAL(mesh.elements()[0]->size(), 11u);
+  check_against_rebuild(dict);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( UpdateFaceCellConnectivity )
+{
+  Mesh& mesh = generate("mesh_faces");
+  Handle<FaceCellConnectivity> face_to_cell = mesh.create_component<FaceCellConnectivity>("face_to_cell");
+  face_to_cell->setup(mesh.topology());
+  BOOST_CHECK_EQUAL(face_to_cell->size(), 31u);
+  const Uint revision = mesh.revision();
+
+  MeshAdaptor mesh_adaptor(mesh);
+  mesh_adaptor.prepare();
+  mesh_adaptor.make_element_node_connectivity_global();
+
+  // Remove a corner element with its corner node, and two inner elements
+  // of which one is added again
+  PackedElement removed_elem(mesh,0,5);
+  mesh_adaptor.remove_element(0,0);
+  mesh_adaptor.remove_element(0,5);
+  mesh_adaptor.remove_element(0,6);
+  mesh_adaptor.remove_node(0,0);
+  mesh_adaptor.add_element(removed_elem);
+  mesh_adaptor.flush_elements();
+  mesh_adaptor.flush_nodes();
+  mesh_adaptor.finish();
+
+  // The log is kept by the mesh until its structures are updated again
+  const MeshChangeLog* changes = mesh.changes_since(revision);
+  BOOST_REQUIRE(changes);
+  BOOST_CHECK_EQUAL(changes->elements(0).removed().size(), 3u);
+  BOOST_CHECK_EQUAL(changes->elements(0).added().size(), 1u);
+  BOOST_CHECK(!mesh.changes_since(mesh.revision()));
+
+  face_to_cell->update_connectivity(*changes);
+  BOOST_CHECK_EQUAL(face_to_cell->size(), 31u - 2u);
+  check_faces_against_rebuild(*face_to_cell);
+
+  mesh.update_structures();
+  BOOST_CHECK(!mesh.changes_since(revision));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( UntrackedChanges )
+{
+  // Without a log, the connectivity is rebuilt from scratch
+  Mesh& mesh = *Core::instance().root().get_child("mesh_add")->handle<Mesh>();
+  MeshChangeLog changes;
+  BOOST_CHECK(!changes.applies_to(mesh));
+  changes.reset(mesh);
+  BOOST_CHECK(changes.applies_to(mesh));
+  BOOST_CHECK(changes.empty());
+  changes.invalidate();
+  BOOST_CHECK(!changes.applies_to(mesh));
+  BOOST_CHECK_NO_THROW(mesh.raise_mesh_changed(changes));
+  check_against_rebuild(mesh.geometry_fields());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
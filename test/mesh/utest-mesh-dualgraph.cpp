@@ -0,0 +1,173 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Tests mesh dual graph"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+
+#include "mesh/DualGraph.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct DualGraph_Fixture
+{
+  /// Generate a 2D mesh of 4 x 3 quads
+  Mesh& generate(const std::string& name, const bool bdry)
+  {
+    boost::shared_ptr< MeshGenerator > mesh_generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","mesh_generator_"+name);
+    Core::instance().root().add_component(mesh_generator);
+    mesh_generator->options().set("mesh",Core::instance().root().uri()/name);
+    mesh_generator->options().set("lengths",std::vector<Real>(2,1.));
+    std::vector<Uint> nb_cells(2);
+    nb_cells[0] = 4;
+    nb_cells[1] = 3;
+    mesh_generator->options().set("nb_cells",nb_cells);
+    mesh_generator->options().set("bdry",bdry);
+    return mesh_generator->generate();
+  }
+
+  /// Number of elements for each number of neighbours
+  std::map<Uint,Uint> histogram(const DualGraph& graph)
+  {
+    std::map<Uint,Uint> result;
+    for (Uint e=0; e<graph.size(); ++e)
+      ++result[graph.nb_neighbors(e)];
+    return result;
+  }
+
+  /// Check that every neighbour relation is mutual, and that elements are not their own neighbour
+  void check_symmetric(const DualGraph& graph)
+  {
+    const std::vector<Uint>& offsets = graph.offsets();
+    const std::vector<Uint>& neighbors = graph.neighbors();
+    for (Uint e=0; e<graph.size(); ++e)
+    {
+      BOOST_CHECK(std::adjacent_find(neighbors.begin()+offsets[e],neighbors.begin()+offsets[e+1],std::greater_equal<Uint>()) == neighbors.begin()+offsets[e+1]);
+      for (Uint k=offsets[e]; k<offsets[e+1]; ++k)
+      {
+        const Uint n = neighbors[k];
+        BOOST_CHECK(n != e);
+        BOOST_CHECK(std::binary_search(neighbors.begin()+offsets[n],neighbors.begin()+offsets[n+1],e));
+      }
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( DualGraph_TestSuite, DualGraph_Fixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( NodeNeighbors )
+{
+  Mesh& mesh = generate("mesh",false);
+  const DualGraph& graph = mesh.dual_graph(DualGraph::NODE_NEIGHBORS);
+  BOOST_CHECK_EQUAL(graph.size(), 12u);
+  BOOST_CHECK_EQUAL(graph.nb_owned(), 12u);
+  BOOST_CHECK_EQUAL(graph.adjacency(), DualGraph::NODE_NEIGHBORS);
+
+  // 4 corners, 6 edge cells and 2 interior cells
+  std::map<Uint,Uint> counts = histogram(graph);
+  BOOST_CHECK_EQUAL(counts.size(), 3u);
+  BOOST_CHECK_EQUAL(counts[3], 4u);
+  BOOST_CHECK_EQUAL(counts[5], 6u);
+  BOOST_CHECK_EQUAL(counts[8], 2u);
+  check_symmetric(graph);
+
+  const Entities& cells = *mesh.elements()[0];
+  BOOST_CHECK_EQUAL(graph.element_index(cells,5), 5u);
+  BOOST_CHECK_EQUAL(graph.location(5).first, 0u);
+  BOOST_CHECK_EQUAL(graph.location(5).second, 5u);
+  BOOST_CHECK_EQUAL(graph.glb_idx(5), cells.glb_idx()[5]);
+}
+
+BOOST_AUTO_TEST_CASE( FaceNeighbors )
+{
+  Mesh& mesh = *Core::instance().root().get_child("mesh")->handle<Mesh>();
+  const DualGraph& graph = mesh.dual_graph(DualGraph::FACE_NEIGHBORS);
+
+  std::map<Uint,Uint> counts = histogram(graph);
+  BOOST_CHECK_EQUAL(counts.size(), 3u);
+  BOOST_CHECK_EQUAL(counts[2], 4u);
+  BOOST_CHECK_EQUAL(counts[3], 6u);
+  BOOST_CHECK_EQUAL(counts[4], 2u);
+
+  // Every interior face is seen from both sides
+  BOOST_CHECK_EQUAL(graph.neighbors().size(), 2u*(3u*3u + 4u*2u));
+  check_symmetric(graph);
+}
+
+BOOST_AUTO_TEST_CASE( BoundaryElements )
+{
+  Mesh& mesh = generate("mesh_bdry",true);
+  const DualGraph& face_graph = mesh.dual_graph(DualGraph::FACE_NEIGHBORS);
+  const DualGraph& node_graph = mesh.dual_graph(DualGraph::NODE_NEIGHBORS);
+  check_symmetric(face_graph);
+  check_symmetric(node_graph);
+
+  // Cells only have cells as face neighbours, and boundary lines have none.
+  // Boundary lines are node neighbours of the lines next to them and of the cells they touch.
+  Uint nb_cells = 0;
+  for (Uint e=0; e<face_graph.size(); ++e)
+  {
+    const Entities& entities = *mesh.elements()[face_graph.location(e).first];
+    if (entities.element_type().dimensionality() == DIM_1D)
+    {
+      BOOST_CHECK_EQUAL(face_graph.nb_neighbors(e), 0u);
+      BOOST_CHECK(node_graph.nb_neighbors(e) >= 4u);
+    }
+    else
+    {
+      ++nb_cells;
+    }
+  }
+  BOOST_CHECK_EQUAL(nb_cells, 12u);
+  BOOST_CHECK_EQUAL(face_graph.neighbors().size(), 2u*(3u*3u + 4u*2u));
+}
+
+BOOST_AUTO_TEST_CASE( Caching )
+{
+  Mesh& mesh = *Core::instance().root().get_child("mesh")->handle<Mesh>();
+  const DualGraph& graph = mesh.dual_graph();
+  const std::vector<Uint> neighbors = graph.neighbors();
+  BOOST_CHECK(graph.is_up_to_date(mesh));
+  BOOST_CHECK_EQUAL(&mesh.dual_graph(), &graph);
+
+  // Updating the mesh structures discards the graph, the next access rebuilds it
+  mesh.update_structures();
+  BOOST_CHECK(!graph.is_up_to_date(mesh));
+  BOOST_CHECK(mesh.dual_graph().neighbors() == neighbors);
+
+  // Building without the thread pool gives the same result
+  Handle<DualGraph> serial_graph = Core::instance().root().create_component<DualGraph>("serial_graph");
+  serial_graph->build(mesh, DualGraph::NODE_NEIGHBORS, false);
+  BOOST_CHECK(serial_graph->offsets() == graph.offsets());
+  BOOST_CHECK(serial_graph->neighbors() == neighbors);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -7,8 +7,10 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for cf3::mesh::LoadMesh"
 
-#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <map>
 
+#include <boost/test/unit_test.hpp>
 
 #include "common/FindComponents.hpp"
 #include "common/Log.hpp"
@@ -19,15 +21,26 @@
 #include "common/OptionArray.hpp"
 #include "common/OptionT.hpp"
 #include "common/OptionURI.hpp"
+#include "common/BoostFilesystem.hpp"
 
 #include "common/XML/SignalFrame.hpp"
 #include "common/XML/SignalOptions.hpp"
 
+#include "mesh/Connectivity.hpp"
 #include "mesh/Domain.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Field.hpp"
 #include "mesh/MeshWriter.hpp"
+#include "mesh/Space.hpp"
 
 #include "mesh/LoadMesh.hpp"
 
+#include "mesh/native/MeshCache.hpp"
+#include "mesh/native/Reader.hpp"
+#include "mesh/native/Shared.hpp"
+
 using namespace cf3;
 using namespace cf3::common;
 using namespace cf3::common::XML;
@@ -75,6 +88,91 @@ BOOST_AUTO_TEST_CASE( output )
   mesh_writer->write_from_to(*mesh,"utest-loadmesh-result.msh");
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( cache )
+{
+  // Work on a copy, as the cache is stored next to the source file
+  const URI source("file:utest-loadmesh-cache.neu");
+  {
+    std::ifstream in("../../resources/rotation-tg-p1.neu", std::ios_base::binary);
+    std::ofstream out(source.path().c_str(), std::ios_base::binary);
+    out << in.rdbuf();
+  }
+  const boost::filesystem::path cache_path(native::MeshCache::cache_file(source).path());
+  boost::filesystem::remove(cache_path);
+
+  Handle<LoadMesh> load_mesh = Core::instance().root().get_child("load_mesh")->handle<LoadMesh>();
+  load_mesh->options().set("use_cache",true);
+
+  // The first load parses the source and stores the cache
+  Handle<Mesh> parsed = Core::instance().root().create_component<Mesh>("parsed");
+  load_mesh->load_mesh_into(source,*parsed);
+  BOOST_REQUIRE(boost::filesystem::exists(cache_path));
+  BOOST_CHECK_EQUAL(native::Reader::read_header(cache_path).source_hash, native::MeshCache::source_hash(source,0));
+
+  // The second load reads the cache, giving the same mesh
+  Handle<Mesh> cached = Core::instance().root().create_component<Mesh>("cached");
+  load_mesh->load_mesh_into(source,*cached);
+  BOOST_CHECK_EQUAL(cached->dimension(), parsed->dimension());
+  BOOST_CHECK_EQUAL(cached->geometry_fields().size(), parsed->geometry_fields().size());
+  BOOST_REQUIRE_EQUAL(cached->elements().size(), parsed->elements().size());
+  for (Uint i=0; i<parsed->elements().size(); ++i)
+    BOOST_CHECK_EQUAL(cached->elements()[i]->size(), parsed->elements()[i]->size());
+
+  // Nodes match by global index, with the same coordinates
+  const Dictionary& parsed_nodes = parsed->geometry_fields();
+  const Dictionary& cached_nodes = cached->geometry_fields();
+  std::map<Uint,Uint> parsed_node_idx;
+  for (Uint n=0; n<parsed_nodes.size(); ++n)
+    parsed_node_idx[parsed_nodes.glb_idx()[n]] = n;
+  BOOST_REQUIRE_EQUAL(parsed_node_idx.size(), parsed_nodes.size());
+  BOOST_REQUIRE_EQUAL(cached_nodes.glb_idx().size(), cached_nodes.size());
+  for (Uint n=0; n<cached_nodes.size(); ++n)
+  {
+    const std::map<Uint,Uint>::const_iterator found = parsed_node_idx.find(cached_nodes.glb_idx()[n]);
+    BOOST_REQUIRE(found != parsed_node_idx.end());
+    for (Uint d=0; d<cached_nodes.coordinates().row_size(); ++d)
+      BOOST_CHECK_EQUAL(cached_nodes.coordinates()[n][d], parsed_nodes.coordinates()[found->second][d]);
+  }
+
+  // Elements match by global index, and connect nodes with the same global indices
+  for (Uint i=0; i<parsed->elements().size(); ++i)
+  {
+    const Entities& parsed_elems = *parsed->elements()[i];
+    const Entities& cached_elems = *cached->elements()[i];
+    BOOST_CHECK_EQUAL(cached_elems.parent()->name(), parsed_elems.parent()->name());
+    BOOST_CHECK_EQUAL(cached_elems.element_type().derived_type_name(), parsed_elems.element_type().derived_type_name());
+    std::map<Uint,Uint> parsed_elem_idx;
+    for (Uint e=0; e<parsed_elems.size(); ++e)
+      parsed_elem_idx[parsed_elems.glb_idx()[e]] = e;
+    BOOST_REQUIRE_EQUAL(parsed_elem_idx.size(), parsed_elems.size());
+    const Connectivity& parsed_connectivity = parsed_elems.geometry_space().connectivity();
+    const Connectivity& cached_connectivity = cached_elems.geometry_space().connectivity();
+    for (Uint e=0; e<cached_elems.size(); ++e)
+    {
+      const std::map<Uint,Uint>::const_iterator found = parsed_elem_idx.find(cached_elems.glb_idx()[e]);
+      BOOST_REQUIRE(found != parsed_elem_idx.end());
+      Connectivity::ConstRow cached_row = cached_connectivity[e];
+      Connectivity::ConstRow parsed_row = parsed_connectivity[found->second];
+      BOOST_REQUIRE_EQUAL(cached_row.size(), parsed_row.size());
+      for (Uint k=0; k<cached_row.size(); ++k)
+        BOOST_CHECK_EQUAL(cached_nodes.glb_idx()[cached_row[k]], parsed_nodes.glb_idx()[parsed_row[k]]);
+    }
+  }
+
+  // Another dimension or a modified source invalidate the cache, leaving the mesh untouched
+  native::MeshCache& cache = *load_mesh->get_child("mesh_cache")->handle<native::MeshCache>();
+  Handle<Mesh> stale = Core::instance().root().create_component<Mesh>("stale");
+  BOOST_CHECK(!cache.read(source,3,*stale));
+  {
+    std::ofstream out(source.path().c_str(), std::ios_base::binary | std::ios_base::app);
+    out << "\n";
+  }
+  BOOST_CHECK(!cache.read(source,0,*stale));
+  BOOST_CHECK_EQUAL(stale->dimension(), 0u);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_SUITE_END()
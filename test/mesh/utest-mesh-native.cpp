@@ -0,0 +1,299 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::mesh::native::Reader and Writer"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Log.hpp"
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/List.hpp"
+#include "common/Table.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Foreach.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshWriter.hpp"
+#include "mesh/MeshReader.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Connectivity.hpp"
+
+#include "mesh/native/Reader.hpp"
+#include "mesh/native/Shared.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct NativeMPITests_Fixture
+{
+  /// common setup for each test case
+  NativeMPITests_Fixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// Global indices of the owned nodes, and of the owned elements of every Entities by path in the mesh
+  typedef std::map< std::string, std::vector<Uint> > OwnedIndices;
+
+  /// Add the global indices of the nodes and elements of a mesh that are owned by the given rank
+  void add_owned_indices(const Mesh& mesh, const Uint rank, OwnedIndices& owned)
+  {
+    const Dictionary& nodes = mesh.geometry_fields();
+    std::vector<Uint>& owned_nodes = owned["nodes"];
+    for (Uint n=0; n<nodes.size(); ++n)
+    {
+      if (nodes.rank()[n] == rank)
+        owned_nodes.push_back(nodes.glb_idx()[n]);
+    }
+    boost_foreach(const Handle<Entities>& entities, mesh.elements())
+    {
+      std::vector<Uint>& owned_elements = owned[entities->uri().path().substr(mesh.uri().path().size())];
+      for (Uint e=0; e<entities->size(); ++e)
+      {
+        if (entities->rank()[e] == rank)
+          owned_elements.push_back(entities->glb_idx()[e]);
+      }
+    }
+  }
+
+  int    m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( NativeMPITests_TestSuite, NativeMPITests_Fixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init_mpi )
+{
+  Core::instance().initiate(m_argc,m_argv);
+  PE::Comm::instance().init(m_argc,m_argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( read_on_other_number_of_ranks )
+{
+  // Without arguments, write a mesh to be read by a run on another number of ranks,
+  // which gets the file as argument
+  if (m_argc < 2)
+  {
+    Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("source");
+    boost::shared_ptr< MeshGenerator > generate_mesh = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","source_generator");
+    generate_mesh->options().set("nb_cells",std::vector<Uint>(2,10));
+    generate_mesh->options().set("lengths",std::vector<Real>(2,1.));
+    generate_mesh->options().set("mesh",mesh->uri());
+    generate_mesh->execute();
+    build_component_abstract_type<MeshWriter>("cf3.mesh.native.Writer","source_writer")->write_from_to(*mesh,"redistribute.cf3mesh");
+    return;
+  }
+
+  const boost::filesystem::path path(m_argv[1]);
+  const Uint nb_parts = native::Reader::read_header(path).nb_parts;
+  BOOST_REQUIRE_NE(nb_parts, PE::Comm::instance().size());
+
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("redistributed");
+  boost::shared_ptr< MeshReader > reader = build_component_abstract_type<MeshReader>("cf3.mesh.native.Reader","redistributing_reader");
+  reader->read_mesh_into(path.string(),*mesh);
+
+  // Every rank reads the owned nodes and elements of all parts as the reference
+  OwnedIndices expected;
+  for (Uint part=0; part<nb_parts; ++part)
+  {
+    boost::shared_ptr< native::Reader > part_reader = allocate_component<native::Reader>("part_reader");
+    boost::shared_ptr< Mesh > part_mesh = allocate_component<Mesh>("part");
+    part_reader->read_part(native::part_path(path,part,nb_parts),part,nb_parts,*part_mesh,true);
+    part_mesh->update_structures();
+    add_owned_indices(*part_mesh,part,expected);
+  }
+
+  OwnedIndices owned;
+  add_owned_indices(*mesh,PE::Comm::instance().rank(),owned);
+  for (OwnedIndices::const_iterator it=owned.begin(); it!=owned.end(); ++it)
+    BOOST_CHECK_MESSAGE(expected.count(it->first), "unexpected entities " << it->first);
+
+  // All ranks together own every node and element exactly once
+  for (OwnedIndices::iterator it=expected.begin(); it!=expected.end(); ++it)
+  {
+    std::vector< std::vector<Uint> > gathered;
+    PE::Comm::instance().all_gather(owned[it->first],gathered);
+    std::vector<Uint> all_owned;
+    boost_foreach(const std::vector<Uint>& rank_owned, gathered)
+      all_owned.insert(all_owned.end(),rank_owned.begin(),rank_owned.end());
+    std::sort(all_owned.begin(),all_owned.end());
+    std::sort(it->second.begin(),it->second.end());
+    BOOST_CHECK_MESSAGE(all_owned.size() == it->second.size(), it->first << ": " << all_owned.size() << " owned in total instead of " << it->second.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(all_owned.begin(),all_owned.end(),it->second.begin(),it->second.end());
+  }
+  BOOST_CHECK_EQUAL(expected["nodes"].size(), 121u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( write_and_read_partitioned )
+{
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("mesh");
+  boost::shared_ptr< MeshGenerator > generate_mesh = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","meshgenerator");
+  generate_mesh->options().set("nb_cells",std::vector<Uint>(2,10));
+  generate_mesh->options().set("lengths",std::vector<Real>(2,1.));
+  generate_mesh->options().set("mesh",mesh->uri());
+  generate_mesh->execute();
+
+  Field& solution = mesh->geometry_fields().create_field("solution","u[vector],p");
+  solution.add_tag("solution");
+  for (Uint n=0; n<solution.size(); ++n)
+    for (Uint j=0; j<solution.row_size(); ++j)
+      solution[n][j] = mesh->geometry_fields().glb_idx()[n] + 0.25*j;
+
+  Dictionary& P0 = mesh->create_discontinuous_space("P0","cf3.mesh.LagrangeP0");
+  Field& cell_field = P0.create_field("cell_field");
+  for (Uint n=0; n<cell_field.size(); ++n)
+    cell_field[n][0] = P0.glb_idx()[n];
+
+  mesh->metadata().properties()["time"] = 1.5;
+  mesh->metadata().properties()["iter"] = 7u;
+
+  boost::shared_ptr< MeshWriter > writer = build_component_abstract_type<MeshWriter>("cf3.mesh.native.Writer","writer");
+  writer->write_from_to(*mesh,"restart.cf3mesh");
+
+  Handle<Mesh> restarted = Core::instance().root().create_component<Mesh>("restarted");
+  boost::shared_ptr< MeshReader > reader = build_component_abstract_type<MeshReader>("cf3.mesh.native.Reader","reader");
+  reader->read_mesh_into("restart.cf3mesh",*restarted);
+
+  BOOST_CHECK_EQUAL(restarted->metadata().properties().value<Real>("time"), 1.5);
+  BOOST_CHECK_EQUAL(restarted->metadata().properties().value<Uint>("iter"), 7u);
+
+  // Nodes and fields are restored exactly, including ghosts
+  BOOST_REQUIRE_EQUAL(restarted->dictionaries().size(), mesh->dictionaries().size());
+  for (Uint d=0; d<mesh->dictionaries().size(); ++d)
+  {
+    const Dictionary& dict = *mesh->dictionaries()[d];
+    const Dictionary& restarted_dict = *restarted->dictionaries()[d];
+    BOOST_CHECK_EQUAL(restarted_dict.name(), dict.name());
+    BOOST_CHECK_EQUAL(restarted_dict.continuous(), dict.continuous());
+    BOOST_REQUIRE_EQUAL(restarted_dict.size(), dict.size());
+    for (Uint n=0; n<dict.size(); ++n)
+    {
+      BOOST_CHECK_EQUAL(restarted_dict.glb_idx()[n], dict.glb_idx()[n]);
+      BOOST_CHECK_EQUAL(restarted_dict.rank()[n], dict.rank()[n]);
+    }
+    BOOST_REQUIRE_EQUAL(restarted_dict.fields().size(), dict.fields().size());
+    for (Uint f=0; f<dict.fields().size(); ++f)
+    {
+      const Field& field = *dict.fields()[f];
+      const Field& restarted_field = *restarted_dict.fields()[f];
+      BOOST_CHECK_EQUAL(restarted_field.name(), field.name());
+      BOOST_CHECK_EQUAL(restarted_field.descriptor().description(), field.descriptor().description());
+      BOOST_REQUIRE_EQUAL(restarted_field.row_size(), field.row_size());
+      for (Uint n=0; n<field.size(); ++n)
+        for (Uint j=0; j<field.row_size(); ++j)
+          BOOST_CHECK_EQUAL(restarted_field[n][j], field[n][j]);
+    }
+  }
+  BOOST_CHECK(restarted->geometry_fields().field("solution").has_tag("solution"));
+
+  // Elements and the connectivity of all their spaces
+  BOOST_REQUIRE_EQUAL(restarted->elements().size(), mesh->elements().size());
+  for (Uint e=0; e<mesh->elements().size(); ++e)
+  {
+    const Entities& entities = *mesh->elements()[e];
+    const Entities& restarted_entities = *restarted->elements()[e];
+    BOOST_CHECK_EQUAL(restarted_entities.uri().path().substr(restarted->uri().path().size()),
+                      entities.uri().path().substr(mesh->uri().path().size()));
+    BOOST_REQUIRE_EQUAL(restarted_entities.size(), entities.size());
+    BOOST_REQUIRE_EQUAL(restarted_entities.spaces().size(), entities.spaces().size());
+    for (Uint i=0; i<entities.size(); ++i)
+    {
+      BOOST_CHECK_EQUAL(restarted_entities.glb_idx()[i], entities.glb_idx()[i]);
+      BOOST_CHECK_EQUAL(restarted_entities.rank()[i], entities.rank()[i]);
+    }
+    for (Uint s=0; s<entities.spaces().size(); ++s)
+    {
+      const Connectivity& connectivity = entities.spaces()[s]->connectivity();
+      const Connectivity& restarted_connectivity = restarted_entities.spaces()[s]->connectivity();
+      BOOST_REQUIRE_EQUAL(restarted_connectivity.row_size(), connectivity.row_size());
+      for (Uint i=0; i<connectivity.size(); ++i)
+        for (Uint j=0; j<connectivity.row_size(); ++j)
+          BOOST_CHECK_EQUAL(restarted_connectivity[i][j], connectivity[i][j]);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( detect_corruption )
+{
+  const std::string part = PE::Comm::instance().size() > 1 ? "restart_P"+to_str(PE::Comm::instance().rank())+".cf3mesh" : "restart.cf3mesh";
+  const std::string corrupt = "corrupt_P"+to_str(PE::Comm::instance().rank())+".cf3mesh";
+
+  std::ifstream in(part.c_str(), std::ios_base::binary);
+  std::vector<char> bytes( (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>() );
+  in.close();
+  BOOST_REQUIRE(bytes.size() > 100);
+  bytes[bytes.size()/2] = ~bytes[bytes.size()/2];
+  std::ofstream out(corrupt.c_str(), std::ios_base::binary);
+  out.write(&bytes[0],bytes.size());
+  out.close();
+
+  boost::shared_ptr< native::Reader > reader = allocate_component<native::Reader>("reader");
+  boost::shared_ptr< Mesh > mesh = allocate_component<Mesh>("corrupt");
+  BOOST_CHECK_THROW(reader->read_part(corrupt,PE::Comm::instance().rank(),PE::Comm::instance().size(),*mesh,false), FileFormatError);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( detect_wrong_part )
+{
+  const Uint rank = PE::Comm::instance().rank();
+  const Uint nb_ranks = PE::Comm::instance().size();
+  const std::string part = nb_ranks > 1 ? "restart_P"+to_str(rank)+".cf3mesh" : "restart.cf3mesh";
+
+  boost::shared_ptr< native::Reader > reader = allocate_component<native::Reader>("reader");
+  boost::shared_ptr< Mesh > wrong_part = allocate_component<Mesh>("wrong_part");
+  BOOST_CHECK_THROW(reader->read_part(part,rank+1,nb_ranks,*wrong_part,false), FileFormatError);
+  boost::shared_ptr< Mesh > wrong_nb_parts = allocate_component<Mesh>("wrong_nb_parts");
+  BOOST_CHECK_THROW(reader->read_part(part,rank,nb_ranks+1,*wrong_nb_parts,false), FileFormatError);
+  boost::shared_ptr< Mesh > right_part = allocate_component<Mesh>("right_part");
+  BOOST_CHECK_NO_THROW(reader->read_part(part,rank,nb_ranks,*right_part,false));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize_mpi )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
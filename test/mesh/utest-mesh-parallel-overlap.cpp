@@ -7,6 +7,7 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for parallel fields"
 
+#include <algorithm>
 #include <iomanip>
 #include <set>
 
@@ -44,6 +45,7 @@
 #include "mesh/MeshAdaptor.hpp"
 #include "mesh/CellFaces.hpp"
 #include "mesh/Space.hpp"
+#include "mesh/actions/GrowOverlap.hpp"
 
 using namespace boost;
 using namespace cf3;
@@ -367,6 +369,42 @@ BOOST_CHECK(true);
   CFinfo << "parallel_overlap_P*"+gmsh_writer->get_extensions()[0]+" written" << CFendl;
 }
 
+BOOST_AUTO_TEST_CASE( grow_overlap_layers )
+{
+  boost::shared_ptr< MeshGenerator > meshgenerator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","2Dgenerator");
+  Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("layered_mesh");
+  meshgenerator->options().set("mesh",mesh->uri());
+  meshgenerator->options().set("nb_cells",std::vector<Uint>(2,12));
+  meshgenerator->options().set("lengths",std::vector<Real>(2,1.));
+  meshgenerator->execute();
+
+  boost::shared_ptr< MeshTransformer > grow_overlap = build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GrowOverlap","grow_overlap");
+  grow_overlap->options().set("nb_layers",2u);
+  grow_overlap->transform(*mesh);
+
+  // every element is owned, or in one of the 2 ghost layers
+  Uint max_depth = 0;
+  boost_foreach(const Handle<Entities>& entities, mesh->elements())
+  {
+    Handle< List<Uint> const > depth = actions::GrowOverlap::overlap_depth(*entities);
+    BOOST_REQUIRE(is_not_null(depth));
+    for (Uint elem=0; elem<entities->size(); ++elem)
+    {
+      BOOST_CHECK_EQUAL((*depth)[elem] == 0, !entities->is_ghost(elem));
+      BOOST_CHECK((*depth)[elem] <= 2u);
+      max_depth = std::max(max_depth,(*depth)[elem]);
+    }
+  }
+  if (PE::Comm::instance().size() > 1)
+    BOOST_CHECK_EQUAL(max_depth, 2u);
+
+  const Dictionary& nodes = mesh->geometry_fields();
+  Handle< List<Uint> const > node_depth = actions::GrowOverlap::overlap_depth(nodes);
+  BOOST_REQUIRE(is_not_null(node_depth));
+  for (Uint node=0; node<nodes.size(); ++node)
+    BOOST_CHECK_EQUAL((*node_depth)[node] == 0, !nodes.is_ghost(node));
+}
+
 BOOST_AUTO_TEST_CASE( finalize_mpi )
 {
   PE::Comm::instance().finalize();
@@ -7,18 +7,24 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Tests mesh octtree"
 
+#include <set>
+
 #include <boost/test/unit_test.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/assign/std/vector.hpp>
 
 #include "common/Core.hpp"
+#include "common/Foreach.hpp"
 #include "common/Log.hpp"
 #include "common/OptionList.hpp"
+#include "common/DynTable.hpp"
 #include "common/Table.hpp"
 
 #include "mesh/Mesh.hpp"
 #include "mesh/Elements.hpp"
 #include "mesh/Space.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/MeshAdaptor.hpp"
 #include "mesh/MeshGenerator.hpp"
 #include "mesh/StencilComputerRings.hpp"
 
@@ -47,6 +53,20 @@ struct StencilComputerRings_Fixture
 
   /// possibly common functions used on the tests below
 
+  /// Reference stencil, growing the rings recursively
+  void reference_neighbors(const Dictionary& dict, std::set<SpaceElem>& included, const SpaceElem& element, const Uint level, const Uint nb_rings)
+  {
+    included.insert(element);
+    if (level < nb_rings)
+    {
+      boost_foreach(Uint node_idx, element.nodes())
+      {
+        boost_foreach(const SpaceElem& neighbor_elem, dict.connectivity()[node_idx])
+          reference_neighbors(dict,included,neighbor_elem,level+1,nb_rings);
+      }
+    }
+  }
+
 
   /// common values accessed by all tests goes here
 
@@ -93,6 +113,80 @@ BOOST_AUTO_TEST_CASE( StencilComputerRings_creation )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( StencilComputerRings_all_elements )
+{
+  Mesh& mesh = *Core::instance().root().get_child("mesh")->handle<Mesh>();
+  Handle<Dictionary> dict = mesh.geometry_fields().handle<Dictionary>();
+  Handle<StencilComputerRings> stencil_computer = Core::instance().root().get_child("stencilcomputer")->handle<StencilComputerRings>();
+  const Space& space = mesh.elements()[0]->space(*dict);
+
+  std::vector<SpaceElem> stencil;
+  for (Uint threaded=0; threaded<2; ++threaded)
+  {
+    stencil_computer->options().set("threaded", static_cast<bool>(threaded) );
+    for (Uint nb_rings=0; nb_rings<4; ++nb_rings)
+    {
+      stencil_computer->options().set("nb_rings", nb_rings );
+      stencil_computer->build_stencils();
+      BOOST_CHECK_EQUAL(stencil_computer->stencil_offsets().size(), space.size()+1);
+
+      for (Uint e=0; e<space.size(); ++e)
+      {
+        const SpaceElem space_elem(space,e);
+        BOOST_CHECK_EQUAL(stencil_computer->element_index(space_elem), e);
+
+        std::set<SpaceElem> reference;
+        reference_neighbors(*dict,reference,space_elem,0,nb_rings);
+        stencil_computer->compute_stencil(space_elem, stencil);
+        BOOST_CHECK_EQUAL(stencil.size(), reference.size());
+        BOOST_CHECK(std::equal(stencil.begin(),stencil.end(),reference.begin()));
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( StencilComputerRings_mesh_changed )
+{
+  Mesh& mesh = *Core::instance().root().get_child("mesh")->handle<Mesh>();
+  Handle<Dictionary> dict = mesh.geometry_fields().handle<Dictionary>();
+  Handle<StencilComputerRings> stencil_computer = Core::instance().root().get_child("stencilcomputer")->handle<StencilComputerRings>();
+  const Space& space = mesh.elements()[0]->space(*dict);
+
+  std::vector<SpaceElem> stencil;
+  stencil_computer->options().set("nb_rings", 1u );
+  stencil_computer->compute_stencil(SpaceElem(space,24), stencil);
+  BOOST_CHECK_EQUAL(stencil.size(), 4u);
+
+  // Move the inner element 13 to the end, which moves the corner element 24 into its place.
+  // The number of elements does not change.
+  MeshAdaptor mesh_adaptor(mesh);
+  mesh_adaptor.prepare();
+  mesh_adaptor.make_element_node_connectivity_global();
+  PackedElement moved_elem(mesh,0,13);
+  mesh_adaptor.remove_element(0,13);
+  mesh_adaptor.add_element(moved_elem);
+  mesh_adaptor.finish();
+  BOOST_CHECK_EQUAL(space.size(), 25u);
+
+  stencil_computer->compute_stencil(SpaceElem(space,24), stencil);
+  BOOST_CHECK_EQUAL(stencil.size(), 9u);
+  stencil_computer->compute_stencil(SpaceElem(space,13), stencil);
+  BOOST_CHECK_EQUAL(stencil.size(), 4u);
+
+  for (Uint e=0; e<space.size(); ++e)
+  {
+    const SpaceElem space_elem(space,e);
+    std::set<SpaceElem> reference;
+    reference_neighbors(*dict,reference,space_elem,0,1);
+    stencil_computer->compute_stencil(space_elem, stencil);
+    BOOST_CHECK_EQUAL(stencil.size(), reference.size());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
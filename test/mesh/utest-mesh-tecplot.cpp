@@ -9,9 +9,15 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
 #include "common/Log.hpp"
 #include "common/OptionList.hpp"
 #include "common/Core.hpp"
+#include "common/StringConversion.hpp"
 
 #include "math/VariablesDescriptor.hpp"
 
@@ -49,6 +55,187 @@ struct TecWriterTests_Fixture
   }
   /// possibly common functions used on the tests below
 
+  /// Contents of a zone of a tecplot file
+  struct Zone
+  {
+    std::string name;
+    int zone_type;
+    Uint nb_nodes;
+    Uint nb_elems;
+    std::vector< std::vector<Real> > values; ///< values of each variable
+    std::vector<Uint> connectivity;          ///< zero-based node indices of each element
+  };
+
+  /// Contents of a tecplot file
+  struct TecplotData
+  {
+    std::vector<std::string> var_names;
+    std::vector<int> var_locations;          ///< 0 for nodal, 1 for cell centred variables
+    std::vector<Zone> zones;
+  };
+
+  template<typename T>
+  T read_binary(std::istream& file)
+  {
+    T value;
+    file.read(reinterpret_cast<char*>(&value),sizeof(T));
+    BOOST_REQUIRE(file.good());
+    return value;
+  }
+
+  std::string read_binary_string(std::istream& file)
+  {
+    std::string result;
+    for (int c = read_binary<int>(file); c != 0; c = read_binary<int>(file))
+      result += static_cast<char>(c);
+    return result;
+  }
+
+  static Uint nodes_per_element(const int zone_type)
+  {
+    const Uint nb_nodes[] = {0, 2, 3, 4, 4, 8};
+    return nb_nodes[zone_type];
+  }
+
+  /// Read all sections of a binary (version 112) tecplot file
+  TecplotData read_binary_file(const std::string& path)
+  {
+    TecplotData data;
+    std::ifstream file(path.c_str(), std::ios_base::in | std::ios_base::binary);
+    char magic[8];
+    file.read(magic,8);
+    BOOST_CHECK_EQUAL(std::string(magic,8), "#!TDV112");
+    BOOST_CHECK_EQUAL(read_binary<int>(file), 1); // byte order
+    BOOST_CHECK_EQUAL(read_binary<int>(file), 0); // full file type
+    BOOST_CHECK_EQUAL(read_binary_string(file), "COOLFluiD Mesh Data");
+    const int nb_vars = read_binary<int>(file);
+    for (int v=0; v<nb_vars; ++v)
+      data.var_names.push_back(read_binary_string(file));
+    data.var_locations.assign(nb_vars,0);
+
+    // Zone headers
+    for (float marker = read_binary<float>(file); marker != 357.; marker = read_binary<float>(file))
+    {
+      BOOST_REQUIRE_EQUAL(marker, 299.);
+      Zone zone;
+      zone.name = read_binary_string(file);
+      BOOST_CHECK_EQUAL(read_binary<int>(file), -1); // parent zone
+      BOOST_CHECK_EQUAL(read_binary<int>(file), static_cast<int>(data.zones.size()+1)); // strand id
+      read_binary<double>(file); // solution time
+      read_binary<int>(file);
+      zone.zone_type = read_binary<int>(file);
+      if (read_binary<int>(file))
+      {
+        for (int v=0; v<nb_vars; ++v)
+          data.var_locations[v] = read_binary<int>(file);
+      }
+      BOOST_CHECK_EQUAL(read_binary<int>(file), 0); // face neighbors
+      BOOST_CHECK_EQUAL(read_binary<int>(file), 0); // user-defined face neighbor connections
+      zone.nb_nodes = read_binary<int>(file);
+      zone.nb_elems = read_binary<int>(file);
+      for (Uint i=0; i<4; ++i) // cell dimensions and auxiliary data
+        BOOST_CHECK_EQUAL(read_binary<int>(file), 0);
+      data.zones.push_back(zone);
+    }
+
+    // Zone data
+    for (Uint z=0; z<data.zones.size(); ++z)
+    {
+      Zone& zone = data.zones[z];
+      BOOST_REQUIRE_EQUAL(read_binary<float>(file), 299.);
+      std::vector<int> formats(nb_vars);
+      for (int v=0; v<nb_vars; ++v)
+        formats[v] = read_binary<int>(file);
+      BOOST_CHECK_EQUAL(read_binary<int>(file), 0); // passive variables
+      BOOST_CHECK_EQUAL(read_binary<int>(file), 0); // variable sharing
+      BOOST_CHECK_EQUAL(read_binary<int>(file), -1); // connectivity sharing
+      std::vector<Real> min_values(nb_vars), max_values(nb_vars);
+      for (int v=0; v<nb_vars; ++v)
+      {
+        min_values[v] = read_binary<double>(file);
+        max_values[v] = read_binary<double>(file);
+      }
+      zone.values.resize(nb_vars);
+      for (int v=0; v<nb_vars; ++v)
+      {
+        const Uint nb_values = data.var_locations[v] ? zone.nb_elems : zone.nb_nodes;
+        for (Uint i=0; i<nb_values; ++i)
+          zone.values[v].push_back(formats[v] == 1 ? read_binary<float>(file) : read_binary<double>(file));
+        if (formats[v] == 2 && !zone.values[v].empty()) // the range of single precision variables is computed before rounding
+        {
+          BOOST_CHECK_EQUAL(*std::min_element(zone.values[v].begin(),zone.values[v].end()), min_values[v]);
+          BOOST_CHECK_EQUAL(*std::max_element(zone.values[v].begin(),zone.values[v].end()), max_values[v]);
+        }
+      }
+      for (Uint i=0; i<zone.nb_elems*nodes_per_element(zone.zone_type); ++i)
+        zone.connectivity.push_back(read_binary<int>(file));
+    }
+    BOOST_CHECK(file.peek() == EOF);
+    return data;
+  }
+
+  /// Read an ASCII tecplot file with the same variables and zone types as the given data
+  TecplotData read_ascii_file(const std::string& path, const TecplotData& layout)
+  {
+    TecplotData data;
+    data.var_locations = layout.var_locations;
+    std::ifstream file(path.c_str());
+    std::string line;
+    std::vector<std::string> zone_tokens;
+    std::vector< std::vector<std::string> > tokens;
+    while (std::getline(file,line))
+    {
+      if (line.compare(0,9,"VARIABLES") == 0)
+      {
+        for (std::size_t begin = line.find('"'); begin != std::string::npos; begin = line.find('"',line.find('"',begin+1)+1))
+          data.var_names.push_back(line.substr(begin+1,line.find('"',begin+1)-begin-1));
+      }
+      else if (line.compare(0,4,"ZONE") == 0)
+      {
+        Zone zone;
+        const std::size_t name_begin = line.find("T=\"")+3;
+        zone.name = line.substr(name_begin,line.find('"',name_begin)-name_begin);
+        zone.nb_nodes = from_str<Uint>(line.substr(line.find(", N=")+4,line.find(",",line.find(", N=")+4)-line.find(", N=")-4));
+        zone.nb_elems = from_str<Uint>(line.substr(line.find(", E=")+4,line.find(",",line.find(", E=")+4)-line.find(", E=")-4));
+        zone.zone_type = layout.zones.at(data.zones.size()).zone_type;
+        data.zones.push_back(zone);
+        tokens.push_back(std::vector<std::string>());
+      }
+      else if (!data.zones.empty() && line.compare(0,3,"###") != 0)
+      {
+        std::istringstream words(line);
+        std::string word;
+        while (words >> word)
+          tokens.back().push_back(word);
+      }
+    }
+
+    for (Uint z=0; z<data.zones.size(); ++z)
+    {
+      Zone& zone = data.zones[z];
+      std::vector<Real> values;
+      Uint t = 0;
+      zone.values.resize(data.var_names.size());
+      for (Uint v=0; v<data.var_names.size(); ++v)
+      {
+        const Uint nb_values = data.var_locations[v] ? zone.nb_elems : zone.nb_nodes;
+        while (zone.values[v].size() < nb_values)
+        {
+          BOOST_REQUIRE(t < tokens[z].size());
+          const std::string& token = tokens[z][t++];
+          const std::size_t repeat = token.find('*');
+          if (repeat == std::string::npos)
+            zone.values[v].push_back(from_str<Real>(token));
+          else
+            zone.values[v].resize(zone.values[v].size()+from_str<Uint>(token.substr(0,repeat)),from_str<Real>(token.substr(repeat+1)));
+        }
+      }
+      for (; t<tokens[z].size(); ++t)
+        zone.connectivity.push_back(from_str<Uint>(tokens[z][t])-1);
+    }
+    return data;
+  }
+
 
   /// common values accessed by all tests goes here
   int    m_argc;
@@ -128,7 +315,36 @@ BOOST_AUTO_TEST_CASE( read_2d_mesh )
   tec_writer->options().set("file",URI("quadtriag_filtered.plt"));
   tec_writer->execute();
 
-  BOOST_CHECK(true);
+  tec_writer->options().set("regions",std::vector<URI>(1,mesh.topology().uri()));
+  tec_writer->options().set("file",URI("quadtriag_ascii.plt"));
+  tec_writer->execute();
+  tec_writer->options().set("binary",true);
+  tec_writer->options().set("file",URI("quadtriag_binary.plt"));
+  tec_writer->execute();
+
+  // The binary file holds the same zones, variables and connectivity as the ASCII one
+  const TecplotData binary = read_binary_file("quadtriag_binary.plt");
+  const TecplotData ascii = read_ascii_file("quadtriag_ascii.plt",binary);
+  BOOST_CHECK_EQUAL(binary.var_names.size(), 2u + 2u + 2u + 2u); // coordinates, nodal, cell_centred, nodesP2
+  BOOST_CHECK_EQUAL(std::count(binary.var_locations.begin(),binary.var_locations.end(),1), 2);
+  BOOST_CHECK_EQUAL_COLLECTIONS(ascii.var_names.begin(),ascii.var_names.end(),binary.var_names.begin(),binary.var_names.end());
+  BOOST_CHECK(!binary.zones.empty());
+  BOOST_REQUIRE_EQUAL(ascii.zones.size(), binary.zones.size());
+  for (Uint z=0; z<binary.zones.size(); ++z)
+  {
+    const Zone& bin_zone = binary.zones[z];
+    const Zone& ascii_zone = ascii.zones[z];
+    BOOST_CHECK_EQUAL(ascii_zone.name, bin_zone.name);
+    BOOST_CHECK_EQUAL(ascii_zone.nb_nodes, bin_zone.nb_nodes);
+    BOOST_CHECK_EQUAL(ascii_zone.nb_elems, bin_zone.nb_elems);
+    for (Uint v=0; v<bin_zone.values.size(); ++v)
+    {
+      BOOST_REQUIRE_EQUAL(ascii_zone.values[v].size(), bin_zone.values[v].size());
+      for (Uint i=0; i<bin_zone.values[v].size(); ++i)
+        BOOST_CHECK_SMALL(ascii_zone.values[v][i] - bin_zone.values[v][i], 1e-10*(1.+std::abs(bin_zone.values[v][i])));
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(ascii_zone.connectivity.begin(),ascii_zone.connectivity.end(),bin_zone.connectivity.begin(),bin_zone.connectivity.end());
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
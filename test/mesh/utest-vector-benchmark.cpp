@@ -7,6 +7,9 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Some benchmarkings for vector operations"
 
+// Lets Eigen check that the fixed-size coordinate access does not allocate (debug builds)
+#define EIGEN_RUNTIME_NO_MALLOC
+
 #include <boost/test/unit_test.hpp>
 #include <boost/numeric/ublas/vector.hpp>
 
@@ -18,6 +21,8 @@
 #include "mesh/Elements.hpp"
 #include "mesh/Region.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/LagrangeP1/Quad2D.hpp"
 
 #include "Tools/MeshGeneration/MeshGeneration.hpp"
 #include "Tools/Testing/TimedTestFixture.hpp"
@@ -121,6 +126,35 @@ void centroid_3d(const Table<Uint>::ArrayT& connectivity, const Table<Real>::Arr
   result /= nb_elem;
 }
 
+/// Centroid of all centroids, with the element coordinates returned by value
+Real centroid_get_coordinates(const Space& space, RealVector& result)
+{
+  const Uint nb_elem = space.size();
+  result.setZero();
+  for(Uint elem = 0; elem != nb_elem; ++elem)
+  {
+    const RealMatrix nodes = space.get_coordinates(elem);
+    result += nodes.colwise().sum().transpose() / nodes.rows();
+  }
+  result /= nb_elem;
+  return result[XX];
+}
+
+/// Centroid of all centroids, with the element coordinates put in a caller-owned matrix
+template<typename MatrixT>
+Real centroid_put_coordinates(const Space& space, MatrixT& nodes, RealVector& result)
+{
+  const Uint nb_elem = space.size();
+  result.setZero();
+  for(Uint elem = 0; elem != nb_elem; ++elem)
+  {
+    space.put_coordinates(nodes, elem);
+    result += nodes.colwise().sum().transpose() / nodes.rows();
+  }
+  result /= nb_elem;
+  return result[XX];
+}
+
 BOOST_AUTO_TEST_SUITE( VectorBenchmarkSuite )
 
 // Must be run  before the next tests
@@ -315,4 +349,41 @@ BOOST_FIXTURE_TEST_CASE( EigenVector3DDynamic, VectorBenchmarkFixture )
   BOOST_CHECK_CLOSE(result[ZZ], 2.5, 1e-6);
 }
 
+BOOST_FIXTURE_TEST_CASE( ElementCoordinatesGet, VectorBenchmarkFixture )
+{
+  const Space& space = find_component_recursively_with_filter<Elements>( *grid_2d, IsElementsVolume() ).geometry_space();
+  RealVector result(2);
+  centroid_get_coordinates(space, result);
+
+  BOOST_CHECK_CLOSE(result[XX], 0.5, 1e-6);
+  BOOST_CHECK_CLOSE(result[YY], 0.5, 1e-6);
+}
+
+BOOST_FIXTURE_TEST_CASE( ElementCoordinatesPut, VectorBenchmarkFixture )
+{
+  const Space& space = find_component_recursively_with_filter<Elements>( *grid_2d, IsElementsVolume() ).geometry_space();
+  RealVector result(2);
+  RealMatrix nodes;
+  space.allocate_coordinates(nodes);
+  centroid_put_coordinates(space, nodes, result);
+
+  BOOST_CHECK_CLOSE(result[XX], 0.5, 1e-6);
+  BOOST_CHECK_CLOSE(result[YY], 0.5, 1e-6);
+}
+
+BOOST_FIXTURE_TEST_CASE( ElementCoordinatesFixedSize, VectorBenchmarkFixture )
+{
+  const Space& space = find_component_recursively_with_filter<Elements>( *grid_2d, IsElementsVolume() ).geometry_space();
+  RealVector result(2);
+  LagrangeP1::Quad2D::NodesT nodes;
+
+  // No heap allocation at all in the element loop
+  Eigen::internal::set_is_malloc_allowed(false);
+  centroid_put_coordinates(space, nodes, result);
+  Eigen::internal::set_is_malloc_allowed(true);
+
+  BOOST_CHECK_CLOSE(result[XX], 0.5, 1e-6);
+  BOOST_CHECK_CLOSE(result[YY], 0.5, 1e-6);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -9,8 +9,14 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <fstream>
+#include <sstream>
+
 #include "common/Log.hpp"
 #include "common/Core.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionArray.hpp"
+#include "common/OptionURI.hpp"
 
 #include "mesh/MeshWriter.hpp"
 
@@ -19,6 +25,8 @@
 #include "common/List.hpp"
 #include "common/Table.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
 
 using namespace cf3;
 using namespace cf3::mesh;
@@ -45,6 +53,74 @@ BOOST_AUTO_TEST_CASE( WriteGrid )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( WriteSinglePrecisionField )
+{
+  Component& root = Core::instance().root();
+
+  Handle<Mesh> mesh = root.create_component<Mesh>("mesh_single");
+  Tools::MeshGeneration::create_rectangle(*mesh, 5., 5., 5, 5);
+
+  Field& double_field = mesh->geometry_fields().create_field("double_field","a");
+  Field& single_field = mesh->geometry_fields().create_field("single_field","b");
+  single_field.set_single_precision(true);
+  BOOST_CHECK(!double_field.single_precision());
+  BOOST_CHECK(single_field.single_precision());
+
+  std::vector<URI> fields;
+  fields.push_back(double_field.uri());
+  fields.push_back(single_field.uri());
+
+  boost::shared_ptr< MeshWriter > vtk_writer = build_component_abstract_type<MeshWriter>("cf3.mesh.VTKLegacy.Writer","meshwriter");
+  vtk_writer->options().set("fields",fields);
+  vtk_writer->write_from_to(*mesh,"grid_single.vtk");
+
+  std::ifstream file("grid_single.vtk");
+  std::stringstream contents;
+  contents << file.rdbuf();
+  BOOST_CHECK(contents.str().find("SCALARS a double") != std::string::npos);
+  BOOST_CHECK(contents.str().find("SCALARS b float") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE( WriteBinary )
+{
+  Component& root = Core::instance().root();
+
+  Handle<Mesh> mesh = root.create_component<Mesh>("mesh_binary");
+  Tools::MeshGeneration::create_rectangle(*mesh, 5., 5., 5, 5);
+
+  Field& field = mesh->geometry_fields().create_field("binary_field","c");
+  for(Uint i = 0; i != field.size(); ++i)
+    field[i][0] = i;
+
+  std::vector<URI> fields;
+  fields.push_back(field.uri());
+
+  boost::shared_ptr< MeshWriter > vtk_writer = build_component_abstract_type<MeshWriter>("cf3.mesh.VTKLegacy.Writer","meshwriter");
+  vtk_writer->options().set("fields",fields);
+  vtk_writer->options().set("binary",true);
+  vtk_writer->write_from_to(*mesh,"grid_binary.vtk");
+
+  std::ifstream file("grid_binary.vtk", std::ios_base::in | std::ios_base::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  const std::string str = contents.str();
+  BOOST_CHECK(str.find("BINARY\n") != std::string::npos);
+
+  // Values are big endian, the last value of the field is the number of nodes - 1
+  const std::string::size_type data_begin = str.find("LOOKUP_TABLE default\n") + 21;
+  const std::string::size_type last_value = data_begin + (field.size()-1)*sizeof(double);
+  BOOST_REQUIRE(last_value + sizeof(double) < str.size());
+  double value;
+  char* bytes = reinterpret_cast<char*>(&value);
+  const int one = 1;
+  const bool little_endian = *reinterpret_cast<const char*>(&one) == 1;
+  for(Uint i = 0; i != sizeof(double); ++i)
+    bytes[little_endian ? sizeof(double)-1-i : i] = str[last_value+i];
+  BOOST_CHECK_EQUAL(value, static_cast<double>(field.size()-1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
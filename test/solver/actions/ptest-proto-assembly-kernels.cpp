@@ -0,0 +1,247 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of element matrix kernels, hand-written and through Proto expressions"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Table.hpp"
+
+#include "math/MatrixTypes.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/LagrangeP1/Line1D.hpp"
+#include "mesh/LagrangeP1/Triag2D.hpp"
+#include "mesh/LagrangeP1/Quad2D.hpp"
+#include "mesh/LagrangeP1/Tetra3D.hpp"
+#include "mesh/LagrangeP1/Hexa3D.hpp"
+#include "mesh/LagrangeP2/Line1D.hpp"
+#include "mesh/LagrangeP2/Triag2D.hpp"
+#include "mesh/LagrangeP2/Quad2D.hpp"
+
+#include "solver/actions/Proto/ElementLooper.hpp"
+#include "solver/actions/Proto/GaussPoints.hpp"
+#include "solver/actions/Proto/Terminals.hpp"
+
+#include "Tools/Testing/BenchmarkFixture.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::solver::actions::Proto;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+const Uint gauss_order = 2;
+
+/// Number of elements to assemble, given on the command line
+Uint nb_elements()
+{
+  const int argc = boost::unit_test::framework::master_test_suite().argc;
+  char** argv = boost::unit_test::framework::master_test_suite().argv;
+  return Tools::Testing::BenchmarkFixture::scaled(argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 10000u);
+}
+
+/// Nodes of element elem_idx: a scaled and shifted copy of the reference element
+template<typename ETYPE>
+void element_nodes(const Uint elem_idx, typename ETYPE::NodesT& nodes)
+{
+  nodes = ETYPE::SF::local_coordinates();
+  nodes *= 1. + 0.01*(elem_idx % 7);
+  nodes.col(0).array() += 0.1*(elem_idx % 5);
+}
+
+/// Laplacian element matrix, evaluating the shape function gradients at every Gauss point
+template<typename ETYPE>
+void generic_laplacian(const typename ETYPE::NodesT& nodes, Eigen::Matrix<Real, ETYPE::nb_nodes, ETYPE::nb_nodes>& result)
+{
+  typedef mesh::Integrators::GaussMappedCoords<gauss_order, ETYPE::shape> GaussT;
+  typename ETYPE::SF::GradientT mapped_gradient;
+  typename ETYPE::SF::GradientT gradient;
+  typename ETYPE::JacobianT jacobian;
+  result.setZero();
+  for(Uint i = 0; i != GaussT::nb_points; ++i)
+  {
+    const typename ETYPE::MappedCoordsT mapped_coords = GaussT::instance().coords.col(i);
+    ETYPE::SF::compute_gradient(mapped_coords, mapped_gradient);
+    ETYPE::compute_jacobian(mapped_coords, nodes, jacobian);
+    gradient.noalias() = jacobian.inverse() * mapped_gradient;
+    result.noalias() += GaussT::instance().weights[i] * jacobian.determinant() * gradient.transpose() * gradient;
+  }
+}
+
+/// Laplacian element matrix, taking the mapped shape function gradients from the table
+template<typename ETYPE>
+void tabulated_laplacian(const typename ETYPE::NodesT& nodes, Eigen::Matrix<Real, ETYPE::nb_nodes, ETYPE::nb_nodes>& result)
+{
+  typedef GaussShapeFunctionTable<ETYPE, gauss_order, ETYPE::shape> TableT;
+  const TableT& table = TableT::instance();
+  typename ETYPE::SF::GradientT gradient;
+  typename ETYPE::JacobianT jacobian;
+  result.setZero();
+  for(Uint i = 0; i != TableT::nb_points; ++i)
+  {
+    jacobian.noalias() = table.mapped_gradients[i] * nodes;
+    gradient.noalias() = jacobian.inverse() * table.mapped_gradients[i];
+    result.noalias() += TableT::GaussT::instance().weights[i] * jacobian.determinant() * gradient.transpose() * gradient;
+  }
+}
+
+/// Mesh of nb_elems disconnected elements, element e having the nodes given by element_nodes
+template<typename ETYPE>
+Mesh& create_mesh(const std::string& element_type_name, const Uint nb_elems)
+{
+  const std::string name = "mesh_" + boost::lexical_cast<std::string>(ETYPE::order) + "_" + ETYPE::type_name();
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>(name);
+  mesh.initialize_nodes(nb_elems*ETYPE::nb_nodes, ETYPE::dimension);
+  Table<Real>& coordinates = mesh.geometry_fields().coordinates();
+  Elements& elements = mesh.topology().create_region("region").create_elements(element_type_name, mesh.geometry_fields());
+  elements.resize(nb_elems);
+  Table<Uint>& connectivity = elements.geometry_space().connectivity();
+
+  typename ETYPE::NodesT nodes;
+  for(Uint e = 0; e != nb_elems; ++e)
+  {
+    element_nodes<ETYPE>(e, nodes);
+    for(Uint i = 0; i != ETYPE::nb_nodes; ++i)
+    {
+      const Uint node = e*ETYPE::nb_nodes + i;
+      connectivity[e][i] = node;
+      for(Uint d = 0; d != ETYPE::dimension; ++d)
+        coordinates[node][d] = nodes(i,d);
+    }
+  }
+
+  mesh.geometry_fields().create_field("solution", "T").add_tag("solution");
+  return mesh;
+}
+
+/// Check that two summed element matrices agree
+template<typename MatrixT>
+void check_sums(const MatrixT& reference, const MatrixT& result, const Uint nb_elems)
+{
+  for(Uint i = 0; i != reference.rows(); ++i)
+    for(Uint j = 0; j != reference.cols(); ++j)
+      BOOST_CHECK_SMALL(reference(i,j) - result(i,j), 1e-8 * nb_elems);
+}
+
+/// Time the hand-written kernels and the Proto integral and element_quadrature expressions
+/// for the given element type, and check that they agree
+template<typename ETYPE>
+void run_benchmark(Tools::Testing::BenchmarkFixture& benchmark, const std::string& element_type_name)
+{
+  typedef Eigen::Matrix<Real, ETYPE::nb_nodes, ETYPE::nb_nodes> MatrixT;
+  typedef boost::mpl::vector1<ETYPE> ElementsT;
+  const Uint nb_elems = nb_elements();
+
+  typename ETYPE::NodesT nodes;
+  MatrixT generic_result, tabulated_result;
+  MatrixT generic_sum = MatrixT::Zero();
+  MatrixT tabulated_sum = MatrixT::Zero();
+  MatrixT integral_sum = MatrixT::Zero();
+  MatrixT quadrature_sum = MatrixT::Zero();
+
+  // Build the table and the mesh outside of the timed sections
+  GaussShapeFunctionTable<ETYPE, gauss_order, ETYPE::shape>::instance();
+  Mesh& mesh = create_mesh<ETYPE>(element_type_name, nb_elems);
+  FieldVariable<0, ScalarField> T("T", "solution");
+
+  benchmark.restart_timer();
+  for(Uint e = 0; e != nb_elems; ++e)
+  {
+    element_nodes<ETYPE>(e, nodes);
+    generic_laplacian<ETYPE>(nodes, generic_result);
+    generic_sum += generic_result;
+  }
+  benchmark.record("generic", nb_elems, "elements");
+
+  benchmark.restart_timer();
+  for(Uint e = 0; e != nb_elems; ++e)
+  {
+    element_nodes<ETYPE>(e, nodes);
+    tabulated_laplacian<ETYPE>(nodes, tabulated_result);
+    tabulated_sum += tabulated_result;
+  }
+  benchmark.record("tabulated", nb_elems, "elements");
+
+  benchmark.restart_timer();
+  for_each_element<ElementsT>(mesh.topology(), boost::proto::lit(integral_sum) += integral<gauss_order>(transpose(nabla(T))*nabla(T)));
+  benchmark.record("proto integral", nb_elems, "elements");
+
+  benchmark.restart_timer();
+  for_each_element<ElementsT>(mesh.topology(), element_quadrature(boost::proto::lit(quadrature_sum) += transpose(nabla(T))*nabla(T)));
+  benchmark.record("proto element_quadrature", nb_elems, "elements");
+
+  check_sums(generic_sum, tabulated_sum, nb_elems);
+  check_sums(generic_sum, integral_sum, nb_elems);
+  check_sums(generic_sum, quadrature_sum, nb_elems);
+
+  Core::instance().root().remove_component(mesh);
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( ProtoAssemblyKernelsSuite, Tools::Testing::BenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( P1Line1D )
+{
+  run_benchmark<LagrangeP1::Line1D>(*this, "cf3.mesh.LagrangeP1.Line1D");
+}
+
+BOOST_AUTO_TEST_CASE( P1Triag2D )
+{
+  run_benchmark<LagrangeP1::Triag2D>(*this, "cf3.mesh.LagrangeP1.Triag2D");
+}
+
+BOOST_AUTO_TEST_CASE( P1Quad2D )
+{
+  run_benchmark<LagrangeP1::Quad2D>(*this, "cf3.mesh.LagrangeP1.Quad2D");
+}
+
+BOOST_AUTO_TEST_CASE( P1Tetra3D )
+{
+  run_benchmark<LagrangeP1::Tetra3D>(*this, "cf3.mesh.LagrangeP1.Tetra3D");
+}
+
+BOOST_AUTO_TEST_CASE( P1Hexa3D )
+{
+  run_benchmark<LagrangeP1::Hexa3D>(*this, "cf3.mesh.LagrangeP1.Hexa3D");
+}
+
+BOOST_AUTO_TEST_CASE( P2Line1D )
+{
+  run_benchmark<LagrangeP2::Line1D>(*this, "cf3.mesh.LagrangeP2.Line1D");
+}
+
+BOOST_AUTO_TEST_CASE( P2Triag2D )
+{
+  run_benchmark<LagrangeP2::Triag2D>(*this, "cf3.mesh.LagrangeP2.Triag2D");
+}
+
+BOOST_AUTO_TEST_CASE( P2Quad2D )
+{
+  run_benchmark<LagrangeP2::Quad2D>(*this, "cf3.mesh.LagrangeP2.Quad2D");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -47,8 +47,8 @@
 #include "solver/actions/Proto/Terminals.hpp"
 
 #include "Tools/MeshGeneration/MeshGeneration.hpp"
+#include "Tools/Testing/BenchmarkFixture.hpp"
 #include "Tools/Testing/ProfiledTestFixture.hpp"
-#include "Tools/Testing/TimedTestFixture.hpp"
 
 using namespace cf3;
 using namespace cf3::solver;
@@ -61,7 +61,7 @@ using namespace cf3::common;
 
 struct ProtoBenchmarkFixture :
   public Tools::Testing::ProfiledTestFixture,
-  public Tools::Testing::TimedTestFixture
+  public Tools::Testing::BenchmarkFixture
 {
   ProtoBenchmarkFixture() :
     root(Core::instance().root()),
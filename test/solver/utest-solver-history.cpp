@@ -0,0 +1,230 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the binary format of cf3::solver::History"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <boost/cstdint.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/OptionList.hpp"
+#include "common/Table.hpp"
+#include "common/URI.hpp"
+
+#include "solver/History.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::solver;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Chunk of a binary history file
+struct HistoryChunk
+{
+  char tag;
+  std::vector<std::string> names;          ///< column names of a 'V' chunk
+  Uint nb_rows;                            ///< number of rows of a 'D' chunk
+  std::vector< std::vector<Real> > columns;///< values of a 'D' chunk, column by column
+};
+
+struct History_Fixture
+{
+  History_Fixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// Create a binary history, logging to given file
+  Handle<History> create_history(const std::string& name, const std::string& file, const Uint chunk_size, const Uint max_rows)
+  {
+    Handle<History> history = Core::instance().root().create_component<History>(name);
+    history->options().set("dimension",1u);
+    history->options().set("format",std::string("binary"));
+    history->options().set("file",URI(file));
+    history->options().set("chunk_size",chunk_size);
+    history->options().set("max_rows",max_rows);
+    return history;
+  }
+
+  /// Read a binary history file, checking its header
+  std::vector<HistoryChunk> read_chunks(const std::string& file)
+  {
+    std::ifstream in(file.c_str(), std::ios_base::binary);
+    const std::vector<char> bytes( (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>() );
+    BOOST_REQUIRE(bytes.size() >= 12u);
+    BOOST_CHECK_EQUAL(std::string(&bytes[0]), std::string("CF3HIST"));
+    BOOST_CHECK_EQUAL(read<boost::uint32_t>(bytes,8), 1u);
+
+    std::vector<HistoryChunk> chunks;
+    std::size_t pos = 12;
+    while (pos < bytes.size())
+    {
+      HistoryChunk chunk;
+      chunk.tag = static_cast<char>(read<boost::uint32_t>(bytes,pos));
+      chunk.nb_rows = 0;
+      if (chunk.tag == 'V')
+      {
+        const Uint nb_columns = read<boost::uint32_t>(bytes,pos+4);
+        pos += 8;
+        for (Uint c=0; c<nb_columns; ++c)
+        {
+          const Uint length = read<boost::uint32_t>(bytes,pos);
+          chunk.names.push_back(std::string(&bytes[pos+4],length));
+          pos += 4+length;
+        }
+      }
+      else
+      {
+        BOOST_REQUIRE_EQUAL(chunk.tag, 'D');
+        chunk.nb_rows = read<boost::uint32_t>(bytes,pos+4);
+        const Uint nb_columns = read<boost::uint32_t>(bytes,pos+8);
+        pos += 12;
+        chunk.columns.resize(nb_columns,std::vector<Real>(chunk.nb_rows));
+        for (Uint c=0; c<nb_columns; ++c)
+        {
+          for (Uint r=0; r<chunk.nb_rows; ++r)
+            chunk.columns[c][r] = read<double>(bytes,pos+8*(c*chunk.nb_rows+r));
+        }
+        pos += 8*nb_columns*chunk.nb_rows;
+      }
+      BOOST_REQUIRE(pos <= bytes.size());
+      chunks.push_back(chunk);
+    }
+    return chunks;
+  }
+
+  template <typename T>
+  T read(const std::vector<char>& bytes, const std::size_t pos)
+  {
+    BOOST_REQUIRE(pos+sizeof(T) <= bytes.size());
+    T value;
+    std::memcpy(&value,&bytes[pos],sizeof(T));
+    return value;
+  }
+
+  /// Check a data chunk holding entries [first, first+nb_rows)
+  void check_data(const HistoryChunk& chunk, const Uint first, const Uint nb_rows, const Uint nb_columns)
+  {
+    BOOST_REQUIRE_EQUAL(chunk.tag, 'D');
+    BOOST_REQUIRE_EQUAL(chunk.nb_rows, nb_rows);
+    BOOST_REQUIRE_EQUAL(chunk.columns.size(), nb_columns);
+    for (Uint r=0; r<nb_rows; ++r)
+    {
+      const Real i = first+r;
+      BOOST_CHECK_EQUAL(chunk.columns[0][r], i);
+      BOOST_CHECK_EQUAL(chunk.columns[1][r], 0.5*i);
+      if (nb_columns == 3)
+        BOOST_CHECK_EQUAL(chunk.columns[2][r], 10.*i);
+    }
+  }
+
+  int    m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( History_TestSuite, History_Fixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( binary_chunks )
+{
+  Handle<History> history = create_history("history","utest-solver-history.bin",2u,3u);
+
+  // 5 entries of 2 variables, then 2 entries with an added variable
+  for (Uint i=0; i<7; ++i)
+  {
+    history->set("iter",Real(i));
+    history->set("time",0.5*i);
+    if (i >= 5)
+      history->set("res",10.*i);
+    history->save_entry();
+  }
+  history->flush();
+
+  const std::vector<HistoryChunk> chunks = read_chunks("utest-solver-history.bin");
+  BOOST_REQUIRE_EQUAL(chunks.size(), 6u);
+
+  BOOST_CHECK_EQUAL(chunks[0].tag, 'V');
+  BOOST_REQUIRE_EQUAL(chunks[0].names.size(), 2u);
+  BOOST_CHECK_EQUAL(chunks[0].names[0], "iter");
+  BOOST_CHECK_EQUAL(chunks[0].names[1], "time");
+  check_data(chunks[1],0,2,2);
+  check_data(chunks[2],2,2,2);
+  // the pending entry is written before the variables change
+  check_data(chunks[3],4,1,2);
+  BOOST_CHECK_EQUAL(chunks[4].tag, 'V');
+  BOOST_REQUIRE_EQUAL(chunks[4].names.size(), 3u);
+  BOOST_CHECK_EQUAL(chunks[4].names[2], "res");
+  check_data(chunks[5],5,2,3);
+
+  // Accessing the table trims it to the last max_rows entries, 4 to 6
+  Handle<Table<Real> const> table = history->table();
+  BOOST_REQUIRE_EQUAL(table->size(), 3u);
+  for (Uint row=0; row<table->size(); ++row)
+  {
+    BOOST_CHECK_EQUAL((*table)[row][0], Real(row+4));
+    BOOST_CHECK_EQUAL((*table)[row][1], 0.5*(row+4));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( single_entry_chunks )
+{
+  // Every entry is written immediately, the first one included
+  Handle<History> history = create_history("history_single","utest-solver-history-single.bin",1u,0u);
+  for (Uint i=0; i<2; ++i)
+  {
+    history->set("iter",Real(i));
+    history->set("time",0.5*i);
+    history->save_entry();
+  }
+
+  const std::vector<HistoryChunk> chunks = read_chunks("utest-solver-history-single.bin");
+  BOOST_REQUIRE_EQUAL(chunks.size(), 3u);
+  BOOST_CHECK_EQUAL(chunks[0].tag, 'V');
+  check_data(chunks[1],0,1,2);
+  check_data(chunks[2],1,1,2);
+  BOOST_CHECK_EQUAL(history->table()->size(), 2u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( python_reader )
+{
+  // Arguments: python interpreter, and the directory holding history.py
+  if (m_argc < 3)
+  {
+    BOOST_TEST_MESSAGE("No python interpreter given, skipping history.py");
+    return;
+  }
+
+  const std::string script =
+      "import sys; sys.path.insert(0,'" + std::string(m_argv[2]) + "'); import history; "
+      "c = history.read('utest-solver-history.bin'); "
+      "assert sorted(c.keys()) == ['iter','res','time']; "
+      "assert list(c['iter']) == [0,1,2,3,4,5,6]; "
+      "assert list(c['time']) == [0,0.5,1,1.5,2,2.5,3]; "
+      "assert list(c['res']) == [0,0,0,0,0,50,60]";
+  const std::string command = std::string(m_argv[1]) + " -c \"" + script + "\"";
+  BOOST_CHECK_EQUAL(std::system(command.c_str()), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
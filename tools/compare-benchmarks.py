@@ -0,0 +1,53 @@
+#!python
+# -*- coding: utf-8 -*-
+
+# Compare the JSON results of the benchmarks target between two builds, e.g. of two revisions.
+# usage: compare-benchmarks.py <reference dir or file> <new dir or file> [relative tolerance, default 0.1]
+# Prints the time and peak memory ratios new/reference for every measurement, and exits with
+# status 1 if any measurement became slower, or used more memory, than the tolerance allows.
+
+import sys
+import os
+import json
+
+def load_results(path):
+  files = []
+  if os.path.isdir(path):
+    files = [os.path.join(path, f) for f in sorted(os.listdir(path)) if f.endswith('.json')]
+  else:
+    files = [path]
+  results = {}
+  for filename in files:
+    with open(filename) as f:
+      data = json.load(f)
+    suite = os.path.splitext(os.path.basename(filename))[0]
+    for result in data['results']:
+      results[(suite, result['name'])] = result
+  return results
+
+reference = load_results(sys.argv[1])
+new = load_results(sys.argv[2])
+tolerance = float(sys.argv[3]) if len(sys.argv) > 3 else 0.1
+
+regressions = 0
+print('%-40s %-50s %12s %12s %8s %14s' % ('benchmark', 'measurement', 'ref time', 'new time', 'ratio', 'peak mem ratio'))
+for key in sorted(set(reference.keys()) & set(new.keys())):
+  ref = reference[key]
+  cur = new[key]
+  ratio = cur['time'] / ref['time'] if ref['time'] > 0. else 1.
+  mem_ratio = cur['memory_peak'] / ref['memory_peak'] if ref['memory_peak'] > 0. else 1.
+  flag = ''
+  if ratio > 1. + tolerance:
+    flag = '  SLOWER'
+    regressions += 1
+  elif ratio < 1. - tolerance:
+    flag = '  faster'
+  if mem_ratio > 1. + tolerance:
+    flag += '  MORE MEMORY'
+    regressions += 1
+  print('%-40s %-50s %12.4g %12.4g %8.3f %14.3f%s' % (key[0], key[1], ref['time'], cur['time'], ratio, mem_ratio, flag))
+
+for key in sorted(set(reference.keys()) ^ set(new.keys())):
+  print('%-40s %-50s only in %s' % (key[0], key[1], 'reference' if key in reference else 'new results'))
+
+sys.exit(1 if regressions > 0 else 0)